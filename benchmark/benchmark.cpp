@@ -0,0 +1,157 @@
+// benchmark.cpp
+//
+// Copyright (C) 2019, 2020 zjhlogo
+//
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or (at
+// your option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License (COPYING.txt) for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+// The developer's email is zjhlogo@gmzigail.com (for great email, take
+// off every 'zig'.)
+//
+
+#include "benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using namespace bench;
+
+namespace
+{
+
+    struct BenchmarkEntry
+    {
+        std::string name;
+        BenchmarkFunc func;
+    };
+
+    std::vector<BenchmarkEntry>& GetBenchmarks()
+    {
+        static std::vector<BenchmarkEntry> benchmarks;
+        return benchmarks;
+    }
+
+    // Returns the value of an argument of the form "<prefix><value>", or NULL
+    // if the argument does not start with the prefix.
+    const char* GetArgValue(const char* arg, const char* prefix)
+    {
+        size_t length = strlen(prefix);
+        return strncmp(arg, prefix, length) == 0 ? arg + length : NULL;
+    }
+
+    volatile double g_sink;
+
+} // namespace
+
+State::State(double minTime, int64_t minIterations)
+    : m_minTime(minTime)
+    , m_minIterations(minIterations)
+    , m_iterations(-1)
+    , m_samplesPerIteration(1)
+    , m_elapsedTime(0.0)
+{
+}
+
+bool State::keepRunning()
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (m_iterations < 0)
+    {
+        m_startTime = now;
+        m_iterations = 0;
+        return true;
+    }
+
+    m_iterations++;
+    m_elapsedTime = std::chrono::duration<double>(now - m_startTime).count();
+    return m_elapsedTime < m_minTime || m_iterations < m_minIterations;
+}
+
+void bench::RegisterBenchmark(const std::string& name, const BenchmarkFunc& func)
+{
+    BenchmarkEntry entry;
+    entry.name = name;
+    entry.func = func;
+    GetBenchmarks().push_back(entry);
+}
+
+int bench::RunBenchmarks(int argc, char** argv)
+{
+    const char* filter = "";
+    double minTime = 0.5;
+    bool listOnly = false;
+    for (int i = 1; i < argc; i++)
+    {
+        const char* value;
+        if ((value = GetArgValue(argv[i], "--benchmark_filter=")) != NULL)
+        {
+            filter = value;
+        }
+        else if ((value = GetArgValue(argv[i], "--benchmark_min_time=")) != NULL)
+        {
+            minTime = atof(value);
+        }
+        else if (strcmp(argv[i], "--benchmark_list") == 0)
+        {
+            listOnly = true;
+        }
+        else
+        {
+            fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            fprintf(stderr, "usage: %s [--benchmark_filter=<text>] [--benchmark_min_time=<seconds>] [--benchmark_list]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (!listOnly)
+    {
+        printf("%-48s %12s %14s %16s\n", "Benchmark", "Iterations", "ns/sample", "samples/sec");
+        printf("%s\n", std::string(93, '-').c_str());
+    }
+
+    const std::vector<BenchmarkEntry>& benchmarks = GetBenchmarks();
+    for (size_t i = 0; i < benchmarks.size(); i++)
+    {
+        const BenchmarkEntry& entry = benchmarks[i];
+        if (entry.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        if (listOnly)
+        {
+            printf("%s\n", entry.name.c_str());
+            continue;
+        }
+
+        State state(minTime, 1);
+        entry.func(state);
+
+        double samples = (double)state.getSamples();
+        double elapsedTime = state.getElapsedTime();
+        double nsPerSample = samples > 0.0 ? elapsedTime * 1.0e9 / samples : 0.0;
+        double samplesPerSec = elapsedTime > 0.0 ? samples / elapsedTime : 0.0;
+        printf("%-48s %12lld %14.2f %16.0f\n", entry.name.c_str(), (long long)state.getIterations(), nsPerSample, samplesPerSec);
+        fflush(stdout);
+    }
+
+    return 0;
+}
+
+void bench::DoNotOptimize(double value)
+{
+    g_sink = value;
+}
@@ -0,0 +1,130 @@
+// benchmark.h
+//
+// Copyright (C) 2019, 2020 zjhlogo
+//
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or (at
+// your option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License (COPYING.txt) for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+// The developer's email is zjhlogo@gmzigail.com (for great email, take
+// off every 'zig'.)
+//
+
+#ifndef NOISE_BENCHMARK_H
+#define NOISE_BENCHMARK_H
+
+#include <chrono>
+#include <functional>
+#include <stdint.h>
+#include <string>
+
+namespace bench
+{
+
+    /// Running state of a single benchmark.
+    ///
+    /// A benchmark function repeats its timed body while keepRunning()
+    /// returns true, and reports how many samples one pass of the body
+    /// generates:
+    ///
+    /// @code
+    /// void PerlinBenchmark(bench::State& state)
+    /// {
+    ///     noise::module::Perlin perlin;
+    ///     state.setSamplesPerIteration(1);
+    ///     while (state.keepRunning())
+    ///     {
+    ///         bench::DoNotOptimize(perlin.getValue(0.5, 0.5, 0.5));
+    ///     }
+    /// }
+    /// @endcode
+    ///
+    /// Setup code placed before the loop is not timed.
+    class State
+    {
+    public:
+        State(double minTime, int64_t minIterations);
+
+        /// Returns true while the timed body must be run again.
+        ///
+        /// The timer starts on the first call and stops once the body has
+        /// run for at least the minimum time and the minimum number of
+        /// iterations.
+        bool keepRunning();
+
+        /// Sets the number of samples generated by one pass of the timed
+        /// body.
+        void setSamplesPerIteration(int64_t samples)
+        {
+            m_samplesPerIteration = samples;
+        }
+
+        /// Returns the number of completed passes of the timed body.
+        int64_t getIterations() const
+        {
+            return m_iterations;
+        }
+
+        /// Returns the total number of samples generated.
+        int64_t getSamples() const
+        {
+            return m_iterations * m_samplesPerIteration;
+        }
+
+        /// Returns the elapsed time, in seconds.
+        double getElapsedTime() const
+        {
+            return m_elapsedTime;
+        }
+
+    private:
+        double m_minTime;
+        int64_t m_minIterations;
+        int64_t m_iterations;
+        int64_t m_samplesPerIteration;
+        double m_elapsedTime;
+        std::chrono::steady_clock::time_point m_startTime;
+    };
+
+    typedef std::function<void(State& state)> BenchmarkFunc;
+
+    /// Registers a benchmark under the specified name.
+    ///
+    /// Benchmarks run in the order in which they are registered.
+    void RegisterBenchmark(const std::string& name, const BenchmarkFunc& func);
+
+    /// Runs the registered benchmarks and prints one result line for each.
+    ///
+    /// Recognized arguments:
+    /// - --benchmark_filter=<text>: only run the benchmarks whose name
+    ///   contains the text.
+    /// - --benchmark_min_time=<seconds>: minimum running time of each
+    ///   benchmark (0.5 by default).
+    /// - --benchmark_list: print the benchmark names without running them.
+    ///
+    /// @returns The process exit code.
+    int RunBenchmarks(int argc, char** argv);
+
+    /// Keeps the compiler from discarding the computation of a value.
+    void DoNotOptimize(double value);
+
+    /// Registers the benchmarks of the individual noise modules.
+    void RegisterModuleBenchmarks();
+
+    /// Registers the benchmarks that replay the noise module graphs of the
+    /// example programs.
+    void RegisterGraphBenchmarks();
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,1057 @@
+// graphbenchmarks.cpp
+//
+// Copyright (C) 2019, 2020 zjhlogo
+//
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or (at
+// your option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License (COPYING.txt) for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+// The developer's email is zjhlogo@gmzigail.com (for great email, take
+// off every 'zig'.)
+//
+
+#include "benchmark.h"
+#include "modulegraph.h"
+#include "noiseutils.h"
+
+#include <noise/noise.h>
+#include <string>
+
+using namespace noise;
+
+// The graphs below replay the noise module graphs of the example programs
+// with the same parameters.  The examples select a band of control values
+// with the original Select::SetBounds() method; the current noise::module::
+// Select module only has a threshold, so a band is expressed with two
+// chained Select modules, and the edge falloff is limited to half the band
+// width as the original method did.
+
+namespace
+{
+
+    // Height of the texture maps, as in the texture examples.
+    const int TEXTURE_HEIGHT = 256;
+
+    // Size of the elevation grid of the planet.  The complexplanet example
+    // builds a 4096 x 2048 grid; the benchmark uses a smaller grid of the
+    // same shape.
+    const int PLANET_GRID_WIDTH = 256;
+    const int PLANET_GRID_HEIGHT = 128;
+
+    typedef std::function<void(bench::ModuleGraph& graph)> GraphFactory;
+
+    void CreateGraniteGraph(bench::ModuleGraph& graph)
+    {
+        module::Billow& primaryGranite = graph.create<module::Billow>();
+        primaryGranite.SetSeed(0);
+        primaryGranite.SetFrequency(8.0);
+        primaryGranite.SetPersistence(0.625);
+        primaryGranite.SetLacunarity(2.18359375);
+        primaryGranite.SetOctaveCount(6);
+        primaryGranite.SetNoiseQuality(QUALITY_STD);
+
+        module::Voronoi& baseGrains = graph.create<module::Voronoi>();
+        baseGrains.SetSeed(1);
+        baseGrains.SetFrequency(16.0);
+        baseGrains.EnableDistance(true);
+
+        module::ScaleBias& scaledGrains = graph.create<module::ScaleBias>(baseGrains);
+        scaledGrains.setScale(-0.5);
+        scaledGrains.setBias(0.0);
+
+        module::Add& combinedGranite = graph.create<module::Add>();
+        combinedGranite.setSourceModule(0, primaryGranite);
+        combinedGranite.setSourceModule(1, scaledGrains);
+
+        module::Turbulence& finalGranite = graph.create<module::Turbulence>(combinedGranite);
+        finalGranite.setSeed(2);
+        finalGranite.setFrequency(4.0);
+        finalGranite.setPower(1.0 / 8.0);
+        finalGranite.setRoughness(6);
+    }
+
+    void CreateJadeGraph(bench::ModuleGraph& graph)
+    {
+        module::RidgedMulti& primaryJade = graph.create<module::RidgedMulti>();
+        primaryJade.SetSeed(0);
+        primaryJade.SetFrequency(2.0);
+        primaryJade.SetLacunarity(2.20703125);
+        primaryJade.SetOctaveCount(6);
+        primaryJade.SetNoiseQuality(QUALITY_STD);
+
+        module::Cylinders& baseSecondaryJade = graph.create<module::Cylinders>();
+        baseSecondaryJade.SetFrequency(2.0);
+
+        module::RotateDomain& rotatedBaseSecondaryJade = graph.create<module::RotateDomain>();
+        rotatedBaseSecondaryJade.setSourceModule(0, baseSecondaryJade);
+        rotatedBaseSecondaryJade.setAngles(90.0, 25.0, 5.0);
+
+        module::Turbulence& perturbedBaseSecondaryJade = graph.create<module::Turbulence>(rotatedBaseSecondaryJade);
+        perturbedBaseSecondaryJade.setSeed(1);
+        perturbedBaseSecondaryJade.setFrequency(4.0);
+        perturbedBaseSecondaryJade.setPower(1.0 / 4.0);
+        perturbedBaseSecondaryJade.setRoughness(4);
+
+        module::ScaleBias& secondaryJade = graph.create<module::ScaleBias>(perturbedBaseSecondaryJade);
+        secondaryJade.setScale(0.25);
+        secondaryJade.setBias(0.0);
+
+        module::Add& combinedJade = graph.create<module::Add>();
+        combinedJade.setSourceModule(0, primaryJade);
+        combinedJade.setSourceModule(1, secondaryJade);
+
+        module::Turbulence& finalJade = graph.create<module::Turbulence>(combinedJade);
+        finalJade.setSeed(2);
+        finalJade.setFrequency(4.0);
+        finalJade.setPower(1.0 / 16.0);
+        finalJade.setRoughness(2);
+    }
+
+    // The sky example renders two noise maps: the water layer and the cloud
+    // layer.  These are the graphs of each layer.
+    void CreateSkyWaterGraph(bench::ModuleGraph& graph)
+    {
+        module::Voronoi& baseWater = graph.create<module::Voronoi>();
+        baseWater.SetSeed(0);
+        baseWater.SetFrequency(8.0);
+        baseWater.EnableDistance(true);
+        baseWater.SetDisplacement(0.0);
+
+        module::ScaleDomain& baseStretchedWater = graph.create<module::ScaleDomain>(baseWater);
+        baseStretchedWater.SetScale(1.0, 1.0, 3.0);
+
+        module::Turbulence& finalWater = graph.create<module::Turbulence>(baseStretchedWater);
+        finalWater.setSeed(1);
+        finalWater.setFrequency(8.0);
+        finalWater.setPower(1.0 / 32.0);
+        finalWater.setRoughness(1);
+    }
+
+    void CreateSkyCloudGraph(bench::ModuleGraph& graph)
+    {
+        module::Billow& cloudBase = graph.create<module::Billow>();
+        cloudBase.SetSeed(2);
+        cloudBase.SetFrequency(2.0);
+        cloudBase.SetPersistence(0.375);
+        cloudBase.SetLacunarity(2.12109375);
+        cloudBase.SetOctaveCount(4);
+        cloudBase.SetNoiseQuality(QUALITY_BEST);
+
+        module::Turbulence& finalClouds = graph.create<module::Turbulence>(cloudBase);
+        finalClouds.setSeed(3);
+        finalClouds.setFrequency(16.0);
+        finalClouds.setPower(1.0 / 64.0);
+        finalClouds.setRoughness(2);
+    }
+
+    void CreateSlimeGraph(bench::ModuleGraph& graph)
+    {
+        module::Billow& largeSlime = graph.create<module::Billow>();
+        largeSlime.SetSeed(0);
+        largeSlime.SetFrequency(4.0);
+        largeSlime.SetLacunarity(2.12109375);
+        largeSlime.SetOctaveCount(1);
+        largeSlime.SetNoiseQuality(QUALITY_BEST);
+
+        module::Billow& smallSlimeBase = graph.create<module::Billow>();
+        smallSlimeBase.SetSeed(1);
+        smallSlimeBase.SetFrequency(24.0);
+        smallSlimeBase.SetLacunarity(2.14453125);
+        smallSlimeBase.SetOctaveCount(1);
+        smallSlimeBase.SetNoiseQuality(QUALITY_BEST);
+
+        module::ScaleBias& smallSlime = graph.create<module::ScaleBias>(smallSlimeBase);
+        smallSlime.setScale(0.5);
+        smallSlime.setBias(-0.5);
+
+        module::RidgedMulti& slimeMap = graph.create<module::RidgedMulti>();
+        slimeMap.SetSeed(0);
+        slimeMap.SetFrequency(2.0);
+        slimeMap.SetLacunarity(2.20703125);
+        slimeMap.SetOctaveCount(3);
+        slimeMap.SetNoiseQuality(QUALITY_STD);
+
+        // Selection band -0.375 to 0.375 with an edge falloff of 0.5, limited
+        // to 0.375.
+        module::Select& slimeChooserLower = graph.create<module::Select>(largeSlime, smallSlime, slimeMap, -0.375, 0.375);
+        module::Select& slimeChooser = graph.create<module::Select>(slimeChooserLower, largeSlime, slimeMap, 0.375, 0.375);
+
+        module::Turbulence& finalSlime = graph.create<module::Turbulence>(slimeChooser);
+        finalSlime.setSeed(2);
+        finalSlime.setFrequency(8.0);
+        finalSlime.setPower(1.0 / 32.0);
+        finalSlime.setRoughness(2);
+    }
+
+    void CreateWoodGraph(bench::ModuleGraph& graph)
+    {
+        module::Cylinders& baseWood = graph.create<module::Cylinders>();
+        baseWood.SetFrequency(16.0);
+
+        module::Perlin& woodGrainNoise = graph.create<module::Perlin>();
+        woodGrainNoise.setSeed(0);
+        woodGrainNoise.setFrequency(48.0);
+        woodGrainNoise.setPersistence(0.5);
+        woodGrainNoise.setLacunarity(2.20703125);
+        woodGrainNoise.setOctaveCount(3);
+        woodGrainNoise.setNoiseQuality(QUALITY_STD);
+
+        module::ScaleDomain& scaledBaseWoodGrain = graph.create<module::ScaleDomain>(woodGrainNoise);
+        scaledBaseWoodGrain.SetYScale(0.25);
+
+        module::ScaleBias& woodGrain = graph.create<module::ScaleBias>(scaledBaseWoodGrain);
+        woodGrain.setScale(0.25);
+        woodGrain.setBias(0.125);
+
+        module::Add& combinedWood = graph.create<module::Add>();
+        combinedWood.setSourceModule(0, baseWood);
+        combinedWood.setSourceModule(1, woodGrain);
+
+        module::Turbulence& perturbedWood = graph.create<module::Turbulence>(combinedWood);
+        perturbedWood.setSeed(1);
+        perturbedWood.setFrequency(4.0);
+        perturbedWood.setPower(1.0 / 256.0);
+        perturbedWood.setRoughness(4);
+
+        module::TranslateDomain& translatedWood = graph.create<module::TranslateDomain>(perturbedWood);
+        translatedWood.SetZTranslation(1.48);
+
+        module::RotateDomain& rotatedWood = graph.create<module::RotateDomain>();
+        rotatedWood.setSourceModule(0, translatedWood);
+        rotatedWood.setAngles(84.0, 0.0, 0.0);
+
+        module::Turbulence& finalWood = graph.create<module::Turbulence>(rotatedWood);
+        finalWood.setSeed(2);
+        finalWood.setFrequency(2.0);
+        finalWood.setPower(1.0 / 64.0);
+        finalWood.setRoughness(4);
+    }
+
+    // The planet graph of the complexplanet example, with the default planet
+    // constants of that example.  See complexplanet.cpp for a description of
+    // each module group.
+    void CreatePlanetGraph(bench::ModuleGraph& graph)
+    {
+        const int CUR_SEED = 0;
+        const double MIN_ELEV = -8192.0;
+        const double MAX_ELEV = 8192.0;
+        const double CONTINENT_FREQUENCY = 1.0;
+        const double CONTINENT_LACUNARITY = 2.208984375;
+        const double MOUNTAIN_LACUNARITY = 2.142578125;
+        const double HILLS_LACUNARITY = 2.162109375;
+        const double PLAINS_LACUNARITY = 2.314453125;
+        const double BADLANDS_LACUNARITY = 2.212890625;
+        const double MOUNTAINS_TWIST = 1.0;
+        const double HILLS_TWIST = 1.0;
+        const double BADLANDS_TWIST = 1.0;
+        const double SEA_LEVEL = 0.0;
+        const double SHELF_LEVEL = -0.375;
+        const double MOUNTAINS_AMOUNT = 0.5;
+        const double HILLS_AMOUNT = (1.0 + MOUNTAINS_AMOUNT) / 2.0;
+        const double BADLANDS_AMOUNT = 0.03125;
+        const double TERRAIN_OFFSET = 1.0;
+        const double MOUNTAIN_GLACIATION = 1.375;
+        const double CONTINENT_HEIGHT_SCALE = (1.0 - SEA_LEVEL) / 4.0;
+        const double RIVER_DEPTH = 0.0234375;
+
+        // Group (continent definition)
+
+        module::Perlin& baseContinentDef_pe0 = graph.create<module::Perlin>();
+        baseContinentDef_pe0.setSeed(CUR_SEED + 0);
+        baseContinentDef_pe0.setFrequency(CONTINENT_FREQUENCY);
+        baseContinentDef_pe0.setPersistence(0.5);
+        baseContinentDef_pe0.setLacunarity(CONTINENT_LACUNARITY);
+        baseContinentDef_pe0.setOctaveCount(14);
+        baseContinentDef_pe0.setNoiseQuality(QUALITY_STD);
+
+        module::Curve& baseContinentDef_cu = graph.create<module::Curve>();
+        baseContinentDef_cu.setSourceModule(0, baseContinentDef_pe0);
+        baseContinentDef_cu.AddControlPoint(-2.0000 + SEA_LEVEL, -1.625 + SEA_LEVEL);
+        baseContinentDef_cu.AddControlPoint(-1.0000 + SEA_LEVEL, -1.375 + SEA_LEVEL);
+        baseContinentDef_cu.AddControlPoint(0.0000 + SEA_LEVEL, -0.375 + SEA_LEVEL);
+        baseContinentDef_cu.AddControlPoint(0.0625 + SEA_LEVEL, 0.125 + SEA_LEVEL);
+        baseContinentDef_cu.AddControlPoint(0.1250 + SEA_LEVEL, 0.250 + SEA_LEVEL);
+        baseContinentDef_cu.AddControlPoint(0.2500 + SEA_LEVEL, 1.000 + SEA_LEVEL);
+        baseContinentDef_cu.AddControlPoint(0.5000 + SEA_LEVEL, 0.250 + SEA_LEVEL);
+        baseContinentDef_cu.AddControlPoint(0.7500 + SEA_LEVEL, 0.250 + SEA_LEVEL);
+        baseContinentDef_cu.AddControlPoint(1.0000 + SEA_LEVEL, 0.500 + SEA_LEVEL);
+        baseContinentDef_cu.AddControlPoint(2.0000 + SEA_LEVEL, 0.500 + SEA_LEVEL);
+
+        module::Perlin& baseContinentDef_pe1 = graph.create<module::Perlin>();
+        baseContinentDef_pe1.setSeed(CUR_SEED + 1);
+        baseContinentDef_pe1.setFrequency(CONTINENT_FREQUENCY * 4.34375);
+        baseContinentDef_pe1.setPersistence(0.5);
+        baseContinentDef_pe1.setLacunarity(CONTINENT_LACUNARITY);
+        baseContinentDef_pe1.setOctaveCount(11);
+        baseContinentDef_pe1.setNoiseQuality(QUALITY_STD);
+
+        module::ScaleBias& baseContinentDef_sb = graph.create<module::ScaleBias>(baseContinentDef_pe1);
+        baseContinentDef_sb.setScale(0.375);
+        baseContinentDef_sb.setBias(0.625);
+
+        module::Min& baseContinentDef_mi = graph.create<module::Min>();
+        baseContinentDef_mi.setSourceModule(0, baseContinentDef_sb);
+        baseContinentDef_mi.setSourceModule(1, baseContinentDef_cu);
+
+        module::Clamp& baseContinentDef_cl = graph.create<module::Clamp>();
+        baseContinentDef_cl.setSourceModule(0, baseContinentDef_mi);
+        baseContinentDef_cl.SetBounds(-1.0, 1.0);
+
+        module::Cache& baseContinentDef = graph.create<module::Cache>();
+        baseContinentDef.setSourceModule(0, baseContinentDef_cl);
+
+        module::Turbulence& continentDef_tu0 = graph.create<module::Turbulence>(baseContinentDef);
+        continentDef_tu0.setSeed(CUR_SEED + 10);
+        continentDef_tu0.setFrequency(CONTINENT_FREQUENCY * 15.25);
+        continentDef_tu0.setPower(CONTINENT_FREQUENCY / 113.75);
+        continentDef_tu0.setRoughness(13);
+
+        // Passing a Turbulence module directly would copy it instead of
+        // using it as the source module.
+        module::Turbulence& continentDef_tu1 = graph.create<module::Turbulence>(ScalarParameter(continentDef_tu0));
+        continentDef_tu1.setSeed(CUR_SEED + 11);
+        continentDef_tu1.setFrequency(CONTINENT_FREQUENCY * 47.25);
+        continentDef_tu1.setPower(CONTINENT_FREQUENCY / 433.75);
+        continentDef_tu1.setRoughness(12);
+
+        module::Turbulence& continentDef_tu2 = graph.create<module::Turbulence>(ScalarParameter(continentDef_tu1));
+        continentDef_tu2.setSeed(CUR_SEED + 12);
+        continentDef_tu2.setFrequency(CONTINENT_FREQUENCY * 95.25);
+        continentDef_tu2.setPower(CONTINENT_FREQUENCY / 1019.75);
+        continentDef_tu2.setRoughness(11);
+
+        module::Select& continentDef_se = graph.create<module::Select>(baseContinentDef, continentDef_tu2, baseContinentDef, SEA_LEVEL - 0.0375, 0.0625);
+
+        module::Cache& continentDef = graph.create<module::Cache>();
+        continentDef.setSourceModule(0, continentDef_se);
+
+        // Group (terrain type definition)
+
+        module::Turbulence& terrainTypeDef_tu = graph.create<module::Turbulence>(continentDef);
+        terrainTypeDef_tu.setSeed(CUR_SEED + 20);
+        terrainTypeDef_tu.setFrequency(CONTINENT_FREQUENCY * 18.125);
+        terrainTypeDef_tu.setPower(CONTINENT_FREQUENCY / 20.59375 * TERRAIN_OFFSET);
+        terrainTypeDef_tu.setRoughness(3);
+
+        module::Terrace& terrainTypeDef_te = graph.create<module::Terrace>();
+        terrainTypeDef_te.setSourceModule(0, terrainTypeDef_tu);
+        terrainTypeDef_te.AddControlPoint(-1.00);
+        terrainTypeDef_te.AddControlPoint(SHELF_LEVEL + SEA_LEVEL / 2.0);
+        terrainTypeDef_te.AddControlPoint(1.00);
+
+        module::Cache& terrainTypeDef = graph.create<module::Cache>();
+        terrainTypeDef.setSourceModule(0, terrainTypeDef_te);
+
+        // Group (mountainous terrain)
+
+        module::RidgedMulti& mountainBaseDef_rm0 = graph.create<module::RidgedMulti>();
+        mountainBaseDef_rm0.SetSeed(CUR_SEED + 30);
+        mountainBaseDef_rm0.SetFrequency(1723.0);
+        mountainBaseDef_rm0.SetLacunarity(MOUNTAIN_LACUNARITY);
+        mountainBaseDef_rm0.SetOctaveCount(4);
+        mountainBaseDef_rm0.SetNoiseQuality(QUALITY_STD);
+
+        module::ScaleBias& mountainBaseDef_sb0 = graph.create<module::ScaleBias>(mountainBaseDef_rm0);
+        mountainBaseDef_sb0.setScale(0.5);
+        mountainBaseDef_sb0.setBias(0.375);
+
+        module::RidgedMulti& mountainBaseDef_rm1 = graph.create<module::RidgedMulti>();
+        mountainBaseDef_rm1.SetSeed(CUR_SEED + 31);
+        mountainBaseDef_rm1.SetFrequency(367.0);
+        mountainBaseDef_rm1.SetLacunarity(MOUNTAIN_LACUNARITY);
+        mountainBaseDef_rm1.SetOctaveCount(1);
+        mountainBaseDef_rm1.SetNoiseQuality(QUALITY_BEST);
+
+        module::ScaleBias& mountainBaseDef_sb1 = graph.create<module::ScaleBias>(mountainBaseDef_rm1);
+        mountainBaseDef_sb1.setScale(-2.0);
+        mountainBaseDef_sb1.setBias(-0.5);
+
+        module::Const& mountainBaseDef_co = graph.create<module::Const>();
+        mountainBaseDef_co.setConstValue(-1.0);
+
+        module::Blend& mountainBaseDef_bl = graph.create<module::Blend>();
+        mountainBaseDef_bl.setSourceModule(0, mountainBaseDef_co);
+        mountainBaseDef_bl.setSourceModule(1, mountainBaseDef_sb0);
+        mountainBaseDef_bl.SetControlModule(mountainBaseDef_sb1);
+
+        module::Turbulence& mountainBaseDef_tu0 = graph.create<module::Turbulence>(mountainBaseDef_bl);
+        mountainBaseDef_tu0.setSeed(CUR_SEED + 32);
+        mountainBaseDef_tu0.setFrequency(1337.0);
+        mountainBaseDef_tu0.setPower(1.0 / 6730.0 * MOUNTAINS_TWIST);
+        mountainBaseDef_tu0.setRoughness(4);
+
+        module::Turbulence& mountainBaseDef_tu1 = graph.create<module::Turbulence>(ScalarParameter(mountainBaseDef_tu0));
+        mountainBaseDef_tu1.setSeed(CUR_SEED + 33);
+        mountainBaseDef_tu1.setFrequency(21221.0);
+        mountainBaseDef_tu1.setPower(1.0 / 120157.0 * MOUNTAINS_TWIST);
+        mountainBaseDef_tu1.setRoughness(6);
+
+        module::Cache& mountainBaseDef = graph.create<module::Cache>();
+        mountainBaseDef.setSourceModule(0, mountainBaseDef_tu1);
+
+        module::RidgedMulti& mountainousHigh_rm0 = graph.create<module::RidgedMulti>();
+        mountainousHigh_rm0.SetSeed(CUR_SEED + 40);
+        mountainousHigh_rm0.SetFrequency(2371.0);
+        mountainousHigh_rm0.SetLacunarity(MOUNTAIN_LACUNARITY);
+        mountainousHigh_rm0.SetOctaveCount(3);
+        mountainousHigh_rm0.SetNoiseQuality(QUALITY_BEST);
+
+        module::RidgedMulti& mountainousHigh_rm1 = graph.create<module::RidgedMulti>();
+        mountainousHigh_rm1.SetSeed(CUR_SEED + 41);
+        mountainousHigh_rm1.SetFrequency(2341.0);
+        mountainousHigh_rm1.SetLacunarity(MOUNTAIN_LACUNARITY);
+        mountainousHigh_rm1.SetOctaveCount(3);
+        mountainousHigh_rm1.SetNoiseQuality(QUALITY_BEST);
+
+        module::Max& mountainousHigh_ma = graph.create<module::Max>();
+        mountainousHigh_ma.setSourceModule(0, mountainousHigh_rm0);
+        mountainousHigh_ma.setSourceModule(1, mountainousHigh_rm1);
+
+        module::Turbulence& mountainousHigh_tu = graph.create<module::Turbulence>(mountainousHigh_ma);
+        mountainousHigh_tu.setSeed(CUR_SEED + 42);
+        mountainousHigh_tu.setFrequency(31511.0);
+        mountainousHigh_tu.setPower(1.0 / 180371.0 * MOUNTAINS_TWIST);
+        mountainousHigh_tu.setRoughness(4);
+
+        module::Cache& mountainousHigh = graph.create<module::Cache>();
+        mountainousHigh.setSourceModule(0, mountainousHigh_tu);
+
+        module::RidgedMulti& mountainousLow_rm0 = graph.create<module::RidgedMulti>();
+        mountainousLow_rm0.SetSeed(CUR_SEED + 50);
+        mountainousLow_rm0.SetFrequency(1381.0);
+        mountainousLow_rm0.SetLacunarity(MOUNTAIN_LACUNARITY);
+        mountainousLow_rm0.SetOctaveCount(8);
+        mountainousLow_rm0.SetNoiseQuality(QUALITY_BEST);
+
+        module::RidgedMulti& mountainousLow_rm1 = graph.create<module::RidgedMulti>();
+        mountainousLow_rm1.SetSeed(CUR_SEED + 51);
+        mountainousLow_rm1.SetFrequency(1427.0);
+        mountainousLow_rm1.SetLacunarity(MOUNTAIN_LACUNARITY);
+        mountainousLow_rm1.SetOctaveCount(8);
+        mountainousLow_rm1.SetNoiseQuality(QUALITY_BEST);
+
+        module::Multiply& mountainousLow_mu = graph.create<module::Multiply>();
+        mountainousLow_mu.setSourceModule(0, mountainousLow_rm0);
+        mountainousLow_mu.setSourceModule(1, mountainousLow_rm1);
+
+        module::Cache& mountainousLow = graph.create<module::Cache>();
+        mountainousLow.setSourceModule(0, mountainousLow_mu);
+
+        module::ScaleBias& mountainousTerrain_sb0 = graph.create<module::ScaleBias>(mountainousLow);
+        mountainousTerrain_sb0.setScale(0.03125);
+        mountainousTerrain_sb0.setBias(-0.96875);
+
+        module::ScaleBias& mountainousTerrain_sb1 = graph.create<module::ScaleBias>(mountainousHigh);
+        mountainousTerrain_sb1.setScale(0.25);
+        mountainousTerrain_sb1.setBias(0.25);
+
+        module::Add& mountainousTerrain_ad = graph.create<module::Add>();
+        mountainousTerrain_ad.setSourceModule(0, mountainousTerrain_sb1);
+        mountainousTerrain_ad.setSourceModule(1, mountainBaseDef);
+
+        module::Select& mountainousTerrain_se = graph.create<module::Select>(mountainousTerrain_sb0, mountainousTerrain_ad, mountainBaseDef, -0.5, 0.5);
+
+        module::ScaleBias& mountainousTerrain_sb2 = graph.create<module::ScaleBias>(mountainousTerrain_se);
+        mountainousTerrain_sb2.setScale(0.8);
+        mountainousTerrain_sb2.setBias(0.0);
+
+        module::Exponent& mountainousTerrain_ex = graph.create<module::Exponent>();
+        mountainousTerrain_ex.setSourceModule(0, mountainousTerrain_sb2);
+        mountainousTerrain_ex.SetExponent(MOUNTAIN_GLACIATION);
+
+        module::Cache& mountainousTerrain = graph.create<module::Cache>();
+        mountainousTerrain.setSourceModule(0, mountainousTerrain_ex);
+
+        // Group (hilly terrain)
+
+        module::Billow& hillyTerrain_bi = graph.create<module::Billow>();
+        hillyTerrain_bi.SetSeed(CUR_SEED + 60);
+        hillyTerrain_bi.SetFrequency(1663.0);
+        hillyTerrain_bi.SetPersistence(0.5);
+        hillyTerrain_bi.SetLacunarity(HILLS_LACUNARITY);
+        hillyTerrain_bi.SetOctaveCount(6);
+        hillyTerrain_bi.SetNoiseQuality(QUALITY_BEST);
+
+        module::ScaleBias& hillyTerrain_sb0 = graph.create<module::ScaleBias>(hillyTerrain_bi);
+        hillyTerrain_sb0.setScale(0.5);
+        hillyTerrain_sb0.setBias(0.5);
+
+        module::RidgedMulti& hillyTerrain_rm = graph.create<module::RidgedMulti>();
+        hillyTerrain_rm.SetSeed(CUR_SEED + 61);
+        hillyTerrain_rm.SetFrequency(367.5);
+        hillyTerrain_rm.SetLacunarity(HILLS_LACUNARITY);
+        hillyTerrain_rm.SetNoiseQuality(QUALITY_BEST);
+        hillyTerrain_rm.SetOctaveCount(1);
+
+        module::ScaleBias& hillyTerrain_sb1 = graph.create<module::ScaleBias>(hillyTerrain_rm);
+        hillyTerrain_sb1.setScale(-2.0);
+        hillyTerrain_sb1.setBias(-0.5);
+
+        module::Const& hillyTerrain_co = graph.create<module::Const>();
+        hillyTerrain_co.setConstValue(-1.0);
+
+        module::Blend& hillyTerrain_bl = graph.create<module::Blend>();
+        hillyTerrain_bl.setSourceModule(0, hillyTerrain_co);
+        hillyTerrain_bl.setSourceModule(1, hillyTerrain_sb1);
+        hillyTerrain_bl.SetControlModule(hillyTerrain_sb0);
+
+        module::ScaleBias& hillyTerrain_sb2 = graph.create<module::ScaleBias>(hillyTerrain_bl);
+        hillyTerrain_sb2.setScale(0.75);
+        hillyTerrain_sb2.setBias(-0.25);
+
+        module::Exponent& hillyTerrain_ex = graph.create<module::Exponent>();
+        hillyTerrain_ex.setSourceModule(0, hillyTerrain_sb2);
+        hillyTerrain_ex.SetExponent(1.375);
+
+        module::Turbulence& hillyTerrain_tu0 = graph.create<module::Turbulence>(hillyTerrain_ex);
+        hillyTerrain_tu0.setSeed(CUR_SEED + 62);
+        hillyTerrain_tu0.setFrequency(1531.0);
+        hillyTerrain_tu0.setPower(1.0 / 16921.0 * HILLS_TWIST);
+        hillyTerrain_tu0.setRoughness(4);
+
+        module::Turbulence& hillyTerrain_tu1 = graph.create<module::Turbulence>(ScalarParameter(hillyTerrain_tu0));
+        hillyTerrain_tu1.setSeed(CUR_SEED + 63);
+        hillyTerrain_tu1.setFrequency(21617.0);
+        hillyTerrain_tu1.setPower(1.0 / 117529.0 * HILLS_TWIST);
+        hillyTerrain_tu1.setRoughness(6);
+
+        module::Cache& hillyTerrain = graph.create<module::Cache>();
+        hillyTerrain.setSourceModule(0, hillyTerrain_tu1);
+
+        // Group (plains terrain)
+
+        module::Billow& plainsTerrain_bi0 = graph.create<module::Billow>();
+        plainsTerrain_bi0.SetSeed(CUR_SEED + 70);
+        plainsTerrain_bi0.SetFrequency(1097.5);
+        plainsTerrain_bi0.SetPersistence(0.5);
+        plainsTerrain_bi0.SetLacunarity(PLAINS_LACUNARITY);
+        plainsTerrain_bi0.SetOctaveCount(8);
+        plainsTerrain_bi0.SetNoiseQuality(QUALITY_BEST);
+
+        module::ScaleBias& plainsTerrain_sb0 = graph.create<module::ScaleBias>(plainsTerrain_bi0);
+        plainsTerrain_sb0.setScale(0.5);
+        plainsTerrain_sb0.setBias(0.5);
+
+        module::Billow& plainsTerrain_bi1 = graph.create<module::Billow>();
+        plainsTerrain_bi1.SetSeed(CUR_SEED + 71);
+        plainsTerrain_bi1.SetFrequency(1319.5);
+        plainsTerrain_bi1.SetPersistence(0.5);
+        plainsTerrain_bi1.SetLacunarity(PLAINS_LACUNARITY);
+        plainsTerrain_bi1.SetOctaveCount(8);
+        plainsTerrain_bi1.SetNoiseQuality(QUALITY_BEST);
+
+        module::ScaleBias& plainsTerrain_sb1 = graph.create<module::ScaleBias>(plainsTerrain_bi1);
+        plainsTerrain_sb1.setScale(0.5);
+        plainsTerrain_sb1.setBias(0.5);
+
+        module::Multiply& plainsTerrain_mu = graph.create<module::Multiply>();
+        plainsTerrain_mu.setSourceModule(0, plainsTerrain_sb0);
+        plainsTerrain_mu.setSourceModule(1, plainsTerrain_sb1);
+
+        module::ScaleBias& plainsTerrain_sb2 = graph.create<module::ScaleBias>(plainsTerrain_mu);
+        plainsTerrain_sb2.setScale(2.0);
+        plainsTerrain_sb2.setBias(-1.0);
+
+        module::Cache& plainsTerrain = graph.create<module::Cache>();
+        plainsTerrain.setSourceModule(0, plainsTerrain_sb2);
+
+        // Group (badlands terrain)
+
+        module::RidgedMulti& badlandsSand_rm = graph.create<module::RidgedMulti>();
+        badlandsSand_rm.SetSeed(CUR_SEED + 80);
+        badlandsSand_rm.SetFrequency(6163.5);
+        badlandsSand_rm.SetLacunarity(BADLANDS_LACUNARITY);
+        badlandsSand_rm.SetNoiseQuality(QUALITY_BEST);
+        badlandsSand_rm.SetOctaveCount(1);
+
+        module::ScaleBias& badlandsSand_sb0 = graph.create<module::ScaleBias>(badlandsSand_rm);
+        badlandsSand_sb0.setScale(0.875);
+        badlandsSand_sb0.setBias(0.0);
+
+        module::Voronoi& badlandsSand_vo = graph.create<module::Voronoi>();
+        badlandsSand_vo.SetSeed(CUR_SEED + 81);
+        badlandsSand_vo.SetFrequency(16183.25);
+        badlandsSand_vo.SetDisplacement(0.0);
+        badlandsSand_vo.EnableDistance();
+
+        module::ScaleBias& badlandsSand_sb1 = graph.create<module::ScaleBias>(badlandsSand_vo);
+        badlandsSand_sb1.setScale(0.25);
+        badlandsSand_sb1.setBias(0.25);
+
+        module::Add& badlandsSand_ad = graph.create<module::Add>();
+        badlandsSand_ad.setSourceModule(0, badlandsSand_sb0);
+        badlandsSand_ad.setSourceModule(1, badlandsSand_sb1);
+
+        module::Cache& badlandsSand = graph.create<module::Cache>();
+        badlandsSand.setSourceModule(0, badlandsSand_ad);
+
+        module::Perlin& badlandsCliffs_pe = graph.create<module::Perlin>();
+        badlandsCliffs_pe.setSeed(CUR_SEED + 90);
+        badlandsCliffs_pe.setFrequency(CONTINENT_FREQUENCY * 839.0);
+        badlandsCliffs_pe.setPersistence(0.5);
+        badlandsCliffs_pe.setLacunarity(BADLANDS_LACUNARITY);
+        badlandsCliffs_pe.setOctaveCount(6);
+        badlandsCliffs_pe.setNoiseQuality(QUALITY_STD);
+
+        module::Curve& badlandsCliffs_cu = graph.create<module::Curve>();
+        badlandsCliffs_cu.setSourceModule(0, badlandsCliffs_pe);
+        badlandsCliffs_cu.AddControlPoint(-2.0000, -2.0000);
+        badlandsCliffs_cu.AddControlPoint(-1.0000, -1.2500);
+        badlandsCliffs_cu.AddControlPoint(-0.0000, -0.7500);
+        badlandsCliffs_cu.AddControlPoint(0.5000, -0.2500);
+        badlandsCliffs_cu.AddControlPoint(0.6250, 0.8750);
+        badlandsCliffs_cu.AddControlPoint(0.7500, 1.0000);
+        badlandsCliffs_cu.AddControlPoint(2.0000, 1.2500);
+
+        module::Clamp& badlandsCliffs_cl = graph.create<module::Clamp>();
+        badlandsCliffs_cl.setSourceModule(0, badlandsCliffs_cu);
+        badlandsCliffs_cl.SetBounds(-999.125, 0.875);
+
+        module::Terrace& badlandsCliffs_te = graph.create<module::Terrace>();
+        badlandsCliffs_te.setSourceModule(0, badlandsCliffs_cl);
+        badlandsCliffs_te.AddControlPoint(-1.0000);
+        badlandsCliffs_te.AddControlPoint(-0.8750);
+        badlandsCliffs_te.AddControlPoint(-0.7500);
+        badlandsCliffs_te.AddControlPoint(-0.5000);
+        badlandsCliffs_te.AddControlPoint(0.0000);
+        badlandsCliffs_te.AddControlPoint(1.0000);
+
+        module::Turbulence& badlandsCliffs_tu0 = graph.create<module::Turbulence>(badlandsCliffs_te);
+        badlandsCliffs_tu0.setSeed(CUR_SEED + 91);
+        badlandsCliffs_tu0.setFrequency(16111.0);
+        badlandsCliffs_tu0.setPower(1.0 / 141539.0 * BADLANDS_TWIST);
+        badlandsCliffs_tu0.setRoughness(3);
+
+        module::Turbulence& badlandsCliffs_tu1 = graph.create<module::Turbulence>(ScalarParameter(badlandsCliffs_tu0));
+        badlandsCliffs_tu1.setSeed(CUR_SEED + 92);
+        badlandsCliffs_tu1.setFrequency(36107.0);
+        badlandsCliffs_tu1.setPower(1.0 / 211543.0 * BADLANDS_TWIST);
+        badlandsCliffs_tu1.setRoughness(3);
+
+        module::Cache& badlandsCliffs = graph.create<module::Cache>();
+        badlandsCliffs.setSourceModule(0, badlandsCliffs_tu1);
+
+        module::ScaleBias& badlandsTerrain_sb = graph.create<module::ScaleBias>(badlandsSand);
+        badlandsTerrain_sb.setScale(0.25);
+        badlandsTerrain_sb.setBias(-0.75);
+
+        module::Max& badlandsTerrain_ma = graph.create<module::Max>();
+        badlandsTerrain_ma.setSourceModule(0, badlandsCliffs);
+        badlandsTerrain_ma.setSourceModule(1, badlandsTerrain_sb);
+
+        module::Cache& badlandsTerrain = graph.create<module::Cache>();
+        badlandsTerrain.setSourceModule(0, badlandsTerrain_ma);
+
+        // Group (river positions)
+
+        module::RidgedMulti& riverPositions_rm0 = graph.create<module::RidgedMulti>();
+        riverPositions_rm0.SetSeed(CUR_SEED + 100);
+        riverPositions_rm0.SetFrequency(18.75);
+        riverPositions_rm0.SetLacunarity(CONTINENT_LACUNARITY);
+        riverPositions_rm0.SetOctaveCount(1);
+        riverPositions_rm0.SetNoiseQuality(QUALITY_BEST);
+
+        module::Curve& riverPositions_cu0 = graph.create<module::Curve>();
+        riverPositions_cu0.setSourceModule(0, riverPositions_rm0);
+        riverPositions_cu0.AddControlPoint(-2.000, 2.000);
+        riverPositions_cu0.AddControlPoint(-1.000, 1.000);
+        riverPositions_cu0.AddControlPoint(-0.125, 0.875);
+        riverPositions_cu0.AddControlPoint(0.000, -1.000);
+        riverPositions_cu0.AddControlPoint(1.000, -1.500);
+        riverPositions_cu0.AddControlPoint(2.000, -2.000);
+
+        module::RidgedMulti& riverPositions_rm1 = graph.create<module::RidgedMulti>();
+        riverPositions_rm1.SetSeed(CUR_SEED + 101);
+        riverPositions_rm1.SetFrequency(43.25);
+        riverPositions_rm1.SetLacunarity(CONTINENT_LACUNARITY);
+        riverPositions_rm1.SetOctaveCount(1);
+        riverPositions_rm1.SetNoiseQuality(QUALITY_BEST);
+
+        module::Curve& riverPositions_cu1 = graph.create<module::Curve>();
+        riverPositions_cu1.setSourceModule(0, riverPositions_rm1);
+        riverPositions_cu1.AddControlPoint(-2.000, 2.0000);
+        riverPositions_cu1.AddControlPoint(-1.000, 1.5000);
+        riverPositions_cu1.AddControlPoint(-0.125, 1.4375);
+        riverPositions_cu1.AddControlPoint(0.000, 0.5000);
+        riverPositions_cu1.AddControlPoint(1.000, 0.2500);
+        riverPositions_cu1.AddControlPoint(2.000, 0.0000);
+
+        module::Min& riverPositions_mi = graph.create<module::Min>();
+        riverPositions_mi.setSourceModule(0, riverPositions_cu0);
+        riverPositions_mi.setSourceModule(1, riverPositions_cu1);
+
+        module::Turbulence& riverPositions_tu = graph.create<module::Turbulence>(riverPositions_mi);
+        riverPositions_tu.setSeed(CUR_SEED + 102);
+        riverPositions_tu.setFrequency(9.25);
+        riverPositions_tu.setPower(1.0 / 57.75);
+        riverPositions_tu.setRoughness(6);
+
+        module::Cache& riverPositions = graph.create<module::Cache>();
+        riverPositions.setSourceModule(0, riverPositions_tu);
+
+        // Group (scaled mountainous terrain)
+
+        module::ScaleBias& scaledMountainousTerrain_sb0 = graph.create<module::ScaleBias>(mountainousTerrain);
+        scaledMountainousTerrain_sb0.setScale(0.125);
+        scaledMountainousTerrain_sb0.setBias(0.125);
+
+        module::Perlin& scaledMountainousTerrain_pe = graph.create<module::Perlin>();
+        scaledMountainousTerrain_pe.setSeed(CUR_SEED + 110);
+        scaledMountainousTerrain_pe.setFrequency(14.5);
+        scaledMountainousTerrain_pe.setPersistence(0.5);
+        scaledMountainousTerrain_pe.setLacunarity(MOUNTAIN_LACUNARITY);
+        scaledMountainousTerrain_pe.setOctaveCount(6);
+        scaledMountainousTerrain_pe.setNoiseQuality(QUALITY_STD);
+
+        module::Exponent& scaledMountainousTerrain_ex = graph.create<module::Exponent>();
+        scaledMountainousTerrain_ex.setSourceModule(0, scaledMountainousTerrain_pe);
+        scaledMountainousTerrain_ex.SetExponent(1.25);
+
+        module::ScaleBias& scaledMountainousTerrain_sb1 = graph.create<module::ScaleBias>(scaledMountainousTerrain_ex);
+        scaledMountainousTerrain_sb1.setScale(0.25);
+        scaledMountainousTerrain_sb1.setBias(1.0);
+
+        module::Multiply& scaledMountainousTerrain_mu = graph.create<module::Multiply>();
+        scaledMountainousTerrain_mu.setSourceModule(0, scaledMountainousTerrain_sb0);
+        scaledMountainousTerrain_mu.setSourceModule(1, scaledMountainousTerrain_sb1);
+
+        module::Cache& scaledMountainousTerrain = graph.create<module::Cache>();
+        scaledMountainousTerrain.setSourceModule(0, scaledMountainousTerrain_mu);
+
+        // Group (scaled hilly terrain)
+
+        module::ScaleBias& scaledHillyTerrain_sb0 = graph.create<module::ScaleBias>(hillyTerrain);
+        scaledHillyTerrain_sb0.setScale(0.0625);
+        scaledHillyTerrain_sb0.setBias(0.0625);
+
+        module::Perlin& scaledHillyTerrain_pe = graph.create<module::Perlin>();
+        scaledHillyTerrain_pe.setSeed(CUR_SEED + 120);
+        scaledHillyTerrain_pe.setFrequency(13.5);
+        scaledHillyTerrain_pe.setPersistence(0.5);
+        scaledHillyTerrain_pe.setLacunarity(HILLS_LACUNARITY);
+        scaledHillyTerrain_pe.setOctaveCount(6);
+        scaledHillyTerrain_pe.setNoiseQuality(QUALITY_STD);
+
+        module::Exponent& scaledHillyTerrain_ex = graph.create<module::Exponent>();
+        scaledHillyTerrain_ex.setSourceModule(0, scaledHillyTerrain_pe);
+        scaledHillyTerrain_ex.SetExponent(1.25);
+
+        module::ScaleBias& scaledHillyTerrain_sb1 = graph.create<module::ScaleBias>(scaledHillyTerrain_ex);
+        scaledHillyTerrain_sb1.setScale(0.5);
+        scaledHillyTerrain_sb1.setBias(1.5);
+
+        module::Multiply& scaledHillyTerrain_mu = graph.create<module::Multiply>();
+        scaledHillyTerrain_mu.setSourceModule(0, scaledHillyTerrain_sb0);
+        scaledHillyTerrain_mu.setSourceModule(1, scaledHillyTerrain_sb1);
+
+        module::Cache& scaledHillyTerrain = graph.create<module::Cache>();
+        scaledHillyTerrain.setSourceModule(0, scaledHillyTerrain_mu);
+
+        // Group (scaled plains terrain)
+
+        module::ScaleBias& scaledPlainsTerrain_sb = graph.create<module::ScaleBias>(plainsTerrain);
+        scaledPlainsTerrain_sb.setScale(0.00390625);
+        scaledPlainsTerrain_sb.setBias(0.0078125);
+
+        module::Cache& scaledPlainsTerrain = graph.create<module::Cache>();
+        scaledPlainsTerrain.setSourceModule(0, scaledPlainsTerrain_sb);
+
+        // Group (scaled badlands terrain)
+
+        module::ScaleBias& scaledBadlandsTerrain_sb = graph.create<module::ScaleBias>(badlandsTerrain);
+        scaledBadlandsTerrain_sb.setScale(0.0625);
+        scaledBadlandsTerrain_sb.setBias(0.0625);
+
+        module::Cache& scaledBadlandsTerrain = graph.create<module::Cache>();
+        scaledBadlandsTerrain.setSourceModule(0, scaledBadlandsTerrain_sb);
+
+        // Group (final planet)
+
+        module::Terrace& continentalShelf_te = graph.create<module::Terrace>();
+        continentalShelf_te.setSourceModule(0, continentDef);
+        continentalShelf_te.AddControlPoint(-1.0);
+        continentalShelf_te.AddControlPoint(-0.75);
+        continentalShelf_te.AddControlPoint(SHELF_LEVEL);
+        continentalShelf_te.AddControlPoint(1.0);
+
+        module::RidgedMulti& continentalShelf_rm = graph.create<module::RidgedMulti>();
+        continentalShelf_rm.SetSeed(CUR_SEED + 130);
+        continentalShelf_rm.SetFrequency(CONTINENT_FREQUENCY * 4.375);
+        continentalShelf_rm.SetLacunarity(CONTINENT_LACUNARITY);
+        continentalShelf_rm.SetOctaveCount(16);
+        continentalShelf_rm.SetNoiseQuality(QUALITY_BEST);
+
+        module::ScaleBias& continentalShelf_sb = graph.create<module::ScaleBias>(continentalShelf_rm);
+        continentalShelf_sb.setScale(-0.125);
+        continentalShelf_sb.setBias(-0.125);
+
+        module::Clamp& continentalShelf_cl = graph.create<module::Clamp>();
+        continentalShelf_cl.setSourceModule(0, continentalShelf_te);
+        continentalShelf_cl.SetBounds(-0.75, SEA_LEVEL);
+
+        module::Add& continentalShelf_ad = graph.create<module::Add>();
+        continentalShelf_ad.setSourceModule(0, continentalShelf_sb);
+        continentalShelf_ad.setSourceModule(1, continentalShelf_cl);
+
+        module::Cache& continentalShelf = graph.create<module::Cache>();
+        continentalShelf.setSourceModule(0, continentalShelf_ad);
+
+        module::ScaleBias& baseContinentElev_sb = graph.create<module::ScaleBias>(continentDef);
+        baseContinentElev_sb.setScale(CONTINENT_HEIGHT_SCALE);
+        baseContinentElev_sb.setBias(0.0);
+
+        // The selection range of the example ends at the shelf level, so the
+        // continental shelf is the low module here.
+        module::Select& baseContinentElev_se = graph.create<module::Select>(continentalShelf, baseContinentElev_sb, continentDef, SHELF_LEVEL, 0.03125);
+
+        module::Cache& baseContinentElev = graph.create<module::Cache>();
+        baseContinentElev.setSourceModule(0, baseContinentElev_se);
+
+        module::Add& continentsWithPlains_ad = graph.create<module::Add>();
+        continentsWithPlains_ad.setSourceModule(0, baseContinentElev);
+        continentsWithPlains_ad.setSourceModule(1, scaledPlainsTerrain);
+
+        module::Cache& continentsWithPlains = graph.create<module::Cache>();
+        continentsWithPlains.setSourceModule(0, continentsWithPlains_ad);
+
+        module::Add& continentsWithHills_ad = graph.create<module::Add>();
+        continentsWithHills_ad.setSourceModule(0, baseContinentElev);
+        continentsWithHills_ad.setSourceModule(1, scaledHillyTerrain);
+
+        module::Select& continentsWithHills_se = graph.create<module::Select>(continentsWithPlains, continentsWithHills_ad, terrainTypeDef, 1.0 - HILLS_AMOUNT, 0.25);
+
+        module::Cache& continentsWithHills = graph.create<module::Cache>();
+        continentsWithHills.setSourceModule(0, continentsWithHills_se);
+
+        module::Add& continentsWithMountains_ad0 = graph.create<module::Add>();
+        continentsWithMountains_ad0.setSourceModule(0, baseContinentElev);
+        continentsWithMountains_ad0.setSourceModule(1, scaledMountainousTerrain);
+
+        module::Curve& continentsWithMountains_cu = graph.create<module::Curve>();
+        continentsWithMountains_cu.setSourceModule(0, continentDef);
+        continentsWithMountains_cu.AddControlPoint(-1.0, -0.0625);
+        continentsWithMountains_cu.AddControlPoint(0.0, 0.0000);
+        continentsWithMountains_cu.AddControlPoint(1.0 - MOUNTAINS_AMOUNT, 0.0625);
+        continentsWithMountains_cu.AddControlPoint(1.0, 0.2500);
+
+        module::Add& continentsWithMountains_ad1 = graph.create<module::Add>();
+        continentsWithMountains_ad1.setSourceModule(0, continentsWithMountains_ad0);
+        continentsWithMountains_ad1.setSourceModule(1, continentsWithMountains_cu);
+
+        module::Select& continentsWithMountains_se = graph.create<module::Select>(continentsWithHills, continentsWithMountains_ad1, terrainTypeDef, 1.0 - MOUNTAINS_AMOUNT, 0.25);
+
+        module::Cache& continentsWithMountains = graph.create<module::Cache>();
+        continentsWithMountains.setSourceModule(0, continentsWithMountains_se);
+
+        module::Perlin& continentsWithBadlands_pe = graph.create<module::Perlin>();
+        continentsWithBadlands_pe.setSeed(CUR_SEED + 140);
+        continentsWithBadlands_pe.setFrequency(16.5);
+        continentsWithBadlands_pe.setPersistence(0.5);
+        continentsWithBadlands_pe.setLacunarity(CONTINENT_LACUNARITY);
+        continentsWithBadlands_pe.setOctaveCount(2);
+        continentsWithBadlands_pe.setNoiseQuality(QUALITY_STD);
+
+        module::Add& continentsWithBadlands_ad = graph.create<module::Add>();
+        continentsWithBadlands_ad.setSourceModule(0, baseContinentElev);
+        continentsWithBadlands_ad.setSourceModule(1, scaledBadlandsTerrain);
+
+        module::Select& continentsWithBadlands_se = graph.create<module::Select>(continentsWithMountains, continentsWithBadlands_ad, continentsWithBadlands_pe, 1.0 - BADLANDS_AMOUNT, 0.25);
+
+        module::Max& continentsWithBadlands_ma = graph.create<module::Max>();
+        continentsWithBadlands_ma.setSourceModule(0, continentsWithMountains);
+        continentsWithBadlands_ma.setSourceModule(1, continentsWithBadlands_se);
+
+        module::Cache& continentsWithBadlands = graph.create<module::Cache>();
+        continentsWithBadlands.setSourceModule(0, continentsWithBadlands_ma);
+
+        module::ScaleBias& continentsWithRivers_sb = graph.create<module::ScaleBias>(riverPositions);
+        continentsWithRivers_sb.setScale(RIVER_DEPTH / 2.0);
+        continentsWithRivers_sb.setBias(-RIVER_DEPTH / 2.0);
+
+        module::Add& continentsWithRivers_ad = graph.create<module::Add>();
+        continentsWithRivers_ad.setSourceModule(0, continentsWithBadlands);
+        continentsWithRivers_ad.setSourceModule(1, continentsWithRivers_sb);
+
+        // Selection band SEA_LEVEL to SEA_LEVEL + CONTINENT_HEIGHT_SCALE; the
+        // edge falloff is limited to half the band width.
+        const double riverEdgeFalloff = CONTINENT_HEIGHT_SCALE / 2.0;
+        module::Select& continentsWithRivers_se0 = graph.create<module::Select>(continentsWithBadlands, continentsWithRivers_ad, continentsWithBadlands, SEA_LEVEL, riverEdgeFalloff);
+        module::Select& continentsWithRivers_se1 = graph.create<module::Select>(continentsWithRivers_se0, continentsWithBadlands, continentsWithBadlands, SEA_LEVEL + CONTINENT_HEIGHT_SCALE, riverEdgeFalloff);
+
+        module::Cache& continentsWithRivers = graph.create<module::Cache>();
+        continentsWithRivers.setSourceModule(0, continentsWithRivers_se1);
+
+        module::Cache& unscaledFinalPlanet = graph.create<module::Cache>();
+        unscaledFinalPlanet.setSourceModule(0, continentsWithRivers);
+
+        module::ScaleBias& finalPlanet_sb = graph.create<module::ScaleBias>(unscaledFinalPlanet);
+        finalPlanet_sb.setScale((MAX_ELEV - MIN_ELEV) / 2.0);
+        finalPlanet_sb.setBias(MIN_ELEV + ((MAX_ELEV - MIN_ELEV) / 2.0));
+
+        module::Cache& finalPlanet = graph.create<module::Cache>();
+        finalPlanet.setSourceModule(0, finalPlanet_sb);
+    }
+
+    // Returns a graph factory that evaluates the graph of the specified
+    // factory through a noise::module::Program compiled from it.
+    GraphFactory Compiled(const GraphFactory& factory)
+    {
+        return [factory](bench::ModuleGraph& graph) {
+            factory(graph);
+            const module::ModuleBase& output = graph.getOutput();
+            graph.create<module::Program>().setSourceModule(0, output);
+        };
+    }
+
+    // Registers a benchmark that builds a planar noise map of the graph, as
+    // the CreatePlanarTexture() function of the texture examples does.
+    void RegisterPlaneBuild(const std::string& name, const GraphFactory& factory, bool seamless)
+    {
+        bench::RegisterBenchmark(name, [factory, seamless](bench::State& state) {
+            bench::ModuleGraph graph;
+            factory(graph);
+            utils::NoiseMap noiseMap;
+            utils::NoiseMapBuilderPlane plane;
+            plane.SetBounds(-1.0, 1.0, -1.0, 1.0);
+            plane.SetDestSize(TEXTURE_HEIGHT, TEXTURE_HEIGHT);
+            plane.SetSourceModule(graph.getOutput());
+            plane.SetDestNoiseMap(noiseMap);
+            plane.EnableSeamless(seamless);
+            state.setSamplesPerIteration(TEXTURE_HEIGHT * TEXTURE_HEIGHT);
+            while (state.keepRunning())
+            {
+                plane.Build();
+            }
+            bench::DoNotOptimize(noiseMap.GetValue(0, 0));
+        });
+    }
+
+    // Registers a benchmark that builds a spherical noise map of the graph.
+    void RegisterSphereBuild(const std::string& name, const GraphFactory& factory, int width, int height)
+    {
+        bench::RegisterBenchmark(name, [factory, width, height](bench::State& state) {
+            bench::ModuleGraph graph;
+            factory(graph);
+            utils::NoiseMap noiseMap;
+            utils::NoiseMapBuilderSphere sphere;
+            sphere.SetBounds(-90.0, 90.0, -180.0, 180.0);
+            sphere.SetDestSize(width, height);
+            sphere.SetSourceModule(graph.getOutput());
+            sphere.SetDestNoiseMap(noiseMap);
+            state.setSamplesPerIteration((int64_t)width * height);
+            while (state.keepRunning())
+            {
+                sphere.Build();
+            }
+            bench::DoNotOptimize(noiseMap.GetValue(0, 0));
+        });
+    }
+
+    void RegisterTexture(const std::string& name, const GraphFactory& factory)
+    {
+        RegisterPlaneBuild("Graph/" + name + "/plane", factory, false);
+        RegisterPlaneBuild("Graph/" + name + "/seamless", factory, true);
+        RegisterSphereBuild("Graph/" + name + "/sphere", factory, TEXTURE_HEIGHT * 2, TEXTURE_HEIGHT);
+        RegisterPlaneBuild("Graph/" + name + "/plane/program", Compiled(factory), false);
+    }
+
+    // Registers a benchmark that renders a planar noise map of the graph, as
+    // the RenderTexture() function of the granite example does, on the
+    // specified number of threads (0 for one per hardware thread).
+    void RegisterRender(const std::string& name, const GraphFactory& factory, bool enableLight, int threadCount)
+    {
+        bench::RegisterBenchmark(name, [factory, enableLight, threadCount](bench::State& state) {
+            bench::ModuleGraph graph;
+            factory(graph);
+            utils::NoiseMap noiseMap;
+            utils::NoiseMapBuilderPlane plane;
+            plane.SetBounds(-1.0, 1.0, -1.0, 1.0);
+            plane.SetDestSize(TEXTURE_HEIGHT, TEXTURE_HEIGHT);
+            plane.SetSourceModule(graph.getOutput());
+            plane.SetDestNoiseMap(noiseMap);
+            plane.Build();
+
+            utils::Image image;
+            utils::RendererImage renderer;
+            renderer.ClearGradient();
+            renderer.AddGradientPoint(-1.0000, utils::Color(0, 0, 0, 255));
+            renderer.AddGradientPoint(-0.9375, utils::Color(0, 0, 0, 255));
+            renderer.AddGradientPoint(-0.8750, utils::Color(216, 216, 242, 255));
+            renderer.AddGradientPoint(0.0000, utils::Color(191, 191, 191, 255));
+            renderer.AddGradientPoint(0.5000, utils::Color(210, 116, 125, 255));
+            renderer.AddGradientPoint(0.7500, utils::Color(210, 113, 98, 255));
+            renderer.AddGradientPoint(1.0000, utils::Color(255, 176, 192, 255));
+            renderer.SetSourceNoiseMap(noiseMap);
+            renderer.SetDestImage(image);
+            renderer.EnableLight(enableLight);
+            renderer.SetLightAzimuth(135.0);
+            renderer.SetLightElev(60.0);
+            renderer.SetLightContrast(2.0);
+            renderer.SetLightColor(utils::Color(255, 255, 255, 0));
+            renderer.SetThreadCount(threadCount);
+            state.setSamplesPerIteration(TEXTURE_HEIGHT * TEXTURE_HEIGHT);
+            while (state.keepRunning())
+            {
+                renderer.Render();
+            }
+            bench::DoNotOptimize(image.GetValue(0, 0).red);
+        });
+    }
+
+    // Registers a benchmark that renders a normal map from a planar noise map
+    // of the graph.
+    void RegisterNormalMapRender(const std::string& name, const GraphFactory& factory)
+    {
+        bench::RegisterBenchmark(name, [factory](bench::State& state) {
+            bench::ModuleGraph graph;
+            factory(graph);
+            utils::NoiseMap noiseMap;
+            utils::NoiseMapBuilderPlane plane;
+            plane.SetBounds(-1.0, 1.0, -1.0, 1.0);
+            plane.SetDestSize(TEXTURE_HEIGHT, TEXTURE_HEIGHT);
+            plane.SetSourceModule(graph.getOutput());
+            plane.SetDestNoiseMap(noiseMap);
+            plane.Build();
+
+            utils::Image image(TEXTURE_HEIGHT, TEXTURE_HEIGHT);
+            utils::RendererNormalMap renderer;
+            renderer.SetSourceNoiseMap(noiseMap);
+            renderer.SetDestImage(image);
+            renderer.SetBumpHeight(4.0);
+            state.setSamplesPerIteration(TEXTURE_HEIGHT * TEXTURE_HEIGHT);
+            while (state.keepRunning())
+            {
+                renderer.Render();
+            }
+            bench::DoNotOptimize(image.GetValue(0, 0).red);
+        });
+    }
+
+} // namespace
+
+void bench::RegisterGraphBenchmarks()
+{
+    RegisterTexture("granite", CreateGraniteGraph);
+    RegisterTexture("jade", CreateJadeGraph);
+    RegisterTexture("skywater", CreateSkyWaterGraph);
+    RegisterTexture("skycloud", CreateSkyCloudGraph);
+    RegisterTexture("slime", CreateSlimeGraph);
+    RegisterTexture("wood", CreateWoodGraph);
+    RegisterSphereBuild("Graph/complexplanet/sphere", CreatePlanetGraph, PLANET_GRID_WIDTH, PLANET_GRID_HEIGHT);
+    RegisterSphereBuild("Graph/complexplanet/sphere/program", Compiled(CreatePlanetGraph), PLANET_GRID_WIDTH, PLANET_GRID_HEIGHT);
+
+    RegisterRender("Render/granite/nolight", CreateGraniteGraph, false, 1);
+    RegisterRender("Render/granite/light", CreateGraniteGraph, true, 1);
+    RegisterRender("Render/granite/light/threads", CreateGraniteGraph, true, 0);
+    RegisterNormalMapRender("Render/granite/normalmap", CreateGraniteGraph);
+}
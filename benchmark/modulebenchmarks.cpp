@@ -0,0 +1,329 @@
+// modulebenchmarks.cpp
+//
+// Copyright (C) 2019, 2020 zjhlogo
+//
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or (at
+// your option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License (COPYING.txt) for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+// The developer's email is zjhlogo@gmzigail.com (for great email, take
+// off every 'zig'.)
+//
+
+#include "benchmark.h"
+#include "modulegraph.h"
+
+#include <noise/noise.h>
+#include <string>
+#include <vector>
+
+using namespace noise;
+
+namespace
+{
+
+    // Width and height of the grid of input values evaluated by one
+    // iteration of a module benchmark.
+    const int GRID_SIZE = 64;
+
+    // A fixed grid of input values that spans several noise cells.
+    struct SampleGrid
+    {
+        SampleGrid()
+        {
+            for (int z = 0; z < GRID_SIZE; z++)
+            {
+                for (int x = 0; x < GRID_SIZE; x++)
+                {
+                    xs.push_back(x * (4.0 / GRID_SIZE) + 0.0625);
+                    ys.push_back(0.375 + z * (1.0 / 1024.0));
+                    zs.push_back(z * (4.0 / GRID_SIZE) + 0.03125);
+                }
+            }
+            out.resize(xs.size());
+            floatXs.assign(xs.begin(), xs.end());
+            floatYs.assign(ys.begin(), ys.end());
+            floatZs.assign(zs.begin(), zs.end());
+            floatOut.resize(xs.size());
+        }
+
+        std::vector<double> xs;
+        std::vector<double> ys;
+        std::vector<double> zs;
+        std::vector<double> out;
+        std::vector<float> floatXs;
+        std::vector<float> floatYs;
+        std::vector<float> floatZs;
+        std::vector<float> floatOut;
+    };
+
+    // Fills a graph with the noise module to benchmark, preceded by the source
+    // modules it needs.
+    typedef std::function<void(bench::ModuleGraph& graph)> GraphFactory;
+
+    // Registers a scalar, a batch and a float benchmark of the noise module
+    // created by the factory.  The scalar benchmark calls getValue() once per
+    // input value; the batch and float benchmarks call getValues() and
+    // getFloatValues() once for the whole grid.
+    void RegisterModule(const std::string& name, const GraphFactory& factory)
+    {
+        bench::RegisterBenchmark(name + "/scalar", [factory](bench::State& state) {
+            bench::ModuleGraph graph;
+            factory(graph);
+            const module::ModuleBase& noiseModule = graph.getOutput();
+            SampleGrid grid;
+            state.setSamplesPerIteration(grid.xs.size());
+            while (state.keepRunning())
+            {
+                double sum = 0.0;
+                for (size_t i = 0; i < grid.xs.size(); i++)
+                {
+                    sum += noiseModule.getValue(grid.xs[i], grid.ys[i], grid.zs[i]);
+                }
+                bench::DoNotOptimize(sum);
+            }
+        });
+
+        bench::RegisterBenchmark(name + "/batch", [factory](bench::State& state) {
+            bench::ModuleGraph graph;
+            factory(graph);
+            const module::ModuleBase& noiseModule = graph.getOutput();
+            SampleGrid grid;
+            state.setSamplesPerIteration(grid.xs.size());
+            while (state.keepRunning())
+            {
+                noiseModule.getValues(grid.xs.data(), grid.ys.data(), grid.zs.data(), grid.out.data(), grid.xs.size());
+                bench::DoNotOptimize(grid.out[0]);
+            }
+        });
+
+        bench::RegisterBenchmark(name + "/float", [factory](bench::State& state) {
+            bench::ModuleGraph graph;
+            factory(graph);
+            const module::ModuleBase& noiseModule = graph.getOutput();
+            SampleGrid grid;
+            state.setSamplesPerIteration(grid.xs.size());
+            while (state.keepRunning())
+            {
+                noiseModule.getFloatValues(grid.floatXs.data(), grid.floatYs.data(), grid.floatZs.data(), grid.floatOut.data(), grid.xs.size());
+                bench::DoNotOptimize(grid.floatOut[0]);
+            }
+        });
+    }
+
+    // Registers benchmarks of the output value and gradient of a generator
+    // module of type @a Generator.  The analytic benchmark calls
+    // getValueAndGradient() once per input value; the differences benchmark
+    // computes the gradient from forward differences, calling getValue() four
+    // times per input value.
+    template <class Generator> void RegisterGradient(const std::string& name)
+    {
+        bench::RegisterBenchmark(name + "/gradient/analytic", [](bench::State& state) {
+            Generator generator;
+            SampleGrid grid;
+            state.setSamplesPerIteration(grid.xs.size());
+            while (state.keepRunning())
+            {
+                double sum = 0.0;
+                for (size_t i = 0; i < grid.xs.size(); i++)
+                {
+                    double dx, dy, dz;
+                    sum += generator.getValueAndGradient(grid.xs[i], grid.ys[i], grid.zs[i], dx, dy, dz);
+                    sum += dx + dy + dz;
+                }
+                bench::DoNotOptimize(sum);
+            }
+        });
+
+        bench::RegisterBenchmark(name + "/gradient/differences", [](bench::State& state) {
+            const double DELTA = 1.0 / 4096.0;
+            Generator generator;
+            SampleGrid grid;
+            state.setSamplesPerIteration(grid.xs.size());
+            while (state.keepRunning())
+            {
+                double sum = 0.0;
+                for (size_t i = 0; i < grid.xs.size(); i++)
+                {
+                    double value = generator.getValue(grid.xs[i], grid.ys[i], grid.zs[i]);
+                    double dx = (generator.getValue(grid.xs[i] + DELTA, grid.ys[i], grid.zs[i]) - value) / DELTA;
+                    double dy = (generator.getValue(grid.xs[i], grid.ys[i] + DELTA, grid.zs[i]) - value) / DELTA;
+                    double dz = (generator.getValue(grid.xs[i], grid.ys[i], grid.zs[i] + DELTA) - value) / DELTA;
+                    sum += value + dx + dy + dz;
+                }
+                bench::DoNotOptimize(sum);
+            }
+        });
+    }
+
+    const char* GetQualityName(NoiseQuality noiseQuality)
+    {
+        switch (noiseQuality)
+        {
+        case QUALITY_FAST:
+            return "fast";
+        case QUALITY_STD:
+            return "std";
+        case QUALITY_BEST:
+            return "best";
+        }
+        return "unknown";
+    }
+
+    // Creates a Perlin module with the default settings and the specified
+    // seed.
+    module::Perlin& CreatePerlin(bench::ModuleGraph& graph, int seed)
+    {
+        module::Perlin& perlin = graph.create<module::Perlin>();
+        perlin.setSeed(seed);
+        return perlin;
+    }
+
+    void RegisterGenerators()
+    {
+        const NoiseQuality qualities[] = {QUALITY_FAST, QUALITY_STD, QUALITY_BEST};
+        for (NoiseQuality noiseQuality : qualities)
+        {
+            RegisterModule(std::string("Perlin/") + GetQualityName(noiseQuality), [noiseQuality](bench::ModuleGraph& graph) {
+                CreatePerlin(graph, 0).setNoiseQuality(noiseQuality);
+            });
+        }
+
+        RegisterModule("Billow/std", [](bench::ModuleGraph& graph) {
+            graph.create<module::Billow>();
+        });
+
+        RegisterModule("RidgedMulti/std", [](bench::ModuleGraph& graph) {
+            graph.create<module::RidgedMulti>();
+        });
+
+        RegisterGradient<module::Perlin>("Perlin/std");
+        RegisterGradient<module::Billow>("Billow/std");
+        RegisterGradient<module::RidgedMulti>("RidgedMulti/std");
+
+        const bool distances[] = {false, true};
+        for (bool enableDistance : distances)
+        {
+            RegisterModule(std::string("Voronoi/") + (enableDistance ? "distance" : "nodistance"), [enableDistance](bench::ModuleGraph& graph) {
+                module::Voronoi& voronoi = graph.create<module::Voronoi>();
+                voronoi.SetFrequency(4.0);
+                voronoi.EnableDistance(enableDistance);
+            });
+        }
+    }
+
+    void RegisterModifiers()
+    {
+        const double edgeFalloffs[] = {0.0, 0.25};
+        for (double edgeFalloff : edgeFalloffs)
+        {
+            RegisterModule(std::string("Select/") + (edgeFalloff > 0.0 ? "falloff" : "nofalloff"), [edgeFalloff](bench::ModuleGraph& graph) {
+                module::Perlin& low = CreatePerlin(graph, 0);
+                module::Perlin& high = CreatePerlin(graph, 1);
+                module::Perlin& control = CreatePerlin(graph, 2);
+                graph.create<module::Select>(low, high, control, 0.0, edgeFalloff);
+            });
+        }
+
+        // The scale and bias are applied to a cheap source module, so that
+        // the cost of the parameters dominates.
+        RegisterModule("ScaleBias/constant", [](bench::ModuleGraph& graph) {
+            module::Cylinders& cylinders = graph.create<module::Cylinders>();
+            graph.create<module::ScaleBias>(cylinders, 2.0, 0.5);
+        });
+
+        // The control value of the blend is clamped to [-1, +1] on most of
+        // the grid, where only one source module contributes.
+        RegisterModule("Blend/clamped", [](bench::ModuleGraph& graph) {
+            module::Perlin& source0 = CreatePerlin(graph, 0);
+            module::Perlin& source1 = CreatePerlin(graph, 1);
+            module::Perlin& control = CreatePerlin(graph, 2);
+            module::ScaleBias& scaleBias = graph.create<module::ScaleBias>(control, 4.0, 0.0);
+            module::Clamp& clamp = graph.create<module::Clamp>();
+            clamp.setSourceModule(0, scaleBias);
+            clamp.SetBounds(-1.0, 1.0);
+            module::Blend& blend = graph.create<module::Blend>();
+            blend.setSourceModule(0, source0);
+            blend.setSourceModule(1, source1);
+            blend.setSourceModule(2, clamp);
+        });
+
+        // A chain of four transformer modules over a cheap source module,
+        // evaluated as is and fused into a single noise::module::AffineDomain
+        // module.
+        const bool fuseChains[] = {false, true};
+        for (bool fuseChain : fuseChains)
+        {
+            RegisterModule(std::string("DomainChain/") + (fuseChain ? "fused" : "chained"), [fuseChain](bench::ModuleGraph& graph) {
+                module::Cylinders& cylinders = graph.create<module::Cylinders>();
+                module::RotateDomain& rotate = graph.create<module::RotateDomain>(30.0, 45.0, -20.0);
+                rotate.setSourceModule(0, cylinders);
+                module::ScaleDomain& scale = graph.create<module::ScaleDomain>(rotate, 2.0, 1.5, 0.5);
+                module::TranslateDomain& translate = graph.create<module::TranslateDomain>(scale, 0.25, -1.0, 4.0);
+                module::ScaleDomain& chain = graph.create<module::ScaleDomain>(translate, 1.25);
+                if (fuseChain)
+                {
+                    graph.create<module::AffineDomain>().fuseChain(chain);
+                }
+            });
+        }
+
+        RegisterModule("Turbulence/roughness3", [](bench::ModuleGraph& graph) {
+            module::Perlin& perlin = CreatePerlin(graph, 0);
+            graph.create<module::Turbulence>(perlin).setRoughness(3);
+        });
+
+        // Turbulence over a cheap source module, so that the cost of the
+        // displacement dominates.
+        RegisterModule("Turbulence/cylinders", [](bench::ModuleGraph& graph) {
+            module::Cylinders& cylinders = graph.create<module::Cylinders>();
+            graph.create<module::Turbulence>(cylinders).setRoughness(3);
+        });
+
+        // The curve and terrace modules map the output value from a cheap
+        // source module, so that the cost of the control point lookup
+        // dominates.
+        RegisterModule("Cylinders", [](bench::ModuleGraph& graph) {
+            graph.create<module::Cylinders>();
+        });
+
+        const int controlPointCounts[] = {4, 16, 64};
+        for (int controlPointCount : controlPointCounts)
+        {
+            RegisterModule("Curve/" + std::to_string(controlPointCount), [controlPointCount](bench::ModuleGraph& graph) {
+                module::Cylinders& cylinders = graph.create<module::Cylinders>();
+                module::Curve& curve = graph.create<module::Curve>();
+                curve.setSourceModule(0, cylinders);
+                for (int i = 0; i < controlPointCount; i++)
+                {
+                    double inputValue = -1.0 + 2.0 * i / (controlPointCount - 1);
+                    curve.AddControlPoint(inputValue, (i & 1) ? inputValue * 0.5 : -inputValue);
+                }
+            });
+
+            RegisterModule("Terrace/" + std::to_string(controlPointCount), [controlPointCount](bench::ModuleGraph& graph) {
+                module::Cylinders& cylinders = graph.create<module::Cylinders>();
+                module::Terrace& terrace = graph.create<module::Terrace>();
+                terrace.setSourceModule(0, cylinders);
+                terrace.MakeControlPoints(controlPointCount);
+            });
+        }
+    }
+
+} // namespace
+
+void bench::RegisterModuleBenchmarks()
+{
+    RegisterGenerators();
+    RegisterModifiers();
+}
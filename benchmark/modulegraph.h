@@ -0,0 +1,70 @@
+// modulegraph.h
+//
+// Copyright (C) 2019, 2020 zjhlogo
+//
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or (at
+// your option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License (COPYING.txt) for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+// The developer's email is zjhlogo@gmzigail.com (for great email, take
+// off every 'zig'.)
+//
+
+#ifndef NOISE_BENCHMARK_MODULEGRAPH_H
+#define NOISE_BENCHMARK_MODULEGRAPH_H
+
+#include <memory>
+#include <noise/noise.h>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+
+    /// Owns the noise modules of a benchmarked noise module graph.
+    ///
+    /// Noise modules keep references to their source modules, so a graph
+    /// must stay alive as long as it is evaluated.  The most recently created
+    /// noise module is the output of the graph.
+    class ModuleGraph
+    {
+    public:
+        /// Creates a noise module that belongs to this graph.
+        ///
+        /// @returns A reference to the new noise module.
+        template <class T, class... Args> T& create(Args&&... args)
+        {
+            T* pModule = new T(std::forward<Args>(args)...);
+            m_modules.emplace_back(pModule);
+            return *pModule;
+        }
+
+        /// Returns the output noise module of this graph.
+        const noise::module::ModuleBase& getOutput() const
+        {
+            return *m_modules.back();
+        }
+
+        /// Returns the number of noise modules in this graph.
+        size_t getModuleCount() const
+        {
+            return m_modules.size();
+        }
+
+    private:
+        std::vector<std::unique_ptr<noise::module::ModuleBase>> m_modules;
+    };
+
+} // namespace bench
+
+#endif
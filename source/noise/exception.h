@@ -34,6 +34,13 @@ namespace noise
     {
     };
 
+    /// Cancelled exception
+    ///
+    /// An operation was cancelled by the application before it completed.
+    class ExceptionCancelled : public Exception
+    {
+    };
+
     /// Invalid parameter exception
     ///
     /// An invalid parameter was passed to a libnoise function or method.
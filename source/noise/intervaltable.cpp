@@ -0,0 +1,67 @@
+// intervaltable.cpp
+//
+// Copyright (C) 2019, 2020 zjhlogo
+//
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or (at
+// your option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License (COPYING.txt) for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+// The developer's email is zjhlogo@gmzigail.com (for great email, take
+// off every 'zig'.)
+//
+
+#include "intervaltable.h"
+
+using namespace noise;
+
+IntervalTable::IntervalTable()
+    : m_buckets(2, 0)
+    , m_bucketCount(1)
+    , m_lowerBound(0.0)
+    , m_bucketScale(0.0)
+{
+}
+
+void IntervalTable::build(const double* pBounds, int count, size_t stride)
+{
+    m_bounds.resize(count);
+    const char* pBound = (const char*)pBounds;
+    for (int i = 0; i < count; i++)
+    {
+        m_bounds[i] = *(const double*)pBound;
+        pBound += stride;
+    }
+
+    // A table with few enough bounds to walk through them all, or with bounds
+    // that are all equal, has a single bucket.
+    m_bucketCount = 1;
+    m_lowerBound = 0.0;
+    m_bucketScale = 0.0;
+    if (count > INTERVAL_TABLE_MAX_WALK && m_bounds[count - 1] > m_bounds[0])
+    {
+        m_bucketCount = count * INTERVAL_TABLE_BUCKETS_PER_BOUND;
+        m_lowerBound = m_bounds[0];
+        m_bucketScale = m_bucketCount / (m_bounds[count - 1] - m_bounds[0]);
+    }
+
+    // The first bucket also holds the values smaller than the smallest bound,
+    // and the last bucket the values larger than the largest bound.
+    m_buckets.resize(m_bucketCount + 1);
+    m_buckets[0] = 0;
+    for (int bucket = 1; bucket < m_bucketCount; bucket++)
+    {
+        double bucketStart = m_lowerBound + bucket / m_bucketScale;
+        m_buckets[bucket] = (int)(std::upper_bound(m_bounds.begin(), m_bounds.end(), bucketStart) - m_bounds.begin());
+    }
+    m_buckets[m_bucketCount] = count;
+}
@@ -0,0 +1,154 @@
+// intervaltable.h
+//
+// Copyright (C) 2019, 2020 zjhlogo
+//
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or (at
+// your option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License (COPYING.txt) for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+// The developer's email is zjhlogo@gmzigail.com (for great email, take
+// off every 'zig'.)
+//
+
+#ifndef NOISE_INTERVALTABLE_H
+#define NOISE_INTERVALTABLE_H
+
+#include <algorithm>
+#include <vector>
+
+namespace noise
+{
+
+    /// @addtogroup libnoise
+    /// @{
+
+    /// Number of buckets of a noise::IntervalTable object for each bound
+    /// stored in it.
+    const int INTERVAL_TABLE_BUCKETS_PER_BOUND = 4;
+
+    /// Maximum number of bounds in a bucket of a noise::IntervalTable object
+    /// that a lookup walks through; a lookup in a bucket with more bounds
+    /// performs a binary search.
+    const int INTERVAL_TABLE_MAX_WALK = 8;
+
+    /// Lookup table that finds the interval of a sorted array of bounds that
+    /// contains a value.
+    ///
+    /// The range between the smallest and the largest bound is divided into
+    /// buckets of equal width.  Each bucket stores the range of bound indices
+    /// it overlaps, so a lookup computes the bucket from the value and only
+    /// searches the few bounds within that bucket.  For evenly spaced bounds,
+    /// a lookup takes constant time; for any spacing, it takes no more than
+    /// a binary search.
+    ///
+    /// The noise::module::Curve and noise::module::Terrace noise modules use
+    /// this table to find the control points that surround the output value
+    /// from their source module.
+    class IntervalTable
+    {
+    public:
+        /// Constructor.
+        ///
+        /// The table is empty; findUpperBound() returns 0 for any value.
+        IntervalTable();
+
+        /// Rebuilds the table from an array of bounds.
+        ///
+        /// @param pBounds A pointer to the array of bounds.
+        /// @param count The number of bounds in the array.
+        /// @param stride The distance, in bytes, between two consecutive
+        /// bounds in the array.
+        ///
+        /// @pre The bounds are sorted in ascending order.
+        ///
+        /// The table copies the bounds; the array is not referenced after
+        /// this method returns.  An application must call this method each
+        /// time the bounds change.
+        void build(const double* pBounds, int count, size_t stride = sizeof(double));
+
+        /// Returns the number of bounds in the table.
+        int getBoundCount() const
+        {
+            return (int)m_bounds.size();
+        }
+
+        /// Returns the index of the first bound that is larger than a value.
+        ///
+        /// @param value The value to look up.
+        ///
+        /// @returns The index of the first bound that is larger than @a
+        /// value, or the number of bounds if there is no such bound.
+        ///
+        /// The result is the same as the result of a linear search for the
+        /// first bound @a b for which <i>value < b</i> is true, including
+        /// for a NaN value, for which the number of bounds is returned.
+        int findUpperBound(double value) const
+        {
+            // Compute the bucket that contains the value.  The comparisons are
+            // written so that a NaN value selects the last bucket.
+            double position = (value - m_lowerBound) * m_bucketScale;
+            int bucket = m_bucketCount - 1;
+            if (!(position >= m_bucketCount))
+            {
+                bucket = position > 0.0 ? (int)position : 0;
+            }
+
+            // Search the bounds that overlap the bucket.  Most buckets overlap
+            // at most one bound, so walk them unless there are many.
+            const double* pBounds = m_bounds.data();
+            int boundCount = (int)m_bounds.size();
+            int index = m_buckets[bucket];
+            int bucketEnd = m_buckets[bucket + 1];
+            if (bucketEnd - index > INTERVAL_TABLE_MAX_WALK)
+            {
+                index = (int)(std::upper_bound(pBounds + index, pBounds + bucketEnd, value) - pBounds);
+            }
+
+            // Walk forward to the first bound larger than the value.  The
+            // bucket computed from a value close to a bucket edge may also be
+            // off by one because of rounding, so walk backward if needed.
+            while (index < boundCount && !(value < pBounds[index]))
+            {
+                ++index;
+            }
+            while (index > 0 && value < pBounds[index - 1])
+            {
+                --index;
+            }
+            return index;
+        }
+
+    private:
+        /// Sorted copy of the bounds.
+        std::vector<double> m_bounds;
+
+        /// For each bucket, the index of the first bound larger than the
+        /// start of the bucket, followed by the number of bounds.
+        std::vector<int> m_buckets;
+
+        /// Number of buckets.
+        int m_bucketCount;
+
+        /// Smallest bound; the start of the first bucket.
+        double m_lowerBound;
+
+        /// Number of buckets per unit between the smallest and the largest
+        /// bound.
+        double m_bucketScale;
+    };
+
+    /// @}
+
+} // namespace noise
+
+#endif
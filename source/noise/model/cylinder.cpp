@@ -23,6 +23,7 @@
 #include "cylinder.h"
 
 #include "../mathconsts.h"
+#include "../misc.h"
 
 using namespace noise;
 using namespace noise::model;
@@ -47,3 +48,41 @@ double Cylinder::GetValue(double angle, double height) const
     z = sin(angle * DEG_TO_RAD);
     return m_pModule->getValue(x, y, z);
 }
+
+void Cylinder::GetValues(const double* angles, const double* heights, double* out, size_t count) const
+{
+    assert(m_pModule != NULL);
+
+    double xs[module::MAX_BATCH_SIZE];
+    double zs[module::MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += module::MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, module::MAX_BATCH_SIZE);
+        for (size_t j = 0; j < n; j++)
+        {
+            xs[j] = cos(angles[i + j] * DEG_TO_RAD);
+            zs[j] = sin(angles[i + j] * DEG_TO_RAD);
+        }
+        m_pModule->getValues(xs, heights + i, zs, out + i, n);
+    }
+}
+
+void Cylinder::GetFloatValues(const double* angles, const double* heights, float* out, size_t count) const
+{
+    assert(m_pModule != NULL);
+
+    float xs[module::MAX_BATCH_SIZE];
+    float ys[module::MAX_BATCH_SIZE];
+    float zs[module::MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += module::MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, module::MAX_BATCH_SIZE);
+        for (size_t j = 0; j < n; j++)
+        {
+            xs[j] = (float)cos(angles[i + j] * DEG_TO_RAD);
+            ys[j] = (float)heights[i + j];
+            zs[j] = (float)sin(angles[i + j] * DEG_TO_RAD);
+        }
+        m_pModule->getFloatValues(xs, ys, zs, out + i, n);
+    }
+}
@@ -101,6 +101,38 @@ namespace noise
             /// origin.
             double GetValue(double angle, double height) const;
 
+            /// Returns the output values from the noise module given the
+            /// (angle, height) coordinates of a batch of input values located
+            /// on the surface of the cylinder.
+            ///
+            /// @param angles The angles around the cylinder's center, in
+            /// degrees.
+            /// @param heights The heights along the @a y axis.
+            /// @param out The array that receives the output values.
+            /// @param count The number of input values.
+            ///
+            /// @pre A noise module was passed to the SetModule() method.
+            ///
+            /// Each output value is equal to the value returned by GetValue()
+            /// for the same input value.
+            void GetValues(const double* angles, const double* heights, double* out, size_t count) const;
+
+            /// Returns the output values from the noise module given the
+            /// (angle, height) coordinates of a batch of input values located
+            /// on the surface of the cylinder, in single precision.
+            ///
+            /// @param angles The angles around the cylinder's center, in
+            /// degrees.
+            /// @param heights The heights along the @a y axis.
+            /// @param out The array that receives the output values.
+            /// @param count The number of input values.
+            ///
+            /// @pre A noise module was passed to the SetModule() method.
+            ///
+            /// The output values are generated by the getFloatValues() method
+            /// of the noise module, in single precision.
+            void GetFloatValues(const double* angles, const double* heights, float* out, size_t count) const;
+
             /// Sets the noise module that is used to generate the output values.
             ///
             /// @param module The noise module that is used to generate the output
@@ -21,6 +21,8 @@
 
 #include "plane.h"
 
+#include "../misc.h"
+
 using namespace noise;
 using namespace noise::model;
 
@@ -41,3 +43,34 @@ double Plane::GetValue(double x, double z) const
 
     return m_pModule->getValue(x, 0, z);
 }
+
+void Plane::GetValues(const double* xs, const double* zs, double* out, size_t count) const
+{
+    assert(m_pModule != NULL);
+
+    double ys[module::MAX_BATCH_SIZE] = {0.0};
+    for (size_t i = 0; i < count; i += module::MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, module::MAX_BATCH_SIZE);
+        m_pModule->getValues(xs + i, ys, zs + i, out + i, n);
+    }
+}
+
+void Plane::GetFloatValues(const double* xs, const double* zs, float* out, size_t count) const
+{
+    assert(m_pModule != NULL);
+
+    float fxs[module::MAX_BATCH_SIZE];
+    float fys[module::MAX_BATCH_SIZE] = {0.0f};
+    float fzs[module::MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += module::MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, module::MAX_BATCH_SIZE);
+        for (size_t j = 0; j < n; j++)
+        {
+            fxs[j] = (float)xs[i + j];
+            fzs[j] = (float)zs[i + j];
+        }
+        m_pModule->getFloatValues(fxs, fys, fzs, out + i, n);
+    }
+}
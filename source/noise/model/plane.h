@@ -91,6 +91,36 @@ namespace noise
             /// SetModule() method.
             double GetValue(double x, double z) const;
 
+            /// Returns the output values from the noise module given the
+            /// ( @a x, @a z ) coordinates of a batch of input values located on
+            /// the surface of the plane.
+            ///
+            /// @param xs The @a x coordinates of the input values.
+            /// @param zs The @a z coordinates of the input values.
+            /// @param out The array that receives the output values.
+            /// @param count The number of input values.
+            ///
+            /// @pre A noise module was passed to the SetModule() method.
+            ///
+            /// Each output value is equal to the value returned by GetValue()
+            /// for the same input value.
+            void GetValues(const double* xs, const double* zs, double* out, size_t count) const;
+
+            /// Returns the output values from the noise module given the
+            /// ( @a x, @a z ) coordinates of a batch of input values located on
+            /// the surface of the plane, in single precision.
+            ///
+            /// @param xs The @a x coordinates of the input values.
+            /// @param zs The @a z coordinates of the input values.
+            /// @param out The array that receives the output values.
+            /// @param count The number of input values.
+            ///
+            /// @pre A noise module was passed to the SetModule() method.
+            ///
+            /// The output values are generated by the getFloatValues() method
+            /// of the noise module, in single precision.
+            void GetFloatValues(const double* xs, const double* zs, float* out, size_t count) const;
+
             /// Sets the noise module that is used to generate the output values.
             ///
             /// @param module The noise module that is used to generate the output
@@ -23,6 +23,7 @@
 #include "sphere.h"
 
 #include "../latlon.h"
+#include "../misc.h"
 
 using namespace noise;
 using namespace noise::model;
@@ -45,3 +46,45 @@ double Sphere::GetValue(double lat, double lon) const
     LatLonToXYZ(lat, lon, x, y, z);
     return m_pModule->getValue(x, y, z);
 }
+
+void Sphere::GetValues(const double* lats, const double* lons, double* out, size_t count) const
+{
+    assert(m_pModule != NULL);
+
+    double xs[module::MAX_BATCH_SIZE];
+    double ys[module::MAX_BATCH_SIZE];
+    double zs[module::MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += module::MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, module::MAX_BATCH_SIZE);
+        for (size_t j = 0; j < n; j++)
+        {
+            LatLonToXYZ(lats[i + j], lons[i + j], xs[j], ys[j], zs[j]);
+        }
+        m_pModule->getValues(xs, ys, zs, out + i, n);
+    }
+}
+
+void Sphere::GetFloatValues(const double* lats, const double* lons, float* out, size_t count) const
+{
+    assert(m_pModule != NULL);
+
+    float xs[module::MAX_BATCH_SIZE];
+    float ys[module::MAX_BATCH_SIZE];
+    float zs[module::MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += module::MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, module::MAX_BATCH_SIZE);
+        for (size_t j = 0; j < n; j++)
+        {
+            // Convert to Cartesian coordinates in double precision, so that
+            // only the result is rounded.
+            double x, y, z;
+            LatLonToXYZ(lats[i + j], lons[i + j], x, y, z);
+            xs[j] = (float)x;
+            ys[j] = (float)y;
+            zs[j] = (float)z;
+        }
+        m_pModule->getFloatValues(xs, ys, zs, out + i, n);
+    }
+}
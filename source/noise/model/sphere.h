@@ -101,6 +101,36 @@ namespace noise
             /// western hemisphere.
             double GetValue(double lat, double lon) const;
 
+            /// Returns the output values from the noise module given the
+            /// (latitude, longitude) coordinates of a batch of input values
+            /// located on the surface of the sphere.
+            ///
+            /// @param lats The latitudes of the input values, in degrees.
+            /// @param lons The longitudes of the input values, in degrees.
+            /// @param out The array that receives the output values.
+            /// @param count The number of input values.
+            ///
+            /// @pre A noise module was passed to the SetModule() method.
+            ///
+            /// Each output value is equal to the value returned by GetValue()
+            /// for the same input value.
+            void GetValues(const double* lats, const double* lons, double* out, size_t count) const;
+
+            /// Returns the output values from the noise module given the
+            /// (latitude, longitude) coordinates of a batch of input values
+            /// located on the surface of the sphere, in single precision.
+            ///
+            /// @param lats The latitudes of the input values, in degrees.
+            /// @param lons The longitudes of the input values, in degrees.
+            /// @param out The array that receives the output values.
+            /// @param count The number of input values.
+            ///
+            /// @pre A noise module was passed to the SetModule() method.
+            ///
+            /// The output values are generated by the getFloatValues() method
+            /// of the noise module, in single precision.
+            void GetFloatValues(const double* lats, const double* lons, float* out, size_t count) const;
+
             /// Sets the noise module that is used to generate the output values.
             ///
             /// @param module The noise module that is used to generate the output
@@ -55,6 +55,8 @@ namespace noise
             Add();
 
             virtual double getValue(double x, double y, double z) const;
+
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const;
         };
 
         /// @}
@@ -0,0 +1,200 @@
+// affinedomain.cpp
+//
+// Copyright (C) 2019, 2020 zjhlogo
+//
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or (at
+// your option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License (COPYING.txt) for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+// The developer's email is zjhlogo@gmzigail.com (for great email, take
+// off every 'zig'.)
+//
+
+#include "affinedomain.h"
+
+#include "../misc.h"
+#include "rotatedomain.h"
+#include "scaledomain.h"
+#include "translatedomain.h"
+
+using namespace noise::module;
+
+namespace
+{
+
+    // The 3x4 identity matrix.
+    const double IDENTITY_MATRIX[12] = {
+        1.0, 0.0, 0.0, 0.0,
+        0.0, 1.0, 0.0, 0.0,
+        0.0, 0.0, 1.0, 0.0};
+
+    // Composes a matrix with a linear transformation applied after it.  The
+    // 3x3 linear transformation is in row-major order.
+    void ApplyLinear(double matrix[12], const double linear[9])
+    {
+        double result[12];
+        for (int row = 0; row < 3; row++)
+        {
+            for (int column = 0; column < 4; column++)
+            {
+                result[row * 4 + column] = linear[row * 3 + 0] * matrix[0 * 4 + column]
+                                         + linear[row * 3 + 1] * matrix[1 * 4 + column]
+                                         + linear[row * 3 + 2] * matrix[2 * 4 + column];
+            }
+        }
+        for (int i = 0; i < 12; i++)
+        {
+            matrix[i] = result[i];
+        }
+    }
+
+    // Composes a matrix with another affine transformation applied after
+    // it.  Both matrices are 3x4 matrices in row-major order.
+    void ApplyAffine(double matrix[12], const double affine[12])
+    {
+        double linear[9];
+        for (int row = 0; row < 3; row++)
+        {
+            for (int column = 0; column < 3; column++)
+            {
+                linear[row * 3 + column] = affine[row * 4 + column];
+            }
+        }
+        ApplyLinear(matrix, linear);
+        for (int row = 0; row < 3; row++)
+        {
+            matrix[row * 4 + 3] += affine[row * 4 + 3];
+        }
+    }
+
+} // namespace
+
+AffineDomain::AffineDomain()
+    : ModuleBase(1)
+{
+    setMatrix(IDENTITY_MATRIX);
+}
+
+void AffineDomain::setMatrix(const double matrix[12])
+{
+    for (int i = 0; i < 12; i++)
+    {
+        m_matrix[i] = matrix[i];
+    }
+}
+
+void AffineDomain::getMatrix(double matrix[12]) const
+{
+    for (int i = 0; i < 12; i++)
+    {
+        matrix[i] = m_matrix[i];
+    }
+}
+
+int AffineDomain::fuseChain(const ModuleBase& firstModule)
+{
+    double matrix[12];
+    for (int i = 0; i < 12; i++)
+    {
+        matrix[i] = IDENTITY_MATRIX[i];
+    }
+
+    // Walk down the chain, composing the transformation of each noise module
+    // with the transformations of the noise modules before it.
+    const ModuleBase* pModule = &firstModule;
+    int fusedCount = 0;
+    for (;;)
+    {
+        const ModuleBase* pNext = NULL;
+        if (const TranslateDomain* pTranslate = dynamic_cast<const TranslateDomain*>(pModule))
+        {
+            if (pTranslate->GetXTranslation().isConstant() && pTranslate->GetYTranslation().isConstant() && pTranslate->GetZTranslation().isConstant())
+            {
+                matrix[3] += pTranslate->GetXTranslation().getConstValue();
+                matrix[7] += pTranslate->GetYTranslation().getConstValue();
+                matrix[11] += pTranslate->GetZTranslation().getConstValue();
+                pNext = pTranslate->getSource().getSourceModule();
+            }
+        }
+        else if (const ScaleDomain* pScale = dynamic_cast<const ScaleDomain*>(pModule))
+        {
+            if (pScale->GetXScale().isConstant() && pScale->GetYScale().isConstant() && pScale->GetZScale().isConstant())
+            {
+                double linear[9] = {
+                    pScale->GetXScale().getConstValue(), 0.0, 0.0,
+                    0.0, pScale->GetYScale().getConstValue(), 0.0,
+                    0.0, 0.0, pScale->GetZScale().getConstValue()};
+                ApplyLinear(matrix, linear);
+                pNext = pScale->getSource().getSourceModule();
+            }
+        }
+        else if (const RotateDomain* pRotate = dynamic_cast<const RotateDomain*>(pModule))
+        {
+            double linear[9];
+            pRotate->getMatrix(linear);
+            ApplyLinear(matrix, linear);
+            pNext = &pRotate->getSourceModule(0);
+        }
+        else if (const AffineDomain* pAffine = dynamic_cast<const AffineDomain*>(pModule))
+        {
+            ApplyAffine(matrix, pAffine->m_matrix);
+            pNext = &pAffine->getSourceModule(0);
+        }
+
+        // A noise module that cannot be fused, or whose source is a plain
+        // constant rather than a noise module, ends the chain.
+        if (pNext == NULL)
+        {
+            break;
+        }
+        pModule = pNext;
+        ++fusedCount;
+    }
+
+    setMatrix(matrix);
+    setSourceModule(0, *pModule);
+    return fusedCount;
+}
+
+double AffineDomain::getValue(double x, double y, double z) const
+{
+    assert(m_pSourceModule[0] != NULL);
+
+    double nx = (m_matrix[0] * x) + (m_matrix[1] * y) + (m_matrix[2] * z) + m_matrix[3];
+    double ny = (m_matrix[4] * x) + (m_matrix[5] * y) + (m_matrix[6] * z) + m_matrix[7];
+    double nz = (m_matrix[8] * x) + (m_matrix[9] * y) + (m_matrix[10] * z) + m_matrix[11];
+    return m_pSourceModule[0]->getValue(nx, ny, nz);
+}
+
+void AffineDomain::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    assert(m_pSourceModule[0] != NULL);
+
+    double nx[MAX_BATCH_SIZE];
+    double ny[MAX_BATCH_SIZE];
+    double nz[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        for (size_t j = 0; j < n; j++)
+        {
+            double x = xs[i + j];
+            double y = ys[i + j];
+            double z = zs[i + j];
+            nx[j] = (m_matrix[0] * x) + (m_matrix[1] * y) + (m_matrix[2] * z) + m_matrix[3];
+            ny[j] = (m_matrix[4] * x) + (m_matrix[5] * y) + (m_matrix[6] * z) + m_matrix[7];
+            nz[j] = (m_matrix[8] * x) + (m_matrix[9] * y) + (m_matrix[10] * z) + m_matrix[11];
+        }
+        m_pSourceModule[0]->getValues(nx, ny, nz, out + i, n);
+    }
+}
@@ -0,0 +1,135 @@
+// affinedomain.h
+//
+// Copyright (C) 2019, 2020 zjhlogo
+//
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or (at
+// your option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License (COPYING.txt) for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+// The developer's email is zjhlogo@gmzigail.com (for great email, take
+// off every 'zig'.)
+//
+
+#ifndef NOISE_MODULE_AFFINEDOMAIN_H
+#define NOISE_MODULE_AFFINEDOMAIN_H
+
+#include "modulebase.h"
+
+namespace noise
+{
+
+    namespace module
+    {
+
+        /// @addtogroup libnoise
+        /// @{
+
+        /// @addtogroup modules
+        /// @{
+
+        /// @addtogroup transformermodules
+        /// @{
+
+        /// Noise module that applies an affine transformation to the input
+        /// value before returning the output value from a source module.
+        ///
+        /// The getValue() method multiplies the ( @a x, @a y, @a z )
+        /// coordinates of the input value by a 3x4 matrix, that is, a 3x3
+        /// linear transformation followed by a translation, before returning
+        /// the output value from the source module.  To set the matrix, call
+        /// the setMatrix() method.
+        ///
+        /// Any sequence of rotations, scalings and translations is an affine
+        /// transformation, so a chain of noise::module::TranslateDomain,
+        /// noise::module::ScaleDomain and noise::module::RotateDomain noise
+        /// modules can be replaced by a single noise module of this type.  The
+        /// fuseChain() method computes the matrix of such a chain and connects
+        /// this noise module to the source module at the end of the chain.
+        /// The chain then costs one matrix multiplication per input value
+        /// instead of one virtual call and one transformation per noise
+        /// module.  The output values are equal to the output values of the
+        /// chain within floating-point rounding, since the fused matrix
+        /// rounds its products differently.
+        ///
+        /// This noise module requires one source module.
+        class AffineDomain : public ModuleBase
+        {
+
+        public:
+            /// Constructor.
+            ///
+            /// The matrix is set to the identity matrix.
+            AffineDomain();
+
+            /// Sets the matrix to apply to the input value.
+            ///
+            /// @param matrix The 3x4 matrix in row-major order.
+            ///
+            /// Row @a i holds the factors that the @a x, @a y and @a z
+            /// coordinates of the input value are multiplied with and summed
+            /// in that order, followed by the translation added to the sum, to
+            /// produce coordinate @a i of the transformed input value.
+            void setMatrix(const double matrix[12]);
+
+            /// Returns the matrix applied to the input value.
+            ///
+            /// @param matrix The array that receives the 3x4 matrix in
+            /// row-major order.
+            void getMatrix(double matrix[12]) const;
+
+            /// Replaces this noise module by the fused chain of transformer
+            /// modules that starts at a noise module.
+            ///
+            /// @param firstModule The first noise module of the chain.
+            ///
+            /// @returns The number of noise modules that were fused.
+            ///
+            /// @pre Each noise::module::RotateDomain and
+            /// noise::module::AffineDomain noise module of the chain has a
+            /// source module.
+            ///
+            /// The chain follows the source modules of @a firstModule for as
+            /// long as they are noise::module::TranslateDomain or
+            /// noise::module::ScaleDomain noise modules with constant
+            /// parameters, noise::module::RotateDomain noise modules, or
+            /// noise::module::AffineDomain noise modules.  This method sets
+            /// the matrix to the composition of their transformations, and the
+            /// source module to the first noise module after the chain.  If
+            /// @a firstModule does not start a chain, the matrix is set to the
+            /// identity matrix and the source module to @a firstModule.
+            ///
+            /// The parameters of the chain are copied; if an application
+            /// changes a noise module of the chain, it must call this method
+            /// again.
+            int fuseChain(const ModuleBase& firstModule);
+
+            virtual double getValue(double x, double y, double z) const override;
+
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const override;
+
+        protected:
+            /// The 3x4 matrix applied to the input value, in row-major order.
+            double m_matrix[12];
+        };
+
+        /// @}
+
+        /// @}
+
+        /// @}
+
+    } // namespace module
+
+} // namespace noise
+
+#endif
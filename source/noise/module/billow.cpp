@@ -22,6 +22,8 @@
 
 #include "billow.h"
 
+#include "../misc.h"
+
 using namespace noise::module;
 
 Billow::Billow()
@@ -33,15 +35,39 @@ Billow::Billow()
     , m_persistence(DEFAULT_BILLOW_PERSISTENCE)
     , m_seed(DEFAULT_BILLOW_SEED)
 {
+    CalcOctaveTables();
+}
+
+void Billow::CalcOctaveTables()
+{
+    // Accumulate the persistence as a running product, exactly as an octave
+    // loop would, so that the output values are not affected by rounding.
+    double curPersistence = 1.0;
+    for (int curOctave = 0; curOctave < BILLOW_MAX_OCTAVE; curOctave++)
+    {
+        m_octavePersistence[curOctave] = curPersistence;
+        m_octaveSeed[curOctave] = (m_seed + curOctave) & 0xffffffff;
+        curPersistence *= m_persistence;
+    }
 }
 
 double Billow::getValue(double x, double y, double z) const
+{
+    switch (m_noiseQuality)
+    {
+    case QUALITY_FAST:
+        return GetValueQ<QUALITY_FAST>(x, y, z);
+    case QUALITY_BEST:
+        return GetValueQ<QUALITY_BEST>(x, y, z);
+    default:
+        return GetValueQ<QUALITY_STD>(x, y, z);
+    }
+}
+
+template <noise::NoiseQuality noiseQuality>
+double Billow::GetValueQ(double x, double y, double z) const
 {
     double value = 0.0;
-    double signal = 0.0;
-    double curPersistence = 1.0;
-    double nx, ny, nz;
-    int seed;
 
     x *= m_frequency;
     y *= m_frequency;
@@ -49,27 +75,188 @@ double Billow::getValue(double x, double y, double z) const
 
     for (int curOctave = 0; curOctave < m_octaveCount; curOctave++)
     {
-
         // Make sure that these floating-point values have the same range as a 32-
         // bit integer so that we can pass them to the coherent-noise functions.
-        nx = MakeInt32Range(x);
-        ny = MakeInt32Range(y);
-        nz = MakeInt32Range(z);
+        double nx = MakeInt32Range(x);
+        double ny = MakeInt32Range(y);
+        double nz = MakeInt32Range(z);
 
         // Get the coherent-noise value from the input value and add it to the
         // final result.
-        seed = (m_seed + curOctave) & 0xffffffff;
-        signal = GradientCoherentNoise3D(nx, ny, nz, seed, m_noiseQuality);
+        double signal = GradientCoherentNoise3D<noiseQuality>(nx, ny, nz, m_octaveSeed[curOctave]);
         signal = 2.0 * fabs(signal) - 1.0;
-        value += signal * curPersistence;
+        value += signal * m_octavePersistence[curOctave];
 
         // Prepare the next octave.
         x *= m_lacunarity;
         y *= m_lacunarity;
         z *= m_lacunarity;
-        curPersistence *= m_persistence;
     }
     value += 0.5;
 
     return value;
 }
+
+double Billow::getValueAndGradient(double x, double y, double z, double& dx, double& dy, double& dz) const
+{
+    switch (m_noiseQuality)
+    {
+    case QUALITY_FAST:
+        return GetValueAndGradientQ<QUALITY_FAST>(x, y, z, dx, dy, dz);
+    case QUALITY_BEST:
+        return GetValueAndGradientQ<QUALITY_BEST>(x, y, z, dx, dy, dz);
+    default:
+        return GetValueAndGradientQ<QUALITY_STD>(x, y, z, dx, dy, dz);
+    }
+}
+
+template <noise::NoiseQuality noiseQuality>
+double Billow::GetValueAndGradientQ(double x, double y, double z, double& dx, double& dy, double& dz) const
+{
+    double value = 0.0;
+    dx = 0.0;
+    dy = 0.0;
+    dz = 0.0;
+
+    double curFrequency = m_frequency;
+    x *= m_frequency;
+    y *= m_frequency;
+    z *= m_frequency;
+
+    for (int curOctave = 0; curOctave < m_octaveCount; curOctave++)
+    {
+        double nx = MakeInt32Range(x);
+        double ny = MakeInt32Range(y);
+        double nz = MakeInt32Range(z);
+
+        double signalDx, signalDy, signalDz;
+        double signal = GradientCoherentNoise3DAndGradient<noiseQuality>(nx, ny, nz, signalDx, signalDy, signalDz, m_octaveSeed[curOctave]);
+
+        // The derivative of 2 * |signal| - 1 is 2 * sign(signal) times the
+        // derivative of the signal, scaled by the frequency of the octave.
+        double scale = (signal > 0.0 ? 2.0 : (signal < 0.0 ? -2.0 : 0.0)) * m_octavePersistence[curOctave] * curFrequency;
+        dx += signalDx * scale;
+        dy += signalDy * scale;
+        dz += signalDz * scale;
+
+        signal = 2.0 * fabs(signal) - 1.0;
+        value += signal * m_octavePersistence[curOctave];
+
+        // Prepare the next octave.
+        x *= m_lacunarity;
+        y *= m_lacunarity;
+        z *= m_lacunarity;
+        curFrequency *= m_lacunarity;
+    }
+    value += 0.5;
+
+    return value;
+}
+
+void Billow::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    double nx[MAX_BATCH_SIZE];
+    double ny[MAX_BATCH_SIZE];
+    double nz[MAX_BATCH_SIZE];
+    double mx[MAX_BATCH_SIZE];
+    double my[MAX_BATCH_SIZE];
+    double mz[MAX_BATCH_SIZE];
+    double signals[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        double* value = out + i;
+        for (size_t j = 0; j < n; j++)
+        {
+            nx[j] = xs[i + j] * m_frequency;
+            ny[j] = ys[i + j] * m_frequency;
+            nz[j] = zs[i + j] * m_frequency;
+            value[j] = 0.0;
+        }
+
+        // Evaluate one octave for the whole batch at a time, so that the
+        // coherent-noise values of each octave are generated in one call.
+        for (int curOctave = 0; curOctave < m_octaveCount; curOctave++)
+        {
+            double curPersistence = m_octavePersistence[curOctave];
+            for (size_t j = 0; j < n; j++)
+            {
+                mx[j] = MakeInt32Range(nx[j]);
+                my[j] = MakeInt32Range(ny[j]);
+                mz[j] = MakeInt32Range(nz[j]);
+            }
+            GradientCoherentNoise3D(mx, my, mz, signals, n, m_octaveSeed[curOctave], m_noiseQuality);
+
+            for (size_t j = 0; j < n; j++)
+            {
+                double signal = signals[j];
+                signal = 2.0 * fabs(signal) - 1.0;
+                value[j] += signal * curPersistence;
+
+                // Prepare the next octave.
+                nx[j] *= m_lacunarity;
+                ny[j] *= m_lacunarity;
+                nz[j] *= m_lacunarity;
+            }
+        }
+
+        for (size_t j = 0; j < n; j++)
+        {
+            value[j] += 0.5;
+        }
+    }
+}
+
+void Billow::getFloatValues(const float* xs, const float* ys, const float* zs, float* out, size_t count) const
+{
+    float nx[MAX_BATCH_SIZE];
+    float ny[MAX_BATCH_SIZE];
+    float nz[MAX_BATCH_SIZE];
+    float mx[MAX_BATCH_SIZE];
+    float my[MAX_BATCH_SIZE];
+    float mz[MAX_BATCH_SIZE];
+    float signals[MAX_BATCH_SIZE];
+    const float frequency = (float)m_frequency;
+    const float lacunarity = (float)m_lacunarity;
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        float* value = out + i;
+        for (size_t j = 0; j < n; j++)
+        {
+            nx[j] = xs[i + j] * frequency;
+            ny[j] = ys[i + j] * frequency;
+            nz[j] = zs[i + j] * frequency;
+            value[j] = 0.0f;
+        }
+
+        // Same octave loop as getValues(), in single precision.
+        for (int curOctave = 0; curOctave < m_octaveCount; curOctave++)
+        {
+            float curPersistence = (float)m_octavePersistence[curOctave];
+            for (size_t j = 0; j < n; j++)
+            {
+                mx[j] = MakeInt32Range(nx[j]);
+                my[j] = MakeInt32Range(ny[j]);
+                mz[j] = MakeInt32Range(nz[j]);
+            }
+            GradientCoherentNoise3D(mx, my, mz, signals, n, m_octaveSeed[curOctave], m_noiseQuality);
+
+            for (size_t j = 0; j < n; j++)
+            {
+                float signal = 2.0f * fabsf(signals[j]) - 1.0f;
+                value[j] += signal * curPersistence;
+
+                // Prepare the next octave.
+                nx[j] *= lacunarity;
+                ny[j] *= lacunarity;
+                nz[j] *= lacunarity;
+            }
+        }
+
+        for (size_t j = 0; j < n; j++)
+        {
+            value[j] += 0.5f;
+        }
+    }
+}
@@ -158,6 +158,33 @@ namespace noise
 
             virtual double getValue(double x, double y, double z) const;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const;
+
+            virtual void getFloatValues(const float* xs, const float* ys, const float* zs, float* out, size_t count) const;
+
+            /// Generates an output value and its gradient, given the coordinates
+            /// of the specified input value.
+            ///
+            /// @param x The @a x coordinate of the input value.
+            /// @param y The @a y coordinate of the input value.
+            /// @param z The @a z coordinate of the input value.
+            /// @param dx Receives the derivative of the output value along the
+            /// @a x axis.
+            /// @param dy Receives the derivative of the output value along the
+            /// @a y axis.
+            /// @param dz Receives the derivative of the output value along the
+            /// @a z axis.
+            ///
+            /// @returns The output value, identical to the value returned by
+            /// getValue().
+            ///
+            /// The gradient is computed analytically alongside the output
+            /// value; see noise::module::Perlin::getValueAndGradient().  Where
+            /// an octave's coherent-noise value is exactly zero, the output
+            /// value has a crease and the gradient is taken to be zero along
+            /// it.
+            double getValueAndGradient(double x, double y, double z, double& dx, double& dy, double& dz) const;
+
             /// Sets the frequency of the first octave.
             ///
             /// @param frequency The frequency of the first octave.
@@ -227,6 +254,7 @@ namespace noise
             void SetPersistence(double persistence)
             {
                 m_persistence = persistence;
+                CalcOctaveTables();
             }
 
             /// Sets the seed value used by the billowy-noise function.
@@ -235,9 +263,25 @@ namespace noise
             void SetSeed(int seed)
             {
                 m_seed = seed;
+                CalcOctaveTables();
             }
 
         protected:
+            /// Calculates the persistence and the seed of each octave.
+            ///
+            /// This method is called when the persistence or the seed changes.
+            void CalcOctaveTables();
+
+            /// Generates the output value with the noise quality fixed at
+            /// compile time.
+            template <noise::NoiseQuality noiseQuality>
+            double GetValueQ(double x, double y, double z) const;
+
+            /// Generates the output value and its gradient with the noise
+            /// quality fixed at compile time.
+            template <noise::NoiseQuality noiseQuality>
+            double GetValueAndGradientQ(double x, double y, double z, double& dx, double& dy, double& dz) const;
+
             /// Frequency of the first octave.
             double m_frequency;
 
@@ -255,6 +299,12 @@ namespace noise
 
             /// Seed value used by the billowy-noise function.
             int m_seed;
+
+            /// Persistence applied to each octave.
+            double m_octavePersistence[BILLOW_MAX_OCTAVE];
+
+            /// Seed value used by each octave.
+            int m_octaveSeed[BILLOW_MAX_OCTAVE];
         };
 
         /// @}
@@ -22,6 +22,7 @@
 
 #include "blend.h"
 #include "../interp.h"
+#include "../misc.h"
 
 using namespace noise::module;
 
@@ -36,8 +37,68 @@ double Blend::getValue(double x, double y, double z) const
     assert(m_pSourceModule[1] != NULL);
     assert(m_pSourceModule[2] != NULL);
 
+    double alpha = (m_pSourceModule[2]->getValue(x, y, z) + 1.0) / 2.0;
+    if (alpha == 0.0)
+    {
+        return m_pSourceModule[0]->getValue(x, y, z);
+    }
+    else if (alpha == 1.0)
+    {
+        return m_pSourceModule[1]->getValue(x, y, z);
+    }
+
     double v0 = m_pSourceModule[0]->getValue(x, y, z);
     double v1 = m_pSourceModule[1]->getValue(x, y, z);
-    double alpha = (m_pSourceModule[2]->getValue(x, y, z) + 1.0) / 2.0;
     return LinearInterp(v0, v1, alpha);
 }
+
+void Blend::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    assert(m_pSourceModule[0] != NULL);
+    assert(m_pSourceModule[1] != NULL);
+    assert(m_pSourceModule[2] != NULL);
+
+    double v0[MAX_BATCH_SIZE];
+    double v1[MAX_BATCH_SIZE];
+    double alpha[MAX_BATCH_SIZE];
+    size_t lanes0[MAX_BATCH_SIZE];
+    size_t lanes1[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        m_pSourceModule[2]->getValues(xs + i, ys + i, zs + i, alpha, n);
+
+        // Where the control value is at the end of its range, such as the
+        // output of a noise::module::Clamp module, the blended value is
+        // the value of one source module alone, so the other one is not
+        // evaluated there.
+        size_t laneCount0 = 0;
+        size_t laneCount1 = 0;
+        for (size_t j = 0; j < n; j++)
+        {
+            alpha[j] = (alpha[j] + 1.0) / 2.0;
+            lanes0[laneCount0] = j;
+            laneCount0 += (alpha[j] != 1.0);
+            lanes1[laneCount1] = j;
+            laneCount1 += (alpha[j] != 0.0);
+        }
+        getLaneValues(*m_pSourceModule[0], xs + i, ys + i, zs + i, lanes0, laneCount0, n, v0);
+        getLaneValues(*m_pSourceModule[1], xs + i, ys + i, zs + i, lanes1, laneCount1, n, v1);
+
+        for (size_t j = 0; j < n; j++)
+        {
+            if (alpha[j] == 0.0)
+            {
+                out[i + j] = v0[j];
+            }
+            else if (alpha[j] == 1.0)
+            {
+                out[i + j] = v1[j];
+            }
+            else
+            {
+                out[i + j] = LinearInterp(v0[j], v1[j], alpha[j]);
+            }
+        }
+    }
+}
@@ -64,7 +64,9 @@ namespace noise
         /// application code easier to read.
         ///
         /// This noise module uses linear interpolation to perform the blending
-        /// operation.
+        /// operation.  Where the output value from the control module is -1.0
+        /// or +1.0, such as where a noise::module::Clamp module clamps it,
+        /// this noise module only evaluates the source module that it outputs.
         ///
         /// This noise module requires three source modules.
         class Blend : public ModuleBase
@@ -100,6 +102,8 @@ namespace noise
 
             virtual double getValue(double x, double y, double z) const;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const;
+
             /// Sets the control module.
             ///
             /// @param controlModule The control module.
@@ -22,11 +22,16 @@
 
 #include "cache.h"
 
+#include "../misc.h"
+
+#include <string.h>
+
 using namespace noise::module;
 
 Cache::Cache()
     : ModuleBase(1)
     , m_isCached(false)
+    , m_batchCount(0)
 {
 }
 
@@ -44,3 +49,26 @@ double Cache::getValue(double x, double y, double z) const
     m_isCached = true;
     return m_cachedValue;
 }
+
+void Cache::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    assert(m_pSourceModule[0] != NULL);
+
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        size_t bytes = n * sizeof(double);
+        if (!(m_batchCount == n
+              && memcmp(xs + i, m_xBatchCache, bytes) == 0
+              && memcmp(ys + i, m_yBatchCache, bytes) == 0
+              && memcmp(zs + i, m_zBatchCache, bytes) == 0))
+        {
+            m_pSourceModule[0]->getValues(xs + i, ys + i, zs + i, m_batchCachedValues, n);
+            memcpy(m_xBatchCache, xs + i, bytes);
+            memcpy(m_yBatchCache, ys + i, bytes);
+            memcpy(m_zBatchCache, zs + i, bytes);
+            m_batchCount = n;
+        }
+        memcpy(out + i, m_batchCachedValues, bytes);
+    }
+}
@@ -55,6 +55,10 @@ namespace noise
         /// module returns the cached output value without having the source
         /// module recalculate the output value.
         ///
+        /// The getValues() method caches the last batch of input values in the
+        /// same way; a batch is only served from the cache if all of its input
+        /// values are equal to the previously passed-in batch.
+        ///
         /// If an application passes a new source module to the SetSourceModule()
         /// method, the cache is invalidated.
         ///
@@ -63,6 +67,9 @@ namespace noise
         /// module will redundantly calculate the same output value once for each
         /// noise module in which it is included.
         ///
+        /// This noise module must not be evaluated from several threads at
+        /// once; use noise::module::ThreadCache for that purpose.
+        ///
         /// This noise module requires one source module.
         class Cache : public ModuleBase
         {
@@ -73,10 +80,13 @@ namespace noise
 
             virtual double getValue(double x, double y, double z) const;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const;
+
             virtual void setSourceModule(int index, const ModuleBase& sourceModule)
             {
                 ModuleBase::setSourceModule(index, sourceModule);
                 m_isCached = false;
+                m_batchCount = 0;
             }
 
         protected:
@@ -95,6 +105,22 @@ namespace noise
 
             /// @a z coordinate of the cached input value.
             mutable double m_zCache;
+
+            /// Number of input values in the cached batch, or 0 if no batch is
+            /// cached.
+            mutable size_t m_batchCount;
+
+            /// @a x coordinates of the cached batch of input values.
+            mutable double m_xBatchCache[MAX_BATCH_SIZE];
+
+            /// @a y coordinates of the cached batch of input values.
+            mutable double m_yBatchCache[MAX_BATCH_SIZE];
+
+            /// @a z coordinates of the cached batch of input values.
+            mutable double m_zBatchCache[MAX_BATCH_SIZE];
+
+            /// The cached output values of the cached batch of input values.
+            mutable double m_batchCachedValues[MAX_BATCH_SIZE];
         };
 
         /// @}
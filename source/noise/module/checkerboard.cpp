@@ -36,3 +36,11 @@ double Checkerboard::getValue(double x, double y, double z) const
     int iz = (int)(floor(MakeInt32Range(z)));
     return (ix & 1 ^ iy & 1 ^ iz & 1) ? -1.0 : 1.0;
 }
+
+void Checkerboard::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = Checkerboard::getValue(xs[i], ys[i], zs[i]);
+    }
+}
@@ -57,3 +57,21 @@ void Clamp::SetBounds(double lowerBound, double upperBound)
     m_lowerBound = lowerBound;
     m_upperBound = upperBound;
 }
+
+void Clamp::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    assert(m_pSourceModule[0] != NULL);
+
+    m_pSourceModule[0]->getValues(xs, ys, zs, out, count);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (out[i] < m_lowerBound)
+        {
+            out[i] = m_lowerBound;
+        }
+        else if (out[i] > m_upperBound)
+        {
+            out[i] = m_upperBound;
+        }
+    }
+}
@@ -105,6 +105,8 @@ namespace noise
 
             virtual double getValue(double x, double y, double z) const;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const;
+
             /// Sets the lower and upper bounds of the clamping range.
             ///
             /// @param lowerBound The lower bound.
@@ -50,3 +50,11 @@ void Const::setConstValue(double constValue)
 {
     m_constValue = constValue;
 }
+
+void Const::getValues(const double*, const double*, const double*, double* out, size_t count) const
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = m_constValue;
+    }
+}
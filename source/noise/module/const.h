@@ -73,6 +73,8 @@ namespace noise
 
             virtual double getValue(double x, double y, double z) const override;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const override;
+
             /// Sets the constant output value for this noise module.
             ///
             /// @param constValue The constant output value for this noise module.
@@ -22,7 +22,6 @@
 
 #include "curve.h"
 
-#include "../interp.h"
 #include "../misc.h"
 
 using namespace noise::module;
@@ -46,6 +45,7 @@ void Curve::AddControlPoint(double inputValue, double outputValue)
     // input value.
     int insertionPos = FindInsertionPos(inputValue);
     InsertAtPos(insertionPos, inputValue, outputValue);
+    UpdateSegments();
 }
 
 void Curve::ClearAllControlPoints()
@@ -53,6 +53,7 @@ void Curve::ClearAllControlPoints()
     delete[] m_pControlPoints;
     m_pControlPoints = NULL;
     m_controlPointCount = 0;
+    UpdateSegments();
 }
 
 int Curve::FindInsertionPos(double inputValue)
@@ -81,48 +82,45 @@ double Curve::getValue(double x, double y, double z) const
     assert(m_pSourceModule[0] != NULL);
     assert(m_controlPointCount >= 4);
 
-    // Get the output value from the source module.
-    double sourceModuleValue = m_pSourceModule[0]->getValue(x, y, z);
+    return MapValue(m_pSourceModule[0]->getValue(x, y, z));
+}
 
-    // Find the first element in the control point array that has an input value
-    // larger than the output value from the source module.
-    int indexPos;
-    for (indexPos = 0; indexPos < m_controlPointCount; indexPos++)
+void Curve::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    assert(m_pSourceModule[0] != NULL);
+    assert(m_controlPointCount >= 4);
+
+    m_pSourceModule[0]->getValues(xs, ys, zs, out, count);
+    for (size_t i = 0; i < count; i++)
     {
-        if (sourceModuleValue < m_pControlPoints[indexPos].inputValue)
-        {
-            break;
-        }
+        out[i] = MapValue(out[i]);
     }
+}
 
-    // Find the four nearest control points so that we can perform cubic
-    // interpolation.
-    int index0 = ClampValue(indexPos - 2, 0, m_controlPointCount - 1);
-    int index1 = ClampValue(indexPos - 1, 0, m_controlPointCount - 1);
-    int index2 = ClampValue(indexPos, 0, m_controlPointCount - 1);
-    int index3 = ClampValue(indexPos + 1, 0, m_controlPointCount - 1);
+double Curve::MapValue(double sourceModuleValue) const
+{
+    // Find the first element in the control point array that has an input value
+    // larger than the output value from the source module.
+    int indexPos = m_inputTable.findUpperBound(sourceModuleValue);
 
     // If some control points are missing (which occurs if the value from the
     // source module is greater than the largest input value or less than the
     // smallest input value of the control point array), get the corresponding
     // output value of the nearest control point and exit now.
-    if (index1 == index2)
+    if (indexPos == 0)
     {
-        return m_pControlPoints[index1].outputValue;
+        return m_pControlPoints[0].outputValue;
+    }
+    if (indexPos == m_controlPointCount)
+    {
+        return m_pControlPoints[m_controlPointCount - 1].outputValue;
     }
 
-    // Compute the alpha value used for cubic interpolation.
-    double input0 = m_pControlPoints[index1].inputValue;
-    double input1 = m_pControlPoints[index2].inputValue;
-    double alpha = (sourceModuleValue - input0) / (input1 - input0);
-
-    // Now perform the cubic interpolation given the alpha value.
-    return CubicInterp(
-        m_pControlPoints[index0].outputValue,
-        m_pControlPoints[index1].outputValue,
-        m_pControlPoints[index2].outputValue,
-        m_pControlPoints[index3].outputValue,
-        alpha);
+    // Compute the alpha value used for cubic interpolation, then evaluate the
+    // cubic polynomial of the segment that contains the value.
+    const CurveSegment& segment = m_segments[indexPos - 1];
+    double alpha = (sourceModuleValue - segment.inputValue0) / segment.inputExtent;
+    return segment.p * alpha * alpha * alpha + segment.q * alpha * alpha + segment.r * alpha + segment.s;
 }
 
 void Curve::InsertAtPos(int insertionPos, double inputValue,
@@ -153,3 +151,30 @@ void Curve::InsertAtPos(int insertionPos, double inputValue,
     m_pControlPoints[insertionPos].inputValue = inputValue;
     m_pControlPoints[insertionPos].outputValue = outputValue;
 }
+
+void Curve::UpdateSegments()
+{
+    const double* pInputValues = m_controlPointCount > 0 ? &m_pControlPoints[0].inputValue : NULL;
+    m_inputTable.build(pInputValues, m_controlPointCount, sizeof(ControlPoint));
+
+    m_segments.clear();
+    for (int indexPos = 1; indexPos < m_controlPointCount; indexPos++)
+    {
+        // Find the four nearest control points of the segment; the
+        // coefficients are computed as in the CubicInterp() function, so that
+        // the curve is unchanged.
+        double n0 = m_pControlPoints[ClampValue(indexPos - 2, 0, m_controlPointCount - 1)].outputValue;
+        double n1 = m_pControlPoints[indexPos - 1].outputValue;
+        double n2 = m_pControlPoints[indexPos].outputValue;
+        double n3 = m_pControlPoints[ClampValue(indexPos + 1, 0, m_controlPointCount - 1)].outputValue;
+
+        CurveSegment segment;
+        segment.inputValue0 = m_pControlPoints[indexPos - 1].inputValue;
+        segment.inputExtent = m_pControlPoints[indexPos].inputValue - segment.inputValue0;
+        segment.p = (n3 - n2) - (n0 - n1);
+        segment.q = (n0 - n1) - segment.p;
+        segment.r = n2 - n0;
+        segment.s = n1;
+        m_segments.push_back(segment);
+    }
+}
@@ -23,8 +23,11 @@
 #ifndef NOISE_MODULE_CURVE_H
 #define NOISE_MODULE_CURVE_H
 
+#include "../intervaltable.h"
 #include "modulebase.h"
 
+#include <vector>
+
 namespace noise
 {
 
@@ -76,6 +79,12 @@ namespace noise
         /// value.  There is no limit to the number of control points that can be
         /// added to the curve.
         ///
+        /// Adding a control point precomputes the cubic polynomial between
+        /// each pair of adjacent control points, and a lookup table that finds
+        /// the pair that surrounds an output value from the source module in
+        /// constant time.  Mapping a value therefore costs about the same for
+        /// any number of control points.
+        ///
         /// This noise module requires one source module.
         class Curve : public ModuleBase
         {
@@ -130,7 +139,35 @@ namespace noise
 
             virtual double getValue(double x, double y, double z) const;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const;
+
         protected:
+            /// Coefficients of the cubic polynomial that maps the values
+            /// between two adjacent control points.
+            struct CurveSegment
+            {
+                /// The input value of the first control point.
+                double inputValue0;
+
+                /// The difference between the input values of the second and
+                /// the first control point.
+                double inputExtent;
+
+                /// The coefficients of the polynomial, from the cubic term to
+                /// the constant term.
+                double p, q, r, s;
+            };
+
+            /// Maps an output value from the source module onto the curve.
+            ///
+            /// @param sourceModuleValue The output value from the source module.
+            ///
+            /// @returns The mapped value.
+            ///
+            /// @pre The number of control points must be greater than or equal
+            /// to 4.
+            double MapValue(double sourceModuleValue) const;
+
             /// Determines the array index in which to insert the control point
             /// into the internal control point array.
             ///
@@ -168,11 +205,24 @@ namespace noise
             void InsertAtPos(int insertionPos, double inputValue,
                              double outputValue);
 
+            /// Recomputes the curve segments and the input value lookup table
+            /// from the control points.
+            ///
+            /// This method must be called each time the control points change.
+            void UpdateSegments();
+
             /// Number of control points on the curve.
             int m_controlPointCount;
 
             /// Array that stores the control points.
             ControlPoint* m_pControlPoints;
+
+            /// Lookup table of the input values of the control points.
+            IntervalTable m_inputTable;
+
+            /// Curve segments; the segment at index @a i lies between the
+            /// control points at indices @a i and <i>i + 1</i>.
+            std::vector<CurveSegment> m_segments;
         };
 
         /// @}
@@ -22,6 +22,8 @@
 
 #include "displace.h"
 
+#include "../misc.h"
+
 using namespace noise::module;
 
 Displace::Displace()
@@ -46,3 +48,29 @@ double Displace::getValue(double x, double y, double z) const
     // the original input value.
     return m_pSourceModule[0]->getValue(xDisplace, yDisplace, zDisplace);
 }
+
+void Displace::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    assert(m_pSourceModule[0] != NULL);
+    assert(m_pSourceModule[1] != NULL);
+    assert(m_pSourceModule[2] != NULL);
+    assert(m_pSourceModule[3] != NULL);
+
+    double xDisplace[MAX_BATCH_SIZE];
+    double yDisplace[MAX_BATCH_SIZE];
+    double zDisplace[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        m_pSourceModule[1]->getValues(xs + i, ys + i, zs + i, xDisplace, n);
+        m_pSourceModule[2]->getValues(xs + i, ys + i, zs + i, yDisplace, n);
+        m_pSourceModule[3]->getValues(xs + i, ys + i, zs + i, zDisplace, n);
+        for (size_t j = 0; j < n; j++)
+        {
+            xDisplace[j] = xs[i + j] + xDisplace[j];
+            yDisplace[j] = ys[i + j] + yDisplace[j];
+            zDisplace[j] = zs[i + j] + zDisplace[j];
+        }
+        m_pSourceModule[0]->getValues(xDisplace, yDisplace, zDisplace, out + i, n);
+    }
+}
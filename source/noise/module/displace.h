@@ -75,6 +75,8 @@ namespace noise
 
             virtual double getValue(double x, double y, double z) const;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const;
+
             /// Returns the @a x displacement module.
             ///
             /// @returns A reference to the @a x displacement module.
@@ -37,3 +37,14 @@ double Exponent::getValue(double x, double y, double z) const
     double value = m_pSourceModule[0]->getValue(x, y, z);
     return (pow(fabs((value + 1.0) / 2.0), m_exponent) * 2.0 - 1.0);
 }
+
+void Exponent::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    assert(m_pSourceModule[0] != NULL);
+
+    m_pSourceModule[0]->getValues(xs, ys, zs, out, count);
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = (pow(fabs((out[i] + 1.0) / 2.0), m_exponent) * 2.0 - 1.0);
+    }
+}
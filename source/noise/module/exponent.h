@@ -79,6 +79,8 @@ namespace noise
 
             virtual double getValue(double x, double y, double z) const;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const;
+
             /// Sets the exponent value to apply to the output value from the
             /// source module.
             ///
@@ -53,3 +53,11 @@ double Gradient::getValue(double x, double y, double z) const
 
     return (dp - 0.5) * 2.0;  // normalize it back to [-1, 1]
 }
+
+void Gradient::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = Gradient::getValue(xs[i], ys[i], zs[i]);
+    }
+}
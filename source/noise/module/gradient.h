@@ -70,6 +70,8 @@ namespace noise
 
             virtual double getValue(double x, double y, double z) const override;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const override;
+
         protected:
             double m_gx1, m_gy1, m_gz1;
             double m_x, m_y, m_z;
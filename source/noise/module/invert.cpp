@@ -35,3 +35,14 @@ double Invert::getValue(double x, double y, double z) const
 
     return -(m_pSourceModule[0]->getValue(x, y, z));
 }
+
+void Invert::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    assert(m_pSourceModule[0] != NULL);
+
+    m_pSourceModule[0]->getValues(xs, ys, zs, out, count);
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = -out[i];
+    }
+}
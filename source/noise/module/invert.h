@@ -53,6 +53,8 @@ namespace noise
             Invert();
 
             virtual double getValue(double x, double y, double z) const;
+
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const;
         };
 
         /// @}
@@ -54,6 +54,8 @@ namespace noise
             Max();
 
             virtual double getValue(double x, double y, double z) const;
+
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const;
         };
 
         /// @}
@@ -40,3 +40,21 @@ double Min::getValue(double x, double y, double z) const
     double v1 = m_pSourceModule[1]->getValue(x, y, z);
     return GetMin(v0, v1);
 }
+
+void Min::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    assert(m_pSourceModule[0] != NULL);
+    assert(m_pSourceModule[1] != NULL);
+
+    double v1[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        m_pSourceModule[0]->getValues(xs + i, ys + i, zs + i, out + i, n);
+        m_pSourceModule[1]->getValues(xs + i, ys + i, zs + i, v1, n);
+        for (size_t j = 0; j < n; j++)
+        {
+            out[i + j] = GetMin(out[i + j], v1[j]);
+        }
+    }
+}
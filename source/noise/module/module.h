@@ -25,6 +25,7 @@
 
 #include "abs.h"
 #include "add.h"
+#include "affinedomain.h"
 #include "billow.h"
 #include "blend.h"
 #include "cache.h"
@@ -42,6 +43,7 @@
 #include "multiply.h"
 #include "perlin.h"
 #include "power.h"
+#include "program.h"
 #include "ridgedmulti.h"
 #include "rotatedomain.h"
 #include "scalebias.h"
@@ -49,6 +51,7 @@
 #include "select.h"
 #include "spheres.h"
 #include "terrace.h"
+#include "threadcache.h"
 #include "translatedomain.h"
 #include "turbulence.h"
 #include "voronoi.h"
@@ -22,6 +22,8 @@
 
 #include "modulebase.h"
 
+#include "../misc.h"
+
 using namespace noise::module;
 
 ModuleBase::ModuleBase(int sourceModuleCount)
@@ -68,6 +70,37 @@ const ModuleBase& ModuleBase::getSourceModule(int index) const
     return *(m_pSourceModule[index]);
 }
 
+void ModuleBase::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = getValue(xs[i], ys[i], zs[i]);
+    }
+}
+
+void ModuleBase::getFloatValues(const float* xs, const float* ys, const float* zs, float* out, size_t count) const
+{
+    double xBuffer[MAX_BATCH_SIZE];
+    double yBuffer[MAX_BATCH_SIZE];
+    double zBuffer[MAX_BATCH_SIZE];
+    double outBuffer[MAX_BATCH_SIZE];
+    for (size_t start = 0; start < count; start += MAX_BATCH_SIZE)
+    {
+        size_t chunk = GetMin(count - start, MAX_BATCH_SIZE);
+        for (size_t i = 0; i < chunk; i++)
+        {
+            xBuffer[i] = xs[start + i];
+            yBuffer[i] = ys[start + i];
+            zBuffer[i] = zs[start + i];
+        }
+        getValues(xBuffer, yBuffer, zBuffer, outBuffer, chunk);
+        for (size_t i = 0; i < chunk; i++)
+        {
+            out[start + i] = (float)outBuffer[i];
+        }
+    }
+}
+
 const ModuleBase& ModuleBase::operator=(const ModuleBase& m)
 {
     return *this;
@@ -22,6 +22,8 @@
 
 #include "multiply.h"
 
+#include "../misc.h"
+
 using namespace noise::module;
 
 Multiply::Multiply()
@@ -36,3 +38,21 @@ double Multiply::getValue(double x, double y, double z) const
 
     return m_pSourceModule[0]->getValue(x, y, z) * m_pSourceModule[1]->getValue(x, y, z);
 }
+
+void Multiply::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    assert(m_pSourceModule[0] != NULL);
+    assert(m_pSourceModule[1] != NULL);
+
+    double v1[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        m_pSourceModule[0]->getValues(xs + i, ys + i, zs + i, out + i, n);
+        m_pSourceModule[1]->getValues(xs + i, ys + i, zs + i, v1, n);
+        for (size_t j = 0; j < n; j++)
+        {
+            out[i + j] *= v1[j];
+        }
+    }
+}
@@ -22,6 +22,8 @@
 
 #include "perlin.h"
 
+#include "../misc.h"
+
 using namespace noise::module;
 
 Perlin::Perlin()
@@ -32,6 +34,7 @@ Perlin::Perlin()
     , m_persistence(DEFAULT_PERLIN_PERSISTENCE)
     , m_seed(DEFAULT_PERLIN_SEED)
 {
+    calcOctaveTables();
 }
 
 Perlin::Perlin(int octaveCount, double frequency)
@@ -42,6 +45,7 @@ Perlin::Perlin(int octaveCount, double frequency)
     , m_persistence(DEFAULT_PERLIN_PERSISTENCE)
     , m_seed(DEFAULT_PERLIN_SEED)
 {
+    calcOctaveTables();
 }
 
 Perlin::Perlin(int octaveCount, double frequency, double persistence)
@@ -52,6 +56,7 @@ Perlin::Perlin(int octaveCount, double frequency, double persistence)
     , m_persistence(persistence)
     , m_seed(DEFAULT_PERLIN_SEED)
 {
+    calcOctaveTables();
 }
 
 Perlin::Perlin(int octaveCount, double frequency, double persistence, double lacunarity)
@@ -62,6 +67,7 @@ Perlin::Perlin(int octaveCount, double frequency, double persistence, double lac
     , m_persistence(persistence)
     , m_seed(DEFAULT_PERLIN_SEED)
 {
+    calcOctaveTables();
 }
 
 void Perlin::setOctaveCount(int octaveCount)
@@ -88,6 +94,7 @@ double Perlin::getFrequency() const
 void Perlin::setPersistence(double persistence)
 {
     m_persistence = persistence;
+    calcOctaveTables();
 }
 
 double Perlin::getPersistence() const
@@ -118,6 +125,7 @@ noise::NoiseQuality Perlin::getNoiseQuality() const
 void Perlin::setSeed(int seed)
 {
     m_seed = seed;
+    calcOctaveTables();
 }
 
 int Perlin::getSeed() const
@@ -125,13 +133,36 @@ int Perlin::getSeed() const
     return m_seed;
 }
 
+void Perlin::calcOctaveTables()
+{
+    // Accumulate the persistence as a running product, exactly as an octave
+    // loop would, so that the output values are not affected by rounding.
+    double curPersistence = 1.0;
+    for (int curOctave = 0; curOctave < PERLIN_MAX_OCTAVE; curOctave++)
+    {
+        m_octavePersistence[curOctave] = curPersistence;
+        m_octaveSeed[curOctave] = (m_seed + curOctave) & 0xffffffff;
+        curPersistence *= m_persistence;
+    }
+}
+
 double Perlin::getValue(double x, double y, double z) const
+{
+    switch (m_noiseQuality)
+    {
+    case QUALITY_FAST:
+        return getValueQ<QUALITY_FAST>(x, y, z);
+    case QUALITY_BEST:
+        return getValueQ<QUALITY_BEST>(x, y, z);
+    default:
+        return getValueQ<QUALITY_STD>(x, y, z);
+    }
+}
+
+template <noise::NoiseQuality noiseQuality>
+double Perlin::getValueQ(double x, double y, double z) const
 {
     double value = 0.0;
-    double signal = 0.0;
-    double curPersistence = 1.0;
-    double nx, ny, nz;
-    int seed;
 
     x *= m_frequency;
     y *= m_frequency;
@@ -139,25 +170,172 @@ double Perlin::getValue(double x, double y, double z) const
 
     for (int curOctave = 0; curOctave < m_octaveCount; curOctave++)
     {
-
         // Make sure that these floating-point values have the same range as a 32-
         // bit integer so that we can pass them to the coherent-noise functions.
-        nx = MakeInt32Range(x);
-        ny = MakeInt32Range(y);
-        nz = MakeInt32Range(z);
+        double nx = MakeInt32Range(x);
+        double ny = MakeInt32Range(y);
+        double nz = MakeInt32Range(z);
 
         // Get the coherent-noise value from the input value and add it to the
         // final result.
-        seed = (m_seed + curOctave) & 0xffffffff;
-        signal = GradientCoherentNoise3D(nx, ny, nz, seed, m_noiseQuality);
-        value += signal * curPersistence;
+        double signal = GradientCoherentNoise3D<noiseQuality>(nx, ny, nz, m_octaveSeed[curOctave]);
+        value += signal * m_octavePersistence[curOctave];
 
         // Prepare the next octave.
         x *= m_lacunarity;
         y *= m_lacunarity;
         z *= m_lacunarity;
-        curPersistence *= m_persistence;
     }
 
     return value;
 }
+
+double Perlin::getValueAndGradient(double x, double y, double z, double& dx, double& dy, double& dz) const
+{
+    switch (m_noiseQuality)
+    {
+    case QUALITY_FAST:
+        return getValueAndGradientQ<QUALITY_FAST>(x, y, z, dx, dy, dz);
+    case QUALITY_BEST:
+        return getValueAndGradientQ<QUALITY_BEST>(x, y, z, dx, dy, dz);
+    default:
+        return getValueAndGradientQ<QUALITY_STD>(x, y, z, dx, dy, dz);
+    }
+}
+
+template <noise::NoiseQuality noiseQuality>
+double Perlin::getValueAndGradientQ(double x, double y, double z, double& dx, double& dy, double& dz) const
+{
+    double value = 0.0;
+    dx = 0.0;
+    dy = 0.0;
+    dz = 0.0;
+
+    // Each octave samples the coherent noise at the input value scaled by
+    // the frequency of the octave, so the chain rule scales the gradient of
+    // the coherent noise by the same frequency.
+    double curFrequency = m_frequency;
+    x *= m_frequency;
+    y *= m_frequency;
+    z *= m_frequency;
+
+    for (int curOctave = 0; curOctave < m_octaveCount; curOctave++)
+    {
+        double nx = MakeInt32Range(x);
+        double ny = MakeInt32Range(y);
+        double nz = MakeInt32Range(z);
+
+        double signalDx, signalDy, signalDz;
+        double signal = GradientCoherentNoise3DAndGradient<noiseQuality>(nx, ny, nz, signalDx, signalDy, signalDz, m_octaveSeed[curOctave]);
+        value += signal * m_octavePersistence[curOctave];
+
+        double scale = m_octavePersistence[curOctave] * curFrequency;
+        dx += signalDx * scale;
+        dy += signalDy * scale;
+        dz += signalDz * scale;
+
+        // Prepare the next octave.
+        x *= m_lacunarity;
+        y *= m_lacunarity;
+        z *= m_lacunarity;
+        curFrequency *= m_lacunarity;
+    }
+
+    return value;
+}
+
+void Perlin::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    double nx[MAX_BATCH_SIZE];
+    double ny[MAX_BATCH_SIZE];
+    double nz[MAX_BATCH_SIZE];
+    double mx[MAX_BATCH_SIZE];
+    double my[MAX_BATCH_SIZE];
+    double mz[MAX_BATCH_SIZE];
+    double signals[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        double* value = out + i;
+        for (size_t j = 0; j < n; j++)
+        {
+            nx[j] = xs[i + j] * m_frequency;
+            ny[j] = ys[i + j] * m_frequency;
+            nz[j] = zs[i + j] * m_frequency;
+            value[j] = 0.0;
+        }
+
+        // Evaluate one octave for the whole batch at a time, so that the
+        // coherent-noise values of each octave are generated in one call.
+        for (int curOctave = 0; curOctave < m_octaveCount; curOctave++)
+        {
+            double curPersistence = m_octavePersistence[curOctave];
+            for (size_t j = 0; j < n; j++)
+            {
+                mx[j] = MakeInt32Range(nx[j]);
+                my[j] = MakeInt32Range(ny[j]);
+                mz[j] = MakeInt32Range(nz[j]);
+            }
+            GradientCoherentNoise3D(mx, my, mz, signals, n, m_octaveSeed[curOctave], m_noiseQuality);
+
+            for (size_t j = 0; j < n; j++)
+            {
+                double signal = signals[j];
+                value[j] += signal * curPersistence;
+
+                // Prepare the next octave.
+                nx[j] *= m_lacunarity;
+                ny[j] *= m_lacunarity;
+                nz[j] *= m_lacunarity;
+            }
+        }
+    }
+}
+
+void Perlin::getFloatValues(const float* xs, const float* ys, const float* zs, float* out, size_t count) const
+{
+    float nx[MAX_BATCH_SIZE];
+    float ny[MAX_BATCH_SIZE];
+    float nz[MAX_BATCH_SIZE];
+    float mx[MAX_BATCH_SIZE];
+    float my[MAX_BATCH_SIZE];
+    float mz[MAX_BATCH_SIZE];
+    float signals[MAX_BATCH_SIZE];
+    const float frequency = (float)m_frequency;
+    const float lacunarity = (float)m_lacunarity;
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        float* value = out + i;
+        for (size_t j = 0; j < n; j++)
+        {
+            nx[j] = xs[i + j] * frequency;
+            ny[j] = ys[i + j] * frequency;
+            nz[j] = zs[i + j] * frequency;
+            value[j] = 0.0f;
+        }
+
+        // Same octave loop as getValues(), in single precision.
+        for (int curOctave = 0; curOctave < m_octaveCount; curOctave++)
+        {
+            float curPersistence = (float)m_octavePersistence[curOctave];
+            for (size_t j = 0; j < n; j++)
+            {
+                mx[j] = MakeInt32Range(nx[j]);
+                my[j] = MakeInt32Range(ny[j]);
+                mz[j] = MakeInt32Range(nz[j]);
+            }
+            GradientCoherentNoise3D(mx, my, mz, signals, n, m_octaveSeed[curOctave], m_noiseQuality);
+
+            for (size_t j = 0; j < n; j++)
+            {
+                value[j] += signals[j] * curPersistence;
+
+                // Prepare the next octave.
+                nx[j] *= lacunarity;
+                ny[j] *= lacunarity;
+                nz[j] *= lacunarity;
+            }
+        }
+    }
+}
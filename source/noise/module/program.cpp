@@ -0,0 +1,1020 @@
+// program.cpp
+//
+// Copyright (C) 2019, 2020 zjhlogo
+//
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or (at
+// your option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License (COPYING.txt) for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+// The developer's email is zjhlogo@gmzigail.com (for great email, take
+// off every 'zig'.)
+//
+
+#include "program.h"
+#include "abs.h"
+#include "add.h"
+#include "affinedomain.h"
+#include "blend.h"
+#include "cache.h"
+#include "clamp.h"
+#include "const.h"
+#include "displace.h"
+#include "exponent.h"
+#include "invert.h"
+#include "max.h"
+#include "min.h"
+#include "multiply.h"
+#include "power.h"
+#include "rotatedomain.h"
+#include "scalebias.h"
+#include "scaledomain.h"
+#include "select.h"
+#include "threadcache.h"
+#include "translatedomain.h"
+#include "turbulence.h"
+
+#include "../interp.h"
+#include "../misc.h"
+
+#include <deque>
+#include <map>
+#include <stdint.h>
+#include <string.h>
+#include <tuple>
+
+using namespace noise::module;
+
+namespace
+{
+
+    // Registers 0, 1 and 2 hold the x, y and z coordinates of the input
+    // values.  They point into the arrays passed to getValues() and have no
+    // storage of their own.
+    const int X_REGISTER = 0;
+    const int Y_REGISTER = 1;
+    const int Z_REGISTER = 2;
+    const int INPUT_REGISTER_COUNT = 3;
+
+} // namespace
+
+// Translates a noise module graph into instructions.
+//
+// The compiler first emits instructions in static single assignment form:
+// each instruction writes a new virtual register.  finish() then removes the
+// instructions whose output is never used, and maps the virtual registers
+// onto as few registers as possible by reusing a register once its last
+// reader has run.
+class Program::Compiler
+{
+public:
+    Compiler()
+        : m_statistics()
+    {
+        for (int i = 0; i < INPUT_REGISTER_COUNT; i++)
+        {
+            m_registers.push_back(RegisterInfo());
+        }
+    }
+
+    // Returns the virtual register holding the output values of the module
+    // at the input values whose coordinates are held by the registers in
+    // coords.
+    //
+    // A module that is used by several modules at the same input values is
+    // only compiled once; the other uses share its output register.
+    int compileModule(const ModuleBase& sourceModule, const int coords[3])
+    {
+        NodeKey key(&sourceModule, coords[0], coords[1], coords[2]);
+        std::map<NodeKey, Node>::iterator it = m_nodes.find(key);
+        if (it != m_nodes.end())
+        {
+            Node& node = it->second;
+            node.referenceCount++;
+            if (node.referenceCount == 2)
+            {
+                m_statistics.sharedModuleCount++;
+            }
+            m_statistics.eliminatedEvaluationCount += node.evaluationCount;
+            return node.reg;
+        }
+
+        size_t evaluationCount = m_statistics.moduleCount + m_statistics.eliminatedEvaluationCount;
+        int reg = translateModule(sourceModule, coords);
+        m_statistics.moduleCount++;
+
+        // The number of evaluations that a recursive evaluation of the graph
+        // performs for each use of this module: the module itself and its
+        // sources.  A cache module only evaluates its source once.
+        Node node;
+        node.reg = reg;
+        node.referenceCount = 1;
+        node.evaluationCount = m_statistics.moduleCount + m_statistics.eliminatedEvaluationCount - evaluationCount;
+        if (dynamic_cast<const Cache*>(&sourceModule) || dynamic_cast<const ThreadCache*>(&sourceModule))
+        {
+            node.evaluationCount = 1;
+        }
+        m_nodes[key] = node;
+        return reg;
+    }
+
+    // Translates a module into instructions.
+    int translateModule(const ModuleBase& sourceModule, const int coords[3])
+    {
+        if (const Const* pConst = dynamic_cast<const Const*>(&sourceModule))
+        {
+            return makeConstant(pConst->getConstValue());
+        }
+
+        if (dynamic_cast<const Cache*>(&sourceModule) || dynamic_cast<const ThreadCache*>(&sourceModule))
+        {
+            // Sharing the output registers already caches the output values.
+            return compileModule(sourceModule.getSourceModule(0), coords);
+        }
+
+        if (dynamic_cast<const Add*>(&sourceModule))
+        {
+            return compileBinary(OP_ADD, sourceModule, coords);
+        }
+        if (dynamic_cast<const Multiply*>(&sourceModule))
+        {
+            return compileBinary(OP_MULTIPLY, sourceModule, coords);
+        }
+        if (dynamic_cast<const Min*>(&sourceModule))
+        {
+            return compileBinary(OP_MIN, sourceModule, coords);
+        }
+        if (dynamic_cast<const Max*>(&sourceModule))
+        {
+            return compileBinary(OP_MAX, sourceModule, coords);
+        }
+        if (dynamic_cast<const Power*>(&sourceModule))
+        {
+            return compileBinary(OP_POWER, sourceModule, coords);
+        }
+
+        if (dynamic_cast<const Abs*>(&sourceModule))
+        {
+            return emit(OP_ABS, compileModule(sourceModule.getSourceModule(0), coords));
+        }
+
+        if (dynamic_cast<const Invert*>(&sourceModule))
+        {
+            return emitNegate(compileModule(sourceModule.getSourceModule(0), coords));
+        }
+
+        if (const Clamp* pClamp = dynamic_cast<const Clamp*>(&sourceModule))
+        {
+            Instruction instruction = makeInstruction(OP_CLAMP);
+            instruction.src[0] = compileModule(sourceModule.getSourceModule(0), coords);
+            instruction.imm[0] = pClamp->GetLowerBound();
+            instruction.imm[1] = pClamp->GetUpperBound();
+            return emit(instruction);
+        }
+
+        if (const Exponent* pExponent = dynamic_cast<const Exponent*>(&sourceModule))
+        {
+            Instruction instruction = makeInstruction(OP_EXPONENT);
+            instruction.src[0] = compileModule(sourceModule.getSourceModule(0), coords);
+            instruction.imm[0] = pExponent->GetExponent();
+            return emit(instruction);
+        }
+
+        if (dynamic_cast<const Blend*>(&sourceModule))
+        {
+            Instruction instruction = makeInstruction(OP_BLEND);
+            for (int i = 0; i < 3; i++)
+            {
+                instruction.src[i] = compileModule(sourceModule.getSourceModule(i), coords);
+            }
+            return emit(instruction);
+        }
+
+        if (const ScaleBias* pScaleBias = dynamic_cast<const ScaleBias*>(&sourceModule))
+        {
+            int source = compileParameter(pScaleBias->getSource(), coords);
+            int scale = compileParameter(pScaleBias->getScale(), coords);
+            int bias = compileParameter(pScaleBias->getBias(), coords);
+            return emitScaleBias(source, scale, bias);
+        }
+
+        if (const Select* pSelect = dynamic_cast<const Select*>(&sourceModule))
+        {
+            Instruction instruction = makeInstruction(OP_SELECT);
+            instruction.src[0] = compileParameter(pSelect->getLowModule(), coords);
+            instruction.src[1] = compileParameter(pSelect->getHighModule(), coords);
+            instruction.src[2] = compileParameter(pSelect->getControlModule(), coords);
+            instruction.src[3] = compileParameter(pSelect->getThreshold(), coords);
+            instruction.src[4] = compileParameter(pSelect->getEdgeFalloff(), coords);
+            return emit(instruction);
+        }
+
+        if (const TranslateDomain* pTranslate = dynamic_cast<const TranslateDomain*>(&sourceModule))
+        {
+            int newCoords[3];
+            newCoords[0] = emit(OP_ADD, coords[0], compileParameter(pTranslate->GetXTranslation(), coords));
+            newCoords[1] = emit(OP_ADD, coords[1], compileParameter(pTranslate->GetYTranslation(), coords));
+            newCoords[2] = emit(OP_ADD, coords[2], compileParameter(pTranslate->GetZTranslation(), coords));
+            return compileParameter(pTranslate->getSource(), newCoords);
+        }
+
+        if (const ScaleDomain* pScale = dynamic_cast<const ScaleDomain*>(&sourceModule))
+        {
+            int newCoords[3];
+            newCoords[0] = emit(OP_MULTIPLY, coords[0], compileParameter(pScale->GetXScale(), coords));
+            newCoords[1] = emit(OP_MULTIPLY, coords[1], compileParameter(pScale->GetYScale(), coords));
+            newCoords[2] = emit(OP_MULTIPLY, coords[2], compileParameter(pScale->GetZScale(), coords));
+            return compileParameter(pScale->getSource(), newCoords);
+        }
+
+        if (const RotateDomain* pRotate = dynamic_cast<const RotateDomain*>(&sourceModule))
+        {
+            double matrix[9];
+            pRotate->getMatrix(matrix);
+            int newCoords[3];
+            for (int row = 0; row < 3; row++)
+            {
+                Instruction instruction = makeInstruction(OP_DOT3);
+                for (int i = 0; i < 3; i++)
+                {
+                    instruction.src[i] = coords[i];
+                    instruction.imm[i] = matrix[row * 3 + i];
+                }
+                newCoords[row] = emit(instruction);
+            }
+            return compileModule(sourceModule.getSourceModule(0), newCoords);
+        }
+
+        if (const AffineDomain* pAffine = dynamic_cast<const AffineDomain*>(&sourceModule))
+        {
+            double matrix[12];
+            pAffine->getMatrix(matrix);
+            int newCoords[3];
+            for (int row = 0; row < 3; row++)
+            {
+                Instruction instruction = makeInstruction(OP_DOT3);
+                for (int i = 0; i < 3; i++)
+                {
+                    instruction.src[i] = coords[i];
+                    instruction.imm[i] = matrix[row * 4 + i];
+                }
+                newCoords[row] = emit(OP_ADD, emit(instruction), makeConstant(matrix[row * 4 + 3]));
+            }
+            return compileModule(sourceModule.getSourceModule(0), newCoords);
+        }
+
+        if (dynamic_cast<const Displace*>(&sourceModule))
+        {
+            int newCoords[3];
+            for (int i = 0; i < 3; i++)
+            {
+                newCoords[i] = emit(OP_ADD, coords[i], compileModule(sourceModule.getSourceModule(i + 1), coords));
+            }
+            return compileModule(sourceModule.getSourceModule(0), newCoords);
+        }
+
+        if (const Turbulence* pTurbulence = dynamic_cast<const Turbulence*>(&sourceModule))
+        {
+            // The same offsets as in Turbulence::getValue().
+            static const double offsets[3][3] = {
+                {12414.0 / 65536.0, 65124.0 / 65536.0, 31337.0 / 65536.0},
+                {26519.0 / 65536.0, 18128.0 / 65536.0, 60493.0 / 65536.0},
+                {53820.0 / 65536.0, 11213.0 / 65536.0, 44845.0 / 65536.0}};
+            const Perlin* distortModules[3] = {&pTurbulence->getXDistortModule(), &pTurbulence->getYDistortModule(), &pTurbulence->getZDistortModule()};
+            int power = makeConstant(pTurbulence->getPower());
+            int newCoords[3];
+            for (int axis = 0; axis < 3; axis++)
+            {
+                int offsetCoords[3];
+                for (int i = 0; i < 3; i++)
+                {
+                    offsetCoords[i] = emit(OP_ADD, coords[i], makeConstant(offsets[axis][i]));
+                }
+                int distort = emitCall(*distortModules[axis], offsetCoords);
+                newCoords[axis] = emitScaleBias(distort, power, coords[axis]);
+            }
+            return compileParameter(pTurbulence->getSource(), newCoords);
+        }
+
+        return emitCall(sourceModule, coords);
+    }
+
+    // Returns the virtual register holding the values of the parameter at the
+    // input values whose coordinates are held by the registers in coords.
+    int compileParameter(const noise::ScalarParameter& parameter, const int coords[3])
+    {
+        if (parameter.isConstant())
+        {
+            return makeConstant(parameter.getConstValue());
+        }
+        return compileModule(*parameter.getSourceModule(), coords);
+    }
+
+    // Removes the unused instructions, allocates the registers, and stores
+    // the result into the program.
+    void finish(int outputRegister, Program& program)
+    {
+        // Keep the instructions whose output is used, walking backwards from
+        // the output register.
+        std::vector<bool> isLive(m_registers.size(), false);
+        isLive[outputRegister] = true;
+        std::vector<bool> isKept(m_code.size(), false);
+        for (size_t i = m_code.size(); i-- > 0;)
+        {
+            const Instruction& instruction = m_code[i];
+            if (!isLive[instruction.dst])
+            {
+                continue;
+            }
+            isKept[i] = true;
+            for (int j = 0; j < GetSourceCount(instruction.opcode); j++)
+            {
+                isLive[instruction.src[j]] = true;
+            }
+        }
+
+        std::vector<Instruction> code;
+        for (size_t i = 0; i < m_code.size(); i++)
+        {
+            if (isKept[i])
+            {
+                code.push_back(m_code[i]);
+            }
+        }
+
+        // Find the last instruction that reads each virtual register.  The
+        // output register is read after the last instruction.
+        std::vector<size_t> lastUse(m_registers.size(), 0);
+        for (size_t i = 0; i < code.size(); i++)
+        {
+            for (int j = 0; j < GetSourceCount(code[i].opcode); j++)
+            {
+                lastUse[code[i].src[j]] = i;
+            }
+        }
+        lastUse[outputRegister] = code.size();
+
+        // The input registers and the constant registers keep their register
+        // for the whole program; every other register is released after its
+        // last use.
+        std::vector<int> mapping(m_registers.size(), -1);
+        for (int i = 0; i < INPUT_REGISTER_COUNT; i++)
+        {
+            mapping[i] = i;
+        }
+        int registerCount = INPUT_REGISTER_COUNT;
+        program.m_constants.clear();
+        for (size_t i = INPUT_REGISTER_COUNT; i < m_registers.size(); i++)
+        {
+            if (isLive[i] && m_registers[i].isConstant)
+            {
+                mapping[i] = registerCount++;
+                program.m_constants.push_back(std::make_pair(mapping[i], m_registers[i].value));
+            }
+        }
+
+        std::vector<int> freeRegisters;
+        for (size_t i = 0; i < code.size(); i++)
+        {
+            Instruction& instruction = code[i];
+
+            // Allocate the output register before releasing the source
+            // registers, so that a module called by an OP_CALL instruction
+            // never writes into its own input values.
+            int dst = instruction.dst;
+            if (freeRegisters.empty())
+            {
+                mapping[dst] = registerCount++;
+            }
+            else
+            {
+                mapping[dst] = freeRegisters.back();
+                freeRegisters.pop_back();
+            }
+            instruction.dst = mapping[dst];
+
+            for (int j = 0; j < GetSourceCount(instruction.opcode); j++)
+            {
+                int src = instruction.src[j];
+                instruction.src[j] = mapping[src];
+                if (lastUse[src] == i && isTemporary(src))
+                {
+                    // Release the register only once if the instruction reads
+                    // it several times.
+                    lastUse[src] = code.size() + 1;
+                    freeRegisters.push_back(mapping[src]);
+                }
+            }
+        }
+
+        program.m_instructions = code;
+        program.m_registerCount = registerCount;
+        program.m_outputRegister = mapping[outputRegister];
+        program.m_statistics = m_statistics;
+    }
+
+private:
+    // Information about a virtual register.
+    struct RegisterInfo
+    {
+        // Determines if the register holds a constant.
+        bool isConstant = false;
+
+        // Value of a constant register.
+        double value = 0.0;
+
+        // Index of the instruction that writes the register, or -1.
+        int definition = -1;
+    };
+
+    // Identifies the output of a module at a set of input values.
+    typedef std::tuple<const ModuleBase*, int, int, int> NodeKey;
+
+    // A module compiled at a set of input values.
+    struct Node
+    {
+        // Virtual register holding the output values.
+        int reg;
+
+        // Number of uses of the module at these input values.
+        size_t referenceCount;
+
+        // Number of module evaluations that a use of the module costs in a
+        // recursive evaluation of the graph.
+        size_t evaluationCount;
+    };
+
+    // Identifies an instruction by its operation and operands.
+    typedef std::tuple<int, int, int, int, int, int, uint64_t, uint64_t, uint64_t, const ModuleBase*> InstructionKey;
+
+    // Returns the number of source registers read by an instruction.
+    static int GetSourceCount(Opcode opcode)
+    {
+        switch (opcode)
+        {
+        case OP_CALL:
+        case OP_SCALE_BIAS:
+        case OP_BLEND:
+        case OP_DOT3:
+            return 3;
+        case OP_ADD:
+        case OP_MULTIPLY:
+        case OP_MIN:
+        case OP_MAX:
+        case OP_POWER:
+            return 2;
+        case OP_ABS:
+        case OP_NEGATE:
+        case OP_CLAMP:
+        case OP_EXPONENT:
+            return 1;
+        case OP_SELECT:
+            return 5;
+        }
+        return 0;
+    }
+
+    static Instruction makeInstruction(Opcode opcode)
+    {
+        Instruction instruction;
+        instruction.opcode = opcode;
+        instruction.dst = -1;
+        for (int i = 0; i < MAX_INSTRUCTION_SOURCES; i++)
+        {
+            instruction.src[i] = -1;
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            instruction.imm[i] = 0.0;
+        }
+        instruction.pModule = nullptr;
+        return instruction;
+    }
+
+    bool isConstant(int reg) const
+    {
+        return m_registers[reg].isConstant;
+    }
+
+    bool isTemporary(int reg) const
+    {
+        return reg >= INPUT_REGISTER_COUNT && !m_registers[reg].isConstant;
+    }
+
+    // Returns the instruction that writes the virtual register, or NULL.
+    const Instruction* getDefinition(int reg) const
+    {
+        int definition = m_registers[reg].definition;
+        return definition >= 0 ? &m_code[definition] : nullptr;
+    }
+
+    int makeConstant(double value)
+    {
+        // Compare the bit patterns, so that 0.0 and -0.0 stay apart.
+        uint64_t key;
+        memcpy(&key, &value, sizeof(key));
+        std::map<uint64_t, int>::const_iterator it = m_constantRegisters.find(key);
+        if (it != m_constantRegisters.end())
+        {
+            return it->second;
+        }
+
+        RegisterInfo info;
+        info.isConstant = true;
+        info.value = value;
+        int reg = (int)m_registers.size();
+        m_registers.push_back(info);
+        m_constantRegisters[key] = reg;
+        return reg;
+    }
+
+    // Appends an instruction and returns its output register.  If all of its
+    // sources are constants, the instruction is run right away and its
+    // output becomes a constant instead.
+    int emit(Instruction instruction)
+    {
+        int sourceCount = GetSourceCount(instruction.opcode);
+        bool isFoldable = (instruction.opcode != OP_CALL);
+        for (int i = 0; i < sourceCount && isFoldable; i++)
+        {
+            isFoldable = isConstant(instruction.src[i]);
+        }
+
+        if (isFoldable)
+        {
+            double values[MAX_INSTRUCTION_SOURCES + 1];
+            double* registers[MAX_INSTRUCTION_SOURCES + 1];
+            for (int i = 0; i <= MAX_INSTRUCTION_SOURCES; i++)
+            {
+                registers[i] = &values[i];
+            }
+            for (int i = 0; i < sourceCount; i++)
+            {
+                values[i] = m_registers[instruction.src[i]].value;
+                instruction.src[i] = i;
+            }
+            instruction.dst = MAX_INSTRUCTION_SOURCES;
+            execute(instruction, registers, 1);
+            return makeConstant(values[MAX_INSTRUCTION_SOURCES]);
+        }
+
+        // Reuse the output of an identical instruction, such as the
+        // coordinates computed by two transformer modules with the same
+        // parameters.
+        uint64_t imm[3];
+        memcpy(imm, instruction.imm, sizeof(imm));
+        InstructionKey key(instruction.opcode, instruction.src[0], instruction.src[1], instruction.src[2], instruction.src[3], instruction.src[4], imm[0], imm[1], imm[2], instruction.pModule);
+        std::map<InstructionKey, int>::const_iterator it = m_instructionRegisters.find(key);
+        if (it != m_instructionRegisters.end())
+        {
+            return it->second;
+        }
+
+        RegisterInfo info;
+        info.definition = (int)m_code.size();
+        instruction.dst = (int)m_registers.size();
+        m_registers.push_back(info);
+        m_code.push_back(instruction);
+        m_instructionRegisters[key] = instruction.dst;
+        return instruction.dst;
+    }
+
+    int emit(Opcode opcode, int src0, int src1 = -1)
+    {
+        Instruction instruction = makeInstruction(opcode);
+        instruction.src[0] = src0;
+        instruction.src[1] = src1;
+        return emit(instruction);
+    }
+
+    int emitCall(const ModuleBase& sourceModule, const int coords[3])
+    {
+        Instruction instruction = makeInstruction(OP_CALL);
+        for (int i = 0; i < 3; i++)
+        {
+            instruction.src[i] = coords[i];
+        }
+        instruction.pModule = &sourceModule;
+        return emit(instruction);
+    }
+
+    int emitNegate(int src)
+    {
+        const Instruction* pDefinition = getDefinition(src);
+        if (pDefinition && pDefinition->opcode == OP_NEGATE)
+        {
+            return pDefinition->src[0];
+        }
+        if (pDefinition && pDefinition->opcode == OP_SCALE_BIAS && isConstant(pDefinition->src[1]) && isConstant(pDefinition->src[2]))
+        {
+            // -(a * s + b) is exactly a * -s + -b.
+            int source = pDefinition->src[0];
+            int scale = makeConstant(-m_registers[pDefinition->src[1]].value);
+            int bias = makeConstant(-m_registers[pDefinition->src[2]].value);
+            return emitScaleBias(source, scale, bias);
+        }
+        return emit(OP_NEGATE, src);
+    }
+
+    int emitScaleBias(int source, int scale, int bias)
+    {
+        if (isConstant(scale) && isConstant(bias) && m_registers[scale].value == 1.0 && m_registers[bias].value == 0.0)
+        {
+            return source;
+        }
+
+        const Instruction* pDefinition = getDefinition(source);
+        if (pDefinition && pDefinition->opcode == OP_NEGATE && isConstant(scale))
+        {
+            // -a * s is exactly a * -s.
+            source = pDefinition->src[0];
+            scale = makeConstant(-m_registers[scale].value);
+        }
+
+        Instruction instruction = makeInstruction(OP_SCALE_BIAS);
+        instruction.src[0] = source;
+        instruction.src[1] = scale;
+        instruction.src[2] = bias;
+        return emit(instruction);
+    }
+
+    int compileBinary(Opcode opcode, const ModuleBase& sourceModule, const int coords[3])
+    {
+        int src0 = compileModule(sourceModule.getSourceModule(0), coords);
+        int src1 = compileModule(sourceModule.getSourceModule(1), coords);
+        return emit(opcode, src0, src1);
+    }
+
+    // Instructions in static single assignment form.
+    std::vector<Instruction> m_code;
+
+    // Information about each virtual register.
+    std::vector<RegisterInfo> m_registers;
+
+    // Virtual register of each constant, keyed by its bit pattern.
+    std::map<uint64_t, int> m_constantRegisters;
+
+    // Each module compiled at a set of input values.
+    std::map<NodeKey, Node> m_nodes;
+
+    // Output register of each emitted instruction, to share the output of
+    // identical instructions.
+    std::map<InstructionKey, int> m_instructionRegisters;
+
+    // Statistics of the compiled graph.
+    Statistics m_statistics;
+};
+
+Program::Program()
+    : ModuleBase(1)
+    , m_registerCount(INPUT_REGISTER_COUNT)
+    , m_outputRegister(-1)
+    , m_statistics()
+{
+}
+
+void Program::compile()
+{
+    const int coords[3] = {X_REGISTER, Y_REGISTER, Z_REGISTER};
+    Compiler compiler;
+    int outputRegister = compiler.compileModule(getSourceModule(0), coords);
+    compiler.finish(outputRegister, *this);
+}
+
+void Program::setSourceModule(int index, const ModuleBase& sourceModule)
+{
+    ModuleBase::setSourceModule(index, sourceModule);
+    compile();
+}
+
+double Program::getValue(double x, double y, double z) const
+{
+    double value;
+    getValues(&x, &y, &z, &value, 1);
+    return value;
+}
+
+void Program::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    run(xs, ys, zs, out, count);
+}
+
+void Program::getFloatValues(const float* xs, const float* ys, const float* zs, float* out, size_t count) const
+{
+    run(xs, ys, zs, out, count);
+}
+
+namespace
+{
+
+    // Evaluates the noise module called by an OP_CALL instruction in the
+    // precision of the registers.  A single input value goes through
+    // getValue(), which returns the same value without the setup of a batch.
+    inline void CallModule(const ModuleBase* pModule, const double* xs, const double* ys, const double* zs, double* out, size_t count)
+    {
+        if (count == 1)
+        {
+            out[0] = pModule->getValue(xs[0], ys[0], zs[0]);
+            return;
+        }
+        pModule->getValues(xs, ys, zs, out, count);
+    }
+
+    inline void CallModule(const ModuleBase* pModule, const float* xs, const float* ys, const float* zs, float* out, size_t count)
+    {
+        pModule->getFloatValues(xs, ys, zs, out, count);
+    }
+
+    // Largest program whose registers Program::run() keeps on the stack
+    // when it evaluates a single input value.
+    const int MAX_STACK_REGISTER_COUNT = 128;
+
+    // Storage of the registers of one running program.
+    template <class T> struct RegisterLevel
+    {
+        std::vector<T> storage;
+        std::vector<T*> registers;
+    };
+
+    // Storage of the registers of the programs running on a thread.  A
+    // program may call noise modules that run programs themselves, so each
+    // nested run uses the next level.  The levels are kept for later runs, so
+    // a thread only allocates storage when a run needs more than before.
+    template <class T> struct RegisterStack
+    {
+        std::deque<RegisterLevel<T>> levels;
+        size_t depth = 0;
+    };
+
+    template <class T> RegisterStack<T>& GetRegisterStack()
+    {
+        thread_local RegisterStack<T> stack;
+        return stack;
+    }
+
+    // Takes the next level of the register stack of the calling thread for
+    // the lifetime of this object.
+    template <class T> class RegisterFrame
+    {
+    public:
+        RegisterFrame(int registerCount, size_t stride)
+            : m_stack(GetRegisterStack<T>())
+        {
+            if (m_stack.depth == m_stack.levels.size())
+            {
+                m_stack.levels.emplace_back();
+            }
+            RegisterLevel<T>& level = m_stack.levels[m_stack.depth++];
+            if (level.storage.size() < registerCount * stride)
+            {
+                level.storage.resize(registerCount * stride);
+            }
+            if (level.registers.size() < (size_t)registerCount)
+            {
+                level.registers.resize(registerCount);
+            }
+            for (int i = 0; i < registerCount; i++)
+            {
+                level.registers[i] = &level.storage[i * stride];
+            }
+            m_registers = level.registers.data();
+        }
+
+        ~RegisterFrame()
+        {
+            m_stack.depth--;
+        }
+
+        T** getRegisters() const
+        {
+            return m_registers;
+        }
+
+    private:
+        RegisterStack<T>& m_stack;
+        T** m_registers;
+    };
+
+} // namespace
+
+template <class T> void Program::run(const T* xs, const T* ys, const T* zs, T* out, size_t count) const
+{
+    assert(m_outputRegister >= 0);
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    // A single input value needs one value per register, which usually fits
+    // on the stack.
+    if (count == 1 && m_registerCount <= MAX_STACK_REGISTER_COUNT)
+    {
+        T storage[MAX_STACK_REGISTER_COUNT];
+        T* registers[MAX_STACK_REGISTER_COUNT];
+        for (int i = 0; i < m_registerCount; i++)
+        {
+            registers[i] = &storage[i];
+        }
+        runBatches(registers, 1, xs, ys, zs, out, count);
+        return;
+    }
+
+    // Each register holds up to MAX_BATCH_SIZE values.  The storage of the
+    // input registers is unused; runBatches() points them at the input
+    // values.
+    size_t stride = GetMin(count, MAX_BATCH_SIZE);
+    RegisterFrame<T> frame(m_registerCount, stride);
+    runBatches(frame.getRegisters(), stride, xs, ys, zs, out, count);
+}
+
+template <class T> void Program::runBatches(T** registers, size_t stride, const T* xs, const T* ys, const T* zs, T* out, size_t count) const
+{
+    for (size_t i = 0; i < m_constants.size(); i++)
+    {
+        T* pConstant = registers[m_constants[i].first];
+        for (size_t j = 0; j < stride; j++)
+        {
+            pConstant[j] = (T)m_constants[i].second;
+        }
+    }
+
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+
+        // The instructions never write into the input registers.
+        registers[X_REGISTER] = const_cast<T*>(xs + i);
+        registers[Y_REGISTER] = const_cast<T*>(ys + i);
+        registers[Z_REGISTER] = const_cast<T*>(zs + i);
+        for (size_t j = 0; j < m_instructions.size(); j++)
+        {
+            execute(m_instructions[j], registers, n);
+        }
+
+        const T* pOutput = registers[m_outputRegister];
+        for (size_t j = 0; j < n; j++)
+        {
+            out[i + j] = pOutput[j];
+        }
+    }
+}
+
+template <class T> void Program::execute(const Instruction& instruction, T* const* registers, size_t count)
+{
+    T* dst = registers[instruction.dst];
+    const T* src0 = instruction.src[0] >= 0 ? registers[instruction.src[0]] : nullptr;
+    const T* src1 = instruction.src[1] >= 0 ? registers[instruction.src[1]] : nullptr;
+    const T* src2 = instruction.src[2] >= 0 ? registers[instruction.src[2]] : nullptr;
+
+    switch (instruction.opcode)
+    {
+    case OP_CALL:
+        CallModule(instruction.pModule, src0, src1, src2, dst, count);
+        break;
+
+    case OP_ADD:
+        for (size_t i = 0; i < count; i++)
+        {
+            dst[i] = src0[i] + src1[i];
+        }
+        break;
+
+    case OP_MULTIPLY:
+        for (size_t i = 0; i < count; i++)
+        {
+            dst[i] = src0[i] * src1[i];
+        }
+        break;
+
+    case OP_MIN:
+        for (size_t i = 0; i < count; i++)
+        {
+            dst[i] = GetMin(src0[i], src1[i]);
+        }
+        break;
+
+    case OP_MAX:
+        for (size_t i = 0; i < count; i++)
+        {
+            dst[i] = GetMax(src0[i], src1[i]);
+        }
+        break;
+
+    case OP_POWER:
+        for (size_t i = 0; i < count; i++)
+        {
+            dst[i] = (T)pow(src0[i], src1[i]);
+        }
+        break;
+
+    case OP_ABS:
+        for (size_t i = 0; i < count; i++)
+        {
+            dst[i] = fabs(src0[i]);
+        }
+        break;
+
+    case OP_NEGATE:
+        for (size_t i = 0; i < count; i++)
+        {
+            dst[i] = -src0[i];
+        }
+        break;
+
+    case OP_SCALE_BIAS:
+        for (size_t i = 0; i < count; i++)
+        {
+            dst[i] = src0[i] * src1[i] + src2[i];
+        }
+        break;
+
+    case OP_CLAMP:
+    {
+        T lowerBound = (T)instruction.imm[0];
+        T upperBound = (T)instruction.imm[1];
+        for (size_t i = 0; i < count; i++)
+        {
+            T value = src0[i];
+            if (value < lowerBound)
+            {
+                value = lowerBound;
+            }
+            else if (value > upperBound)
+            {
+                value = upperBound;
+            }
+            dst[i] = value;
+        }
+        break;
+    }
+
+    case OP_EXPONENT:
+        for (size_t i = 0; i < count; i++)
+        {
+            dst[i] = (T)(pow(fabs((src0[i] + 1.0) / 2.0), instruction.imm[0]) * 2.0 - 1.0);
+        }
+        break;
+
+    case OP_BLEND:
+        for (size_t i = 0; i < count; i++)
+        {
+            double alpha = (src2[i] + 1.0) / 2.0;
+            dst[i] = (T)LinearInterp(src0[i], src1[i], alpha);
+        }
+        break;
+
+    case OP_SELECT:
+    {
+        const T* threshold = registers[instruction.src[3]];
+        const T* edgeFalloff = registers[instruction.src[4]];
+        for (size_t i = 0; i < count; i++)
+        {
+            T controlValue = src2[i];
+            if (edgeFalloff[i] > 0.0)
+            {
+                T lowerCurve = (threshold[i] - edgeFalloff[i]);
+                T upperCurve = (threshold[i] + edgeFalloff[i]);
+                if (controlValue < lowerCurve)
+                {
+                    dst[i] = src0[i];
+                }
+                else if (controlValue > upperCurve)
+                {
+                    dst[i] = src1[i];
+                }
+                else
+                {
+                    double alpha = SCurve3((controlValue - lowerCurve) / (upperCurve - lowerCurve));
+                    dst[i] = (T)LinearInterp(src0[i], src1[i], alpha);
+                }
+            }
+            else if (controlValue < threshold[i])
+            {
+                dst[i] = src0[i];
+            }
+            else
+            {
+                dst[i] = src1[i];
+            }
+        }
+        break;
+    }
+
+    case OP_DOT3:
+        for (size_t i = 0; i < count; i++)
+        {
+            dst[i] = (T)((instruction.imm[0] * src0[i]) + (instruction.imm[1] * src1[i]) + (instruction.imm[2] * src2[i]));
+        }
+        break;
+    }
+}
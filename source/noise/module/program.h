@@ -0,0 +1,269 @@
+// program.h
+//
+// Copyright (C) 2019, 2020 zjhlogo
+//
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or (at
+// your option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License (COPYING.txt) for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+// The developer's email is zjhlogo@gmzigail.com (for great email, take
+// off every 'zig'.)
+//
+
+#ifndef NOISE_MODULE_PROGRAM_H
+#define NOISE_MODULE_PROGRAM_H
+
+#include "modulebase.h"
+
+#include <utility>
+#include <vector>
+
+namespace noise
+{
+
+    namespace module
+    {
+
+        /// @addtogroup libnoise
+        /// @{
+
+        /// @addtogroup modules
+        /// @{
+
+        /// @addtogroup miscmodules
+        /// @{
+
+        /// Noise module that evaluates a compiled copy of a noise module
+        /// graph.
+        ///
+        /// Evaluating a noise module graph recursively calls each source
+        /// module through a virtual method, once per noise module per batch of
+        /// input values.  This noise module instead compiles the graph rooted
+        /// at its source module into a flat program of instructions in
+        /// evaluation order.  Each instruction reads and writes
+        /// <i>registers</i>, which are arrays holding one value per input
+        /// value of a batch, so the program evaluates a batch in a single loop
+        /// over its instructions.
+        ///
+        /// The compiler translates the arithmetic modules (noise::module::Add,
+        /// noise::module::ScaleBias, noise::module::Select, etc.) and the
+        /// transformer modules into instructions.  The generator modules, and
+        /// the modules that the compiler does not know, are called through
+        /// their getValues() method.  While compiling, the compiler also:
+        ///
+        /// - replaces noise::module::Const modules, constant parameters, and
+        ///   instructions that only depend on constants by constant registers.
+        /// - merges a noise::module::Invert module into a neighboring
+        ///   noise::module::Invert or noise::module::ScaleBias module, and
+        ///   drops a noise::module::ScaleBias module that has no effect.
+        /// - evaluates a noise module that is used by several noise modules
+        ///   only once for each input value, and shares its output values
+        ///   among these noise modules.  A noise module graph therefore does
+        ///   not need noise::module::Cache modules to avoid redundant
+        ///   evaluations; the compiler treats them as plain references to
+        ///   their source modules.
+        /// - shares the output of identical instructions, such as the
+        ///   coordinates computed by two transformer modules with the same
+        ///   parameters.
+        ///
+        /// The getStatistics() method reports how many evaluations the
+        /// sharing eliminates.
+        /// The output values of this noise module are equal to the output
+        /// values of the source module, except that the sign of a zero output
+        /// value may differ.
+        ///
+        /// The program stores the parameters of the noise modules that were
+        /// translated into instructions at the time it is compiled.  If an
+        /// application changes a noise module of the graph, it must call the
+        /// compile() method again.  The noise modules of the graph must exist
+        /// throughout the lifetime of this noise module.
+        ///
+        /// The getFloatValues() method runs the same program on
+        /// single-precision registers, and calls the getFloatValues() method of
+        /// the noise modules that are not translated into instructions.
+        ///
+        /// The program itself is not modified by the getValue(), getValues()
+        /// and getFloatValues() methods, so this noise module can be evaluated
+        /// from several threads at once if the noise modules of the graph can.
+        ///
+        /// This noise module requires one source module.
+        class Program : public ModuleBase
+        {
+
+        public:
+            /// Statistics about the noise module graph of a compiled program.
+            struct Statistics
+            {
+                /// Number of noise modules evaluated by the program.  A noise
+                /// module that is evaluated at several sets of input values,
+                /// such as the source module of a transformer module that is
+                /// also used directly, is counted once for each set.
+                size_t moduleCount;
+
+                /// Number of those noise modules that are used by more than
+                /// one noise module.
+                size_t sharedModuleCount;
+
+                /// Number of noise module evaluations per input value that the
+                /// program eliminates by sharing the output of noise modules,
+                /// compared to evaluating the graph recursively.  A recursive
+                /// evaluation evaluates a noise module and all of its source
+                /// modules once for each use, except that a
+                /// noise::module::Cache or noise::module::ThreadCache module
+                /// evaluates its source module once.
+                size_t eliminatedEvaluationCount;
+            };
+
+            /// Constructor.
+            Program();
+
+            /// Compiles the noise module graph rooted at the source module.
+            ///
+            /// @pre A source module has been passed to the setSourceModule()
+            /// method.
+            ///
+            /// The setSourceModule() method compiles the graph; call this
+            /// method after modifying a noise module of the graph.
+            void compile();
+
+            /// Returns the number of instructions of the compiled program.
+            ///
+            /// @returns The number of instructions.
+            size_t getInstructionCount() const
+            {
+                return m_instructions.size();
+            }
+
+            /// Returns the number of registers used by the compiled program.
+            ///
+            /// @returns The number of registers, including the registers that
+            /// hold the coordinates of the input values and the constants.
+            int getRegisterCount() const
+            {
+                return m_registerCount;
+            }
+
+            /// Returns the statistics about the noise module graph of the
+            /// compiled program.
+            ///
+            /// @returns The statistics.
+            const Statistics& getStatistics() const
+            {
+                return m_statistics;
+            }
+
+            virtual double getValue(double x, double y, double z) const override;
+
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const override;
+
+            virtual void getFloatValues(const float* xs, const float* ys, const float* zs, float* out, size_t count) const override;
+
+            virtual void setSourceModule(int index, const ModuleBase& sourceModule) override;
+
+        protected:
+            /// Operation performed by an instruction.
+            enum Opcode
+            {
+                /// dst = the output values of the module at ( src0, src1, src2 ).
+                OP_CALL,
+                /// dst = src0 + src1.
+                OP_ADD,
+                /// dst = src0 * src1.
+                OP_MULTIPLY,
+                /// dst = the smaller of src0 and src1.
+                OP_MIN,
+                /// dst = the larger of src0 and src1.
+                OP_MAX,
+                /// dst = src0 raised to the power of src1.
+                OP_POWER,
+                /// dst = the absolute value of src0.
+                OP_ABS,
+                /// dst = -src0.
+                OP_NEGATE,
+                /// dst = src0 * src1 + src2.
+                OP_SCALE_BIAS,
+                /// dst = src0 clamped to [imm0, imm1].
+                OP_CLAMP,
+                /// dst = src0 mapped by the exponential curve of imm0.
+                OP_EXPONENT,
+                /// dst = src0 and src1 blended by the control value src2.
+                OP_BLEND,
+                /// dst = src0 or src1, selected by the control value src2, the
+                /// threshold src3 and the edge falloff src4.
+                OP_SELECT,
+                /// dst = imm0 * src0 + imm1 * src1 + imm2 * src2.
+                OP_DOT3
+            };
+
+            /// Maximum number of source registers of an instruction.
+            static const int MAX_INSTRUCTION_SOURCES = 5;
+
+            /// A single instruction of a compiled program.
+            struct Instruction
+            {
+                Opcode opcode;
+                int dst;
+                int src[MAX_INSTRUCTION_SOURCES];
+                double imm[3];
+                const ModuleBase* pModule;
+            };
+
+            /// Translates a noise module graph into instructions, defined in
+            /// program.cpp.
+            class Compiler;
+
+            /// Runs the compiled program over an array of input values, with
+            /// registers of type @a T (@a double or @a float).
+            template <class T> void run(const T* xs, const T* ys, const T* zs, T* out, size_t count) const;
+
+            /// Runs the compiled program over an array of input values, in
+            /// batches of up to @a stride values.
+            ///
+            /// @param registers The arrays of each register, each holding
+            /// @a stride values.
+            template <class T> void runBatches(T** registers, size_t stride, const T* xs, const T* ys, const T* zs, T* out, size_t count) const;
+
+            /// Runs a single instruction over a batch.
+            ///
+            /// @param instruction The instruction to run.
+            /// @param registers The arrays of each register.
+            /// @param count The number of input values in the batch.
+            template <class T> static void execute(const Instruction& instruction, T* const* registers, size_t count);
+
+            /// Instructions of the compiled program, in evaluation order.
+            std::vector<Instruction> m_instructions;
+
+            /// Registers holding constants, and their values.
+            std::vector<std::pair<int, double>> m_constants;
+
+            /// Number of registers used by the compiled program.
+            int m_registerCount;
+
+            /// Register holding the output values of the compiled program.
+            int m_outputRegister;
+
+            /// Statistics about the noise module graph.
+            Statistics m_statistics;
+        };
+
+        /// @}
+
+        /// @}
+
+        /// @}
+
+    } // namespace module
+
+} // namespace noise
+
+#endif
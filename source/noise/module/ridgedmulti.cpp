@@ -22,6 +22,8 @@
 
 #include "ridgedmulti.h"
 
+#include "../misc.h"
+
 using namespace noise::module;
 
 RidgedMulti::RidgedMulti()
@@ -33,6 +35,7 @@ RidgedMulti::RidgedMulti()
     , m_seed(DEFAULT_RIDGED_SEED)
 {
     CalcSpectralWeights();
+    CalcOctaveSeeds();
 }
 
 // Calculates the spectral weights for each octave.
@@ -51,9 +54,32 @@ void RidgedMulti::CalcSpectralWeights()
     }
 }
 
+// Calculates the seed value used by each octave.
+void RidgedMulti::CalcOctaveSeeds()
+{
+    for (int i = 0; i < RIDGED_MAX_OCTAVE; i++)
+    {
+        m_octaveSeed[i] = (m_seed + i) & 0x7fffffff;
+    }
+}
+
+double RidgedMulti::getValue(double x, double y, double z) const
+{
+    switch (m_noiseQuality)
+    {
+    case QUALITY_FAST:
+        return GetValueQ<QUALITY_FAST>(x, y, z);
+    case QUALITY_BEST:
+        return GetValueQ<QUALITY_BEST>(x, y, z);
+    default:
+        return GetValueQ<QUALITY_STD>(x, y, z);
+    }
+}
+
 // Multifractal code originally written by F. Kenton "Doc Mojo" Musgrave,
 // 1998.  Modified by jas for use with libnoise.
-double RidgedMulti::getValue(double x, double y, double z) const
+template <noise::NoiseQuality noiseQuality>
+double RidgedMulti::GetValueQ(double x, double y, double z) const
 {
     x *= m_frequency;
     y *= m_frequency;
@@ -79,8 +105,7 @@ double RidgedMulti::getValue(double x, double y, double z) const
         nz = MakeInt32Range(z);
 
         // Get the coherent-noise value.
-        int seed = (m_seed + curOctave) & 0x7fffffff;
-        signal = GradientCoherentNoise3D(nx, ny, nz, seed, m_noiseQuality);
+        signal = GradientCoherentNoise3D<noiseQuality>(nx, ny, nz, m_octaveSeed[curOctave]);
 
         // Make the ridges.
         signal = fabs(signal);
@@ -117,6 +142,236 @@ double RidgedMulti::getValue(double x, double y, double z) const
     return (value * 1.25) - 1.0;
 }
 
+double RidgedMulti::getValueAndGradient(double x, double y, double z, double& dx, double& dy, double& dz) const
+{
+    switch (m_noiseQuality)
+    {
+    case QUALITY_FAST:
+        return GetValueAndGradientQ<QUALITY_FAST>(x, y, z, dx, dy, dz);
+    case QUALITY_BEST:
+        return GetValueAndGradientQ<QUALITY_BEST>(x, y, z, dx, dy, dz);
+    default:
+        return GetValueAndGradientQ<QUALITY_STD>(x, y, z, dx, dy, dz);
+    }
+}
+
+template <noise::NoiseQuality noiseQuality>
+double RidgedMulti::GetValueAndGradientQ(double x, double y, double z, double& dx, double& dy, double& dz) const
+{
+    double curFrequency = m_frequency;
+    x *= m_frequency;
+    y *= m_frequency;
+    z *= m_frequency;
+
+    double value = 0.0;
+    double weight = 1.0;
+    double valueGradient[3] = {0.0, 0.0, 0.0};
+    double weightGradient[3] = {0.0, 0.0, 0.0};
+
+    // Same parameters as GetValueQ().
+    double offset = 1.0;
+    double gain = 2.0;
+
+    for (int curOctave = 0; curOctave < m_octaveCount; curOctave++)
+    {
+        double nx = MakeInt32Range(x);
+        double ny = MakeInt32Range(y);
+        double nz = MakeInt32Range(z);
+
+        double noiseGradient[3];
+        double noiseValue = GradientCoherentNoise3DAndGradient<noiseQuality>(nx, ny, nz, noiseGradient[0], noiseGradient[1], noiseGradient[2], m_octaveSeed[curOctave]);
+
+        // The signal is (offset - |noise|)^2 * weight.  Its derivative follows
+        // from the product rule, where the derivative of the ridge
+        // offset - |noise| is -sign(noise) times the derivative of the noise,
+        // scaled by the frequency of the octave.
+        double ridge = offset - fabs(noiseValue);
+        double ridgeScale = (noiseValue > 0.0 ? -1.0 : (noiseValue < 0.0 ? 1.0 : 0.0)) * curFrequency;
+        double signal = ridge * ridge * weight;
+        double signalGradient[3];
+        for (int i = 0; i < 3; i++)
+        {
+            signalGradient[i] = 2.0 * ridge * noiseGradient[i] * ridgeScale * weight + ridge * ridge * weightGradient[i];
+        }
+
+        // The weight of the next octave is the clamped signal times the gain;
+        // it is constant where it is clamped.
+        weight = signal * gain;
+        bool isWeightClamped = false;
+        if (weight > 1.0)
+        {
+            weight = 1.0;
+            isWeightClamped = true;
+        }
+        if (weight < 0.0)
+        {
+            weight = 0.0;
+            isWeightClamped = true;
+        }
+
+        value += (signal * m_pSpectralWeights[curOctave]);
+        for (int i = 0; i < 3; i++)
+        {
+            weightGradient[i] = isWeightClamped ? 0.0 : signalGradient[i] * gain;
+            valueGradient[i] += signalGradient[i] * m_pSpectralWeights[curOctave];
+        }
+
+        // Go to the next octave.
+        x *= m_lacunarity;
+        y *= m_lacunarity;
+        z *= m_lacunarity;
+        curFrequency *= m_lacunarity;
+    }
+
+    dx = valueGradient[0] * 1.25;
+    dy = valueGradient[1] * 1.25;
+    dz = valueGradient[2] * 1.25;
+    return (value * 1.25) - 1.0;
+}
+
+void RidgedMulti::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    // These parameters should be user-defined; they may be exposed in a
+    // future version of libnoise.
+    const double offset = 1.0;
+    const double gain = 2.0;
+
+    double nx[MAX_BATCH_SIZE];
+    double ny[MAX_BATCH_SIZE];
+    double nz[MAX_BATCH_SIZE];
+    double mx[MAX_BATCH_SIZE];
+    double my[MAX_BATCH_SIZE];
+    double mz[MAX_BATCH_SIZE];
+    double signals[MAX_BATCH_SIZE];
+    double weight[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        double* value = out + i;
+        for (size_t j = 0; j < n; j++)
+        {
+            nx[j] = xs[i + j] * m_frequency;
+            ny[j] = ys[i + j] * m_frequency;
+            nz[j] = zs[i + j] * m_frequency;
+            value[j] = 0.0;
+            weight[j] = 1.0;
+        }
+
+        // Evaluate one octave for the whole batch at a time; the weight of
+        // each input value is carried from octave to octave in weight[].
+        for (int curOctave = 0; curOctave < m_octaveCount; curOctave++)
+        {
+            double spectralWeight = m_pSpectralWeights[curOctave];
+            for (size_t j = 0; j < n; j++)
+            {
+                mx[j] = MakeInt32Range(nx[j]);
+                my[j] = MakeInt32Range(ny[j]);
+                mz[j] = MakeInt32Range(nz[j]);
+            }
+            GradientCoherentNoise3D(mx, my, mz, signals, n, m_octaveSeed[curOctave], m_noiseQuality);
+
+            for (size_t j = 0; j < n; j++)
+            {
+                double signal = signals[j];
+
+                // Make the ridges, then square the signal to increase their
+                // sharpness and apply the weighting from the previous octave.
+                signal = fabs(signal);
+                signal = offset - signal;
+                signal *= signal;
+                signal *= weight[j];
+
+                // Weight successive contributions by the previous signal.
+                weight[j] = signal * gain;
+                if (weight[j] > 1.0)
+                {
+                    weight[j] = 1.0;
+                }
+                if (weight[j] < 0.0)
+                {
+                    weight[j] = 0.0;
+                }
+
+                value[j] += (signal * spectralWeight);
+
+                // Go to the next octave.
+                nx[j] *= m_lacunarity;
+                ny[j] *= m_lacunarity;
+                nz[j] *= m_lacunarity;
+            }
+        }
+
+        for (size_t j = 0; j < n; j++)
+        {
+            value[j] = (value[j] * 1.25) - 1.0;
+        }
+    }
+}
+
+void RidgedMulti::getFloatValues(const float* xs, const float* ys, const float* zs, float* out, size_t count) const
+{
+    const float offset = 1.0f;
+    const float gain = 2.0f;
+
+    float nx[MAX_BATCH_SIZE];
+    float ny[MAX_BATCH_SIZE];
+    float nz[MAX_BATCH_SIZE];
+    float mx[MAX_BATCH_SIZE];
+    float my[MAX_BATCH_SIZE];
+    float mz[MAX_BATCH_SIZE];
+    float signals[MAX_BATCH_SIZE];
+    float weight[MAX_BATCH_SIZE];
+    const float frequency = (float)m_frequency;
+    const float lacunarity = (float)m_lacunarity;
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        float* value = out + i;
+        for (size_t j = 0; j < n; j++)
+        {
+            nx[j] = xs[i + j] * frequency;
+            ny[j] = ys[i + j] * frequency;
+            nz[j] = zs[i + j] * frequency;
+            value[j] = 0.0f;
+            weight[j] = 1.0f;
+        }
+
+        // Same octave loop as getValues(), in single precision.
+        for (int curOctave = 0; curOctave < m_octaveCount; curOctave++)
+        {
+            float spectralWeight = (float)m_pSpectralWeights[curOctave];
+            for (size_t j = 0; j < n; j++)
+            {
+                mx[j] = MakeInt32Range(nx[j]);
+                my[j] = MakeInt32Range(ny[j]);
+                mz[j] = MakeInt32Range(nz[j]);
+            }
+            GradientCoherentNoise3D(mx, my, mz, signals, n, m_octaveSeed[curOctave], m_noiseQuality);
+
+            for (size_t j = 0; j < n; j++)
+            {
+                float signal = offset - fabsf(signals[j]);
+                signal *= signal;
+                signal *= weight[j];
+
+                weight[j] = GetMin(GetMax(signal * gain, 0.0f), 1.0f);
+
+                value[j] += (signal * spectralWeight);
+
+                // Go to the next octave.
+                nx[j] *= lacunarity;
+                ny[j] *= lacunarity;
+                nz[j] *= lacunarity;
+            }
+        }
+
+        for (size_t j = 0; j < n; j++)
+        {
+            value[j] = (value[j] * 1.25f) - 1.0f;
+        }
+    }
+}
+
 void noise::module::RidgedMulti::SetOctaveCount(int octaveCount)
 {
     assert(octaveCount <= RIDGED_MAX_OCTAVE);
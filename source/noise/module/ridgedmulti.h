@@ -239,6 +239,7 @@ namespace noise
             void SetSeed(int seed)
             {
                 m_seed = seed;
+                CalcOctaveSeeds();
             }
 
             /// Returns the seed value used by the ridged-multifractal-noise
@@ -252,12 +253,54 @@ namespace noise
 
             virtual double getValue(double x, double y, double z) const;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const;
+
+            virtual void getFloatValues(const float* xs, const float* ys, const float* zs, float* out, size_t count) const;
+
+            /// Generates an output value and its gradient, given the coordinates
+            /// of the specified input value.
+            ///
+            /// @param x The @a x coordinate of the input value.
+            /// @param y The @a y coordinate of the input value.
+            /// @param z The @a z coordinate of the input value.
+            /// @param dx Receives the derivative of the output value along the
+            /// @a x axis.
+            /// @param dy Receives the derivative of the output value along the
+            /// @a y axis.
+            /// @param dz Receives the derivative of the output value along the
+            /// @a z axis.
+            ///
+            /// @returns The output value, identical to the value returned by
+            /// getValue().
+            ///
+            /// The gradient is computed analytically alongside the output
+            /// value; see noise::module::Perlin::getValueAndGradient().  Where
+            /// an octave's coherent-noise value is exactly zero, on the crest
+            /// of a ridge, the output value has a crease and the gradient is
+            /// taken to be zero along it.
+            double getValueAndGradient(double x, double y, double z, double& dx, double& dy, double& dz) const;
+
         protected:
             /// Calculates the spectral weights for each octave.
             ///
             /// This method is called when the lacunarity changes.
             void CalcSpectralWeights();
 
+            /// Calculates the seed value used by each octave.
+            ///
+            /// This method is called when the seed changes.
+            void CalcOctaveSeeds();
+
+            /// Generates the output value with the noise quality fixed at
+            /// compile time.
+            template <noise::NoiseQuality noiseQuality>
+            double GetValueQ(double x, double y, double z) const;
+
+            /// Generates the output value and its gradient with the noise
+            /// quality fixed at compile time.
+            template <noise::NoiseQuality noiseQuality>
+            double GetValueAndGradientQ(double x, double y, double z, double& dx, double& dy, double& dz) const;
+
             /// Total number of octaves that generate the ridged-multifractal
             /// noise.
             int m_octaveCount;
@@ -276,6 +319,9 @@ namespace noise
 
             /// Contains the spectral weights for each octave.
             double m_pSpectralWeights[RIDGED_MAX_OCTAVE];
+
+            /// Seed value used by each octave.
+            int m_octaveSeed[RIDGED_MAX_OCTAVE];
         };
 
         /// @}
@@ -23,6 +23,7 @@
 #include "rotatedomain.h"
 
 #include "../mathconsts.h"
+#include "../misc.h"
 
 using namespace noise::module;
 
@@ -93,6 +94,19 @@ void RotateDomain::setAngles(double xAngle, double yAngle, double zAngle)
     m_zAngle = zAngle;
 }
 
+void RotateDomain::getMatrix(double matrix[9]) const
+{
+    matrix[0] = m_x1Matrix;
+    matrix[1] = m_y1Matrix;
+    matrix[2] = m_z1Matrix;
+    matrix[3] = m_x2Matrix;
+    matrix[4] = m_y2Matrix;
+    matrix[5] = m_z2Matrix;
+    matrix[6] = m_x3Matrix;
+    matrix[7] = m_y3Matrix;
+    matrix[8] = m_z3Matrix;
+}
+
 double RotateDomain::getValue(double x, double y, double z) const
 {
     assert(m_pSourceModule[0] != NULL);
@@ -102,3 +116,26 @@ double RotateDomain::getValue(double x, double y, double z) const
     double nz = (m_x3Matrix * x) + (m_y3Matrix * y) + (m_z3Matrix * z);
     return m_pSourceModule[0]->getValue(nx, ny, nz);
 }
+
+void RotateDomain::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    assert(m_pSourceModule[0] != NULL);
+
+    double nx[MAX_BATCH_SIZE];
+    double ny[MAX_BATCH_SIZE];
+    double nz[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        for (size_t j = 0; j < n; j++)
+        {
+            double x = xs[i + j];
+            double y = ys[i + j];
+            double z = zs[i + j];
+            nx[j] = (m_x1Matrix * x) + (m_y1Matrix * y) + (m_z1Matrix * z);
+            ny[j] = (m_x2Matrix * x) + (m_y2Matrix * y) + (m_z2Matrix * z);
+            nz[j] = (m_x3Matrix * x) + (m_y3Matrix * y) + (m_z3Matrix * z);
+        }
+        m_pSourceModule[0]->getValues(nx, ny, nz, out + i, n);
+    }
+}
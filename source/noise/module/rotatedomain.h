@@ -147,8 +147,20 @@ namespace noise
             /// source module.
             void setAngles(double xAngle, double yAngle, double zAngle);
 
+            /// Returns the rotation matrix applied to the input value.
+            ///
+            /// @param matrix The array that receives the 3x3 matrix in row-major
+            /// order.
+            ///
+            /// Row @a i holds the factors that the @a x, @a y and @a z
+            /// coordinates of the input value are multiplied with and summed in
+            /// that order to produce coordinate @a i of the rotated input value.
+            void getMatrix(double matrix[9]) const;
+
             virtual double getValue(double x, double y, double z) const override;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const override;
+
         protected:
             /// An entry within the 3x3 rotation matrix used for rotating the
             /// input value.
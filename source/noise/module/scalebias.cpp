@@ -22,6 +22,8 @@
 
 #include "scalebias.h"
 
+#include "../misc.h"
+
 using namespace noise::module;
 
 ScaleBias::ScaleBias(const noise::ScalarParameter& src)
@@ -58,7 +60,43 @@ const noise::ScalarParameter& ScaleBias::getBias() const
     return m_bias;
 }
 
+const noise::ScalarParameter& ScaleBias::getSource() const
+{
+    return m_source;
+}
+
 double ScaleBias::getValue(double x, double y, double z) const
 {
     return m_source.getValue(x, y, z) * m_scale.getValue(x, y, z) + m_bias.getValue(x, y, z);
 }
+
+void ScaleBias::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    if (m_scale.isConstant() && m_bias.isConstant())
+    {
+        // Apply the constant scale and bias directly, without filling a batch
+        // of parameter values.
+        double scale = m_scale.getConstValue();
+        double bias = m_bias.getConstValue();
+        m_source.getValues(xs, ys, zs, out, count);
+        for (size_t i = 0; i < count; i++)
+        {
+            out[i] = out[i] * scale + bias;
+        }
+        return;
+    }
+
+    double scale[MAX_BATCH_SIZE];
+    double bias[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        m_source.getValues(xs + i, ys + i, zs + i, out + i, n);
+        m_scale.getValues(xs + i, ys + i, zs + i, scale, n);
+        m_bias.getValues(xs + i, ys + i, zs + i, bias, n);
+        for (size_t j = 0; j < n; j++)
+        {
+            out[i + j] = out[i + j] * scale[j] + bias[j];
+        }
+    }
+}
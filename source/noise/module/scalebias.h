@@ -107,8 +107,16 @@ namespace noise
             /// it, then outputs the value.
             const noise::ScalarParameter& getBias() const;
 
+            /// Returns the source module whose output value this noise module
+            /// scales and biases.
+            ///
+            /// @returns The source module, or a constant value.
+            const noise::ScalarParameter& getSource() const;
+
             virtual double getValue(double x, double y, double z) const override;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const override;
+
         protected:
             noise::ScalarParameter m_source;
 
@@ -22,6 +22,8 @@
 
 #include "scaledomain.h"
 
+#include "../misc.h"
+
 using namespace noise::module;
 
 ScaleDomain::ScaleDomain(const noise::ScalarParameter& src)
@@ -92,6 +94,11 @@ void ScaleDomain::SetScale(const noise::ScalarParameter& xScale, const noise::Sc
     m_zScale = zScale;
 }
 
+const noise::ScalarParameter& ScaleDomain::getSource() const
+{
+    return m_source;
+}
+
 double ScaleDomain::getValue(double x, double y, double z) const
 {
     double finalX = x * m_xScale.getValue(x, y, z);
@@ -100,3 +107,24 @@ double ScaleDomain::getValue(double x, double y, double z) const
 
     return m_source.getValue(finalX, finalY, finalZ);
 }
+
+void ScaleDomain::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    double finalX[MAX_BATCH_SIZE];
+    double finalY[MAX_BATCH_SIZE];
+    double finalZ[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        m_xScale.getValues(xs + i, ys + i, zs + i, finalX, n);
+        m_yScale.getValues(xs + i, ys + i, zs + i, finalY, n);
+        m_zScale.getValues(xs + i, ys + i, zs + i, finalZ, n);
+        for (size_t j = 0; j < n; j++)
+        {
+            finalX[j] = xs[i + j] * finalX[j];
+            finalY[j] = ys[i + j] * finalY[j];
+            finalZ[j] = zs[i + j] * finalZ[j];
+        }
+        m_source.getValues(finalX, finalY, finalZ, out + i, n);
+    }
+}
@@ -152,8 +152,16 @@ namespace noise
             /// returning the output value from the source module.
             void SetScale(const noise::ScalarParameter& xScale, const noise::ScalarParameter& yScale, const noise::ScalarParameter& zScale);
 
+            /// Returns the source module that this noise module evaluates at the
+            /// scaled input value.
+            ///
+            /// @returns The source module, or a constant value.
+            const noise::ScalarParameter& getSource() const;
+
             virtual double getValue(double x, double y, double z) const override;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const override;
+
         protected:
             noise::ScalarParameter m_source;
 
@@ -23,6 +23,7 @@
 #include "select.h"
 #include "../scalarparameter.h"
 #include "../interp.h"
+#include "../misc.h"
 
 using namespace noise::module;
 
@@ -135,3 +136,159 @@ double Select::getValue(double x, double y, double z) const
         }
     }
 }
+
+void Select::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    if (m_threshold.isConstant() && m_edgeFalloff.isConstant())
+    {
+        getValuesWithConstantThreshold(xs, ys, zs, out, count);
+        return;
+    }
+
+    double controlValue[MAX_BATCH_SIZE];
+    double fallOffValue[MAX_BATCH_SIZE];
+    double threshold[MAX_BATCH_SIZE];
+    double lowValue[MAX_BATCH_SIZE];
+    double highValue[MAX_BATCH_SIZE];
+    size_t lowLanes[MAX_BATCH_SIZE];
+    size_t highLanes[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        m_control.getValues(xs + i, ys + i, zs + i, controlValue, n);
+        m_edgeFalloff.getValues(xs + i, ys + i, zs + i, fallOffValue, n);
+        m_threshold.getValues(xs + i, ys + i, zs + i, threshold, n);
+
+        // Partition the input values into the lanes that need the low source
+        // module and the lanes that need the high source module; the input
+        // values within the falloff need both.  Each source module is then
+        // evaluated in one batch over its lanes only.
+        size_t lowLaneCount = 0;
+        size_t highLaneCount = 0;
+        for (size_t j = 0; j < n; j++)
+        {
+            bool isLow;
+            bool isHigh;
+            if (fallOffValue[j] > 0.0)
+            {
+                isLow = !(controlValue[j] > (threshold[j] + fallOffValue[j]));
+                isHigh = !(controlValue[j] < (threshold[j] - fallOffValue[j]));
+            }
+            else
+            {
+                isLow = (controlValue[j] < threshold[j]);
+                isHigh = !isLow;
+            }
+            lowLanes[lowLaneCount] = j;
+            lowLaneCount += isLow;
+            highLanes[highLaneCount] = j;
+            highLaneCount += isHigh;
+        }
+        getLaneValues(m_low, xs + i, ys + i, zs + i, lowLanes, lowLaneCount, n, lowValue);
+        getLaneValues(m_high, xs + i, ys + i, zs + i, highLanes, highLaneCount, n, highValue);
+
+        for (size_t j = 0; j < n; j++)
+        {
+            if (fallOffValue[j] > 0.0)
+            {
+                double lowerCurve = (threshold[j] - fallOffValue[j]);
+                double upperCurve = (threshold[j] + fallOffValue[j]);
+                if (controlValue[j] < lowerCurve)
+                {
+                    out[i + j] = lowValue[j];
+                }
+                else if (controlValue[j] > upperCurve)
+                {
+                    out[i + j] = highValue[j];
+                }
+                else
+                {
+                    double alpha = SCurve3((controlValue[j] - lowerCurve) / (upperCurve - lowerCurve));
+                    out[i + j] = LinearInterp(lowValue[j], highValue[j], alpha);
+                }
+            }
+            else if (controlValue[j] < threshold[j])
+            {
+                out[i + j] = lowValue[j];
+            }
+            else
+            {
+                out[i + j] = highValue[j];
+            }
+        }
+    }
+}
+
+void Select::getValuesWithConstantThreshold(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    double threshold = m_threshold.getConstValue();
+    double fallOffValue = m_edgeFalloff.getConstValue();
+    double lowerCurve = (threshold - fallOffValue);
+    double upperCurve = (threshold + fallOffValue);
+
+    double controlValue[MAX_BATCH_SIZE];
+    double lowValue[MAX_BATCH_SIZE];
+    double highValue[MAX_BATCH_SIZE];
+    size_t lowLanes[MAX_BATCH_SIZE];
+    size_t highLanes[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        m_control.getValues(xs + i, ys + i, zs + i, controlValue, n);
+
+        // Partition the input values as in getValues(), with the test of the
+        // falloff hoisted out of the loops.
+        size_t lowLaneCount = 0;
+        size_t highLaneCount = 0;
+        if (fallOffValue > 0.0)
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                lowLanes[lowLaneCount] = j;
+                lowLaneCount += !(controlValue[j] > upperCurve);
+                highLanes[highLaneCount] = j;
+                highLaneCount += !(controlValue[j] < lowerCurve);
+            }
+        }
+        else
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                bool isLow = (controlValue[j] < threshold);
+                lowLanes[lowLaneCount] = j;
+                lowLaneCount += isLow;
+                highLanes[highLaneCount] = j;
+                highLaneCount += !isLow;
+            }
+        }
+        getLaneValues(m_low, xs + i, ys + i, zs + i, lowLanes, lowLaneCount, n, lowValue);
+        getLaneValues(m_high, xs + i, ys + i, zs + i, highLanes, highLaneCount, n, highValue);
+
+        if (fallOffValue > 0.0)
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                if (controlValue[j] < lowerCurve)
+                {
+                    out[i + j] = lowValue[j];
+                }
+                else if (controlValue[j] > upperCurve)
+                {
+                    out[i + j] = highValue[j];
+                }
+                else
+                {
+                    double alpha = SCurve3((controlValue[j] - lowerCurve) / (upperCurve - lowerCurve));
+                    out[i + j] = LinearInterp(lowValue[j], highValue[j], alpha);
+                }
+            }
+        }
+        else
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                out[i + j] = (controlValue[j] < threshold) ? lowValue[j] : highValue[j];
+            }
+        }
+    }
+}
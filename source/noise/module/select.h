@@ -74,6 +74,14 @@ namespace noise
         /// smooth the transition, pass a non-zero value to the SetEdgeFalloff()
         /// method.  Higher values result in a smoother transition.
         ///
+        /// This noise module only evaluates the source modules that contribute
+        /// to its output value: both of them within the transition, and only
+        /// the selected one elsewhere.  The getValues() method partitions each
+        /// batch of input values accordingly, and evaluates each source module
+        /// in one batch over the input values that need it.  If the threshold
+        /// and the edge falloff are constant, the getValues() method tests
+        /// the falloff once per call rather than once per input value.
+        ///
         /// This noise module requires three source modules.
         class Select : public ModuleBase
         {
@@ -196,7 +204,16 @@ namespace noise
 
             virtual double getValue(double x, double y, double z) const override;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const override;
+
         protected:
+            /// Generates the output values for a batch of input values when the
+            /// threshold and the edge falloff are constant.
+            ///
+            /// The output values are the same as those of the general
+            /// getValues() path.
+            void getValuesWithConstantThreshold(const double* xs, const double* ys, const double* zs, double* out, size_t count) const;
+
             noise::ScalarParameter m_low;
             noise::ScalarParameter m_high;
             noise::ScalarParameter m_control;
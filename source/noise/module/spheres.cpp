@@ -43,3 +43,11 @@ double Spheres::getValue(double x, double y, double z) const
     double nearestDist = GetMin(distFromSmallerSphere, distFromLargerSphere);
     return 1.0 - (nearestDist * 4.0); // Puts it in the -1.0 to +1.0 range.
 }
+
+void Spheres::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = Spheres::getValue(xs[i], ys[i], zs[i]);
+    }
+}
@@ -90,6 +90,8 @@ namespace noise
 
             virtual double getValue(double x, double y, double z) const;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const;
+
             /// Sets the frequenct of the concentric spheres.
             ///
             /// @param frequency The frequency of the concentric spheres.
@@ -49,6 +49,7 @@ void Terrace::AddControlPoint(double value)
     // value.
     int insertionPos = FindInsertionPos(value);
     InsertAtPos(insertionPos, value);
+    m_controlPointTable.build(m_pControlPoints, m_controlPointCount);
 }
 
 void Terrace::ClearAllControlPoints()
@@ -56,6 +57,7 @@ void Terrace::ClearAllControlPoints()
     delete[] m_pControlPoints;
     m_pControlPoints = NULL;
     m_controlPointCount = 0;
+    m_controlPointTable.build(m_pControlPoints, m_controlPointCount);
 }
 
 int Terrace::FindInsertionPos(double value)
@@ -84,19 +86,26 @@ double Terrace::getValue(double x, double y, double z) const
     assert(m_pSourceModule[0] != NULL);
     assert(m_controlPointCount >= 2);
 
-    // Get the output value from the source module.
-    double sourceModuleValue = m_pSourceModule[0]->getValue(x, y, z);
+    return MapValue(m_pSourceModule[0]->getValue(x, y, z));
+}
 
-    // Find the first element in the control point array that has a value
-    // larger than the output value from the source module.
-    int indexPos;
-    for (indexPos = 0; indexPos < m_controlPointCount; indexPos++)
+void Terrace::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    assert(m_pSourceModule[0] != NULL);
+    assert(m_controlPointCount >= 2);
+
+    m_pSourceModule[0]->getValues(xs, ys, zs, out, count);
+    for (size_t i = 0; i < count; i++)
     {
-        if (sourceModuleValue < m_pControlPoints[indexPos])
-        {
-            break;
-        }
+        out[i] = MapValue(out[i]);
     }
+}
+
+double Terrace::MapValue(double sourceModuleValue) const
+{
+    // Find the first element in the control point array that has a value
+    // larger than the output value from the source module.
+    int indexPos = m_controlPointTable.findUpperBound(sourceModuleValue);
 
     // Find the two nearest control points so that we can map their values
     // onto a quadratic curve.
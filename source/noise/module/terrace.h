@@ -23,6 +23,7 @@
 #ifndef NOISE_MODULE_TERRACE_H
 #define NOISE_MODULE_TERRACE_H
 
+#include "../intervaltable.h"
 #include "modulebase.h"
 
 namespace noise
@@ -69,6 +70,11 @@ namespace noise
         /// This noise module is often used to generate terrain features such as
         /// your stereotypical desert canyon.
         ///
+        /// The control points are stored in a lookup table that finds the two
+        /// control points that surround an output value from the source module
+        /// in constant time, so mapping a value costs about the same for any
+        /// number of control points.
+        ///
         /// This noise module requires one source module.
         class Terrace : public ModuleBase
         {
@@ -155,6 +161,8 @@ namespace noise
 
             virtual double getValue(double x, double y, double z) const;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const;
+
             /// Creates a number of equally-spaced control points that range from
             /// -1 to +1.
             ///
@@ -175,6 +183,17 @@ namespace noise
             void MakeControlPoints(int controlPointCount);
 
         protected:
+            /// Maps an output value from the source module onto the terrace-
+            /// forming curve.
+            ///
+            /// @param sourceModuleValue The output value from the source module.
+            ///
+            /// @returns The mapped value.
+            ///
+            /// @pre The number of control points must be greater than or equal
+            /// to 2.
+            double MapValue(double sourceModuleValue) const;
+
             /// Determines the array index in which to insert the control point
             /// into the internal control point array.
             ///
@@ -219,6 +238,9 @@ namespace noise
 
             /// Array that stores the control points.
             double* m_pControlPoints;
+
+            /// Lookup table of the control points.
+            IntervalTable m_controlPointTable;
         };
 
         /// @}
@@ -0,0 +1,301 @@
+// threadcache.cpp
+//
+// Copyright (C) 2019, 2020 zjhlogo
+//
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or (at
+// your option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License (COPYING.txt) for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+// The developer's email is zjhlogo@gmzigail.com (for great email, take
+// off every 'zig'.)
+//
+
+#include "threadcache.h"
+
+#include "../misc.h"
+
+#include <mutex>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+using namespace noise::module;
+
+namespace
+{
+
+    // Hands out thread slot indices and recycles the indices of threads that
+    // have exited.
+    class ThreadSlotRegistry
+    {
+    public:
+        int Acquire()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_freeSlots.empty())
+            {
+                int slot = m_freeSlots.back();
+                m_freeSlots.pop_back();
+                return slot;
+            }
+            if (m_nextSlot < THREAD_CACHE_MAX_THREAD_COUNT)
+            {
+                return m_nextSlot++;
+            }
+            return -1;
+        }
+
+        void Release(int slot)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_freeSlots.push_back(slot);
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::vector<int> m_freeSlots;
+        int m_nextSlot = 0;
+    };
+
+    ThreadSlotRegistry& GetThreadSlotRegistry()
+    {
+        static ThreadSlotRegistry registry;
+        return registry;
+    }
+
+    // Owns the slot index of the calling thread for the lifetime of that
+    // thread.
+    struct ThreadSlot
+    {
+        ThreadSlot()
+            : index(GetThreadSlotRegistry().Acquire())
+        {
+        }
+
+        ~ThreadSlot()
+        {
+            if (index >= 0)
+            {
+                GetThreadSlotRegistry().Release(index);
+            }
+        }
+
+        int index;
+    };
+
+    int GetThreadSlot()
+    {
+        thread_local ThreadSlot slot;
+        return slot.index;
+    }
+
+    uint64_t GetBits(double value)
+    {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+} // namespace
+
+// A slot that is reused by a new thread keeps the entries of the thread that
+// owned it before; they are still valid because output values only depend on
+// the input value.
+struct ThreadCache::Table
+{
+    struct Entry
+    {
+        uint64_t x, y, z;
+        double value;
+    };
+
+    Table(int setCount)
+        : entries(setCount * THREAD_CACHE_WAY_COUNT)
+        , isValid(setCount * THREAD_CACHE_WAY_COUNT, 0)
+        , nextWay(setCount, 0)
+        , setMask((uint64_t)setCount - 1)
+    {
+    }
+
+    // Returns the index of the first entry of the set that stores the
+    // specified input value.
+    size_t GetSetBase(uint64_t x, uint64_t y, uint64_t z) const
+    {
+        uint64_t hash = x * 0x9e3779b97f4a7c15ull;
+        hash ^= y * 0xc2b2ae3d27d4eb4full;
+        hash ^= z * 0x165667b19e3779f9ull;
+        hash ^= hash >> 32;
+        return (size_t)(hash & setMask) * THREAD_CACHE_WAY_COUNT;
+    }
+
+    bool Find(size_t setBase, uint64_t x, uint64_t y, uint64_t z, double& value) const
+    {
+        for (int way = 0; way < THREAD_CACHE_WAY_COUNT; way++)
+        {
+            const Entry& entry = entries[setBase + way];
+            if (isValid[setBase + way] && entry.x == x && entry.y == y && entry.z == z)
+            {
+                value = entry.value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Stores an output value, replacing the entries of the set in a
+    // round-robin order.
+    void Insert(size_t setBase, uint64_t x, uint64_t y, uint64_t z, double value)
+    {
+        uint8& way = nextWay[setBase / THREAD_CACHE_WAY_COUNT];
+        Entry& entry = entries[setBase + way];
+        entry.x = x;
+        entry.y = y;
+        entry.z = z;
+        entry.value = value;
+        isValid[setBase + way] = 1;
+        way = (uint8)((way + 1) % THREAD_CACHE_WAY_COUNT);
+    }
+
+    std::vector<Entry> entries;
+    std::vector<uint8> isValid;
+    std::vector<uint8> nextWay;
+    uint64_t setMask;
+};
+
+ThreadCache::ThreadCache(int setCount)
+    : ModuleBase(1)
+    , m_setCount(setCount)
+{
+    if (setCount <= 0 || (setCount & (setCount - 1)) != 0)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    for (int i = 0; i < THREAD_CACHE_MAX_THREAD_COUNT; i++)
+    {
+        m_pTables[i] = NULL;
+    }
+}
+
+ThreadCache::~ThreadCache()
+{
+    clear();
+}
+
+void ThreadCache::clear()
+{
+    for (int i = 0; i < THREAD_CACHE_MAX_THREAD_COUNT; i++)
+    {
+        delete m_pTables[i].exchange(NULL);
+    }
+}
+
+ThreadCache::Table* ThreadCache::getTable() const
+{
+    int slot = GetThreadSlot();
+    if (slot < 0)
+    {
+        return NULL;
+    }
+
+    // Only the thread that owns the slot stores a table into it.
+    Table* pTable = m_pTables[slot].load(std::memory_order_acquire);
+    if (pTable == NULL)
+    {
+        pTable = new Table(m_setCount);
+        m_pTables[slot].store(pTable, std::memory_order_release);
+    }
+    return pTable;
+}
+
+double ThreadCache::getValue(double x, double y, double z) const
+{
+    assert(m_pSourceModule[0] != NULL);
+
+    Table* pTable = getTable();
+    if (pTable == NULL)
+    {
+        return m_pSourceModule[0]->getValue(x, y, z);
+    }
+
+    uint64_t xBits = GetBits(x);
+    uint64_t yBits = GetBits(y);
+    uint64_t zBits = GetBits(z);
+    size_t setBase = pTable->GetSetBase(xBits, yBits, zBits);
+    double value;
+    if (!pTable->Find(setBase, xBits, yBits, zBits, value))
+    {
+        value = m_pSourceModule[0]->getValue(x, y, z);
+        pTable->Insert(setBase, xBits, yBits, zBits, value);
+    }
+    return value;
+}
+
+void ThreadCache::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    assert(m_pSourceModule[0] != NULL);
+
+    Table* pTable = getTable();
+    if (pTable == NULL)
+    {
+        m_pSourceModule[0]->getValues(xs, ys, zs, out, count);
+        return;
+    }
+
+    // Look up each input value, then evaluate all of the misses of a chunk in
+    // one batch.
+    double missX[MAX_BATCH_SIZE];
+    double missY[MAX_BATCH_SIZE];
+    double missZ[MAX_BATCH_SIZE];
+    double missValues[MAX_BATCH_SIZE];
+    size_t missIndices[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        size_t missCount = 0;
+        for (size_t j = 0; j < n; j++)
+        {
+            uint64_t xBits = GetBits(xs[i + j]);
+            uint64_t yBits = GetBits(ys[i + j]);
+            uint64_t zBits = GetBits(zs[i + j]);
+            size_t setBase = pTable->GetSetBase(xBits, yBits, zBits);
+            if (!pTable->Find(setBase, xBits, yBits, zBits, out[i + j]))
+            {
+                missX[missCount] = xs[i + j];
+                missY[missCount] = ys[i + j];
+                missZ[missCount] = zs[i + j];
+                missIndices[missCount] = i + j;
+                missCount++;
+            }
+        }
+
+        if (missCount > 0)
+        {
+            m_pSourceModule[0]->getValues(missX, missY, missZ, missValues, missCount);
+            for (size_t j = 0; j < missCount; j++)
+            {
+                uint64_t xBits = GetBits(missX[j]);
+                uint64_t yBits = GetBits(missY[j]);
+                uint64_t zBits = GetBits(missZ[j]);
+                pTable->Insert(pTable->GetSetBase(xBits, yBits, zBits), xBits, yBits, zBits, missValues[j]);
+                out[missIndices[j]] = missValues[j];
+            }
+        }
+    }
+}
+
+void ThreadCache::setSourceModule(int index, const ModuleBase& sourceModule)
+{
+    ModuleBase::setSourceModule(index, sourceModule);
+    clear();
+}
@@ -0,0 +1,151 @@
+// threadcache.h
+//
+// Copyright (C) 2019, 2020 zjhlogo
+//
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or (at
+// your option) any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+// License (COPYING.txt) for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+// The developer's email is zjhlogo@gmzigail.com (for great email, take
+// off every 'zig'.)
+//
+
+#ifndef NOISE_MODULE_THREADCACHE_H
+#define NOISE_MODULE_THREADCACHE_H
+
+#include "modulebase.h"
+
+#include <atomic>
+
+namespace noise
+{
+
+    namespace module
+    {
+
+        /// @addtogroup libnoise
+        /// @{
+
+        /// @addtogroup modules
+        /// @{
+
+        /// @addtogroup miscmodules
+        /// @{
+
+        /// Default number of sets in the cache table of the
+        /// noise::module::ThreadCache noise module.
+        const int DEFAULT_THREAD_CACHE_SET_COUNT = 256;
+
+        /// Number of entries in each set of the cache table of the
+        /// noise::module::ThreadCache noise module.
+        const int THREAD_CACHE_WAY_COUNT = 4;
+
+        /// Maximum number of threads that can own a cache table of a
+        /// noise::module::ThreadCache noise module at the same time.
+        const int THREAD_CACHE_MAX_THREAD_COUNT = 256;
+
+        /// Noise module that caches the output values generated by a source
+        /// module, and that can be evaluated from several threads at once.
+        ///
+        /// This noise module serves the same purpose as the
+        /// noise::module::Cache noise module: if a source module is used by
+        /// multiple noise modules, caching it prevents the source module from
+        /// calculating the same output value once for each of those noise
+        /// modules.
+        ///
+        /// Unlike noise::module::Cache, each thread that calls the getValue()
+        /// or getValues() method has its own cache table, so no
+        /// synchronization is required and a noise module graph containing
+        /// this noise module can be rendered in parallel.  Each table stores
+        /// several recently generated output values in a set-associative
+        /// layout: the input value selects a set of THREAD_CACHE_WAY_COUNT
+        /// entries, and a cached output value is only returned if its input
+        /// value is exactly equal to the requested input value.
+        ///
+        /// A cache table is allocated for a thread the first time it uses this
+        /// noise module; threads that exit release their slot for reuse.  If
+        /// more than THREAD_CACHE_MAX_THREAD_COUNT threads are active, the
+        /// extra threads evaluate the source module directly.
+        ///
+        /// If an application passes a new source module to the
+        /// setSourceModule() method, or calls the clear() method, all cache
+        /// tables are invalidated.  These methods must not be called while
+        /// another thread evaluates this noise module.
+        ///
+        /// This noise module requires one source module.
+        class ThreadCache : public ModuleBase
+        {
+
+        public:
+            /// Constructor.
+            ///
+            /// @param setCount The number of sets in each cache table.
+            ///
+            /// @pre The set count is a positive power of two.
+            ///
+            /// @throw noise::ExceptionInvalidParam An invalid parameter was
+            /// specified; see the preconditions for more information.
+            ///
+            /// The default number of sets is set to
+            /// noise::module::DEFAULT_THREAD_CACHE_SET_COUNT.
+            ThreadCache(int setCount = DEFAULT_THREAD_CACHE_SET_COUNT);
+
+            /// Destructor.
+            virtual ~ThreadCache();
+
+            /// Invalidates the cache tables of all threads.
+            void clear();
+
+            /// Returns the number of sets in each cache table.
+            ///
+            /// @returns The number of sets in each cache table.
+            int getSetCount() const
+            {
+                return m_setCount;
+            }
+
+            virtual double getValue(double x, double y, double z) const override;
+
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const override;
+
+            virtual void setSourceModule(int index, const ModuleBase& sourceModule) override;
+
+        protected:
+            /// Per-thread cache table, defined in threadcache.cpp.
+            struct Table;
+
+            /// Returns the cache table of the calling thread, allocating it if
+            /// necessary.
+            ///
+            /// @returns The cache table, or NULL if the calling thread does not
+            /// own a cache table slot.
+            Table* getTable() const;
+
+            /// Number of sets in each cache table.
+            int m_setCount;
+
+            /// The cache table of each thread slot.
+            mutable std::atomic<Table*> m_pTables[THREAD_CACHE_MAX_THREAD_COUNT];
+        };
+
+        /// @}
+
+        /// @}
+
+        /// @}
+
+    } // namespace module
+
+} // namespace noise
+
+#endif
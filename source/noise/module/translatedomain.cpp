@@ -22,6 +22,8 @@
 
 #include "translatedomain.h"
 
+#include "../misc.h"
+
 using namespace noise::module;
 
 TranslateDomain::TranslateDomain(const noise::ScalarParameter& src)
@@ -77,6 +79,11 @@ void TranslateDomain::SetTranslation(const noise::ScalarParameter& xTranslation,
     m_zTranslation = zTranslation;
 }
 
+const noise::ScalarParameter& TranslateDomain::getSource() const
+{
+    return m_source;
+}
+
 double TranslateDomain::getValue(double x, double y, double z) const
 {
     double finalX = x + m_xTranslation.getValue(x, y, z);
@@ -85,3 +92,24 @@ double TranslateDomain::getValue(double x, double y, double z) const
 
     return m_source.getValue(finalX, finalY, finalZ);
 }
+
+void TranslateDomain::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    double finalX[MAX_BATCH_SIZE];
+    double finalY[MAX_BATCH_SIZE];
+    double finalZ[MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+        m_xTranslation.getValues(xs + i, ys + i, zs + i, finalX, n);
+        m_yTranslation.getValues(xs + i, ys + i, zs + i, finalY, n);
+        m_zTranslation.getValues(xs + i, ys + i, zs + i, finalZ, n);
+        for (size_t j = 0; j < n; j++)
+        {
+            finalX[j] = xs[i + j] + finalX[j];
+            finalY[j] = ys[i + j] + finalY[j];
+            finalZ[j] = zs[i + j] + finalZ[j];
+        }
+        m_source.getValues(finalX, finalY, finalZ, out + i, n);
+    }
+}
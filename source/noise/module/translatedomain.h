@@ -149,8 +149,16 @@ namespace noise
             /// output value from the source module
             void SetTranslation(const noise::ScalarParameter& xTranslation, const noise::ScalarParameter& yTranslation, const noise::ScalarParameter& zTranslation);
 
+            /// Returns the source module that this noise module evaluates at the
+            /// translated input value.
+            ///
+            /// @returns The source module, or a constant value.
+            const noise::ScalarParameter& getSource() const;
+
             virtual double getValue(double x, double y, double z) const override;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const override;
+
         protected:
             noise::ScalarParameter m_source;
 
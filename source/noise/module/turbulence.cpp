@@ -22,8 +22,22 @@
 
 #include "turbulence.h"
 
+#include "../misc.h"
+
 using namespace noise::module;
 
+namespace
+{
+
+    // Offsets added to the input value before it is passed to each of the
+    // three Perlin-noise modules; see Turbulence::getValue().
+    const double DISTORT_OFFSETS[3][3] = {
+        {12414.0 / 65536.0, 65124.0 / 65536.0, 31337.0 / 65536.0},
+        {26519.0 / 65536.0, 18128.0 / 65536.0, 60493.0 / 65536.0},
+        {53820.0 / 65536.0, 11213.0 / 65536.0, 44845.0 / 65536.0}};
+
+} // namespace
+
 Turbulence::Turbulence(const noise::ScalarParameter& src)
     : m_source(src)
     , m_power(DEFAULT_TURBULENCE_POWER)
@@ -95,8 +109,20 @@ int Turbulence::getSeed() const
     return m_xDistortModule.getSeed();
 }
 
+const noise::ScalarParameter& Turbulence::getSource() const
+{
+    return m_source;
+}
+
 double Turbulence::getValue(double x, double y, double z) const
 {
+    // Distorting the input value of a constant source does not change its
+    // output value.
+    if (m_source.isConstant())
+    {
+        return m_source.getConstValue();
+    }
+
     // Get the values from the three noise::module::Perlin noise modules and
     // add each value to each coordinate of the input value.  There are also
     // some offsets added to the coordinates of the input values.  This prevents
@@ -104,23 +130,134 @@ double Turbulence::getValue(double x, double y, double z) const
     // when multiplied by the frequency, are near an integer boundary.  This is
     // due to a property of gradient coherent noise, which returns zero at
     // integer boundaries.
-    double x0, y0, z0;
-    double x1, y1, z1;
-    double x2, y2, z2;
-    x0 = x + (12414.0 / 65536.0);
-    y0 = y + (65124.0 / 65536.0);
-    z0 = z + (31337.0 / 65536.0);
-    x1 = x + (26519.0 / 65536.0);
-    y1 = y + (18128.0 / 65536.0);
-    z1 = z + (60493.0 / 65536.0);
-    x2 = x + (53820.0 / 65536.0);
-    y2 = y + (11213.0 / 65536.0);
-    z2 = z + (44845.0 / 65536.0);
-    double xDistort = x + (m_xDistortModule.getValue(x0, y0, z0) * m_power);
-    double yDistort = y + (m_yDistortModule.getValue(x1, y1, z1) * m_power);
-    double zDistort = z + (m_zDistortModule.getValue(x2, y2, z2) * m_power);
+    double distortion[3];
+    getDistortion(x, y, z, distortion);
+    double xDistort = x + (distortion[0] * m_power);
+    double yDistort = y + (distortion[1] * m_power);
+    double zDistort = z + (distortion[2] * m_power);
 
     // Retrieve the output value at the offsetted input value instead of the
     // original input value.
     return m_source.getValue(xDistort, yDistort, zDistort);
 }
+
+void Turbulence::getDistortion(double x, double y, double z, double distortion[3]) const
+{
+    // This is the octave loop of Perlin::getValue(), run for the three
+    // Perlin-noise modules at once.
+    double frequency = m_xDistortModule.getFrequency();
+    double lacunarity = m_xDistortModule.getLacunarity();
+    double persistence = m_xDistortModule.getPersistence();
+    int octaveCount = m_xDistortModule.getOctaveCount();
+    noise::NoiseQuality noiseQuality = m_xDistortModule.getNoiseQuality();
+    int seeds[3] = {m_xDistortModule.getSeed(), m_yDistortModule.getSeed(), m_zDistortModule.getSeed()};
+
+    double nx[3], ny[3], nz[3];
+    for (int i = 0; i < 3; i++)
+    {
+        nx[i] = (x + DISTORT_OFFSETS[i][0]) * frequency;
+        ny[i] = (y + DISTORT_OFFSETS[i][1]) * frequency;
+        nz[i] = (z + DISTORT_OFFSETS[i][2]) * frequency;
+        distortion[i] = 0.0;
+    }
+
+    double curPersistence = 1.0;
+    for (int curOctave = 0; curOctave < octaveCount; curOctave++)
+    {
+        double mx[3], my[3], mz[3];
+        int octaveSeeds[3];
+        for (int i = 0; i < 3; i++)
+        {
+            mx[i] = MakeInt32Range(nx[i]);
+            my[i] = MakeInt32Range(ny[i]);
+            mz[i] = MakeInt32Range(nz[i]);
+            octaveSeeds[i] = (seeds[i] + curOctave) & 0xffffffff;
+        }
+
+        double signals[3];
+        GradientCoherentNoise3DTriple(mx, my, mz, octaveSeeds, signals, noiseQuality);
+        for (int i = 0; i < 3; i++)
+        {
+            distortion[i] += signals[i] * curPersistence;
+
+            // Prepare the next octave.
+            nx[i] *= lacunarity;
+            ny[i] *= lacunarity;
+            nz[i] *= lacunarity;
+        }
+        curPersistence *= persistence;
+    }
+}
+
+void Turbulence::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    if (m_source.isConstant())
+    {
+        m_source.getValues(xs, ys, zs, out, count);
+        return;
+    }
+
+    double frequency = m_xDistortModule.getFrequency();
+    double lacunarity = m_xDistortModule.getLacunarity();
+    double persistence = m_xDistortModule.getPersistence();
+    int octaveCount = m_xDistortModule.getOctaveCount();
+    noise::NoiseQuality noiseQuality = m_xDistortModule.getNoiseQuality();
+    int seeds[3] = {m_xDistortModule.getSeed(), m_yDistortModule.getSeed(), m_zDistortModule.getSeed()};
+
+    double nx[3][MAX_BATCH_SIZE], ny[3][MAX_BATCH_SIZE], nz[3][MAX_BATCH_SIZE];
+    double mx[MAX_BATCH_SIZE], my[MAX_BATCH_SIZE], mz[MAX_BATCH_SIZE];
+    double signals[MAX_BATCH_SIZE];
+    double distortion[3][MAX_BATCH_SIZE];
+    for (size_t i = 0; i < count; i += MAX_BATCH_SIZE)
+    {
+        size_t n = GetMin(count - i, MAX_BATCH_SIZE);
+
+        // See getValue() for the reason behind these offsets.
+        for (int axis = 0; axis < 3; axis++)
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                nx[axis][j] = (xs[i + j] + DISTORT_OFFSETS[axis][0]) * frequency;
+                ny[axis][j] = (ys[i + j] + DISTORT_OFFSETS[axis][1]) * frequency;
+                nz[axis][j] = (zs[i + j] + DISTORT_OFFSETS[axis][2]) * frequency;
+                distortion[axis][j] = 0.0;
+            }
+        }
+
+        // Run the octave loop of Perlin::getValues() for the three
+        // Perlin-noise modules at once.
+        double curPersistence = 1.0;
+        for (int curOctave = 0; curOctave < octaveCount; curOctave++)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                for (size_t j = 0; j < n; j++)
+                {
+                    mx[j] = MakeInt32Range(nx[axis][j]);
+                    my[j] = MakeInt32Range(ny[axis][j]);
+                    mz[j] = MakeInt32Range(nz[axis][j]);
+                }
+                int seed = (seeds[axis] + curOctave) & 0xffffffff;
+                GradientCoherentNoise3D(mx, my, mz, signals, n, seed, noiseQuality);
+                for (size_t j = 0; j < n; j++)
+                {
+                    distortion[axis][j] += signals[j] * curPersistence;
+
+                    // Prepare the next octave.
+                    nx[axis][j] *= lacunarity;
+                    ny[axis][j] *= lacunarity;
+                    nz[axis][j] *= lacunarity;
+                }
+            }
+            curPersistence *= persistence;
+        }
+
+        for (size_t j = 0; j < n; j++)
+        {
+            distortion[0][j] = xs[i + j] + (distortion[0][j] * m_power);
+            distortion[1][j] = ys[i + j] + (distortion[1][j] * m_power);
+            distortion[2][j] = zs[i + j] + (distortion[2][j] * m_power);
+        }
+        m_source.getValues(distortion[0], distortion[1], distortion[2], out + i, n);
+    }
+}
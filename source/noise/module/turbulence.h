@@ -107,7 +107,11 @@ namespace noise
         ///
         /// Internally, there are three noise::module::Perlin noise modules
         /// that displace the input value; one for the @a x, one for the @a y,
-        /// and one for the @a z coordinate.
+        /// and one for the @a z coordinate.  If the source is a constant, these
+        /// noise modules are not evaluated.  Otherwise, the three
+        /// displacements are generated together, in one octave loop, rather
+        /// than by evaluating the three noise modules one after the other;
+        /// the output values are the same.
         ///
         /// This noise module requires one source module.
         class Turbulence : public ModuleBase
@@ -211,9 +215,53 @@ namespace noise
             /// and one for the @a z coordinate.
             int getSeed() const;
 
+            /// Returns the source module that this noise module evaluates at the
+            /// distorted input value.
+            ///
+            /// @returns The source module, or a constant value.
+            const noise::ScalarParameter& getSource() const;
+
+            /// Returns the Perlin-noise module that distorts the @a x
+            /// coordinate of the input value.
+            const Perlin& getXDistortModule() const
+            {
+                return m_xDistortModule;
+            }
+
+            /// Returns the Perlin-noise module that distorts the @a y
+            /// coordinate of the input value.
+            const Perlin& getYDistortModule() const
+            {
+                return m_yDistortModule;
+            }
+
+            /// Returns the Perlin-noise module that distorts the @a z
+            /// coordinate of the input value.
+            const Perlin& getZDistortModule() const
+            {
+                return m_zDistortModule;
+            }
+
             virtual double getValue(double x, double y, double z) const override;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const override;
+
         protected:
+            /// Generates the displacements of the @a x, @a y and @a z
+            /// coordinates of an input value.
+            ///
+            /// @param x The @a x coordinate of the input value.
+            /// @param y The @a y coordinate of the input value.
+            /// @param z The @a z coordinate of the input value.
+            /// @param distortion The array that receives the output values of
+            /// the three Perlin-noise modules, before they are scaled by the
+            /// power.
+            ///
+            /// The three Perlin-noise modules have the same parameters except
+            /// for their seeds, so a single octave loop generates the output
+            /// values of all three.
+            void getDistortion(double x, double y, double z, double distortion[3]) const;
+
             noise::ScalarParameter m_source;
 
             /// The power (scale) of the displacement.
@@ -24,6 +24,8 @@
 
 #include "../mathconsts.h"
 
+#include <vector>
+
 using namespace noise::module;
 
 Voronoi::Voronoi()
@@ -35,57 +37,257 @@ Voronoi::Voronoi()
 {
 }
 
-double Voronoi::getValue(double x, double y, double z) const
+namespace
 {
-    // This method could be more efficient by caching the seed values.  Fix
-    // later.
 
-    x *= m_frequency;
-    y *= m_frequency;
-    z *= m_frequency;
+    // Position of the seed point inside of a unit cube.
+    struct SeedPoint
+    {
+        double x, y, z;
+    };
+
+    // Calculates the position of the seed point inside of a unit cube.
+    inline SeedPoint MakeSeedPoint(int xCur, int yCur, int zCur, int seed)
+    {
+        SeedPoint point;
+        point.x = xCur + noise::ValueNoise3D(xCur, yCur, zCur, seed);
+        point.y = yCur + noise::ValueNoise3D(xCur, yCur, zCur, seed + 1);
+        point.z = zCur + noise::ValueNoise3D(xCur, yCur, zCur, seed + 2);
+        return point;
+    }
+
+    // Generates the seed point of each unit cube on demand.
+    class SeedPointGenerator
+    {
+    public:
+        explicit SeedPointGenerator(int seed)
+            : m_seed(seed)
+        {
+        }
+
+        SeedPoint get(int xCur, int yCur, int zCur)
+        {
+            return MakeSeedPoint(xCur, yCur, zCur, m_seed);
+        }
 
-    int xInt = (x > 0.0 ? (int)x : (int)x - 1);
-    int yInt = (y > 0.0 ? (int)y : (int)y - 1);
-    int zInt = (z > 0.0 ? (int)z : (int)z - 1);
+    private:
+        int m_seed;
+    };
 
-    double minDist = 2147483647.0;
-    double xCandidate = 0;
-    double yCandidate = 0;
-    double zCandidate = 0;
+    // Number of entries in a SeedPointCache; a power of two.
+    const int SEED_POINT_CACHE_SIZE = 1024;
 
-    // Inside each unit cube, there is a seed point at a random position.  Go
-    // through each of the nearby cubes until we find a cube with a seed point
-    // that is closest to the specified position.
-    for (int zCur = zInt - 2; zCur <= zInt + 2; zCur++)
+    // Direct-mapped cache of the seed points of recently visited unit cubes.
+    // Input values that are close together share most of the unit cubes they
+    // search, so each seed point is generated once for a batch of input
+    // values instead of once per input value.
+    //
+    // The entries belong to the calling thread and are allocated on its
+    // first batch.  They stay valid from one batch to the next, because a
+    // seed point only depends on its unit cube and the seed.
+    class SeedPointCache
+    {
+    public:
+        explicit SeedPointCache(int seed)
+            : m_pEntries(GetThreadEntries())
+            , m_seed(seed)
+        {
+        }
+
+        SeedPoint get(int xCur, int yCur, int zCur)
+        {
+            unsigned int hash = (unsigned int)xCur * 1619u ^ (unsigned int)yCur * 31337u ^ (unsigned int)zCur * 6971u;
+            Entry& entry = m_pEntries[hash & (SEED_POINT_CACHE_SIZE - 1)];
+            if (!entry.isValid || entry.x != xCur || entry.y != yCur || entry.z != zCur || entry.seed != m_seed)
+            {
+                entry.point = MakeSeedPoint(xCur, yCur, zCur, m_seed);
+                entry.x = xCur;
+                entry.y = yCur;
+                entry.z = zCur;
+                entry.seed = m_seed;
+                entry.isValid = true;
+            }
+            return entry.point;
+        }
+
+    private:
+        struct Entry
+        {
+            SeedPoint point;
+            int x, y, z;
+            int seed;
+            bool isValid = false;
+        };
+
+        static Entry* GetThreadEntries()
+        {
+            thread_local std::vector<Entry> entries;
+            if (entries.empty())
+            {
+                entries.resize(SEED_POINT_CACHE_SIZE);
+            }
+            return entries.data();
+        }
+
+        Entry* m_pEntries;
+        int m_seed;
+    };
+
+    // Returns a lower bound of the distance along one axis between an input
+    // coordinate and the seed point of a unit cube.  The seed point of the
+    // unit cube at cur lies between cur - 1 and cur + 1, because
+    // noise::ValueNoise3D() returns values between -1 and +1.
+    inline double GetAxisDistBound(int cur, double value)
+    {
+        double below = ((double)cur - 1.0) - value;
+        if (below > 0.0)
+        {
+            return below;
+        }
+        double above = value - ((double)cur + 1.0);
+        return above > 0.0 ? above : 0.0;
+    }
+
+    // Finds the seed point closest to the specified position, which has
+    // already been scaled by the frequency.
+    //
+    // A seed point may lie up to two unit cubes away from the cube containing
+    // the position, so the cubes of a 5x5x5 neighborhood are candidates.  The
+    // 3x3x3 cubes around the position are searched first; the cubes of the
+    // outer shell are only searched if the lower bound of their distance does
+    // not exceed the closest distance found so far.  Equal distances are
+    // resolved in favor of the cube that comes first in z, y, x order, so the
+    // result is the same as the result of a full search in that order.
+    template <class SeedPointSource> SeedPoint FindNearestSeedPoint(double x, double y, double z, SeedPointSource& source)
     {
-        for (int yCur = yInt - 2; yCur <= yInt + 2; yCur++)
+        int xInt = (x > 0.0 ? (int)x : (int)x - 1);
+        int yInt = (y > 0.0 ? (int)y : (int)y - 1);
+        int zInt = (z > 0.0 ? (int)z : (int)z - 1);
+
+        double minDist = 2147483647.0;
+        int minOrder = 0;
+        SeedPoint candidate = {0.0, 0.0, 0.0};
+
+        for (int zOff = -1; zOff <= 1; zOff++)
+        {
+            for (int yOff = -1; yOff <= 1; yOff++)
+            {
+                for (int xOff = -1; xOff <= 1; xOff++)
+                {
+                    SeedPoint point = source.get(xInt + xOff, yInt + yOff, zInt + zOff);
+                    double xDist = point.x - x;
+                    double yDist = point.y - y;
+                    double zDist = point.z - z;
+                    double dist = xDist * xDist + yDist * yDist + zDist * zDist;
+                    if (dist < minDist)
+                    {
+                        minDist = dist;
+                        minOrder = ((zOff + 2) * 5 + (yOff + 2)) * 5 + (xOff + 2);
+                        candidate = point;
+                    }
+                }
+            }
+        }
+
+        // Squared lower bounds of the distance along each axis, indexed by the
+        // offset of the cube plus two.
+        double xBounds[5];
+        double yBounds[5];
+        double zBounds[5];
+        for (int off = -2; off <= 2; off++)
         {
-            for (int xCur = xInt - 2; xCur <= xInt + 2; xCur++)
+            double xBound = GetAxisDistBound(xInt + off, x);
+            double yBound = GetAxisDistBound(yInt + off, y);
+            double zBound = GetAxisDistBound(zInt + off, z);
+            xBounds[off + 2] = xBound * xBound;
+            yBounds[off + 2] = yBound * yBound;
+            zBounds[off + 2] = zBound * zBound;
+        }
+
+        // Skip whole planes and rows of cubes whose bound already exceeds the
+        // closest distance.  The small margin keeps rounding differences
+        // between a bound and an actual distance from pruning a cube whose
+        // seed point is exactly as close as the current candidate.
+        const double BOUND_MARGIN = 1.0 + 1.0e-12;
+        for (int zOff = -2; zOff <= 2; zOff++)
+        {
+            double zBound = zBounds[zOff + 2];
+            if (zBound > minDist * BOUND_MARGIN)
+            {
+                continue;
+            }
+
+            for (int yOff = -2; yOff <= 2; yOff++)
             {
+                double yzBound = yBounds[yOff + 2] + zBound;
+                if (yzBound > minDist * BOUND_MARGIN)
+                {
+                    continue;
+                }
 
-                // Calculate the position and distance to the seed point inside of
-                // this unit cube.
-                double xPos = xCur + ValueNoise3D(xCur, yCur, zCur, m_seed);
-                double yPos = yCur + ValueNoise3D(xCur, yCur, zCur, m_seed + 1);
-                double zPos = zCur + ValueNoise3D(xCur, yCur, zCur, m_seed + 2);
-                double xDist = xPos - x;
-                double yDist = yPos - y;
-                double zDist = zPos - z;
-                double dist = xDist * xDist + yDist * yDist + zDist * zDist;
-
-                if (dist < minDist)
+                // Only the two outer cubes of a row that crosses the inner
+                // 3x3x3 cubes are left to search.
+                bool isInnerRow = (yOff >= -1 && yOff <= 1 && zOff >= -1 && zOff <= 1);
+                int xStep = isInnerRow ? 4 : 1;
+                for (int xOff = -2; xOff <= 2; xOff += xStep)
                 {
-                    // This seed point is closer to any others found so far, so record
-                    // this seed point.
-                    minDist = dist;
-                    xCandidate = xPos;
-                    yCandidate = yPos;
-                    zCandidate = zPos;
+                    if (xBounds[xOff + 2] + yzBound > minDist * BOUND_MARGIN)
+                    {
+                        continue;
+                    }
+
+                    SeedPoint point = source.get(xInt + xOff, yInt + yOff, zInt + zOff);
+                    double xDist = point.x - x;
+                    double yDist = point.y - y;
+                    double zDist = point.z - z;
+                    double dist = xDist * xDist + yDist * yDist + zDist * zDist;
+                    int order = ((zOff + 2) * 5 + (yOff + 2)) * 5 + (xOff + 2);
+                    if (dist < minDist || (dist == minDist && order < minOrder))
+                    {
+                        minDist = dist;
+                        minOrder = order;
+                        candidate = point;
+                    }
                 }
             }
         }
+
+        return candidate;
     }
 
+} // namespace
+
+double Voronoi::getValue(double x, double y, double z) const
+{
+    x *= m_frequency;
+    y *= m_frequency;
+    z *= m_frequency;
+
+    // Inside each unit cube, there is a seed point at a random position.  Go
+    // through each of the nearby cubes until we find a cube with a seed point
+    // that is closest to the specified position.
+    SeedPointGenerator generator(m_seed);
+    SeedPoint candidate = FindNearestSeedPoint(x, y, z, generator);
+    return GetOutputValue(x, y, z, candidate.x, candidate.y, candidate.z);
+}
+
+void Voronoi::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
+{
+    // Share the seed points of the unit cubes among all input values of the
+    // batch.
+    SeedPointCache cache(m_seed);
+    for (size_t i = 0; i < count; i++)
+    {
+        double x = xs[i] * m_frequency;
+        double y = ys[i] * m_frequency;
+        double z = zs[i] * m_frequency;
+        SeedPoint candidate = FindNearestSeedPoint(x, y, z, cache);
+        out[i] = GetOutputValue(x, y, z, candidate.x, candidate.y, candidate.z);
+    }
+}
+
+double Voronoi::GetOutputValue(double x, double y, double z, double xCandidate, double yCandidate, double zCandidate) const
+{
     double value;
     if (m_enableDistance)
     {
@@ -173,6 +173,8 @@ namespace noise
 
             virtual double getValue(double x, double y, double z) const;
 
+            virtual void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const;
+
             /// Sets the displacement value of the Voronoi cells.
             ///
             /// @param displacement The displacement value of the Voronoi cells.
@@ -210,6 +212,21 @@ namespace noise
             }
 
         protected:
+            /// Calculates the output value from the nearest seed point.
+            ///
+            /// @param x The @a x coordinate of the input value, scaled by the
+            /// frequency.
+            /// @param y The @a y coordinate of the input value, scaled by the
+            /// frequency.
+            /// @param z The @a z coordinate of the input value, scaled by the
+            /// frequency.
+            /// @param xCandidate The @a x coordinate of the nearest seed point.
+            /// @param yCandidate The @a y coordinate of the nearest seed point.
+            /// @param zCandidate The @a z coordinate of the nearest seed point.
+            ///
+            /// @returns The output value.
+            double GetOutputValue(double x, double y, double z, double xCandidate, double yCandidate, double zCandidate) const;
+
             /// Scale of the random displacement to apply to each Voronoi cell.
             double m_displacement;
 
@@ -25,6 +25,17 @@
 #include "interp.h"
 #include "vectortable.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#    define NOISE_SIMD_X86
+#    define NOISE_TARGET(isa) __attribute__((target(isa)))
+#    include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#    define NOISE_SIMD_X86
+#    define NOISE_TARGET(isa)
+#    include <immintrin.h>
+#    include <intrin.h>
+#endif
+
 using namespace noise;
 
 // Specifies the version of the coherent-noise functions to use.
@@ -56,7 +67,112 @@ const int SEED_NOISE_GEN = 1013;
 const int SHIFT_NOISE_GEN = 8;
 #endif
 
-double noise::GradientCoherentNoise3D(double x, double y, double z, int seed, NoiseQuality noiseQuality)
+namespace
+{
+
+    // Maps the difference between the coordinate of an input value and the
+    // coordinate of the cube's outer-lower-left vertex onto an S-curve.
+    template <NoiseQuality noiseQuality>
+    inline double MapSCurve(double a)
+    {
+        switch (noiseQuality)
+        {
+        case QUALITY_STD:
+            return SCurve3(a);
+        case QUALITY_BEST:
+            return SCurve5(a);
+        default:
+            return a;
+        }
+    }
+
+    // Returns the derivative of MapSCurve() at the specified value.
+    template <NoiseQuality noiseQuality>
+    inline double MapSCurveDerivative(double a)
+    {
+        switch (noiseQuality)
+        {
+        case QUALITY_STD:
+            return 6.0 * a * (1.0 - a);
+        case QUALITY_BEST:
+            return 30.0 * a * a * (1.0 - a) * (1.0 - a);
+        default:
+            return 1.0;
+        }
+    }
+
+    // Randomly generates a gradient vector given the integer coordinates of an
+    // input value.  This implementation generates a random number and uses it
+    // as an index into a normalized-vector lookup table.
+    inline const double* GetGradientVector(int ix, int iy, int iz, int seed)
+    {
+        int vectorIndex = (X_NOISE_GEN * ix + Y_NOISE_GEN * iy + Z_NOISE_GEN * iz + SEED_NOISE_GEN * seed) & 0xffffffff;
+        vectorIndex ^= (vectorIndex >> SHIFT_NOISE_GEN);
+        vectorIndex &= 0xff;
+        return &g_randomVectors[vectorIndex << 2];
+    }
+
+    // Inlined body of GradientNoise3D().
+    inline double GradientNoise3DInline(double fx, double fy, double fz, int ix, int iy, int iz, int seed)
+    {
+        const double* pGradient = GetGradientVector(ix, iy, iz, seed);
+        double xvGradient = pGradient[0];
+        double yvGradient = pGradient[1];
+        double zvGradient = pGradient[2];
+
+        // Set up us another vector equal to the distance between the two vectors
+        // passed to this function.
+        double xvPoint = (fx - (double)ix);
+        double yvPoint = (fy - (double)iy);
+        double zvPoint = (fz - (double)iz);
+
+        // Now compute the dot product of the gradient vector with the distance
+        // vector.  The resulting value is gradient noise.  Apply a scaling value
+        // so that this noise value ranges from -1.0 to 1.0.
+        return ((xvGradient * xvPoint) + (yvGradient * yvPoint) + (zvGradient * zvPoint)) * 2.12;
+    }
+
+    // Gradient noise at a vertex of a unit-length cube, together with its
+    // gradient.
+    struct GradientNoiseSample
+    {
+        double value;
+        double dx;
+        double dy;
+        double dz;
+    };
+
+    // Same as GradientNoise3DInline(), but also returns the gradient of the
+    // noise value, which is the scaled gradient vector of the vertex.
+    inline GradientNoiseSample GradientNoise3DSampleInline(double fx, double fy, double fz, int ix, int iy, int iz, int seed)
+    {
+        const double* pGradient = GetGradientVector(ix, iy, iz, seed);
+        GradientNoiseSample sample;
+        sample.value = ((pGradient[0] * (fx - (double)ix)) + (pGradient[1] * (fy - (double)iy)) + (pGradient[2] * (fz - (double)iz))) * 2.12;
+        sample.dx = pGradient[0] * 2.12;
+        sample.dy = pGradient[1] * 2.12;
+        sample.dz = pGradient[2] * 2.12;
+        return sample;
+    }
+
+    // Interpolates two samples and their gradients along an axis, where @a a
+    // is the S-curve value along that axis.  The caller adds the slope of the
+    // S-curve times the difference of the two values to the derivative along
+    // that axis.
+    inline GradientNoiseSample LerpSample(const GradientNoiseSample& n0, const GradientNoiseSample& n1, double a)
+    {
+        GradientNoiseSample sample;
+        sample.value = LinearInterp(n0.value, n1.value, a);
+        sample.dx = LinearInterp(n0.dx, n1.dx, a);
+        sample.dy = LinearInterp(n0.dy, n1.dy, a);
+        sample.dz = LinearInterp(n0.dz, n1.dz, a);
+        return sample;
+    }
+
+} // namespace
+
+template <NoiseQuality noiseQuality>
+double noise::GradientCoherentNoise3D(double x, double y, double z, int seed)
 {
     // Create a unit-length cube aligned along an integer boundary.  This cube
     // surrounds the input point.
@@ -69,81 +185,993 @@ double noise::GradientCoherentNoise3D(double x, double y, double z, int seed, No
 
     // Map the difference between the coordinates of the input value and the
     // coordinates of the cube's outer-lower-left vertex onto an S-curve.
-    double xs = 0, ys = 0, zs = 0;
-    switch (noiseQuality)
-    {
-    case QUALITY_FAST:
-        xs = (x - (double)x0);
-        ys = (y - (double)y0);
-        zs = (z - (double)z0);
-        break;
-    case QUALITY_STD:
-        xs = SCurve3(x - (double)x0);
-        ys = SCurve3(y - (double)y0);
-        zs = SCurve3(z - (double)z0);
-        break;
-    case QUALITY_BEST:
-        xs = SCurve5(x - (double)x0);
-        ys = SCurve5(y - (double)y0);
-        zs = SCurve5(z - (double)z0);
-        break;
-    }
+    double xs = MapSCurve<noiseQuality>(x - (double)x0);
+    double ys = MapSCurve<noiseQuality>(y - (double)y0);
+    double zs = MapSCurve<noiseQuality>(z - (double)z0);
 
     // Now calculate the noise values at each vertex of the cube.  To generate
     // the coherent-noise value at the input point, interpolate these eight
     // noise values using the S-curve value as the interpolant (trilinear
     // interpolation.)
     double n0, n1, ix0, ix1, iy0, iy1;
-    n0 = GradientNoise3D(x, y, z, x0, y0, z0, seed);
-    n1 = GradientNoise3D(x, y, z, x1, y0, z0, seed);
+    n0 = GradientNoise3DInline(x, y, z, x0, y0, z0, seed);
+    n1 = GradientNoise3DInline(x, y, z, x1, y0, z0, seed);
     ix0 = LinearInterp(n0, n1, xs);
-    n0 = GradientNoise3D(x, y, z, x0, y1, z0, seed);
-    n1 = GradientNoise3D(x, y, z, x1, y1, z0, seed);
+    n0 = GradientNoise3DInline(x, y, z, x0, y1, z0, seed);
+    n1 = GradientNoise3DInline(x, y, z, x1, y1, z0, seed);
     ix1 = LinearInterp(n0, n1, xs);
     iy0 = LinearInterp(ix0, ix1, ys);
-    n0 = GradientNoise3D(x, y, z, x0, y0, z1, seed);
-    n1 = GradientNoise3D(x, y, z, x1, y0, z1, seed);
+    n0 = GradientNoise3DInline(x, y, z, x0, y0, z1, seed);
+    n1 = GradientNoise3DInline(x, y, z, x1, y0, z1, seed);
     ix0 = LinearInterp(n0, n1, xs);
-    n0 = GradientNoise3D(x, y, z, x0, y1, z1, seed);
-    n1 = GradientNoise3D(x, y, z, x1, y1, z1, seed);
+    n0 = GradientNoise3DInline(x, y, z, x0, y1, z1, seed);
+    n1 = GradientNoise3DInline(x, y, z, x1, y1, z1, seed);
     ix1 = LinearInterp(n0, n1, xs);
     iy1 = LinearInterp(ix0, ix1, ys);
 
     return LinearInterp(iy0, iy1, zs);
 }
 
+template double noise::GradientCoherentNoise3D<QUALITY_FAST>(double x, double y, double z, int seed);
+template double noise::GradientCoherentNoise3D<QUALITY_STD>(double x, double y, double z, int seed);
+template double noise::GradientCoherentNoise3D<QUALITY_BEST>(double x, double y, double z, int seed);
+
+template <NoiseQuality noiseQuality>
+double noise::GradientCoherentNoise3DAndGradient(double x, double y, double z, double& dx, double& dy, double& dz, int seed)
+{
+    // Same unit-length cube and S-curve values as GradientCoherentNoise3D(),
+    // together with the slopes of the S-curves.
+    int x0 = (x > 0.0 ? (int)x : (int)x - 1);
+    int x1 = x0 + 1;
+    int y0 = (y > 0.0 ? (int)y : (int)y - 1);
+    int y1 = y0 + 1;
+    int z0 = (z > 0.0 ? (int)z : (int)z - 1);
+    int z1 = z0 + 1;
+    double xs = MapSCurve<noiseQuality>(x - (double)x0);
+    double ys = MapSCurve<noiseQuality>(y - (double)y0);
+    double zs = MapSCurve<noiseQuality>(z - (double)z0);
+    double xSlope = MapSCurveDerivative<noiseQuality>(x - (double)x0);
+    double ySlope = MapSCurveDerivative<noiseQuality>(y - (double)y0);
+    double zSlope = MapSCurveDerivative<noiseQuality>(z - (double)z0);
+
+    // Calculate the noise values and their gradients at each vertex of the
+    // cube, and interpolate them in the same order as
+    // GradientCoherentNoise3D().  Interpolating along an axis also adds the
+    // slope of its S-curve times the difference of the two values to the
+    // derivative along that axis.
+    GradientNoiseSample n0, n1, ix0, ix1, iy0, iy1;
+    n0 = GradientNoise3DSampleInline(x, y, z, x0, y0, z0, seed);
+    n1 = GradientNoise3DSampleInline(x, y, z, x1, y0, z0, seed);
+    ix0 = LerpSample(n0, n1, xs);
+    ix0.dx += xSlope * (n1.value - n0.value);
+    n0 = GradientNoise3DSampleInline(x, y, z, x0, y1, z0, seed);
+    n1 = GradientNoise3DSampleInline(x, y, z, x1, y1, z0, seed);
+    ix1 = LerpSample(n0, n1, xs);
+    ix1.dx += xSlope * (n1.value - n0.value);
+    iy0 = LerpSample(ix0, ix1, ys);
+    iy0.dy += ySlope * (ix1.value - ix0.value);
+    n0 = GradientNoise3DSampleInline(x, y, z, x0, y0, z1, seed);
+    n1 = GradientNoise3DSampleInline(x, y, z, x1, y0, z1, seed);
+    ix0 = LerpSample(n0, n1, xs);
+    ix0.dx += xSlope * (n1.value - n0.value);
+    n0 = GradientNoise3DSampleInline(x, y, z, x0, y1, z1, seed);
+    n1 = GradientNoise3DSampleInline(x, y, z, x1, y1, z1, seed);
+    ix1 = LerpSample(n0, n1, xs);
+    ix1.dx += xSlope * (n1.value - n0.value);
+    iy1 = LerpSample(ix0, ix1, ys);
+    iy1.dy += ySlope * (ix1.value - ix0.value);
+
+    GradientNoiseSample result = LerpSample(iy0, iy1, zs);
+    dx = result.dx;
+    dy = result.dy;
+    dz = result.dz + zSlope * (iy1.value - iy0.value);
+    return result.value;
+}
+
+template double noise::GradientCoherentNoise3DAndGradient<QUALITY_FAST>(double x, double y, double z, double& dx, double& dy, double& dz, int seed);
+template double noise::GradientCoherentNoise3DAndGradient<QUALITY_STD>(double x, double y, double z, double& dx, double& dy, double& dz, int seed);
+template double noise::GradientCoherentNoise3DAndGradient<QUALITY_BEST>(double x, double y, double z, double& dx, double& dy, double& dz, int seed);
+
+double noise::GradientCoherentNoise3DAndGradient(double x, double y, double z, double& dx, double& dy, double& dz, int seed, NoiseQuality noiseQuality)
+{
+    switch (noiseQuality)
+    {
+    case QUALITY_FAST:
+        return GradientCoherentNoise3DAndGradient<QUALITY_FAST>(x, y, z, dx, dy, dz, seed);
+    case QUALITY_BEST:
+        return GradientCoherentNoise3DAndGradient<QUALITY_BEST>(x, y, z, dx, dy, dz, seed);
+    default:
+        return GradientCoherentNoise3DAndGradient<QUALITY_STD>(x, y, z, dx, dy, dz, seed);
+    }
+}
+
+double noise::GradientCoherentNoise3D(double x, double y, double z, int seed, NoiseQuality noiseQuality)
+{
+    switch (noiseQuality)
+    {
+    case QUALITY_FAST:
+        return GradientCoherentNoise3D<QUALITY_FAST>(x, y, z, seed);
+    case QUALITY_BEST:
+        return GradientCoherentNoise3D<QUALITY_BEST>(x, y, z, seed);
+    default:
+        return GradientCoherentNoise3D<QUALITY_STD>(x, y, z, seed);
+    }
+}
+
 double noise::GradientNoise3D(double fx, double fy, double fz, int ix, int iy, int iz, int seed)
 {
-    // Randomly generate a gradient vector given the integer coordinates of the
-    // input value.  This implementation generates a random number and uses it
-    // as an index into a normalized-vector lookup table.
-    int vectorIndex = (X_NOISE_GEN * ix + Y_NOISE_GEN * iy + Z_NOISE_GEN * iz + SEED_NOISE_GEN * seed) & 0xffffffff;
-    vectorIndex ^= (vectorIndex >> SHIFT_NOISE_GEN);
-    vectorIndex &= 0xff;
-
-    double xvGradient = g_randomVectors[(vectorIndex << 2)];
-    double yvGradient = g_randomVectors[(vectorIndex << 2) + 1];
-    double zvGradient = g_randomVectors[(vectorIndex << 2) + 2];
-
-    // Set up us another vector equal to the distance between the two vectors
-    // passed to this function.
-    double xvPoint = (fx - (double)ix);
-    double yvPoint = (fy - (double)iy);
-    double zvPoint = (fz - (double)iz);
-
-    // Now compute the dot product of the gradient vector with the distance
-    // vector.  The resulting value is gradient noise.  Apply a scaling value
-    // so that this noise value ranges from -1.0 to 1.0.
-    return ((xvGradient * xvPoint) + (yvGradient * yvPoint) + (zvGradient * zvPoint)) * 2.12;
+    return GradientNoise3DInline(fx, fy, fz, ix, iy, iz, seed);
+}
+
+namespace
+{
+
+    // Batch kernels for GradientCoherentNoise3D() and
+    // GradientCoherentNoise3DTriple().
+    //
+    // Each kernel performs exactly the same floating-point operations, in the
+    // same order, as the single-value functions above, so the results are
+    // bit-identical.  In particular, the kernels must not be compiled with
+    // fused multiply-add enabled, which would change the rounding.
+
+    typedef void (*GradientCoherentNoise3DBatchFunc)(const double* xs, const double* ys, const double* zs, double* out, size_t count, int seed, NoiseQuality noiseQuality);
+
+    void GradientCoherentNoise3DScalar(const double* xs, const double* ys, const double* zs, double* out, size_t count, int seed, NoiseQuality noiseQuality)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            out[i] = GradientCoherentNoise3D(xs[i], ys[i], zs[i], seed, noiseQuality);
+        }
+    }
+
+    typedef void (*GradientCoherentNoise3DTripleFunc)(const double xs[3], const double ys[3], const double zs[3], const int seeds[3], double out[3], NoiseQuality noiseQuality);
+
+    void GradientCoherentNoise3DTripleScalar(const double xs[3], const double ys[3], const double zs[3], const int seeds[3], double out[3], NoiseQuality noiseQuality)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            out[i] = GradientCoherentNoise3D(xs[i], ys[i], zs[i], seeds[i], noiseQuality);
+        }
+    }
+
+#if defined(NOISE_SIMD_X86)
+
+    // SSE4.1 kernel; evaluates two input values at a time.
+
+    template <NoiseQuality Q>
+    NOISE_TARGET("sse4.1") inline __m128d SCurveSse41(__m128d a)
+    {
+        if (Q == QUALITY_STD)
+        {
+            return _mm_mul_pd(_mm_mul_pd(a, a), _mm_sub_pd(_mm_set1_pd(3.0), _mm_mul_pd(_mm_set1_pd(2.0), a)));
+        }
+        else if (Q == QUALITY_BEST)
+        {
+            __m128d a3 = _mm_mul_pd(_mm_mul_pd(a, a), a);
+            __m128d a4 = _mm_mul_pd(a3, a);
+            __m128d a5 = _mm_mul_pd(a4, a);
+            return _mm_add_pd(_mm_sub_pd(_mm_mul_pd(_mm_set1_pd(6.0), a5), _mm_mul_pd(_mm_set1_pd(15.0), a4)), _mm_mul_pd(_mm_set1_pd(10.0), a3));
+        }
+        return a;
+    }
+
+    NOISE_TARGET("sse4.1") inline __m128d LinearInterpSse41(__m128d n0, __m128d n1, __m128d a)
+    {
+        return _mm_add_pd(_mm_mul_pd(_mm_sub_pd(_mm_set1_pd(1.0), a), n0), _mm_mul_pd(a, n1));
+    }
+
+    // Returns the integer coordinates of the cube's outer-lower-left vertex,
+    // using the same rounding as (x > 0.0 ? (int)x : (int)x - 1).
+    NOISE_TARGET("sse4.1") inline __m128i FloorSse41(__m128d x)
+    {
+        __m128i truncated = _mm_cvttpd_epi32(x);
+        __m128i positive = _mm_cvttpd_epi32(_mm_and_pd(_mm_cmpgt_pd(x, _mm_setzero_pd()), _mm_set1_pd(1.0)));
+        return _mm_add_epi32(_mm_sub_epi32(truncated, _mm_set1_epi32(1)), positive);
+    }
+
+    NOISE_TARGET("sse4.1") inline __m128d GradientNoise3DSse41(__m128d fx, __m128d fy, __m128d fz, __m128i ix, __m128i iy, __m128i iz, __m128i hash)
+    {
+        __m128i vectorIndex = _mm_xor_si128(hash, _mm_srai_epi32(hash, SHIFT_NOISE_GEN));
+        vectorIndex = _mm_slli_epi32(_mm_and_si128(vectorIndex, _mm_set1_epi32(0xff)), 2);
+
+        // Each gradient vector is stored as (x, y, z, pad); load two vectors
+        // and transpose them into x, y and z registers.
+        const double* pVector0 = g_randomVectors + _mm_cvtsi128_si32(vectorIndex);
+        const double* pVector1 = g_randomVectors + _mm_extract_epi32(vectorIndex, 1);
+        __m128d xy0 = _mm_loadu_pd(pVector0);
+        __m128d xy1 = _mm_loadu_pd(pVector1);
+        __m128d xvGradient = _mm_unpacklo_pd(xy0, xy1);
+        __m128d yvGradient = _mm_unpackhi_pd(xy0, xy1);
+        __m128d zvGradient = _mm_unpacklo_pd(_mm_load_sd(pVector0 + 2), _mm_load_sd(pVector1 + 2));
+
+        __m128d xvPoint = _mm_sub_pd(fx, _mm_cvtepi32_pd(ix));
+        __m128d yvPoint = _mm_sub_pd(fy, _mm_cvtepi32_pd(iy));
+        __m128d zvPoint = _mm_sub_pd(fz, _mm_cvtepi32_pd(iz));
+
+        __m128d dot = _mm_add_pd(_mm_add_pd(_mm_mul_pd(xvGradient, xvPoint), _mm_mul_pd(yvGradient, yvPoint)), _mm_mul_pd(zvGradient, zvPoint));
+        return _mm_mul_pd(dot, _mm_set1_pd(2.12));
+    }
+
+    // Evaluates the input values in the lanes of x, y and z.  seedHash holds,
+    // for each lane, the seed multiplied by SEED_NOISE_GEN.
+    template <NoiseQuality Q>
+    NOISE_TARGET("sse4.1") inline __m128d GradientCoherentNoise3DLanesSse41(__m128d x, __m128d y, __m128d z, __m128i seedHash)
+    {
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i xGen = _mm_set1_epi32(X_NOISE_GEN);
+        const __m128i yGen = _mm_set1_epi32(Y_NOISE_GEN);
+        const __m128i zGen = _mm_set1_epi32(Z_NOISE_GEN);
+
+        __m128i x0 = FloorSse41(x);
+        __m128i y0 = FloorSse41(y);
+        __m128i z0 = FloorSse41(z);
+        __m128i x1 = _mm_add_epi32(x0, one);
+        __m128i y1 = _mm_add_epi32(y0, one);
+        __m128i z1 = _mm_add_epi32(z0, one);
+
+        __m128d xs0 = SCurveSse41<Q>(_mm_sub_pd(x, _mm_cvtepi32_pd(x0)));
+        __m128d ys0 = SCurveSse41<Q>(_mm_sub_pd(y, _mm_cvtepi32_pd(y0)));
+        __m128d zs0 = SCurveSse41<Q>(_mm_sub_pd(z, _mm_cvtepi32_pd(z0)));
+
+        // The lattice hash is a sum of per-axis terms, so the terms for
+        // both vertices along each axis are computed once.
+        __m128i hx0 = _mm_mullo_epi32(x0, xGen);
+        __m128i hx1 = _mm_mullo_epi32(x1, xGen);
+        __m128i hy0 = _mm_mullo_epi32(y0, yGen);
+        __m128i hy1 = _mm_mullo_epi32(y1, yGen);
+        __m128i hz0 = _mm_add_epi32(_mm_mullo_epi32(z0, zGen), seedHash);
+        __m128i hz1 = _mm_add_epi32(_mm_mullo_epi32(z1, zGen), seedHash);
+
+        __m128d n0, n1, ix0, ix1, iy0, iy1;
+        n0 = GradientNoise3DSse41(x, y, z, x0, y0, z0, _mm_add_epi32(_mm_add_epi32(hx0, hy0), hz0));
+        n1 = GradientNoise3DSse41(x, y, z, x1, y0, z0, _mm_add_epi32(_mm_add_epi32(hx1, hy0), hz0));
+        ix0 = LinearInterpSse41(n0, n1, xs0);
+        n0 = GradientNoise3DSse41(x, y, z, x0, y1, z0, _mm_add_epi32(_mm_add_epi32(hx0, hy1), hz0));
+        n1 = GradientNoise3DSse41(x, y, z, x1, y1, z0, _mm_add_epi32(_mm_add_epi32(hx1, hy1), hz0));
+        ix1 = LinearInterpSse41(n0, n1, xs0);
+        iy0 = LinearInterpSse41(ix0, ix1, ys0);
+        n0 = GradientNoise3DSse41(x, y, z, x0, y0, z1, _mm_add_epi32(_mm_add_epi32(hx0, hy0), hz1));
+        n1 = GradientNoise3DSse41(x, y, z, x1, y0, z1, _mm_add_epi32(_mm_add_epi32(hx1, hy0), hz1));
+        ix0 = LinearInterpSse41(n0, n1, xs0);
+        n0 = GradientNoise3DSse41(x, y, z, x0, y1, z1, _mm_add_epi32(_mm_add_epi32(hx0, hy1), hz1));
+        n1 = GradientNoise3DSse41(x, y, z, x1, y1, z1, _mm_add_epi32(_mm_add_epi32(hx1, hy1), hz1));
+        ix1 = LinearInterpSse41(n0, n1, xs0);
+        iy1 = LinearInterpSse41(ix0, ix1, ys0);
+
+        return LinearInterpSse41(iy0, iy1, zs0);
+    }
+
+    template <NoiseQuality Q>
+    NOISE_TARGET("sse4.1") void GradientCoherentNoise3DSse41(const double* xs, const double* ys, const double* zs, double* out, size_t count, int seed)
+    {
+        const __m128i seedHash = _mm_set1_epi32((int)((unsigned int)SEED_NOISE_GEN * (unsigned int)seed));
+
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            __m128d x = _mm_loadu_pd(xs + i);
+            __m128d y = _mm_loadu_pd(ys + i);
+            __m128d z = _mm_loadu_pd(zs + i);
+            _mm_storeu_pd(out + i, GradientCoherentNoise3DLanesSse41<Q>(x, y, z, seedHash));
+        }
+
+        for (; i < count; i++)
+        {
+            out[i] = GradientCoherentNoise3D<Q>(xs[i], ys[i], zs[i], seed);
+        }
+    }
+
+    void GradientCoherentNoise3DSse41(const double* xs, const double* ys, const double* zs, double* out, size_t count, int seed, NoiseQuality noiseQuality)
+    {
+        switch (noiseQuality)
+        {
+        case QUALITY_FAST:
+            GradientCoherentNoise3DSse41<QUALITY_FAST>(xs, ys, zs, out, count, seed);
+            break;
+        case QUALITY_STD:
+            GradientCoherentNoise3DSse41<QUALITY_STD>(xs, ys, zs, out, count, seed);
+            break;
+        case QUALITY_BEST:
+            GradientCoherentNoise3DSse41<QUALITY_BEST>(xs, ys, zs, out, count, seed);
+            break;
+        }
+    }
+
+    // Evaluates the first two values in one register and the third value in
+    // both lanes of another.
+    template <NoiseQuality Q>
+    NOISE_TARGET("sse4.1") void GradientCoherentNoise3DTripleSse41(const double xs[3], const double ys[3], const double zs[3], const int seeds[3], double out[3])
+    {
+        const __m128i seedGen = _mm_set1_epi32(SEED_NOISE_GEN);
+        __m128i seedHash01 = _mm_mullo_epi32(_mm_setr_epi32(seeds[0], seeds[1], 0, 0), seedGen);
+        __m128i seedHash2 = _mm_mullo_epi32(_mm_set1_epi32(seeds[2]), seedGen);
+        __m128d n01 = GradientCoherentNoise3DLanesSse41<Q>(_mm_loadu_pd(xs), _mm_loadu_pd(ys), _mm_loadu_pd(zs), seedHash01);
+        __m128d n2 = GradientCoherentNoise3DLanesSse41<Q>(_mm_set1_pd(xs[2]), _mm_set1_pd(ys[2]), _mm_set1_pd(zs[2]), seedHash2);
+        _mm_storeu_pd(out, n01);
+        _mm_store_sd(out + 2, n2);
+    }
+
+    void GradientCoherentNoise3DTripleSse41(const double xs[3], const double ys[3], const double zs[3], const int seeds[3], double out[3], NoiseQuality noiseQuality)
+    {
+        switch (noiseQuality)
+        {
+        case QUALITY_FAST:
+            GradientCoherentNoise3DTripleSse41<QUALITY_FAST>(xs, ys, zs, seeds, out);
+            break;
+        case QUALITY_STD:
+            GradientCoherentNoise3DTripleSse41<QUALITY_STD>(xs, ys, zs, seeds, out);
+            break;
+        case QUALITY_BEST:
+            GradientCoherentNoise3DTripleSse41<QUALITY_BEST>(xs, ys, zs, seeds, out);
+            break;
+        }
+    }
+
+    // AVX2 kernel; evaluates four input values at a time.  The integer lattice
+    // coordinates of the four input values fit in one SSE register.
+
+    template <NoiseQuality Q>
+    NOISE_TARGET("avx2") inline __m256d SCurveAvx2(__m256d a)
+    {
+        if (Q == QUALITY_STD)
+        {
+            return _mm256_mul_pd(_mm256_mul_pd(a, a), _mm256_sub_pd(_mm256_set1_pd(3.0), _mm256_mul_pd(_mm256_set1_pd(2.0), a)));
+        }
+        else if (Q == QUALITY_BEST)
+        {
+            __m256d a3 = _mm256_mul_pd(_mm256_mul_pd(a, a), a);
+            __m256d a4 = _mm256_mul_pd(a3, a);
+            __m256d a5 = _mm256_mul_pd(a4, a);
+            return _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(_mm256_set1_pd(6.0), a5), _mm256_mul_pd(_mm256_set1_pd(15.0), a4)), _mm256_mul_pd(_mm256_set1_pd(10.0), a3));
+        }
+        return a;
+    }
+
+    NOISE_TARGET("avx2") inline __m256d LinearInterpAvx2(__m256d n0, __m256d n1, __m256d a)
+    {
+        return _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), a), n0), _mm256_mul_pd(a, n1));
+    }
+
+    NOISE_TARGET("avx2") inline __m128i FloorAvx2(__m256d x)
+    {
+        __m128i truncated = _mm256_cvttpd_epi32(x);
+        __m128i positive = _mm256_cvttpd_epi32(_mm256_and_pd(_mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_GT_OQ), _mm256_set1_pd(1.0)));
+        return _mm_add_epi32(_mm_sub_epi32(truncated, _mm_set1_epi32(1)), positive);
+    }
+
+    // Gathers four doubles.  The masked form is used so that the pass-through
+    // operand has a defined value; the unmasked intrinsic leaves it
+    // uninitialized, which GCC reports.
+    NOISE_TARGET("avx2") inline __m256d GatherAvx2(const double* base, __m128i index)
+    {
+        return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), base, index, _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8);
+    }
+
+    NOISE_TARGET("avx2") inline __m256d GradientNoise3DAvx2(__m256d fx, __m256d fy, __m256d fz, __m128i ix, __m128i iy, __m128i iz, __m128i hash)
+    {
+        __m128i vectorIndex = _mm_xor_si128(hash, _mm_srai_epi32(hash, SHIFT_NOISE_GEN));
+        vectorIndex = _mm_slli_epi32(_mm_and_si128(vectorIndex, _mm_set1_epi32(0xff)), 2);
+
+        __m256d xvGradient = GatherAvx2(g_randomVectors, vectorIndex);
+        __m256d yvGradient = GatherAvx2(g_randomVectors + 1, vectorIndex);
+        __m256d zvGradient = GatherAvx2(g_randomVectors + 2, vectorIndex);
+
+        __m256d xvPoint = _mm256_sub_pd(fx, _mm256_cvtepi32_pd(ix));
+        __m256d yvPoint = _mm256_sub_pd(fy, _mm256_cvtepi32_pd(iy));
+        __m256d zvPoint = _mm256_sub_pd(fz, _mm256_cvtepi32_pd(iz));
+
+        __m256d dot = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(xvGradient, xvPoint), _mm256_mul_pd(yvGradient, yvPoint)), _mm256_mul_pd(zvGradient, zvPoint));
+        return _mm256_mul_pd(dot, _mm256_set1_pd(2.12));
+    }
+
+    // Evaluates the input values in the lanes of x, y and z.  seedHash holds,
+    // for each lane, the seed multiplied by SEED_NOISE_GEN.
+    template <NoiseQuality Q>
+    NOISE_TARGET("avx2") inline __m256d GradientCoherentNoise3DLanesAvx2(__m256d x, __m256d y, __m256d z, __m128i seedHash)
+    {
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i xGen = _mm_set1_epi32(X_NOISE_GEN);
+        const __m128i yGen = _mm_set1_epi32(Y_NOISE_GEN);
+        const __m128i zGen = _mm_set1_epi32(Z_NOISE_GEN);
+
+        __m128i x0 = FloorAvx2(x);
+        __m128i y0 = FloorAvx2(y);
+        __m128i z0 = FloorAvx2(z);
+        __m128i x1 = _mm_add_epi32(x0, one);
+        __m128i y1 = _mm_add_epi32(y0, one);
+        __m128i z1 = _mm_add_epi32(z0, one);
+
+        __m256d xs0 = SCurveAvx2<Q>(_mm256_sub_pd(x, _mm256_cvtepi32_pd(x0)));
+        __m256d ys0 = SCurveAvx2<Q>(_mm256_sub_pd(y, _mm256_cvtepi32_pd(y0)));
+        __m256d zs0 = SCurveAvx2<Q>(_mm256_sub_pd(z, _mm256_cvtepi32_pd(z0)));
+
+        __m128i hx0 = _mm_mullo_epi32(x0, xGen);
+        __m128i hx1 = _mm_mullo_epi32(x1, xGen);
+        __m128i hy0 = _mm_mullo_epi32(y0, yGen);
+        __m128i hy1 = _mm_mullo_epi32(y1, yGen);
+        __m128i hz0 = _mm_add_epi32(_mm_mullo_epi32(z0, zGen), seedHash);
+        __m128i hz1 = _mm_add_epi32(_mm_mullo_epi32(z1, zGen), seedHash);
+
+        __m256d n0, n1, ix0, ix1, iy0, iy1;
+        n0 = GradientNoise3DAvx2(x, y, z, x0, y0, z0, _mm_add_epi32(_mm_add_epi32(hx0, hy0), hz0));
+        n1 = GradientNoise3DAvx2(x, y, z, x1, y0, z0, _mm_add_epi32(_mm_add_epi32(hx1, hy0), hz0));
+        ix0 = LinearInterpAvx2(n0, n1, xs0);
+        n0 = GradientNoise3DAvx2(x, y, z, x0, y1, z0, _mm_add_epi32(_mm_add_epi32(hx0, hy1), hz0));
+        n1 = GradientNoise3DAvx2(x, y, z, x1, y1, z0, _mm_add_epi32(_mm_add_epi32(hx1, hy1), hz0));
+        ix1 = LinearInterpAvx2(n0, n1, xs0);
+        iy0 = LinearInterpAvx2(ix0, ix1, ys0);
+        n0 = GradientNoise3DAvx2(x, y, z, x0, y0, z1, _mm_add_epi32(_mm_add_epi32(hx0, hy0), hz1));
+        n1 = GradientNoise3DAvx2(x, y, z, x1, y0, z1, _mm_add_epi32(_mm_add_epi32(hx1, hy0), hz1));
+        ix0 = LinearInterpAvx2(n0, n1, xs0);
+        n0 = GradientNoise3DAvx2(x, y, z, x0, y1, z1, _mm_add_epi32(_mm_add_epi32(hx0, hy1), hz1));
+        n1 = GradientNoise3DAvx2(x, y, z, x1, y1, z1, _mm_add_epi32(_mm_add_epi32(hx1, hy1), hz1));
+        ix1 = LinearInterpAvx2(n0, n1, xs0);
+        iy1 = LinearInterpAvx2(ix0, ix1, ys0);
+
+        return LinearInterpAvx2(iy0, iy1, zs0);
+    }
+
+    template <NoiseQuality Q>
+    NOISE_TARGET("avx2") void GradientCoherentNoise3DAvx2(const double* xs, const double* ys, const double* zs, double* out, size_t count, int seed)
+    {
+        const __m128i seedHash = _mm_set1_epi32((int)((unsigned int)SEED_NOISE_GEN * (unsigned int)seed));
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256d x = _mm256_loadu_pd(xs + i);
+            __m256d y = _mm256_loadu_pd(ys + i);
+            __m256d z = _mm256_loadu_pd(zs + i);
+            _mm256_storeu_pd(out + i, GradientCoherentNoise3DLanesAvx2<Q>(x, y, z, seedHash));
+        }
+
+        for (; i < count; i++)
+        {
+            out[i] = GradientCoherentNoise3D<Q>(xs[i], ys[i], zs[i], seed);
+        }
+    }
+
+    void GradientCoherentNoise3DAvx2(const double* xs, const double* ys, const double* zs, double* out, size_t count, int seed, NoiseQuality noiseQuality)
+    {
+        switch (noiseQuality)
+        {
+        case QUALITY_FAST:
+            GradientCoherentNoise3DAvx2<QUALITY_FAST>(xs, ys, zs, out, count, seed);
+            break;
+        case QUALITY_STD:
+            GradientCoherentNoise3DAvx2<QUALITY_STD>(xs, ys, zs, out, count, seed);
+            break;
+        case QUALITY_BEST:
+            GradientCoherentNoise3DAvx2<QUALITY_BEST>(xs, ys, zs, out, count, seed);
+            break;
+        }
+    }
+
+    // Evaluates the three values in the first three lanes of one register;
+    // the fourth lane repeats the third value.
+    template <NoiseQuality Q>
+    NOISE_TARGET("avx2") void GradientCoherentNoise3DTripleAvx2(const double xs[3], const double ys[3], const double zs[3], const int seeds[3], double out[3])
+    {
+        __m256d x = _mm256_setr_pd(xs[0], xs[1], xs[2], xs[2]);
+        __m256d y = _mm256_setr_pd(ys[0], ys[1], ys[2], ys[2]);
+        __m256d z = _mm256_setr_pd(zs[0], zs[1], zs[2], zs[2]);
+        __m128i seedHash = _mm_mullo_epi32(_mm_setr_epi32(seeds[0], seeds[1], seeds[2], seeds[2]), _mm_set1_epi32(SEED_NOISE_GEN));
+        __m256d n = GradientCoherentNoise3DLanesAvx2<Q>(x, y, z, seedHash);
+        _mm_storeu_pd(out, _mm256_castpd256_pd128(n));
+        _mm_store_sd(out + 2, _mm256_extractf128_pd(n, 1));
+    }
+
+    void GradientCoherentNoise3DTripleAvx2(const double xs[3], const double ys[3], const double zs[3], const int seeds[3], double out[3], NoiseQuality noiseQuality)
+    {
+        switch (noiseQuality)
+        {
+        case QUALITY_FAST:
+            GradientCoherentNoise3DTripleAvx2<QUALITY_FAST>(xs, ys, zs, seeds, out);
+            break;
+        case QUALITY_STD:
+            GradientCoherentNoise3DTripleAvx2<QUALITY_STD>(xs, ys, zs, seeds, out);
+            break;
+        case QUALITY_BEST:
+            GradientCoherentNoise3DTripleAvx2<QUALITY_BEST>(xs, ys, zs, seeds, out);
+            break;
+        }
+    }
+
+    bool CpuSupportsAvx2()
+    {
+#    if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+        {
+            return false;
+        }
+        // AVX2 requires OS support for saving the YMM registers (OSXSAVE and
+        // XCR0 bits 1 and 2) in addition to the CPUID feature flag.
+        __cpuid(info, 1);
+        if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+        {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#    else
+        return __builtin_cpu_supports("avx2");
+#    endif
+    }
+
+    bool CpuSupportsSse41()
+    {
+#    if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 19)) != 0;
+#    else
+        return __builtin_cpu_supports("sse4.1");
+#    endif
+    }
+
+#endif
+
+    // Selects the fastest kernel supported by the processor.
+    GradientCoherentNoise3DBatchFunc SelectGradientCoherentNoise3DKernel()
+    {
+#if defined(NOISE_SIMD_X86)
+        if (CpuSupportsAvx2())
+        {
+            return GradientCoherentNoise3DAvx2;
+        }
+        if (CpuSupportsSse41())
+        {
+            return GradientCoherentNoise3DSse41;
+        }
+#endif
+        return GradientCoherentNoise3DScalar;
+    }
+
+    // Selects the fastest three-value kernel supported by the processor.
+    GradientCoherentNoise3DTripleFunc SelectGradientCoherentNoise3DTripleKernel()
+    {
+#if defined(NOISE_SIMD_X86)
+        if (CpuSupportsAvx2())
+        {
+            return GradientCoherentNoise3DTripleAvx2;
+        }
+        if (CpuSupportsSse41())
+        {
+            return GradientCoherentNoise3DTripleSse41;
+        }
+#endif
+        return GradientCoherentNoise3DTripleScalar;
+    }
+
+} // namespace
+
+void noise::GradientCoherentNoise3D(const double* xs, const double* ys, const double* zs, double* out, size_t count, int seed, NoiseQuality noiseQuality)
+{
+    static const GradientCoherentNoise3DBatchFunc kernel = SelectGradientCoherentNoise3DKernel();
+    kernel(xs, ys, zs, out, count, seed, noiseQuality);
+}
+
+void noise::GradientCoherentNoise3DTriple(const double xs[3], const double ys[3], const double zs[3], const int seeds[3], double out[3], NoiseQuality noiseQuality)
+{
+    static const GradientCoherentNoise3DTripleFunc kernel = SelectGradientCoherentNoise3DTripleKernel();
+    kernel(xs, ys, zs, seeds, out, noiseQuality);
+}
+
+namespace
+{
+
+    // Single-precision batch kernels for GradientCoherentNoise3D().
+    //
+    // These kernels perform the same operations as the double-precision
+    // functions, in single precision.  The scalar kernel and the SIMD kernels
+    // generate the same values.
+
+    // Single-precision copy of g_randomVectors.
+    struct FloatVectorTable
+    {
+        FloatVectorTable()
+        {
+            for (int i = 0; i < 256 * 4; i++)
+            {
+                vectors[i] = (float)g_randomVectors[i];
+            }
+        }
+
+        float vectors[256 * 4];
+    };
+
+    const FloatVectorTable g_randomVectorsFloat;
+
+    template <NoiseQuality noiseQuality>
+    inline float MapSCurveFloat(float a)
+    {
+        switch (noiseQuality)
+        {
+        case QUALITY_STD:
+            return (a * a * (3.0f - 2.0f * a));
+        case QUALITY_BEST:
+        {
+            float a3 = a * a * a;
+            float a4 = a3 * a;
+            float a5 = a4 * a;
+            return (6.0f * a5) - (15.0f * a4) + (10.0f * a3);
+        }
+        default:
+            return a;
+        }
+    }
+
+    inline float LinearInterpFloat(float n0, float n1, float a)
+    {
+        return ((1.0f - a) * n0) + (a * n1);
+    }
+
+    inline float GradientNoise3DFloat(float fx, float fy, float fz, int ix, int iy, int iz, int seed)
+    {
+        unsigned int hash = (unsigned int)X_NOISE_GEN * ix + (unsigned int)Y_NOISE_GEN * iy + (unsigned int)Z_NOISE_GEN * iz + (unsigned int)SEED_NOISE_GEN * seed;
+        int vectorIndex = (int)hash;
+        vectorIndex ^= (vectorIndex >> SHIFT_NOISE_GEN);
+        vectorIndex &= 0xff;
+
+        const float* pVector = g_randomVectorsFloat.vectors + (vectorIndex << 2);
+        float xvPoint = (fx - (float)ix);
+        float yvPoint = (fy - (float)iy);
+        float zvPoint = (fz - (float)iz);
+        return ((pVector[0] * xvPoint) + (pVector[1] * yvPoint) + (pVector[2] * zvPoint)) * 2.12f;
+    }
+
+    template <NoiseQuality noiseQuality>
+    float GradientCoherentNoise3DFloat(float x, float y, float z, int seed)
+    {
+        int x0 = (x > 0.0f ? (int)x : (int)x - 1);
+        int x1 = x0 + 1;
+        int y0 = (y > 0.0f ? (int)y : (int)y - 1);
+        int y1 = y0 + 1;
+        int z0 = (z > 0.0f ? (int)z : (int)z - 1);
+        int z1 = z0 + 1;
+
+        float xs = MapSCurveFloat<noiseQuality>(x - (float)x0);
+        float ys = MapSCurveFloat<noiseQuality>(y - (float)y0);
+        float zs = MapSCurveFloat<noiseQuality>(z - (float)z0);
+
+        float n0, n1, ix0, ix1, iy0, iy1;
+        n0 = GradientNoise3DFloat(x, y, z, x0, y0, z0, seed);
+        n1 = GradientNoise3DFloat(x, y, z, x1, y0, z0, seed);
+        ix0 = LinearInterpFloat(n0, n1, xs);
+        n0 = GradientNoise3DFloat(x, y, z, x0, y1, z0, seed);
+        n1 = GradientNoise3DFloat(x, y, z, x1, y1, z0, seed);
+        ix1 = LinearInterpFloat(n0, n1, xs);
+        iy0 = LinearInterpFloat(ix0, ix1, ys);
+        n0 = GradientNoise3DFloat(x, y, z, x0, y0, z1, seed);
+        n1 = GradientNoise3DFloat(x, y, z, x1, y0, z1, seed);
+        ix0 = LinearInterpFloat(n0, n1, xs);
+        n0 = GradientNoise3DFloat(x, y, z, x0, y1, z1, seed);
+        n1 = GradientNoise3DFloat(x, y, z, x1, y1, z1, seed);
+        ix1 = LinearInterpFloat(n0, n1, xs);
+        iy1 = LinearInterpFloat(ix0, ix1, ys);
+
+        return LinearInterpFloat(iy0, iy1, zs);
+    }
+
+    typedef void (*GradientCoherentNoise3DFloatBatchFunc)(const float* xs, const float* ys, const float* zs, float* out, size_t count, int seed, NoiseQuality noiseQuality);
+
+    template <NoiseQuality Q>
+    void GradientCoherentNoise3DFloatScalar(const float* xs, const float* ys, const float* zs, float* out, size_t count, int seed)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            out[i] = GradientCoherentNoise3DFloat<Q>(xs[i], ys[i], zs[i], seed);
+        }
+    }
+
+    void GradientCoherentNoise3DFloatScalar(const float* xs, const float* ys, const float* zs, float* out, size_t count, int seed, NoiseQuality noiseQuality)
+    {
+        switch (noiseQuality)
+        {
+        case QUALITY_FAST:
+            GradientCoherentNoise3DFloatScalar<QUALITY_FAST>(xs, ys, zs, out, count, seed);
+            break;
+        case QUALITY_STD:
+            GradientCoherentNoise3DFloatScalar<QUALITY_STD>(xs, ys, zs, out, count, seed);
+            break;
+        case QUALITY_BEST:
+            GradientCoherentNoise3DFloatScalar<QUALITY_BEST>(xs, ys, zs, out, count, seed);
+            break;
+        }
+    }
+
+#if defined(NOISE_SIMD_X86)
+
+    // SSE4.1 kernel; evaluates four input values at a time.
+
+    template <NoiseQuality Q>
+    NOISE_TARGET("sse4.1") inline __m128 SCurveFloatSse41(__m128 a)
+    {
+        if (Q == QUALITY_STD)
+        {
+            return _mm_mul_ps(_mm_mul_ps(a, a), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_set1_ps(2.0f), a)));
+        }
+        else if (Q == QUALITY_BEST)
+        {
+            __m128 a3 = _mm_mul_ps(_mm_mul_ps(a, a), a);
+            __m128 a4 = _mm_mul_ps(a3, a);
+            __m128 a5 = _mm_mul_ps(a4, a);
+            return _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_set1_ps(6.0f), a5), _mm_mul_ps(_mm_set1_ps(15.0f), a4)), _mm_mul_ps(_mm_set1_ps(10.0f), a3));
+        }
+        return a;
+    }
+
+    NOISE_TARGET("sse4.1") inline __m128 LinearInterpFloatSse41(__m128 n0, __m128 n1, __m128 a)
+    {
+        return _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0f), a), n0), _mm_mul_ps(a, n1));
+    }
+
+    // Returns the integer coordinates of the cube's outer-lower-left vertex,
+    // using the same rounding as (x > 0.0f ? (int)x : (int)x - 1).
+    NOISE_TARGET("sse4.1") inline __m128i FloorFloatSse41(__m128 x)
+    {
+        __m128i truncated = _mm_cvttps_epi32(x);
+        __m128i positive = _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(x, _mm_setzero_ps())), _mm_set1_epi32(1));
+        return _mm_add_epi32(_mm_sub_epi32(truncated, _mm_set1_epi32(1)), positive);
+    }
+
+    NOISE_TARGET("sse4.1") inline __m128 GradientNoise3DFloatSse41(__m128 fx, __m128 fy, __m128 fz, __m128i ix, __m128i iy, __m128i iz, __m128i hash)
+    {
+        __m128i vectorIndex = _mm_xor_si128(hash, _mm_srai_epi32(hash, SHIFT_NOISE_GEN));
+        vectorIndex = _mm_slli_epi32(_mm_and_si128(vectorIndex, _mm_set1_epi32(0xff)), 2);
+
+        // Each gradient vector is stored as (x, y, z, pad); load four vectors
+        // and transpose them into x, y and z registers.
+        __m128 xvGradient = _mm_loadu_ps(g_randomVectorsFloat.vectors + _mm_cvtsi128_si32(vectorIndex));
+        __m128 yvGradient = _mm_loadu_ps(g_randomVectorsFloat.vectors + _mm_extract_epi32(vectorIndex, 1));
+        __m128 zvGradient = _mm_loadu_ps(g_randomVectorsFloat.vectors + _mm_extract_epi32(vectorIndex, 2));
+        __m128 pad = _mm_loadu_ps(g_randomVectorsFloat.vectors + _mm_extract_epi32(vectorIndex, 3));
+        _MM_TRANSPOSE4_PS(xvGradient, yvGradient, zvGradient, pad);
+
+        __m128 xvPoint = _mm_sub_ps(fx, _mm_cvtepi32_ps(ix));
+        __m128 yvPoint = _mm_sub_ps(fy, _mm_cvtepi32_ps(iy));
+        __m128 zvPoint = _mm_sub_ps(fz, _mm_cvtepi32_ps(iz));
+
+        __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xvGradient, xvPoint), _mm_mul_ps(yvGradient, yvPoint)), _mm_mul_ps(zvGradient, zvPoint));
+        return _mm_mul_ps(dot, _mm_set1_ps(2.12f));
+    }
+
+    template <NoiseQuality Q>
+    NOISE_TARGET("sse4.1") void GradientCoherentNoise3DFloatSse41(const float* xs, const float* ys, const float* zs, float* out, size_t count, int seed)
+    {
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i xGen = _mm_set1_epi32(X_NOISE_GEN);
+        const __m128i yGen = _mm_set1_epi32(Y_NOISE_GEN);
+        const __m128i zGen = _mm_set1_epi32(Z_NOISE_GEN);
+        const __m128i seedHash = _mm_set1_epi32((int)((unsigned int)SEED_NOISE_GEN * (unsigned int)seed));
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(xs + i);
+            __m128 y = _mm_loadu_ps(ys + i);
+            __m128 z = _mm_loadu_ps(zs + i);
+
+            __m128i x0 = FloorFloatSse41(x);
+            __m128i y0 = FloorFloatSse41(y);
+            __m128i z0 = FloorFloatSse41(z);
+            __m128i x1 = _mm_add_epi32(x0, one);
+            __m128i y1 = _mm_add_epi32(y0, one);
+            __m128i z1 = _mm_add_epi32(z0, one);
+
+            __m128 xs0 = SCurveFloatSse41<Q>(_mm_sub_ps(x, _mm_cvtepi32_ps(x0)));
+            __m128 ys0 = SCurveFloatSse41<Q>(_mm_sub_ps(y, _mm_cvtepi32_ps(y0)));
+            __m128 zs0 = SCurveFloatSse41<Q>(_mm_sub_ps(z, _mm_cvtepi32_ps(z0)));
+
+            __m128i hx0 = _mm_mullo_epi32(x0, xGen);
+            __m128i hx1 = _mm_mullo_epi32(x1, xGen);
+            __m128i hy0 = _mm_mullo_epi32(y0, yGen);
+            __m128i hy1 = _mm_mullo_epi32(y1, yGen);
+            __m128i hz0 = _mm_add_epi32(_mm_mullo_epi32(z0, zGen), seedHash);
+            __m128i hz1 = _mm_add_epi32(_mm_mullo_epi32(z1, zGen), seedHash);
+
+            __m128 n0, n1, ix0, ix1, iy0, iy1;
+            n0 = GradientNoise3DFloatSse41(x, y, z, x0, y0, z0, _mm_add_epi32(_mm_add_epi32(hx0, hy0), hz0));
+            n1 = GradientNoise3DFloatSse41(x, y, z, x1, y0, z0, _mm_add_epi32(_mm_add_epi32(hx1, hy0), hz0));
+            ix0 = LinearInterpFloatSse41(n0, n1, xs0);
+            n0 = GradientNoise3DFloatSse41(x, y, z, x0, y1, z0, _mm_add_epi32(_mm_add_epi32(hx0, hy1), hz0));
+            n1 = GradientNoise3DFloatSse41(x, y, z, x1, y1, z0, _mm_add_epi32(_mm_add_epi32(hx1, hy1), hz0));
+            ix1 = LinearInterpFloatSse41(n0, n1, xs0);
+            iy0 = LinearInterpFloatSse41(ix0, ix1, ys0);
+            n0 = GradientNoise3DFloatSse41(x, y, z, x0, y0, z1, _mm_add_epi32(_mm_add_epi32(hx0, hy0), hz1));
+            n1 = GradientNoise3DFloatSse41(x, y, z, x1, y0, z1, _mm_add_epi32(_mm_add_epi32(hx1, hy0), hz1));
+            ix0 = LinearInterpFloatSse41(n0, n1, xs0);
+            n0 = GradientNoise3DFloatSse41(x, y, z, x0, y1, z1, _mm_add_epi32(_mm_add_epi32(hx0, hy1), hz1));
+            n1 = GradientNoise3DFloatSse41(x, y, z, x1, y1, z1, _mm_add_epi32(_mm_add_epi32(hx1, hy1), hz1));
+            ix1 = LinearInterpFloatSse41(n0, n1, xs0);
+            iy1 = LinearInterpFloatSse41(ix0, ix1, ys0);
+
+            _mm_storeu_ps(out + i, LinearInterpFloatSse41(iy0, iy1, zs0));
+        }
+
+        for (; i < count; i++)
+        {
+            out[i] = GradientCoherentNoise3DFloat<Q>(xs[i], ys[i], zs[i], seed);
+        }
+    }
+
+    void GradientCoherentNoise3DFloatSse41(const float* xs, const float* ys, const float* zs, float* out, size_t count, int seed, NoiseQuality noiseQuality)
+    {
+        switch (noiseQuality)
+        {
+        case QUALITY_FAST:
+            GradientCoherentNoise3DFloatSse41<QUALITY_FAST>(xs, ys, zs, out, count, seed);
+            break;
+        case QUALITY_STD:
+            GradientCoherentNoise3DFloatSse41<QUALITY_STD>(xs, ys, zs, out, count, seed);
+            break;
+        case QUALITY_BEST:
+            GradientCoherentNoise3DFloatSse41<QUALITY_BEST>(xs, ys, zs, out, count, seed);
+            break;
+        }
+    }
+
+    // AVX2 kernel; evaluates eight input values at a time.
+
+    template <NoiseQuality Q>
+    NOISE_TARGET("avx2") inline __m256 SCurveFloatAvx2(__m256 a)
+    {
+        if (Q == QUALITY_STD)
+        {
+            return _mm256_mul_ps(_mm256_mul_ps(a, a), _mm256_sub_ps(_mm256_set1_ps(3.0f), _mm256_mul_ps(_mm256_set1_ps(2.0f), a)));
+        }
+        else if (Q == QUALITY_BEST)
+        {
+            __m256 a3 = _mm256_mul_ps(_mm256_mul_ps(a, a), a);
+            __m256 a4 = _mm256_mul_ps(a3, a);
+            __m256 a5 = _mm256_mul_ps(a4, a);
+            return _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(6.0f), a5), _mm256_mul_ps(_mm256_set1_ps(15.0f), a4)), _mm256_mul_ps(_mm256_set1_ps(10.0f), a3));
+        }
+        return a;
+    }
+
+    NOISE_TARGET("avx2") inline __m256 LinearInterpFloatAvx2(__m256 n0, __m256 n1, __m256 a)
+    {
+        return _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), a), n0), _mm256_mul_ps(a, n1));
+    }
+
+    NOISE_TARGET("avx2") inline __m256i FloorFloatAvx2(__m256 x)
+    {
+        __m256i truncated = _mm256_cvttps_epi32(x);
+        __m256i positive = _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_GT_OQ)), _mm256_set1_epi32(1));
+        return _mm256_add_epi32(_mm256_sub_epi32(truncated, _mm256_set1_epi32(1)), positive);
+    }
+
+    NOISE_TARGET("avx2") inline __m256 GradientNoise3DFloatAvx2(__m256 fx, __m256 fy, __m256 fz, __m256i ix, __m256i iy, __m256i iz, __m256i hash)
+    {
+        __m256i vectorIndex = _mm256_xor_si256(hash, _mm256_srai_epi32(hash, SHIFT_NOISE_GEN));
+        vectorIndex = _mm256_slli_epi32(_mm256_and_si256(vectorIndex, _mm256_set1_epi32(0xff)), 2);
+
+        __m256 xvGradient = _mm256_i32gather_ps(g_randomVectorsFloat.vectors, vectorIndex, 4);
+        __m256 yvGradient = _mm256_i32gather_ps(g_randomVectorsFloat.vectors + 1, vectorIndex, 4);
+        __m256 zvGradient = _mm256_i32gather_ps(g_randomVectorsFloat.vectors + 2, vectorIndex, 4);
+
+        __m256 xvPoint = _mm256_sub_ps(fx, _mm256_cvtepi32_ps(ix));
+        __m256 yvPoint = _mm256_sub_ps(fy, _mm256_cvtepi32_ps(iy));
+        __m256 zvPoint = _mm256_sub_ps(fz, _mm256_cvtepi32_ps(iz));
+
+        __m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(xvGradient, xvPoint), _mm256_mul_ps(yvGradient, yvPoint)), _mm256_mul_ps(zvGradient, zvPoint));
+        return _mm256_mul_ps(dot, _mm256_set1_ps(2.12f));
+    }
+
+    template <NoiseQuality Q>
+    NOISE_TARGET("avx2") void GradientCoherentNoise3DFloatAvx2(const float* xs, const float* ys, const float* zs, float* out, size_t count, int seed)
+    {
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i xGen = _mm256_set1_epi32(X_NOISE_GEN);
+        const __m256i yGen = _mm256_set1_epi32(Y_NOISE_GEN);
+        const __m256i zGen = _mm256_set1_epi32(Z_NOISE_GEN);
+        const __m256i seedHash = _mm256_set1_epi32((int)((unsigned int)SEED_NOISE_GEN * (unsigned int)seed));
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 x = _mm256_loadu_ps(xs + i);
+            __m256 y = _mm256_loadu_ps(ys + i);
+            __m256 z = _mm256_loadu_ps(zs + i);
+
+            __m256i x0 = FloorFloatAvx2(x);
+            __m256i y0 = FloorFloatAvx2(y);
+            __m256i z0 = FloorFloatAvx2(z);
+            __m256i x1 = _mm256_add_epi32(x0, one);
+            __m256i y1 = _mm256_add_epi32(y0, one);
+            __m256i z1 = _mm256_add_epi32(z0, one);
+
+            __m256 xs0 = SCurveFloatAvx2<Q>(_mm256_sub_ps(x, _mm256_cvtepi32_ps(x0)));
+            __m256 ys0 = SCurveFloatAvx2<Q>(_mm256_sub_ps(y, _mm256_cvtepi32_ps(y0)));
+            __m256 zs0 = SCurveFloatAvx2<Q>(_mm256_sub_ps(z, _mm256_cvtepi32_ps(z0)));
+
+            __m256i hx0 = _mm256_mullo_epi32(x0, xGen);
+            __m256i hx1 = _mm256_mullo_epi32(x1, xGen);
+            __m256i hy0 = _mm256_mullo_epi32(y0, yGen);
+            __m256i hy1 = _mm256_mullo_epi32(y1, yGen);
+            __m256i hz0 = _mm256_add_epi32(_mm256_mullo_epi32(z0, zGen), seedHash);
+            __m256i hz1 = _mm256_add_epi32(_mm256_mullo_epi32(z1, zGen), seedHash);
+
+            __m256 n0, n1, ix0, ix1, iy0, iy1;
+            n0 = GradientNoise3DFloatAvx2(x, y, z, x0, y0, z0, _mm256_add_epi32(_mm256_add_epi32(hx0, hy0), hz0));
+            n1 = GradientNoise3DFloatAvx2(x, y, z, x1, y0, z0, _mm256_add_epi32(_mm256_add_epi32(hx1, hy0), hz0));
+            ix0 = LinearInterpFloatAvx2(n0, n1, xs0);
+            n0 = GradientNoise3DFloatAvx2(x, y, z, x0, y1, z0, _mm256_add_epi32(_mm256_add_epi32(hx0, hy1), hz0));
+            n1 = GradientNoise3DFloatAvx2(x, y, z, x1, y1, z0, _mm256_add_epi32(_mm256_add_epi32(hx1, hy1), hz0));
+            ix1 = LinearInterpFloatAvx2(n0, n1, xs0);
+            iy0 = LinearInterpFloatAvx2(ix0, ix1, ys0);
+            n0 = GradientNoise3DFloatAvx2(x, y, z, x0, y0, z1, _mm256_add_epi32(_mm256_add_epi32(hx0, hy0), hz1));
+            n1 = GradientNoise3DFloatAvx2(x, y, z, x1, y0, z1, _mm256_add_epi32(_mm256_add_epi32(hx1, hy0), hz1));
+            ix0 = LinearInterpFloatAvx2(n0, n1, xs0);
+            n0 = GradientNoise3DFloatAvx2(x, y, z, x0, y1, z1, _mm256_add_epi32(_mm256_add_epi32(hx0, hy1), hz1));
+            n1 = GradientNoise3DFloatAvx2(x, y, z, x1, y1, z1, _mm256_add_epi32(_mm256_add_epi32(hx1, hy1), hz1));
+            ix1 = LinearInterpFloatAvx2(n0, n1, xs0);
+            iy1 = LinearInterpFloatAvx2(ix0, ix1, ys0);
+
+            _mm256_storeu_ps(out + i, LinearInterpFloatAvx2(iy0, iy1, zs0));
+        }
+
+        for (; i < count; i++)
+        {
+            out[i] = GradientCoherentNoise3DFloat<Q>(xs[i], ys[i], zs[i], seed);
+        }
+    }
+
+    void GradientCoherentNoise3DFloatAvx2(const float* xs, const float* ys, const float* zs, float* out, size_t count, int seed, NoiseQuality noiseQuality)
+    {
+        switch (noiseQuality)
+        {
+        case QUALITY_FAST:
+            GradientCoherentNoise3DFloatAvx2<QUALITY_FAST>(xs, ys, zs, out, count, seed);
+            break;
+        case QUALITY_STD:
+            GradientCoherentNoise3DFloatAvx2<QUALITY_STD>(xs, ys, zs, out, count, seed);
+            break;
+        case QUALITY_BEST:
+            GradientCoherentNoise3DFloatAvx2<QUALITY_BEST>(xs, ys, zs, out, count, seed);
+            break;
+        }
+    }
+
+#endif
+
+    // Selects the fastest single-precision kernel supported by the
+    // processor.
+    GradientCoherentNoise3DFloatBatchFunc SelectGradientCoherentNoise3DFloatKernel()
+    {
+#if defined(NOISE_SIMD_X86)
+        if (CpuSupportsAvx2())
+        {
+            return GradientCoherentNoise3DFloatAvx2;
+        }
+        if (CpuSupportsSse41())
+        {
+            return GradientCoherentNoise3DFloatSse41;
+        }
+#endif
+        return GradientCoherentNoise3DFloatScalar;
+    }
+
+} // namespace
+
+void noise::GradientCoherentNoise3D(const float* xs, const float* ys, const float* zs, float* out, size_t count, int seed, NoiseQuality noiseQuality)
+{
+    static const GradientCoherentNoise3DFloatBatchFunc kernel = SelectGradientCoherentNoise3DFloatKernel();
+    kernel(xs, ys, zs, out, count, seed, noiseQuality);
 }
 
 int noise::IntValueNoise3D(int x, int y, int z, int seed)
 {
     // All constants are primes and must remain prime in order for this noise
-    // function to work correctly.
-    int n = (X_NOISE_GEN * x + Y_NOISE_GEN * y + Z_NOISE_GEN * z + SEED_NOISE_GEN * seed) & 0x7fffffff;
+    // function to work correctly.  The arithmetic is unsigned so that it wraps
+    // around instead of overflowing; with signed arithmetic, an optimizing
+    // compiler may drop the final mask and return negative values.
+    unsigned int n = ((unsigned int)X_NOISE_GEN * x + (unsigned int)Y_NOISE_GEN * y + (unsigned int)Z_NOISE_GEN * z + (unsigned int)SEED_NOISE_GEN * seed) & 0x7fffffff;
     n = (n >> 13) ^ n;
-    return (n * (n * n * 60493 + 19990303) + 1376312589) & 0x7fffffff;
+    return (int)((n * (n * n * 60493 + 19990303) + 1376312589) & 0x7fffffff);
 }
 
 double noise::ValueCoherentNoise3D(double x, double y, double z, int seed, NoiseQuality noiseQuality)
@@ -26,6 +26,7 @@
 #include "basictypes.h"
 
 #include <math.h>
+#include <stddef.h>
 
 namespace noise
 {
@@ -77,6 +78,129 @@ namespace noise
     /// <i>value</i> noise, see the comments for the GradientNoise3D() function.
     double GradientCoherentNoise3D(double x, double y, double z, int seed = 0, NoiseQuality noiseQuality = QUALITY_STD);
 
+    /// Generates a gradient-coherent-noise value from the coordinates of a
+    /// three-dimensional input value, with the noise quality fixed at compile
+    /// time.
+    ///
+    /// @tparam noiseQuality The quality of the coherent-noise.
+    ///
+    /// @param x The @a x coordinate of the input value.
+    /// @param y The @a y coordinate of the input value.
+    /// @param z The @a z coordinate of the input value.
+    /// @param seed The random number seed.
+    ///
+    /// @returns The generated gradient-coherent-noise value.
+    ///
+    /// This function returns the same value as the GradientCoherentNoise3D()
+    /// function that takes the noise quality as a parameter, but it does not
+    /// select the S-curve at run time.  Noise modules that generate several
+    /// octaves select the instantiation once and call it for every octave.
+    ///
+    /// This function is instantiated for each noise::NoiseQuality value.
+    template <NoiseQuality noiseQuality>
+    double GradientCoherentNoise3D(double x, double y, double z, int seed);
+
+    /// Generates three gradient-coherent-noise values, each from its own
+    /// three-dimensional input value and seed.
+    ///
+    /// @param xs The @a x coordinates of the three input values.
+    /// @param ys The @a y coordinates of the three input values.
+    /// @param zs The @a z coordinates of the three input values.
+    /// @param seeds The random number seeds of the three values.
+    /// @param out The array that receives the three generated values.
+    /// @param noiseQuality The quality of the coherent-noise.
+    ///
+    /// Each generated value is bit-identical to the value returned by
+    /// GradientCoherentNoise3D() for the same input value and seed.  On
+    /// processors that support SSE4.1 or AVX2, the three values are
+    /// generated in the lanes of the same SIMD registers, so noise modules
+    /// that need three noise values per input value, such as
+    /// noise::module::Turbulence, call this function instead of calling
+    /// GradientCoherentNoise3D() three times.
+    void GradientCoherentNoise3DTriple(const double xs[3], const double ys[3], const double zs[3], const int seeds[3], double out[3], NoiseQuality noiseQuality = QUALITY_STD);
+
+    /// Generates a gradient-coherent-noise value and its gradient from the
+    /// coordinates of a three-dimensional input value.
+    ///
+    /// @param x The @a x coordinate of the input value.
+    /// @param y The @a y coordinate of the input value.
+    /// @param z The @a z coordinate of the input value.
+    /// @param dx Receives the derivative of the value along the @a x axis.
+    /// @param dy Receives the derivative of the value along the @a y axis.
+    /// @param dz Receives the derivative of the value along the @a z axis.
+    /// @param seed The random number seed.
+    /// @param noiseQuality The quality of the coherent-noise.
+    ///
+    /// @returns The generated gradient-coherent-noise value, identical to the
+    /// value returned by GradientCoherentNoise3D().
+    ///
+    /// The derivatives are computed analytically from the same eight gradient
+    /// vectors as the value, so this function costs about as much as two
+    /// evaluations, instead of the four evaluations of a finite
+    /// difference.  With noise::QUALITY_FAST, the derivatives are
+    /// discontinuous at integer boundaries; see noise::NoiseQuality.
+    double GradientCoherentNoise3DAndGradient(double x, double y, double z, double& dx, double& dy, double& dz, int seed = 0, NoiseQuality noiseQuality = QUALITY_STD);
+
+    /// Generates a gradient-coherent-noise value and its gradient from the
+    /// coordinates of a three-dimensional input value, with the noise quality
+    /// fixed at compile time.
+    ///
+    /// @tparam noiseQuality The quality of the coherent-noise.
+    ///
+    /// This function returns the same value and derivatives as the
+    /// GradientCoherentNoise3DAndGradient() function that takes the noise
+    /// quality as a parameter.  It is instantiated for each
+    /// noise::NoiseQuality value.
+    template <NoiseQuality noiseQuality>
+    double GradientCoherentNoise3DAndGradient(double x, double y, double z, double& dx, double& dy, double& dz, int seed);
+
+    /// Generates gradient-coherent-noise values from the coordinates of an
+    /// array of three-dimensional input values.
+    ///
+    /// @param xs The @a x coordinates of the input values.
+    /// @param ys The @a y coordinates of the input values.
+    /// @param zs The @a z coordinates of the input values.
+    /// @param out The array that receives the generated values.
+    /// @param count The number of input values.
+    /// @param seed The random number seed.
+    /// @param noiseQuality The quality of the coherent-noise.
+    ///
+    /// Each generated value is bit-identical to the value returned by the
+    /// single-value GradientCoherentNoise3D() function for the same input
+    /// value.
+    ///
+    /// On x86 processors, this function evaluates several input values at
+    /// once using the widest instruction set supported by the processor
+    /// (AVX2 or SSE4.1), which is detected at run time.  On other processors
+    /// it calls the single-value function once per input value.
+    void GradientCoherentNoise3D(const double* xs, const double* ys, const double* zs, double* out, size_t count, int seed = 0, NoiseQuality noiseQuality = QUALITY_STD);
+
+    /// Generates gradient-coherent-noise values from the coordinates of an
+    /// array of three-dimensional input values, in single precision.
+    ///
+    /// @param xs The @a x coordinates of the input values.
+    /// @param ys The @a y coordinates of the input values.
+    /// @param zs The @a z coordinates of the input values.
+    /// @param out The array that receives the generated values.
+    /// @param count The number of input values.
+    /// @param seed The random number seed.
+    /// @param noiseQuality The quality of the coherent-noise.
+    ///
+    /// This function performs the same calculation as the double-precision
+    /// version in single-precision arithmetic, which doubles the number of
+    /// input values evaluated at once by the SIMD kernels (eight with AVX2,
+    /// four with SSE4.1) and halves the size of the arrays.
+    ///
+    /// The generated values differ from the double-precision values by the
+    /// rounding of the coordinates to @a float and by the rounding of the
+    /// calculation.  The position within a unit cube is known to about
+    /// |coordinate| x 2^-24, so the difference grows with the magnitude of
+    /// the coordinates.  For coordinates of magnitude up to 16, it stays
+    /// below 5.0e-6; up to 256, below 1.0e-4; up to 4096, below 1.0e-3.
+    /// Coordinates of magnitude 2^24 and above have no fractional part left,
+    /// so the generated values are no longer coherent.
+    void GradientCoherentNoise3D(const float* xs, const float* ys, const float* zs, float* out, size_t count, int seed = 0, NoiseQuality noiseQuality = QUALITY_STD);
+
     /// Generates a gradient-noise value from the coordinates of a
     /// three-dimensional input value and the integer coordinates of a
     /// nearby three-dimensional value.
@@ -170,6 +294,30 @@ namespace noise
         }
     }
 
+    /// Modifies a single-precision floating-point value so that it can be
+    /// stored in a noise::int32 variable.
+    ///
+    /// @param n A floating-point number.
+    ///
+    /// @returns The modified floating-point number.
+    ///
+    /// This is the single-precision version of MakeInt32Range().
+    inline float MakeInt32Range(float n)
+    {
+        if (n >= 1073741824.0f)
+        {
+            return (2.0f * fmodf(n, 1073741824.0f)) - 1073741824.0f;
+        }
+        else if (n <= -1073741824.0f)
+        {
+            return (2.0f * fmodf(n, 1073741824.0f)) + 1073741824.0f;
+        }
+        else
+        {
+            return n;
+        }
+    }
+
     /// Generates a value-coherent-noise value from the coordinates of a
     /// three-dimensional input value.
     ///
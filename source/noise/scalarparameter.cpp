@@ -7,6 +7,7 @@
  * 
  */
 #include "scalarparameter.h"
+#include "module/const.h"
 #include "module/modulebase.h"
 
 using namespace noise;
@@ -18,17 +19,42 @@ ScalarParameter::ScalarParameter(double value)
 
 ScalarParameter::ScalarParameter(const module::ModuleBase& src)
     : m_pSrc(&src)
+    , m_pConst(dynamic_cast<const module::Const*>(&src))
 {
 }
 
 ScalarParameter::ScalarParameter(const ScalarParameter& sp)
-    : m_value(sp.m_value)
-    , m_pSrc(sp.m_pSrc)
+    : m_pSrc(sp.m_pSrc)
+    , m_pConst(sp.m_pConst)
+    , m_value(sp.m_value)
 {
 }
 
-double ScalarParameter::getValue(double x, double y, double z) const
+void ScalarParameter::getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const
 {
-    if (m_pSrc) return m_pSrc->getValue(x, y, z);
+    if (!isConstant())
+    {
+        m_pSrc->getValues(xs, ys, zs, out, count);
+        return;
+    }
+
+    double value = getConstValue();
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = value;
+    }
+}
+
+double ScalarParameter::getConstValue() const
+{
+    if (m_pConst)
+    {
+        return m_pConst->getConstValue();
+    }
     return m_value;
 }
+
+const module::ModuleBase* ScalarParameter::getSourceModule() const
+{
+    return m_pSrc;
+}
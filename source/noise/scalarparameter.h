@@ -8,10 +8,13 @@
  */
 #pragma once
 
+#include <stddef.h>
+
 namespace noise
 {
     namespace module
     {
+        class Const;
         class ModuleBase;
     }
 
@@ -22,10 +25,26 @@ namespace noise
         ScalarParameter(const module::ModuleBase& src);
         ScalarParameter(const ScalarParameter& sp);
 
-        double getValue(double x, double y, double z) const;
+        // Defined in modulebase.h, after the module::ModuleBase class.
+        inline double getValue(double x, double y, double z) const;
+        void getValues(const double* xs, const double* ys, const double* zs, double* out, size_t count) const;
+
+        // A parameter is constant if it holds a plain value or a
+        // module::Const; consumers test this once per batch and then use
+        // getConstValue() instead of evaluating the parameter per sample.
+        // The value of a module::Const is read on each call, so changing it
+        // later still takes effect.
+        bool isConstant() const
+        {
+            return m_pSrc == nullptr || m_pConst != nullptr;
+        }
+
+        double getConstValue() const;
+        const module::ModuleBase* getSourceModule() const;
 
     private:
         const module::ModuleBase* m_pSrc{};
+        const module::Const* m_pConst{};
         double m_value{};
 
     };
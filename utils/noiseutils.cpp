@@ -22,10 +22,49 @@
 
 #include "noiseutils.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <exception>
 #include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <noise/interp.h>
 #include <noise/mathconsts.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define NOISE_UTILS_SSE2
+#    include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#    define NOISE_UTILS_SSSE3
+#    define NOISE_UTILS_TARGET(isa) __attribute__((target(isa)))
+#    include <tmmintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#    define NOISE_UTILS_SSSE3
+#    define NOISE_UTILS_TARGET(isa)
+#    include <intrin.h>
+#    include <tmmintrin.h>
+#endif
+
+#if defined(_WIN32)
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    ifndef WIN32_LEAN_AND_MEAN
+#        define WIN32_LEAN_AND_MEAN
+#    endif
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <unistd.h>
+#endif
+
 using namespace noise;
 using namespace noise::model;
 using namespace noise::module;
@@ -99,18 +138,518 @@ namespace noise
             bytes[3] = (noise::uint8)((integer & 0xff000000) >> 24);
             return bytes;
         }
+
+        // Packs four bytes in little endian format into a 32-bit integer
+        // value.
+        inline noise::uint32 PackLittle32(const noise::uint8* bytes)
+        {
+            return (noise::uint32)bytes[0] | ((noise::uint32)bytes[1] << 8) | ((noise::uint32)bytes[2] << 16) | ((noise::uint32)bytes[3] << 24);
+        }
     } // namespace utils
 } // namespace noise
 
 using namespace noise;
 using namespace noise::utils;
 
+namespace
+{
+
+    // Number of rows in a band of rows rendered by one task of the
+    // renderers.  A band is small enough that the source rows it reads stay
+    // in the cache, and large enough to make the cost of claiming it
+    // negligible.
+    const int RENDER_BAND_HEIGHT = 16;
+
+    // Returns the number of threads to use for a thread count setting, where
+    // 0 means one thread per hardware thread.
+    int GetEffectiveThreadCount(int threadCount)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = GetMax((int)std::thread::hardware_concurrency(), 1);
+        }
+        return threadCount;
+    }
+
+    // Calls the task function once for each task index from 0 to taskCount -
+    // 1, through the execution context if there is one, and otherwise on up
+    // to threadCount threads of a thread pool created for the call.  If a
+    // task throws an exception, the remaining tasks are skipped and the
+    // exception is rethrown after all threads have stopped.
+    void RunTasks(ExecutionContext* pContext, int threadCount, int taskCount, const std::function<void(int task)>& runTask)
+    {
+        if (pContext != NULL)
+        {
+            pContext->Run(taskCount, runTask);
+            return;
+        }
+
+        threadCount = GetMin(GetEffectiveThreadCount(threadCount), taskCount);
+        if (threadCount <= 1)
+        {
+            ExecutionContext context;
+            context.Run(taskCount, runTask);
+            return;
+        }
+
+        ThreadPool threadPool(threadCount);
+        ExecutionContext context(threadPool);
+        context.Run(taskCount, runTask);
+    }
+
+    // Factors of the light intensity calculation of RendererImage, which
+    // depend on the light parameters.
+    struct LightFactors
+    {
+        double ix;
+        double iy;
+        double io;
+        double brightness;
+    };
+
+    // Calculates the light intensity of a point from the noise values of its
+    // four-neighbors.
+    inline double CalcLightPoint(double nl, double nr, double nd, double nu, const LightFactors& factors)
+    {
+        double intensity = (factors.ix * (nl - nr) + factors.iy * (nd - nu) + factors.io);
+        if (intensity < 0.0)
+        {
+            intensity = 0.0;
+        }
+        return intensity * factors.brightness;
+    }
+
+    // The row kernels below evaluate a stencil over consecutive points of a
+    // noise map row whose left and right neighbors are the adjacent points of
+    // the same row; the down and up neighbors are the points at the same
+    // position of the rows passed to them.  They process the points in groups
+    // of four SIMD lanes, loading the neighbors of a group as four unaligned
+    // slabs of the rows, and return the number of points processed; the
+    // caller handles the remaining points.  Their results are identical to
+    // the scalar calculations.
+
+#if defined(NOISE_UTILS_SSE2)
+    // Converts four noise values into two pairs of doubles.
+    inline void LoadDoubles(const float* pValues, __m128d& low, __m128d& high)
+    {
+        __m128 values = _mm_loadu_ps(pValues);
+        low = _mm_cvtps_pd(values);
+        high = _mm_cvtps_pd(_mm_movehl_ps(values, values));
+    }
+
+    inline __m128d CalcLightLanes(__m128d nl, __m128d nr, __m128d nd, __m128d nu, const LightFactors& factors)
+    {
+        __m128d intensity = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(factors.ix), _mm_sub_pd(nl, nr)), _mm_mul_pd(_mm_set1_pd(factors.iy), _mm_sub_pd(nd, nu))), _mm_set1_pd(factors.io));
+
+        // With zero as the first operand, _mm_max_pd() keeps NaN and -0.0
+        // values, as the comparison in CalcLightPoint() does.
+        return _mm_mul_pd(_mm_max_pd(_mm_setzero_pd(), intensity), _mm_set1_pd(factors.brightness));
+    }
+#endif
+
+    // Calculates the light intensity of count points of a row, starting at
+    // pCenter, whose down and up neighbors start at pDown and pUp.
+    int CalcLightRow(const float* pDown, const float* pCenter, const float* pUp, int count, const LightFactors& factors, double* pIntensity)
+    {
+        int i = 0;
+#if defined(NOISE_UTILS_SSE2)
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128d nl0, nl1, nr0, nr1, nd0, nd1, nu0, nu1;
+            LoadDoubles(pCenter + i - 1, nl0, nl1);
+            LoadDoubles(pCenter + i + 1, nr0, nr1);
+            LoadDoubles(pDown + i, nd0, nd1);
+            LoadDoubles(pUp + i, nu0, nu1);
+            _mm_storeu_pd(pIntensity + i, CalcLightLanes(nl0, nr0, nd0, nu0, factors));
+            _mm_storeu_pd(pIntensity + i + 2, CalcLightLanes(nl1, nr1, nd1, nu1, factors));
+        }
+#endif
+        return i;
+    }
+
+#if defined(NOISE_UTILS_SSE2)
+    // Maps two components of normal vectors from the -1.0 to 1.0 range to the
+    // 0 to 255 range.  The values are never negative, so truncating them
+    // gives the same results as floor().
+    inline __m128i MapNormalLanes(__m128d v)
+    {
+        __m128d mapped = _mm_mul_pd(_mm_add_pd(v, _mm_set1_pd(1.0)), _mm_set1_pd(127.5));
+        return _mm_and_si128(_mm_cvttpd_epi32(mapped), _mm_set1_epi32(0xff));
+    }
+
+    inline void CalcNormalLanes(__m128d nc, __m128d nr, __m128d nu, __m128d bumpHeight, int* pX, int* pY, int* pZ)
+    {
+        nc = _mm_mul_pd(nc, bumpHeight);
+        nr = _mm_mul_pd(nr, bumpHeight);
+        nu = _mm_mul_pd(nu, bumpHeight);
+        __m128d ncr = _mm_sub_pd(nc, nr);
+        __m128d ncu = _mm_sub_pd(nc, nu);
+        __m128d d = _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(ncu, ncu), _mm_mul_pd(ncr, ncr)), _mm_set1_pd(1.0)));
+        _mm_storel_epi64((__m128i*)pX, MapNormalLanes(_mm_div_pd(ncr, d)));
+        _mm_storel_epi64((__m128i*)pY, MapNormalLanes(_mm_div_pd(ncu, d)));
+        _mm_storel_epi64((__m128i*)pZ, MapNormalLanes(_mm_div_pd(_mm_set1_pd(1.0), d)));
+    }
+#endif
+
+    // Calculates the normal colors of count points of a row, starting at
+    // pCenter, whose up neighbors start at pUp, as
+    // RendererNormalMap::CalcNormalColor() does.
+    int CalcNormalRow(const float* pCenter, const float* pUp, int count, double bumpHeight, Color* pDest)
+    {
+        int i = 0;
+#if defined(NOISE_UTILS_SSE2)
+        const __m128d bump = _mm_set1_pd(bumpHeight);
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128d nc0, nc1, nr0, nr1, nu0, nu1;
+            LoadDoubles(pCenter + i, nc0, nc1);
+            LoadDoubles(pCenter + i + 1, nr0, nr1);
+            LoadDoubles(pUp + i, nu0, nu1);
+            int xc[4], yc[4], zc[4];
+            CalcNormalLanes(nc0, nr0, nu0, bump, xc, yc, zc);
+            CalcNormalLanes(nc1, nr1, nu1, bump, xc + 2, yc + 2, zc + 2);
+            for (int j = 0; j < 4; j++)
+            {
+                pDest[i + j] = Color((noise::uint8)xc[j], (noise::uint8)yc[j], (noise::uint8)zc[j], 0);
+            }
+        }
+#endif
+        return i;
+    }
+
+    // Calculates the offsets of the lower and upper neighbors of the point at
+    // index i along an axis of a noise map with size points, in points, for
+    // the wrapping or cropping rules of the renderers.  Only the points on the
+    // edges of the noise map need this function; the neighbors of the inner
+    // points are always one point away.
+    void CalcNeighborOffsets(int i, int size, bool isWrapEnabled, int& lowerOffset, int& upperOffset)
+    {
+        lowerOffset = -1;
+        upperOffset = 1;
+        if (i == 0)
+        {
+            lowerOffset = isWrapEnabled ? size - 1 : 0;
+        }
+        if (i == size - 1)
+        {
+            upperOffset = isWrapEnabled ? -(size - 1) : 0;
+        }
+    }
+
+    // Returns the rows of a noise map for the row tables of the renderers:
+    // the row at index y + 1 of the table is the row y of the noise map, and
+    // the first and last rows of the table are the down neighbor of the first
+    // row and the up neighbor of the last row, for the wrapping or cropping
+    // rules.
+    std::vector<const float*> GetRendererRows(const NoiseMap& noiseMap, bool isWrapEnabled)
+    {
+        int height = noiseMap.GetHeight();
+        int downOffset, upOffset;
+        std::vector<const float*> rows(height + 2);
+        for (int y = 0; y < height; y++)
+        {
+            rows[y + 1] = noiseMap.GetConstSlabPtr(y);
+        }
+        CalcNeighborOffsets(0, height, isWrapEnabled, downOffset, upOffset);
+        rows[0] = noiseMap.GetConstSlabPtr(downOffset);
+        CalcNeighborOffsets(height - 1, height, isWrapEnabled, downOffset, upOffset);
+        rows[height + 1] = noiseMap.GetConstSlabPtr(height - 1 + upOffset);
+        return rows;
+    }
+
+    // Size of the buffers of FileOutput, in bytes.
+    const size_t FILE_OUTPUT_BUFFER_SIZE = 1 << 20;
+
+    // Encodes colors into the blue, green and red bytes of the pixels of a
+    // Windows bitmap.
+    typedef void (*EncodeBmpPixelsFunc)(const Color* pSource, int count, noise::uint8* pDest);
+
+    void EncodeBmpPixelsScalar(const Color* pSource, int count, noise::uint8* pDest)
+    {
+        for (int x = 0; x < count; x++)
+        {
+            *pDest++ = pSource->blue;
+            *pDest++ = pSource->green;
+            *pDest++ = pSource->red;
+            ++pSource;
+        }
+    }
+
+#if defined(NOISE_UTILS_SSSE3)
+    // Shuffles four colors into twelve bytes with one SSSE3 instruction.  Each
+    // group of four pixels is stored as sixteen bytes, whose last four bytes
+    // the next group overwrites, so the loop stops two pixels early.
+    NOISE_UTILS_TARGET("ssse3") void EncodeBmpPixelsSsse3(const Color* pSource, int count, noise::uint8* pDest)
+    {
+        const char b = (char)offsetof(Color, blue);
+        const char g = (char)offsetof(Color, green);
+        const char r = (char)offsetof(Color, red);
+        const __m128i shuffle = _mm_setr_epi8(b, g, r, b + 4, g + 4, r + 4, b + 8, g + 8, r + 8, b + 12, g + 12, r + 12, -1, -1, -1, -1);
+        int x = 0;
+        for (; x + 6 <= count; x += 4)
+        {
+            __m128i colors = _mm_loadu_si128((const __m128i*)(pSource + x));
+            _mm_storeu_si128((__m128i*)(pDest + x * 3), _mm_shuffle_epi8(colors, shuffle));
+        }
+        EncodeBmpPixelsScalar(pSource + x, count - x, pDest + x * 3);
+    }
+
+    bool CpuSupportsSsse3()
+    {
+#    if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 9)) != 0;
+#    else
+        return __builtin_cpu_supports("ssse3");
+#    endif
+    }
+#endif
+
+    // Selects the fastest encoder supported by the processor.
+    EncodeBmpPixelsFunc SelectEncodeBmpPixels()
+    {
+#if defined(NOISE_UTILS_SSSE3)
+        if (sizeof(Color) == 4 && CpuSupportsSsse3())
+        {
+            return EncodeBmpPixelsSsse3;
+        }
+#endif
+        return EncodeBmpPixelsScalar;
+    }
+
+    // Size of the header of a mapped noise map file, in bytes.  The slabs
+    // follow the header, which keeps them aligned for SIMD loads.
+    const size_t MAPPED_FILE_HEADER_SIZE = 64;
+
+    // The first bytes of a mapped noise map file, and the version of its
+    // format.  The header continues with its size as a 32-bit integer and
+    // the width, height and stride of the noise map as 64-bit integers, all
+    // in little endian format.
+    const char MAPPED_FILE_MAGIC[8] = {'N', 'O', 'I', 'S', 'E', 'M', 'A', 'P'};
+    const noise::uint32 MAPPED_FILE_VERSION = 1;
+
+    // Size of the header of a tiled noise map file, and of the description
+    // of each level in the index that follows it, in bytes.
+    const size_t TILED_FILE_HEADER_SIZE = 64;
+    const size_t TILED_FILE_LEVEL_SIZE = 32;
+
+    // The tiles of a tiled noise map file start at a multiple of this size,
+    // so that they are aligned on a page of the mapped file.
+    const unsigned long long TILED_FILE_DATA_ALIGNMENT = 4096;
+
+    // The first bytes of a tiled noise map file, and the version of its
+    // format.  The header continues with its size, the width and height of
+    // the noise map, the tile size, the tile format and the level count as
+    // 32-bit integers, followed by the 16-bit step as a float.  Each level is
+    // described by its width, height, tile counts and the 64-bit offset of
+    // its tiles.  The writer writes the magic last, when the file is
+    // complete.
+    const char TILED_FILE_MAGIC[8] = {'N', 'O', 'I', 'S', 'E', 'T', 'I', 'L'};
+    const noise::uint32 TILED_FILE_VERSION = 1;
+
+    // Returns the size of a point of a tiled noise map file, in bytes.
+    inline int GetTilePointSize(TileFormat tileFormat)
+    {
+        return (tileFormat == TILE_FORMAT_INT16) ? (int)sizeof(noise::int16) : (int)sizeof(float);
+    }
+
+    // Computes the levels of a tiled noise map file.  Returns the size of the
+    // file, or 0 if the file does not fit in the address space.
+    unsigned long long CalcTileLevels(int width, int height, int tileSize, int pointSize, bool isMipmapped, std::vector<TileLevel>& levels)
+    {
+        levels.clear();
+        for (;;)
+        {
+            TileLevel level;
+            level.width = width;
+            level.height = height;
+            level.tileCountX = (width - 1) / tileSize + 1;
+            level.tileCountY = (height - 1) / tileSize + 1;
+            level.dataOffset = 0;
+            levels.push_back(level);
+            if (!isMipmapped || (width <= tileSize && height <= tileSize))
+            {
+                break;
+            }
+            width = (width + 1) / 2;
+            height = (height + 1) / 2;
+        }
+
+        double tileByteCount = (double)tileSize * tileSize * pointSize;
+        unsigned long long offset = TILED_FILE_HEADER_SIZE + levels.size() * TILED_FILE_LEVEL_SIZE;
+        offset = (offset + TILED_FILE_DATA_ALIGNMENT - 1) & ~(TILED_FILE_DATA_ALIGNMENT - 1);
+        for (std::vector<TileLevel>::iterator it = levels.begin(); it != levels.end(); ++it)
+        {
+            double levelByteCount = (double)it->tileCountX * it->tileCountY * tileByteCount;
+            if ((double)offset + levelByteCount >= (double)(size_t)-1)
+            {
+                return 0;
+            }
+            it->dataOffset = offset;
+            offset += (unsigned long long)it->tileCountX * (unsigned long long)it->tileCountY * (unsigned long long)tileByteCount;
+        }
+        return offset;
+    }
+
+    // Maps a file into memory, creating it with the specified size if
+    // isNewFile is true.  If isWritable is false, the pages are mapped
+    // read-only; a copy-on-write mapping would reserve memory for the whole
+    // file.  Returns NULL if the file could not be mapped.
+    void* MapFileView(const std::string& filename, size_t size, bool isNewFile, bool isWritable)
+    {
+#if defined(_WIN32)
+        HANDLE hFile = CreateFileA(filename.c_str(), isWritable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ, FILE_SHARE_READ, NULL, isNewFile ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (hFile == INVALID_HANDLE_VALUE)
+        {
+            return NULL;
+        }
+
+        // Mapping a new file with a larger size extends it with zeros.
+        unsigned long long mappingSize = size;
+        HANDLE hMapping = CreateFileMappingA(hFile, NULL, isWritable ? PAGE_READWRITE : PAGE_READONLY, (DWORD)(mappingSize >> 32), (DWORD)(mappingSize & 0xffffffff), NULL);
+        void* pView = NULL;
+        if (hMapping != NULL)
+        {
+            pView = MapViewOfFile(hMapping, isWritable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+            CloseHandle(hMapping);
+        }
+        CloseHandle(hFile);
+        return pView;
+#else
+        int fd = open(filename.c_str(), isNewFile ? (O_RDWR | O_CREAT | O_TRUNC) : (isWritable ? O_RDWR : O_RDONLY), 0666);
+        if (fd < 0)
+        {
+            return NULL;
+        }
+
+        // Extending a new file fills it with zeros.
+        if (isNewFile && ftruncate(fd, (off_t)size) != 0)
+        {
+            close(fd);
+            return NULL;
+        }
+
+        // The mapping keeps the file open.
+        void* pView = mmap(NULL, size, isWritable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        return (pView == MAP_FAILED) ? NULL : pView;
+#endif
+    }
+
+    // Unmaps a file mapped by MapFileView().
+    void UnmapFileView(void* pView, size_t size)
+    {
+#if defined(_WIN32)
+        (void)size;
+        UnmapViewOfFile(pView);
+#else
+        munmap(pView, size);
+#endif
+    }
+
+    // Computes the coordinates of the points of a region of a noise map along
+    // one axis.  The coordinates are accumulated from the lower bound point by
+    // point, the same way for every region and band, so that the points match
+    // those of the whole noise map.
+    void CalcRegionCoords(double lowerBound, double delta, int begin, int count, int step, std::vector<double>& coords)
+    {
+        coords.resize(count);
+        double cur = lowerBound;
+        for (int p = 0, i = 0; i < count; p++)
+        {
+            if (p == begin + i * step)
+            {
+                coords[i++] = cur;
+            }
+            cur += delta;
+        }
+    }
+
+    // Copies a row of a noise map into a row of another noise map of the
+    // same width.
+    void CopyNoiseMapRow(const NoiseMap& source, int sourceY, NoiseMap& dest, int destY)
+    {
+        memcpy(dest.GetSlabPtr(destY), source.GetConstSlabPtr(sourceY), (size_t)source.GetWidth() * sizeof(float));
+    }
+
+    // Closes the file of a writer after an error, ignoring the exception
+    // that reports the incomplete file.
+    template <class Writer> void CloseIncompleteFile(Writer& writer)
+    {
+        try
+        {
+            writer.CloseDestFile();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    // Replaces the execution context of a builder or renderer for the
+    // lifetime of this object, if there is a replacement.
+    template <class Stage> class ScopedExecutionContext
+    {
+    public:
+        ScopedExecutionContext(Stage* pStage, ExecutionContext* pContext)
+            : m_pPreviousContext(NULL)
+            , m_pStage((pContext != NULL) ? pStage : NULL)
+        {
+            if (m_pStage != NULL)
+            {
+                m_pPreviousContext = m_pStage->GetExecutionContext();
+                m_pStage->SetExecutionContext(pContext);
+            }
+        }
+
+        ~ScopedExecutionContext()
+        {
+            if (m_pStage != NULL)
+            {
+                m_pStage->SetExecutionContext(m_pPreviousContext);
+            }
+        }
+
+    private:
+        ExecutionContext* m_pPreviousContext;
+        Stage* m_pStage;
+    };
+
+    // Builds the bands of a noise map and passes them to a writer of noise
+    // maps.  The noise values are written as they are, so the bands need no
+    // neighboring rows.
+    template <class Writer> void WriteNoiseMapBands(NoiseMapBuilder& builder, int bandHeight, int width, int height, Writer& writer)
+    {
+        writer.OpenDestFile(width, height);
+        try
+        {
+            NoiseMap band;
+            for (int yBegin = 0; yBegin < height; yBegin += bandHeight)
+            {
+                builder.BuildBand(yBegin, GetMin(yBegin + bandHeight, height), band);
+                writer.WriteRows(band);
+            }
+        }
+        catch (...)
+        {
+            CloseIncompleteFile(writer);
+            throw;
+        }
+        writer.CloseDestFile();
+    }
+
+} // namespace
+
 //////////////////////////////////////////////////////////////////////////////
 // GradientColor class
 
 GradientColor::GradientColor()
+    : m_gradientPointCount(0)
+    , m_pGradientPoints(NULL)
+    , m_lookupTableMin(0.0)
+    , m_lookupTableScale(0.0)
+    , m_lookupTableSize(DEFAULT_GRADIENT_LOOKUP_TABLE_SIZE)
 {
-    m_pGradientPoints = NULL;
 }
 
 GradientColor::~GradientColor()
@@ -125,6 +664,32 @@ void GradientColor::AddGradientPoint(double gradientPos, const Color& gradientCo
     // remain sorted by gradient position.
     int insertionPos = FindInsertionPos(gradientPos);
     InsertAtPos(insertionPos, gradientPos, gradientColor);
+    CalcLookupTable();
+}
+
+void GradientColor::CalcLookupTable()
+{
+    if (m_gradientPointCount < 2)
+    {
+        m_lookupTable.clear();
+        return;
+    }
+
+    // Sample the gradient at evenly spaced positions from the first to the
+    // last gradient point, so that the first and the last entries hold the
+    // exact colors of those gradient points.
+    m_lookupTable.resize(m_lookupTableSize);
+    double posMin = m_pGradientPoints[0].pos;
+    double posMax = m_pGradientPoints[m_gradientPointCount - 1].pos;
+    double posDelta = (posMax - posMin) / (double)(m_lookupTableSize - 1);
+    for (int i = 0; i < m_lookupTableSize; i++)
+    {
+        m_lookupTable[i] = GetColor(posMin + posDelta * i);
+    }
+    m_lookupTable[m_lookupTableSize - 1] = m_pGradientPoints[m_gradientPointCount - 1].color;
+
+    m_lookupTableMin = posMin;
+    m_lookupTableScale = 1.0 / posDelta;
 }
 
 void GradientColor::Clear()
@@ -132,6 +697,7 @@ void GradientColor::Clear()
     delete[] m_pGradientPoints;
     m_pGradientPoints = NULL;
     m_gradientPointCount = 0;
+    CalcLookupTable();
 }
 
 int GradientColor::FindInsertionPos(double gradientPos)
@@ -155,7 +721,7 @@ int GradientColor::FindInsertionPos(double gradientPos)
     return insertionPos;
 }
 
-const Color& GradientColor::GetColor(double gradientPos) const
+Color GradientColor::GetColor(double gradientPos) const
 {
     assert(m_gradientPointCount >= 2);
 
@@ -182,8 +748,7 @@ const Color& GradientColor::GetColor(double gradientPos) const
     // now.
     if (index0 == index1)
     {
-        m_workingColor = m_pGradientPoints[index1].color;
-        return m_workingColor;
+        return m_pGradientPoints[index1].color;
     }
 
     // Compute the alpha value used for linear interpolation.
@@ -194,8 +759,9 @@ const Color& GradientColor::GetColor(double gradientPos) const
     // Now perform the linear interpolation given the alpha value.
     const Color& color0 = m_pGradientPoints[index0].color;
     const Color& color1 = m_pGradientPoints[index1].color;
-    LinearInterpColor(color0, color1, (float)alpha, m_workingColor);
-    return m_workingColor;
+    Color color;
+    LinearInterpColor(color0, color1, (float)alpha, color);
+    return color;
 }
 
 void GradientColor::InsertAtPos(int insertionPos, double gradientPos, const Color& gradientColor)
@@ -227,6 +793,17 @@ void GradientColor::InsertAtPos(int insertionPos, double gradientPos, const Colo
     m_pGradientPoints[insertionPos].color = gradientColor;
 }
 
+void GradientColor::SetLookupTableSize(int lookupTableSize)
+{
+    if (lookupTableSize < 2)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    m_lookupTableSize = lookupTableSize;
+    CalcLookupTable();
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // NoiseMap class
 
@@ -249,7 +826,7 @@ NoiseMap::NoiseMap(const NoiseMap& rhs)
 
 NoiseMap::~NoiseMap()
 {
-    delete[] m_pNoiseMap;
+    FreeNoiseMap();
 }
 
 NoiseMap& NoiseMap::operator=(const NoiseMap& rhs)
@@ -290,12 +867,44 @@ void NoiseMap::CopyNoiseMap(const NoiseMap& source)
     m_borderValue = source.m_borderValue;
 }
 
+void NoiseMap::CreateMappedFile(const std::string& filename, int width, int height)
+{
+    if (width <= 0 || height <= 0 || width > MAPPED_RASTER_MAX_SIZE || height > MAPPED_RASTER_MAX_SIZE)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    DeleteNoiseMapAndReset();
+    MapFile(filename, true, true, width, height);
+
+    // Write the header.  The rest of the file is already filled with zeros.
+    noise::uint8* pHeader = (noise::uint8*)m_pMappedView;
+    memcpy(pHeader, MAPPED_FILE_MAGIC, sizeof(MAPPED_FILE_MAGIC));
+    UnpackLittle32(pHeader + 8, MAPPED_FILE_VERSION);
+    UnpackLittle32(pHeader + 12, (noise::uint32)MAPPED_FILE_HEADER_SIZE);
+    UnpackLittle32(pHeader + 16, (noise::uint32)m_width);
+    UnpackLittle32(pHeader + 24, (noise::uint32)m_height);
+    UnpackLittle32(pHeader + 32, (noise::uint32)m_stride);
+}
+
 void NoiseMap::DeleteNoiseMapAndReset()
 {
-    delete[] m_pNoiseMap;
+    FreeNoiseMap();
     InitObj();
 }
 
+void NoiseMap::FreeNoiseMap()
+{
+    if (m_pMappedView != NULL)
+    {
+        UnmapFileView(m_pMappedView, m_mappedViewSize);
+    }
+    else
+    {
+        delete[] m_pNoiseMap;
+    }
+}
+
 float NoiseMap::GetValue(int x, int y) const
 {
     if (m_pNoiseMap != NULL)
@@ -312,6 +921,8 @@ float NoiseMap::GetValue(int x, int y) const
 
 void NoiseMap::InitObj()
 {
+    m_pMappedView = NULL;
+    m_mappedViewSize = 0;
     m_pNoiseMap = NULL;
     m_height = 0;
     m_width = 0;
@@ -320,8 +931,72 @@ void NoiseMap::InitObj()
     m_borderValue = 0.0;
 }
 
+void NoiseMap::MapFile(const std::string& filename, bool isNewFile, bool isWritable, int width, int height)
+{
+    // Make sure that the file fits in the address space.
+    size_t stride = CalcStride(width);
+    if ((size_t)height > ((size_t)-1 - MAPPED_FILE_HEADER_SIZE) / sizeof(float) / stride)
+    {
+        throw noise::ExceptionOutOfMemory();
+    }
+
+    size_t memUsage = stride * (size_t)height;
+    size_t viewSize = MAPPED_FILE_HEADER_SIZE + memUsage * sizeof(float);
+    void* pView = MapFileView(filename, viewSize, isNewFile, isWritable);
+    if (pView == NULL)
+    {
+        throw noise::ExceptionUnknown();
+    }
+
+    m_pMappedView = pView;
+    m_mappedViewSize = viewSize;
+    m_pNoiseMap = (float*)((noise::uint8*)pView + MAPPED_FILE_HEADER_SIZE);
+    m_memUsed = memUsage;
+    m_stride = (int)stride;
+    m_width = width;
+    m_height = height;
+}
+
+void NoiseMap::OpenMappedFile(const std::string& filename, bool isWritable)
+{
+    DeleteNoiseMapAndReset();
+
+    // Read the header and make sure that it describes a noise map that the
+    // file holds completely.
+    std::ifstream is(filename.c_str(), std::ios::in | std::ios::binary);
+    noise::uint8 header[MAPPED_FILE_HEADER_SIZE];
+    is.read((char*)header, sizeof(header));
+    if (is.fail() || memcmp(header, MAPPED_FILE_MAGIC, sizeof(MAPPED_FILE_MAGIC)) != 0 || PackLittle32(header + 8) != MAPPED_FILE_VERSION || PackLittle32(header + 12) != MAPPED_FILE_HEADER_SIZE)
+    {
+        throw noise::ExceptionUnknown();
+    }
+
+    noise::uint32 width = PackLittle32(header + 16);
+    noise::uint32 height = PackLittle32(header + 24);
+    noise::uint32 stride = PackLittle32(header + 32);
+    if (PackLittle32(header + 20) != 0 || PackLittle32(header + 28) != 0 || PackLittle32(header + 36) != 0 || width == 0 || height == 0 || width > (noise::uint32)MAPPED_RASTER_MAX_SIZE || height > (noise::uint32)MAPPED_RASTER_MAX_SIZE || stride != CalcStride((int)width))
+    {
+        throw noise::ExceptionUnknown();
+    }
+
+    is.seekg(0, std::ios::end);
+    unsigned long long fileSize = (unsigned long long)is.tellg();
+    if (is.fail() || fileSize < MAPPED_FILE_HEADER_SIZE + (unsigned long long)stride * height * sizeof(float))
+    {
+        throw noise::ExceptionUnknown();
+    }
+    is.close();
+
+    MapFile(filename, false, isWritable, (int)width, (int)height);
+}
+
 void NoiseMap::ReclaimMem()
 {
+    if (m_pMappedView != NULL)
+    {
+        return;
+    }
+
     size_t newMemUsage = CalcMinMemUsage(m_width, m_height);
     if (m_memUsed > newMemUsage)
     {
@@ -345,6 +1020,12 @@ void NoiseMap::ReclaimMem()
 
 void NoiseMap::SetSize(int width, int height)
 {
+    if (m_pMappedView != NULL && width == m_width && height == m_height)
+    {
+        // Keep the mapped file.
+        return;
+    }
+
     if (width < 0 || height < 0 || width > RASTER_MAX_WIDTH || height > RASTER_MAX_HEIGHT)
     {
         // Invalid width or height.
@@ -362,9 +1043,10 @@ void NoiseMap::SetSize(int width, int height)
         // unless the current buffer is large enough for the new noise map (we
         // don't want costly reallocations going on.)
         size_t newMemUsage = CalcMinMemUsage(width, height);
-        if (m_memUsed < newMemUsage)
+        if (m_memUsed < newMemUsage || m_pMappedView != NULL)
         {
-            // The new size is too big for the current noise map buffer.  We need to
+            // The new size is too big for the current noise map buffer, or the
+            // noise map is mapped to a file of another size.  We need to
             // reallocate.
             DeleteNoiseMapAndReset();
             try
@@ -398,7 +1080,9 @@ void NoiseMap::TakeOwnership(NoiseMap& source)
 {
     // Copy the values and the noise map buffer from the source noise map to
     // this noise map.  Now this noise map pwnz the source buffer.
-    delete[] m_pNoiseMap;
+    FreeNoiseMap();
+    m_pMappedView = source.m_pMappedView;
+    m_mappedViewSize = source.m_mappedViewSize;
     m_memUsed = source.m_memUsed;
     m_height = source.m_height;
     m_pNoiseMap = source.m_pNoiseMap;
@@ -594,404 +1278,1574 @@ void Image::TakeOwnership(Image& source)
 }
 
 /////////////////////////////////////////////////////////////////////////////
-// WriterBMP class
-
-int WriterBMP::CalcWidthByteCount(int width) const
-{
-    return ((width * 3) + 3) & ~0x03;
-}
+// FileOutput class
 
-void WriterBMP::WriteDestFile()
+namespace noise
 {
-    if (m_pSourceImage == NULL)
+    namespace utils
     {
-        throw noise::ExceptionInvalidParam();
-    }
-
-    int width = m_pSourceImage->GetWidth();
-    int height = m_pSourceImage->GetHeight();
-
-    // The width of one line in the file must be aligned on a 4-byte boundary.
-    int bufferSize = CalcWidthByteCount(width);
-    int destSize = bufferSize * height;
+        // Writes a file through large buffers.  The writers reserve space at
+        // the end of the current buffer, fill it, and commit it; a full buffer
+        // is written to the file with a single call.  If a background thread
+        // is used, it writes one buffer while the writer fills the other.
+        class FileOutput
+        {
 
-    // This buffer holds one horizontal line in the destination file.
-    noise::uint8* pLineBuffer = NULL;
+        public:
+            FileOutput(const std::string& filename, bool isBackgroundEnabled)
+                : m_capacity(FILE_OUTPUT_BUFFER_SIZE)
+                , m_isFailed(false)
+                , m_isStopping(false)
+                , m_pendingCapacity(0)
+                , m_pendingSize(0)
+                , m_size(0)
+            {
+                m_os.open(filename.c_str(), std::ios::out | std::ios::binary);
+                if (m_os.fail() || m_os.bad())
+                {
+                    throw noise::ExceptionUnknown();
+                }
 
-    // File object used to write the file.
-    std::ofstream os;
-    os.clear();
+                try
+                {
+                    m_pBuffer.reset(new noise::uint8[m_capacity]);
+                    if (isBackgroundEnabled)
+                    {
+                        m_pPendingBuffer.reset(new noise::uint8[FILE_OUTPUT_BUFFER_SIZE]);
+                        m_pendingCapacity = FILE_OUTPUT_BUFFER_SIZE;
+                    }
+                }
+                catch (...)
+                {
+                    throw noise::ExceptionOutOfMemory();
+                }
 
-    // Allocate a buffer to hold one horizontal line in the bitmap.
-    try
-    {
-        pLineBuffer = new noise::uint8[bufferSize];
-    }
-    catch (...)
-    {
-        throw noise::ExceptionOutOfMemory();
-    }
+                if (isBackgroundEnabled)
+                {
+                    m_thread = std::thread([this]() { WriteInBackground(); });
+                }
+            }
 
-    // Open the destination file.
-    os.open(m_destFilename.c_str(), std::ios::out | std::ios::binary);
-    if (os.fail() || os.bad())
-    {
-        delete[] pLineBuffer;
-        throw noise::ExceptionUnknown();
-    }
+            // Writes the pending buffer, but not the current one, and closes
+            // the file.
+            ~FileOutput()
+            {
+                StopThread();
+            }
 
-    // Build the header.
-    noise::uint8 d[4];
-    os.write("BM", 2);
-    os.write((char*)UnpackLittle32(d, destSize + BMP_HEADER_SIZE), 4);
-    os.write("\0\0\0\0", 4);
-    os.write((char*)UnpackLittle32(d, (noise::uint32)BMP_HEADER_SIZE), 4);
-    os.write((char*)UnpackLittle32(d, 40), 4); // Palette offset
-    os.write((char*)UnpackLittle32(d, (noise::uint32)width), 4);
-    os.write((char*)UnpackLittle32(d, (noise::uint32)height), 4);
-    os.write((char*)UnpackLittle16(d, 1), 2);  // Planes per pixel
-    os.write((char*)UnpackLittle16(d, 24), 2); // Bits per plane
-    os.write("\0\0\0\0", 4);                   // Compression (0 = none)
-    os.write((char*)UnpackLittle32(d, (noise::uint32)destSize), 4);
-    os.write((char*)UnpackLittle32(d, 2834), 4); // X pixels per meter
-    os.write((char*)UnpackLittle32(d, 2834), 4); // Y pixels per meter
-    os.write("\0\0\0\0", 4);
-    os.write("\0\0\0\0", 4);
-    if (os.fail() || os.bad())
-    {
-        os.clear();
-        os.close();
-        os.clear();
-        delete[] pLineBuffer;
-        throw noise::ExceptionUnknown();
-    }
+            // Writes the remaining data and closes the file.  Throws
+            // noise::ExceptionUnknown if any write failed.
+            void Close()
+            {
+                Flush();
+                StopThread();
+                m_os.close();
+                if (m_isFailed || m_os.fail() || m_os.bad())
+                {
+                    throw noise::ExceptionUnknown();
+                }
+            }
 
-    // Build and write each horizontal line to the file.
-    for (int y = 0; y < height; y++)
-    {
-        memset(pLineBuffer, 0, bufferSize);
-        Color* pSource = m_pSourceImage->GetSlabPtr(y);
-        noise::uint8* pDest = pLineBuffer;
-        for (int x = 0; x < width; x++)
-        {
-            *pDest++ = pSource->blue;
-            *pDest++ = pSource->green;
-            *pDest++ = pSource->red;
-            ++pSource;
-        }
-        os.write((char*)pLineBuffer, (size_t)bufferSize);
-        if (os.fail() || os.bad())
-        {
-            os.clear();
-            os.close();
-            os.clear();
-            delete[] pLineBuffer;
-            throw noise::ExceptionUnknown();
-        }
-    }
+            // Makes the size bytes following the returned pointer part of the
+            // file.  The caller fills them before calling Reserve() again.
+            noise::uint8* Reserve(size_t size)
+            {
+                if (m_size + size > m_capacity)
+                {
+                    Flush();
+                    if (size > m_capacity)
+                    {
+                        try
+                        {
+                            m_pBuffer.reset(new noise::uint8[size]);
+                        }
+                        catch (...)
+                        {
+                            throw noise::ExceptionOutOfMemory();
+                        }
+                        m_capacity = size;
+                    }
+                }
+                noise::uint8* pData = m_pBuffer.get() + m_size;
+                m_size += size;
+                return pData;
+            }
 
-    os.close();
-    os.clear();
-    delete[] pLineBuffer;
-}
+            // Appends bytes to the file.
+            void Write(const void* pData, size_t size)
+            {
+                memcpy(Reserve(size), pData, size);
+            }
+
+        private:
+            // Writes the current buffer to the file, or passes it to the
+            // background thread.
+            void Flush()
+            {
+                if (m_size == 0)
+                {
+                    return;
+                }
+
+                if (!m_thread.joinable())
+                {
+                    m_os.write((const char*)m_pBuffer.get(), (std::streamsize)m_size);
+                    m_size = 0;
+                    if (m_os.fail() || m_os.bad())
+                    {
+                        throw noise::ExceptionUnknown();
+                    }
+                    return;
+                }
+
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_isIdle.wait(lock, [this]() { return m_pendingSize == 0; });
+                if (m_isFailed)
+                {
+                    throw noise::ExceptionUnknown();
+                }
+                std::swap(m_pBuffer, m_pPendingBuffer);
+                std::swap(m_capacity, m_pendingCapacity);
+                m_pendingSize = m_size;
+                m_size = 0;
+                m_hasPending.notify_one();
+            }
+
+            // Stops the background thread after it has written the pending
+            // buffer.
+            void StopThread()
+            {
+                if (m_thread.joinable())
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_isStopping = true;
+                    }
+                    m_hasPending.notify_one();
+                    m_thread.join();
+                }
+            }
+
+            // Body of the background thread.
+            void WriteInBackground()
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                for (;;)
+                {
+                    m_hasPending.wait(lock, [this]() { return m_pendingSize != 0 || m_isStopping; });
+                    if (m_pendingSize == 0)
+                    {
+                        break;
+                    }
+
+                    lock.unlock();
+                    m_os.write((const char*)m_pPendingBuffer.get(), (std::streamsize)m_pendingSize);
+                    bool isFailed = m_os.fail() || m_os.bad();
+                    lock.lock();
+
+                    m_isFailed = m_isFailed || isFailed;
+                    m_pendingSize = 0;
+                    m_isIdle.notify_one();
+                }
+            }
+
+            size_t m_capacity;
+            std::condition_variable m_hasPending;
+            bool m_isFailed;
+            std::condition_variable m_isIdle;
+            bool m_isStopping;
+            std::mutex m_mutex;
+            std::ofstream m_os;
+            std::unique_ptr<noise::uint8[]> m_pBuffer;
+            size_t m_pendingCapacity;
+            size_t m_pendingSize;
+            std::unique_ptr<noise::uint8[]> m_pPendingBuffer;
+            size_t m_size;
+            std::thread m_thread;
+        };
+    } // namespace utils
+} // namespace noise
 
 /////////////////////////////////////////////////////////////////////////////
-// WriterTER class
+// WriterBMP class
 
-int WriterTER::CalcWidthByteCount(int width) const
+WriterBMP::WriterBMP()
+    : m_fileHeight(0)
+    , m_fileWidth(0)
+    , m_isBackgroundWriteEnabled(false)
+    , m_pSourceImage(NULL)
+    , m_writtenRowCount(0)
 {
-    return (width * sizeof(int16));
 }
 
-void WriterTER::WriteDestFile()
+WriterBMP::~WriterBMP()
 {
-    if (m_pSourceNoiseMap == NULL)
+}
+
+int WriterBMP::CalcWidthByteCount(int width) const
+{
+    return ((width * 3) + 3) & ~0x03;
+}
+
+void WriterBMP::CloseDestFile()
+{
+    if (!m_pFile)
     {
         throw noise::ExceptionInvalidParam();
     }
 
-    int width = m_pSourceNoiseMap->GetWidth();
-    int height = m_pSourceNoiseMap->GetHeight();
+    std::unique_ptr<FileOutput> pFile(std::move(m_pFile));
+    if (m_writtenRowCount != m_fileHeight)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+    pFile->Close();
+}
+
+void WriterBMP::OpenDestFile(int width, int height)
+{
+    if (width < 0 || height < 0 || m_pFile)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
 
+    // The width of one line in the file must be aligned on a 4-byte boundary.
     int bufferSize = CalcWidthByteCount(width);
     int destSize = bufferSize * height;
 
-    // This buffer holds one horizontal line in the destination file.
-    noise::uint8* pLineBuffer = NULL;
+    // Build the header.
+    noise::uint8 header[BMP_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header, "BM", 2);
+    UnpackLittle32(header + 2, destSize + BMP_HEADER_SIZE);
+    UnpackLittle32(header + 10, (noise::uint32)BMP_HEADER_SIZE);
+    UnpackLittle32(header + 14, 40); // Palette offset
+    UnpackLittle32(header + 18, (noise::uint32)width);
+    UnpackLittle32(header + 22, (noise::uint32)height);
+    UnpackLittle16(header + 26, 1);  // Planes per pixel
+    UnpackLittle16(header + 28, 24); // Bits per plane
+    UnpackLittle32(header + 34, (noise::uint32)destSize);
+    UnpackLittle32(header + 38, 2834); // X pixels per meter
+    UnpackLittle32(header + 42, 2834); // Y pixels per meter
+
+    // Open the destination file and write the header.
+    std::unique_ptr<FileOutput> pFile(new FileOutput(m_destFilename, m_isBackgroundWriteEnabled));
+    pFile->Write(header, sizeof(header));
+
+    m_pFile = std::move(pFile);
+    m_fileWidth = width;
+    m_fileHeight = height;
+    m_writtenRowCount = 0;
+}
 
-    // File object used to write the file.
-    std::ofstream os;
-    os.clear();
+void WriterBMP::WriteDestFile()
+{
+    if (m_pSourceImage == NULL)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
 
-    // Allocate a buffer to hold one horizontal line in the height map.
+    OpenDestFile(m_pSourceImage->GetWidth(), m_pSourceImage->GetHeight());
     try
     {
-        pLineBuffer = new noise::uint8[bufferSize];
+        WriteRows(*m_pSourceImage);
     }
     catch (...)
     {
-        throw noise::ExceptionOutOfMemory();
+        m_pFile.reset();
+        throw;
     }
+    CloseDestFile();
+}
 
-    // Open the destination file.
-    os.open(m_destFilename.c_str(), std::ios::out | std::ios::binary);
-    if (os.fail() || os.bad())
+void WriterBMP::WriteRows(const Image& sourceRows)
+{
+    int rowCount = sourceRows.GetHeight();
+    if (!m_pFile || (rowCount > 0 && sourceRows.GetWidth() != m_fileWidth) || m_writtenRowCount + rowCount > m_fileHeight)
     {
-        os.clear();
-        delete[] pLineBuffer;
-        throw noise::ExceptionUnknown();
+        throw noise::ExceptionInvalidParam();
     }
 
-    // Build the header.
-    noise::uint8 d[4];
-    int16 heightScale = (int16)(floor(32768.0 / (double)m_metersPerPoint));
-    os.write("TERRAGENTERRAIN ", 16);
-    os.write("SIZE", 4);
-    os.write((char*)UnpackLittle16(d, GetMin(width, height) - 1), 2);
-    os.write("\0\0", 2);
-    os.write("XPTS", 4);
-    os.write((char*)UnpackLittle16(d, width), 2);
-    os.write("\0\0", 2);
-    os.write("YPTS", 4);
-    os.write((char*)UnpackLittle16(d, height), 2);
-    os.write("\0\0", 2);
-    os.write("SCAL", 4);
-    os.write((char*)UnpackFloat(d, m_metersPerPoint), 4);
-    os.write((char*)UnpackFloat(d, m_metersPerPoint), 4);
-    os.write((char*)UnpackFloat(d, m_metersPerPoint), 4);
-    os.write("ALTW", 4);
-    os.write((char*)UnpackLittle16(d, heightScale), 2);
-    os.write("\0\0", 2);
-    if (os.fail() || os.bad())
-    {
-        os.clear();
-        os.close();
-        os.clear();
-        delete[] pLineBuffer;
-        throw noise::ExceptionUnknown();
-    }
+    static const EncodeBmpPixelsFunc encodeBmpPixels = SelectEncodeBmpPixels();
 
-    // Build and write each horizontal line to the file.
-    for (int y = 0; y < height; y++)
+    // Encode each horizontal line directly into the buffer of the file.
+    int bufferSize = CalcWidthByteCount(m_fileWidth);
+    int pixelByteCount = m_fileWidth * 3;
+    try
     {
-        float* pSource = m_pSourceNoiseMap->GetSlabPtr(y);
-        noise::uint8* pDest = pLineBuffer;
-        for (int x = 0; x < width; x++)
-        {
-            int16 scaledHeight = (int16)(floor(*pSource * 2.0));
-            UnpackLittle16(pDest, scaledHeight);
-            pDest += 2;
-            ++pSource;
-        }
-        os.write((char*)pLineBuffer, (size_t)bufferSize);
-        if (os.fail() || os.bad())
+        for (int y = 0; y < rowCount; y++)
         {
-            os.clear();
-            os.close();
-            os.clear();
-            delete[] pLineBuffer;
-            throw noise::ExceptionUnknown();
+            noise::uint8* pDest = m_pFile->Reserve((size_t)bufferSize);
+            encodeBmpPixels(sourceRows.GetConstSlabPtr(y), m_fileWidth, pDest);
+            memset(pDest + pixelByteCount, 0, (size_t)(bufferSize - pixelByteCount));
         }
     }
+    catch (...)
+    {
+        m_pFile.reset();
+        throw;
+    }
 
-    os.close();
-    os.clear();
-    delete[] pLineBuffer;
+    m_writtenRowCount += rowCount;
 }
 
 /////////////////////////////////////////////////////////////////////////////
-// NoiseMapBuilder class
+// WriterTER class
 
-NoiseMapBuilder::NoiseMapBuilder()
-    : m_pCallback(NULL)
-    , m_destHeight(0)
-    , m_destWidth(0)
-    , m_pDestNoiseMap(NULL)
-    , m_pSourceModule(NULL)
+WriterTER::WriterTER()
+    : m_fileHeight(0)
+    , m_fileWidth(0)
+    , m_isBackgroundWriteEnabled(false)
+    , m_metersPerPoint(DEFAULT_METERS_PER_POINT)
+    , m_pSourceNoiseMap(NULL)
+    , m_writtenRowCount(0)
 {
 }
 
-void NoiseMapBuilder::SetCallback(NoiseMapCallback pCallback)
+WriterTER::~WriterTER()
 {
-    m_pCallback = pCallback;
 }
 
-/////////////////////////////////////////////////////////////////////////////
-// NoiseMapBuilderCylinder class
-
-NoiseMapBuilderCylinder::NoiseMapBuilderCylinder()
-    : m_lowerAngleBound(0.0)
-    , m_lowerHeightBound(0.0)
-    , m_upperAngleBound(0.0)
-    , m_upperHeightBound(0.0)
+int WriterTER::CalcWidthByteCount(int width) const
 {
+    return (width * sizeof(int16));
 }
 
-void NoiseMapBuilderCylinder::Build()
+void WriterTER::CloseDestFile()
 {
-    if (m_upperAngleBound <= m_lowerAngleBound || m_upperHeightBound <= m_lowerHeightBound || m_destWidth <= 0 || m_destHeight <= 0 || m_pSourceModule == NULL || m_pDestNoiseMap == NULL)
+    if (!m_pFile)
     {
         throw noise::ExceptionInvalidParam();
     }
 
-    // Resize the destination noise map so that it can store the new output
-    // values from the source model.
-    m_pDestNoiseMap->SetSize(m_destWidth, m_destHeight);
-
-    // Create the cylinder model.
-    model::Cylinder cylinderModel;
-    cylinderModel.SetModule(*m_pSourceModule);
-
-    double angleExtent = m_upperAngleBound - m_lowerAngleBound;
-    double heightExtent = m_upperHeightBound - m_lowerHeightBound;
-    double xDelta = angleExtent / (double)m_destWidth;
-    double yDelta = heightExtent / (double)m_destHeight;
-    double curAngle = m_lowerAngleBound;
-    double curHeight = m_lowerHeightBound;
-
-    // Fill every point in the noise map with the output values from the model.
-    for (int y = 0; y < m_destHeight; y++)
+    std::unique_ptr<FileOutput> pFile(std::move(m_pFile));
+    if (m_writtenRowCount != m_fileHeight)
     {
-        float* pDest = m_pDestNoiseMap->GetSlabPtr(y);
-        curAngle = m_lowerAngleBound;
-        for (int x = 0; x < m_destWidth; x++)
-        {
-            float curValue = (float)cylinderModel.GetValue(curAngle, curHeight);
-            *pDest++ = curValue;
-            curAngle += xDelta;
-        }
-        curHeight += yDelta;
-        if (m_pCallback != NULL)
-        {
-            m_pCallback(y);
-        }
+        throw noise::ExceptionInvalidParam();
     }
+    pFile->Close();
 }
 
-/////////////////////////////////////////////////////////////////////////////
-// NoiseMapBuilderPlane class
-
-NoiseMapBuilderPlane::NoiseMapBuilderPlane()
-    : m_isSeamlessEnabled(false)
-    , m_lowerXBound(0.0)
-    , m_lowerZBound(0.0)
-    , m_upperXBound(0.0)
-    , m_upperZBound(0.0)
+void WriterTER::OpenDestFile(int width, int height)
 {
+    if (width < 0 || height < 0 || m_pFile)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    // Build the header.
+    noise::uint8 header[64];
+    int16 heightScale = (int16)(floor(32768.0 / (double)m_metersPerPoint));
+    memset(header, 0, sizeof(header));
+    memcpy(header, "TERRAGENTERRAIN ", 16);
+    memcpy(header + 16, "SIZE", 4);
+    UnpackLittle16(header + 20, GetMin(width, height) - 1);
+    memcpy(header + 24, "XPTS", 4);
+    UnpackLittle16(header + 28, width);
+    memcpy(header + 32, "YPTS", 4);
+    UnpackLittle16(header + 36, height);
+    memcpy(header + 40, "SCAL", 4);
+    UnpackFloat(header + 44, m_metersPerPoint);
+    UnpackFloat(header + 48, m_metersPerPoint);
+    UnpackFloat(header + 52, m_metersPerPoint);
+    memcpy(header + 56, "ALTW", 4);
+    UnpackLittle16(header + 60, heightScale);
+
+    // Open the destination file and write the header.
+    std::unique_ptr<FileOutput> pFile(new FileOutput(m_destFilename, m_isBackgroundWriteEnabled));
+    pFile->Write(header, sizeof(header));
+
+    m_pFile = std::move(pFile);
+    m_fileWidth = width;
+    m_fileHeight = height;
+    m_writtenRowCount = 0;
 }
 
-void NoiseMapBuilderPlane::Build()
+void WriterTER::WriteDestFile()
 {
-    if (m_upperXBound <= m_lowerXBound || m_upperZBound <= m_lowerZBound || m_destWidth <= 0 || m_destHeight <= 0 || m_pSourceModule == NULL || m_pDestNoiseMap == NULL)
+    if (m_pSourceNoiseMap == NULL)
     {
         throw noise::ExceptionInvalidParam();
     }
 
-    // Resize the destination noise map so that it can store the new output
-    // values from the source model.
-    m_pDestNoiseMap->SetSize(m_destWidth, m_destHeight);
-
-    // Create the plane model.
-    model::Plane planeModel;
-    planeModel.SetModule(*m_pSourceModule);
+    OpenDestFile(m_pSourceNoiseMap->GetWidth(), m_pSourceNoiseMap->GetHeight());
+    try
+    {
+        WriteRows(*m_pSourceNoiseMap);
+    }
+    catch (...)
+    {
+        m_pFile.reset();
+        throw;
+    }
+    CloseDestFile();
+}
 
-    double xExtent = m_upperXBound - m_lowerXBound;
-    double zExtent = m_upperZBound - m_lowerZBound;
-    double xDelta = xExtent / (double)m_destWidth;
-    double zDelta = zExtent / (double)m_destHeight;
-    double xCur = m_lowerXBound;
-    double zCur = m_lowerZBound;
+void WriterTER::WriteRows(const NoiseMap& sourceRows)
+{
+    int rowCount = sourceRows.GetHeight();
+    if (!m_pFile || (rowCount > 0 && sourceRows.GetWidth() != m_fileWidth) || m_writtenRowCount + rowCount > m_fileHeight)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
 
-    // Fill every point in the noise map with the output values from the model.
-    for (int z = 0; z < m_destHeight; z++)
+    // Encode each horizontal line directly into the buffer of the file.
+    int bufferSize = CalcWidthByteCount(m_fileWidth);
+    try
     {
-        float* pDest = m_pDestNoiseMap->GetSlabPtr(z);
-        xCur = m_lowerXBound;
-        for (int x = 0; x < m_destWidth; x++)
+        for (int y = 0; y < rowCount; y++)
         {
-            float finalValue;
-            if (!m_isSeamlessEnabled)
+            const float* pSource = sourceRows.GetConstSlabPtr(y);
+            noise::uint8* pDest = m_pFile->Reserve((size_t)bufferSize);
+            for (int x = 0; x < m_fileWidth; x++)
             {
-                finalValue = static_cast<float>(planeModel.GetValue(xCur, zCur));
+                int16 scaledHeight = (int16)(floor(*pSource * 2.0));
+                UnpackLittle16(pDest, scaledHeight);
+                pDest += 2;
+                ++pSource;
             }
-            else
-            {
-                double swValue, seValue, nwValue, neValue;
-                swValue = planeModel.GetValue(xCur, zCur);
-                seValue = planeModel.GetValue(xCur + xExtent, zCur);
-                nwValue = planeModel.GetValue(xCur, zCur + zExtent);
-                neValue = planeModel.GetValue(xCur + xExtent, zCur + zExtent);
-                double xBlend = 1.0 - ((xCur - m_lowerXBound) / xExtent);
-                double zBlend = 1.0 - ((zCur - m_lowerZBound) / zExtent);
-                double z0 = LinearInterp(swValue, seValue, xBlend);
-                double z1 = LinearInterp(nwValue, neValue, xBlend);
-                finalValue = (float)LinearInterp(z0, z1, zBlend);
-            }
-            *pDest++ = finalValue;
-            xCur += xDelta;
-        }
-        zCur += zDelta;
-        if (m_pCallback != NULL)
-        {
-            m_pCallback(z);
         }
     }
+    catch (...)
+    {
+        m_pFile.reset();
+        throw;
+    }
+
+    m_writtenRowCount += rowCount;
 }
 
 /////////////////////////////////////////////////////////////////////////////
-// NoiseMapBuilderSphere class
+// WriterTiled class
 
-NoiseMapBuilderSphere::NoiseMapBuilderSphere()
-    : m_eastLonBound(0.0)
-    , m_northLatBound(0.0)
-    , m_southLatBound(0.0)
-    , m_westLonBound(0.0)
+WriterTiled::WriterTiled()
+    : m_int16Step(DEFAULT_TILE_INT16_STEP)
+    , m_isMipmapsEnabled(false)
+    , m_mappedViewSize(0)
+    , m_pMappedView(NULL)
+    , m_pSourceNoiseMap(NULL)
+    , m_tileFormat(TILE_FORMAT_FLOAT)
+    , m_tileSize(DEFAULT_TILE_SIZE)
+    , m_writtenRowCount(0)
 {
 }
 
-void NoiseMapBuilderSphere::Build()
+WriterTiled::~WriterTiled()
 {
-    if (m_eastLonBound <= m_westLonBound || m_northLatBound <= m_southLatBound || m_destWidth <= 0 || m_destHeight <= 0 || m_pSourceModule == NULL || m_pDestNoiseMap == NULL)
+    if (m_pMappedView != NULL)
     {
-        throw noise::ExceptionInvalidParam();
+        UnmapFileView(m_pMappedView, m_mappedViewSize);
     }
+}
 
-    // Resize the destination noise map so that it can store the new output
-    // values from the source model.
-    m_pDestNoiseMap->SetSize(m_destWidth, m_destHeight);
+void WriterTiled::CloseDestFile()
+{
+    if (m_pMappedView == NULL)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
 
-    // Create the plane model.
-    model::Sphere sphereModel;
-    sphereModel.SetModule(*m_pSourceModule);
+    // The magic marks the file as complete.
+    bool isComplete = (m_writtenRowCount == m_levels[0].height);
+    if (isComplete)
+    {
+        memcpy(m_pMappedView, TILED_FILE_MAGIC, sizeof(TILED_FILE_MAGIC));
+    }
+    UnmapFileView(m_pMappedView, m_mappedViewSize);
+    m_pMappedView = NULL;
+    m_mappedViewSize = 0;
+    if (!isComplete)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+}
 
-    double lonExtent = m_eastLonBound - m_westLonBound;
-    double latExtent = m_northLatBound - m_southLatBound;
-    double xDelta = lonExtent / (double)m_destWidth;
-    double yDelta = latExtent / (double)m_destHeight;
-    double curLon = m_westLonBound;
-    double curLat = m_southLatBound;
+void WriterTiled::OpenDestFile(int width, int height)
+{
+    if (width <= 0 || height <= 0 || width > MAPPED_RASTER_MAX_SIZE || height > MAPPED_RASTER_MAX_SIZE || m_pMappedView != NULL)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
 
-    // Fill every point in the noise map with the output values from the model.
-    for (int y = 0; y < m_destHeight; y++)
+    std::vector<TileLevel> levels;
+    std::vector<std::vector<float>> mipmapRows;
+    unsigned long long fileSize;
+    try
     {
-        float* pDest = m_pDestNoiseMap->GetSlabPtr(y);
-        curLon = m_westLonBound;
-        for (int x = 0; x < m_destWidth; x++)
-        {
-            float curValue = (float)sphereModel.GetValue(curLat, curLon);
-            *pDest++ = curValue;
-            curLon += xDelta;
-        }
-        curLat += yDelta;
-        if (m_pCallback != NULL)
+        fileSize = CalcTileLevels(width, height, m_tileSize, GetTilePointSize(m_tileFormat), m_isMipmapsEnabled, levels);
+        mipmapRows.resize(levels.size() - 1);
+        for (size_t i = 0; i < mipmapRows.size(); i++)
         {
-            m_pCallback(y);
+            mipmapRows[i].resize((size_t)levels[i].width + (size_t)levels[i + 1].width);
         }
     }
-}
+    catch (...)
+    {
+        throw noise::ExceptionOutOfMemory();
+    }
+    if (fileSize == 0)
+    {
+        throw noise::ExceptionOutOfMemory();
+    }
 
-//////////////////////////////////////////////////////////////////////////////
-// RendererImage class
+    // Create the file.  Its tiles are already filled with zeros.
+    noise::uint8* pView = (noise::uint8*)MapFileView(m_destFilename, (size_t)fileSize, true, true);
+    if (pView == NULL)
+    {
+        throw noise::ExceptionUnknown();
+    }
+
+    // Write the header and the index, except for the magic.
+    UnpackLittle32(pView + 8, TILED_FILE_VERSION);
+    UnpackLittle32(pView + 12, (noise::uint32)TILED_FILE_HEADER_SIZE);
+    UnpackLittle32(pView + 16, (noise::uint32)width);
+    UnpackLittle32(pView + 20, (noise::uint32)height);
+    UnpackLittle32(pView + 24, (noise::uint32)m_tileSize);
+    UnpackLittle32(pView + 28, (noise::uint32)m_tileFormat);
+    UnpackLittle32(pView + 32, (noise::uint32)levels.size());
+    UnpackFloat(pView + 36, m_int16Step);
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        noise::uint8* pLevel = pView + TILED_FILE_HEADER_SIZE + i * TILED_FILE_LEVEL_SIZE;
+        UnpackLittle32(pLevel, (noise::uint32)levels[i].width);
+        UnpackLittle32(pLevel + 4, (noise::uint32)levels[i].height);
+        UnpackLittle32(pLevel + 8, (noise::uint32)levels[i].tileCountX);
+        UnpackLittle32(pLevel + 12, (noise::uint32)levels[i].tileCountY);
+        UnpackLittle32(pLevel + 16, (noise::uint32)(levels[i].dataOffset & 0xffffffff));
+        UnpackLittle32(pLevel + 20, (noise::uint32)(levels[i].dataOffset >> 32));
+    }
+
+    m_levels.swap(levels);
+    m_mipmapRows.swap(mipmapRows);
+    m_pMappedView = pView;
+    m_mappedViewSize = (size_t)fileSize;
+    m_writtenRowCount = 0;
+}
+
+void WriterTiled::SetInt16Step(float step)
+{
+    if (!(step > 0.0f))
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    m_int16Step = step;
+}
+
+void WriterTiled::SetTileSize(int tileSize)
+{
+    if (tileSize < 1 || tileSize > RASTER_MAX_WIDTH)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    m_tileSize = tileSize;
+}
+
+void WriterTiled::StoreMipmapRow(int level, int y, const float* pLower, const float* pUpper)
+{
+    const TileLevel& sourceLevel = m_levels[level];
+    const TileLevel& destLevel = m_levels[level + 1];
+
+    // The last column of an odd-width level is averaged with itself.
+    float* pDest = &m_mipmapRows[level][sourceLevel.width];
+    int lastX = sourceLevel.width - 1;
+    for (int x = 0; x < destLevel.width; x++)
+    {
+        int x0 = x * 2;
+        int x1 = GetMin(x0 + 1, lastX);
+        pDest[x] = (pLower[x0] + pLower[x1] + pUpper[x0] + pUpper[x1]) * 0.25f;
+    }
+    StoreRow(level + 1, y / 2, pDest);
+}
+
+void WriterTiled::StoreRow(int level, int y, const float* pSource)
+{
+    const TileLevel& tileLevel = m_levels[level];
+    size_t pointSize = (size_t)GetTilePointSize(m_tileFormat);
+    size_t tileByteCount = (size_t)m_tileSize * m_tileSize * pointSize;
+
+    // Copy the row into the tiles of its row of tiles.
+    noise::uint8* pDest = m_pMappedView + tileLevel.dataOffset + (size_t)(y / m_tileSize) * tileLevel.tileCountX * tileByteCount + (size_t)(y % m_tileSize) * m_tileSize * pointSize;
+    for (int x = 0; x < tileLevel.width; x += m_tileSize)
+    {
+        int count = GetMin(m_tileSize, tileLevel.width - x);
+        if (m_tileFormat == TILE_FORMAT_FLOAT)
+        {
+            memcpy(pDest, pSource + x, (size_t)count * sizeof(float));
+        }
+        else
+        {
+            noise::int16* pPoints = (noise::int16*)pDest;
+            for (int i = 0; i < count; i++)
+            {
+                float scaled = floor(pSource[x + i] / m_int16Step + 0.5f);
+                pPoints[i] = (noise::int16)(scaled >= 32767.0f ? 32767.0f : (scaled >= -32768.0f ? scaled : -32768.0f));
+            }
+        }
+        pDest += tileByteCount;
+    }
+
+    // Average the row with the previous one into the next level.
+    if (level + 1 < (int)m_levels.size())
+    {
+        float* pPending = &m_mipmapRows[level][0];
+        if (y % 2 != 0)
+        {
+            StoreMipmapRow(level, y, pPending, pSource);
+        }
+        else if (y + 1 < tileLevel.height)
+        {
+            memcpy(pPending, pSource, (size_t)tileLevel.width * sizeof(float));
+        }
+        else
+        {
+            StoreMipmapRow(level, y, pSource, pSource);
+        }
+    }
+}
+
+void WriterTiled::WriteDestFile()
+{
+    if (m_pSourceNoiseMap == NULL)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    OpenDestFile(m_pSourceNoiseMap->GetWidth(), m_pSourceNoiseMap->GetHeight());
+    WriteRows(*m_pSourceNoiseMap);
+    CloseDestFile();
+}
+
+void WriterTiled::WriteRows(const NoiseMap& sourceRows)
+{
+    int rowCount = sourceRows.GetHeight();
+    if (m_pMappedView == NULL || (rowCount > 0 && sourceRows.GetWidth() != m_levels[0].width) || m_writtenRowCount + rowCount > m_levels[0].height)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    for (int y = 0; y < rowCount; y++)
+    {
+        StoreRow(0, m_writtenRowCount + y, sourceRows.GetConstSlabPtr(y));
+    }
+
+    m_writtenRowCount += rowCount;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// ReaderTiled class
+
+ReaderTiled::ReaderTiled()
+    : m_int16Step(DEFAULT_TILE_INT16_STEP)
+    , m_mappedViewSize(0)
+    , m_pMappedView(NULL)
+    , m_tileFormat(TILE_FORMAT_FLOAT)
+    , m_tileSize(DEFAULT_TILE_SIZE)
+{
+}
+
+ReaderTiled::~ReaderTiled()
+{
+    Close();
+}
+
+void ReaderTiled::Close()
+{
+    if (m_pMappedView != NULL)
+    {
+        UnmapFileView((void*)m_pMappedView, m_mappedViewSize);
+        m_pMappedView = NULL;
+        m_mappedViewSize = 0;
+    }
+    m_levels.clear();
+}
+
+const void* ReaderTiled::GetTileData(int level, int tileX, int tileY) const
+{
+    if (level < 0 || level >= GetLevelCount() || tileX < 0 || tileX >= m_levels[level].tileCountX || tileY < 0 || tileY >= m_levels[level].tileCountY)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    size_t tileByteCount = (size_t)m_tileSize * m_tileSize * GetTilePointSize(m_tileFormat);
+    return m_pMappedView + m_levels[level].dataOffset + ((size_t)tileY * m_levels[level].tileCountX + tileX) * tileByteCount;
+}
+
+void ReaderTiled::Open(const std::string& filename)
+{
+    Close();
+
+    // Read the header and make sure that it is complete and valid.
+    std::ifstream is(filename.c_str(), std::ios::in | std::ios::binary);
+    noise::uint8 header[TILED_FILE_HEADER_SIZE];
+    is.read((char*)header, sizeof(header));
+    if (is.fail() || memcmp(header, TILED_FILE_MAGIC, sizeof(TILED_FILE_MAGIC)) != 0 || PackLittle32(header + 8) != TILED_FILE_VERSION || PackLittle32(header + 12) != TILED_FILE_HEADER_SIZE)
+    {
+        throw noise::ExceptionUnknown();
+    }
+
+    noise::uint32 width = PackLittle32(header + 16);
+    noise::uint32 height = PackLittle32(header + 20);
+    noise::uint32 tileSize = PackLittle32(header + 24);
+    noise::uint32 tileFormat = PackLittle32(header + 28);
+    noise::uint32 levelCount = PackLittle32(header + 32);
+    float int16Step;
+    memcpy(&int16Step, header + 36, sizeof(int16Step));
+    if (width == 0 || height == 0 || width > (noise::uint32)MAPPED_RASTER_MAX_SIZE || height > (noise::uint32)MAPPED_RASTER_MAX_SIZE || tileSize == 0 || tileSize > (noise::uint32)RASTER_MAX_WIDTH || (tileFormat != TILE_FORMAT_FLOAT && tileFormat != TILE_FORMAT_INT16) || levelCount == 0 || !(int16Step > 0.0f))
+    {
+        throw noise::ExceptionUnknown();
+    }
+
+    // The index must describe the levels that the writer computes for this
+    // noise map.
+    std::vector<TileLevel> levels;
+    unsigned long long fileSize;
+    try
+    {
+        fileSize = CalcTileLevels((int)width, (int)height, (int)tileSize, GetTilePointSize((TileFormat)tileFormat), levelCount > 1, levels);
+    }
+    catch (...)
+    {
+        throw noise::ExceptionOutOfMemory();
+    }
+    if (levels.size() != levelCount)
+    {
+        throw noise::ExceptionUnknown();
+    }
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        noise::uint8 level[TILED_FILE_LEVEL_SIZE];
+        is.read((char*)level, sizeof(level));
+        unsigned long long dataOffset = PackLittle32(level + 16) | ((unsigned long long)PackLittle32(level + 20) << 32);
+        if (is.fail() || PackLittle32(level) != (noise::uint32)levels[i].width || PackLittle32(level + 4) != (noise::uint32)levels[i].height || PackLittle32(level + 8) != (noise::uint32)levels[i].tileCountX || PackLittle32(level + 12) != (noise::uint32)levels[i].tileCountY || dataOffset != levels[i].dataOffset)
+        {
+            throw noise::ExceptionUnknown();
+        }
+    }
+    if (fileSize == 0)
+    {
+        throw noise::ExceptionOutOfMemory();
+    }
+
+    is.seekg(0, std::ios::end);
+    unsigned long long actualFileSize = (unsigned long long)is.tellg();
+    if (is.fail() || actualFileSize < fileSize)
+    {
+        throw noise::ExceptionUnknown();
+    }
+    is.close();
+
+    const noise::uint8* pView = (const noise::uint8*)MapFileView(filename, (size_t)fileSize, false, false);
+    if (pView == NULL)
+    {
+        throw noise::ExceptionUnknown();
+    }
+
+    m_int16Step = int16Step;
+    m_levels.swap(levels);
+    m_mappedViewSize = (size_t)fileSize;
+    m_pMappedView = pView;
+    m_tileFormat = (TileFormat)tileFormat;
+    m_tileSize = (int)tileSize;
+}
+
+void ReaderTiled::ReadRegion(int level, int x, int y, int width, int height, NoiseMap& destNoiseMap) const
+{
+    if (m_pMappedView == NULL || level < 0 || level >= GetLevelCount() || width <= 0 || height <= 0)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    // Resizing the noise map resets its border value.
+    float borderValue = destNoiseMap.GetBorderValue();
+    destNoiseMap.SetSize(width, height);
+    destNoiseMap.SetBorderValue(borderValue);
+
+    // The part of the region inside the level, relative to the region.
+    const TileLevel& tileLevel = m_levels[level];
+    long long xBegin = GetMax(-(long long)x, 0LL);
+    long long xEnd = GetMin((long long)tileLevel.width - x, (long long)width);
+    size_t pointSize = (size_t)GetTilePointSize(m_tileFormat);
+    for (int row = 0; row < height; row++)
+    {
+        float* pDest = destNoiseMap.GetSlabPtr(row);
+        long long sourceY = (long long)y + row;
+        if (sourceY < 0 || sourceY >= tileLevel.height || xBegin >= xEnd)
+        {
+            std::fill(pDest, pDest + width, borderValue);
+            continue;
+        }
+
+        std::fill(pDest, pDest + xBegin, borderValue);
+        std::fill(pDest + xEnd, pDest + width, borderValue);
+
+        // Copy the points from each tile that the row crosses.
+        int tileY = (int)sourceY / m_tileSize;
+        size_t rowOffset = (size_t)(sourceY % m_tileSize) * m_tileSize;
+        for (int destX = (int)xBegin; destX < (int)xEnd;)
+        {
+            int sourceX = x + destX;
+            int tileX = sourceX / m_tileSize;
+            int count = GetMin((tileX + 1) * m_tileSize - sourceX, (int)xEnd - destX);
+            const noise::uint8* pSource = (const noise::uint8*)GetTileData(level, tileX, tileY) + (rowOffset + (size_t)(sourceX % m_tileSize)) * pointSize;
+            if (m_tileFormat == TILE_FORMAT_FLOAT)
+            {
+                memcpy(pDest + destX, pSource, (size_t)count * sizeof(float));
+            }
+            else
+            {
+                const noise::int16* pPoints = (const noise::int16*)pSource;
+                for (int i = 0; i < count; i++)
+                {
+                    pDest[destX + i] = (float)pPoints[i] * m_int16Step;
+                }
+            }
+            destX += count;
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// ScratchArena class
+
+ScratchArena::ScratchArena()
+    : m_blockCount(0)
+    , m_usedSize(0)
+{
+}
+
+void* ScratchArena::Allocate(size_t size)
+{
+    size_t alignedSize = GetMax((size + SCRATCH_ARENA_ALIGNMENT - 1) & ~(SCRATCH_ARENA_ALIGNMENT - 1), SCRATCH_ARENA_ALIGNMENT);
+
+    if (m_blockCount == 0 || m_usedSize + alignedSize > m_blocks[m_blockCount - 1].size)
+    {
+        // Move on to the next block.  Reuse it if it is large enough;
+        // otherwise, replace it and the blocks after it by a block at least
+        // as large as all blocks before it, so that the number of blocks stays
+        // small.
+        if (m_blockCount == m_blocks.size() || m_blocks[m_blockCount].size < alignedSize)
+        {
+            m_blocks.resize(m_blockCount);
+            Block block;
+            block.size = GetMax(GetMax(alignedSize, SCRATCH_ARENA_BLOCK_SIZE), GetCapacity());
+            try
+            {
+                block.pData.reset(new char[block.size + SCRATCH_ARENA_ALIGNMENT - 1]);
+            }
+            catch (...)
+            {
+                throw noise::ExceptionOutOfMemory();
+            }
+            m_blocks.push_back(std::move(block));
+        }
+        m_blockCount++;
+        m_usedSize = 0;
+    }
+
+    uintptr_t blockBegin = (uintptr_t)m_blocks[m_blockCount - 1].pData.get();
+    char* pBlock = (char*)((blockBegin + SCRATCH_ARENA_ALIGNMENT - 1) & ~(uintptr_t)(SCRATCH_ARENA_ALIGNMENT - 1));
+    void* pMemory = pBlock + m_usedSize;
+    m_usedSize += alignedSize;
+    return pMemory;
+}
+
+size_t ScratchArena::GetCapacity() const
+{
+    size_t capacity = 0;
+    for (size_t i = 0; i < m_blocks.size(); i++)
+    {
+        capacity += m_blocks[i].size;
+    }
+    return capacity;
+}
+
+ScratchArena::Mark ScratchArena::GetMark() const
+{
+    Mark mark;
+    mark.blockCount = m_blockCount;
+    mark.usedSize = m_usedSize;
+    return mark;
+}
+
+void ScratchArena::Release(const Mark& mark)
+{
+    m_blockCount = mark.blockCount;
+    m_usedSize = mark.usedSize;
+
+    if (m_blockCount == 0 && m_blocks.size() > 1)
+    {
+        // Merge the blocks into one; if that fails, the arena simply starts
+        // over from no blocks.
+        Block block;
+        block.size = GetCapacity();
+        m_blocks.clear();
+        try
+        {
+            block.pData.reset(new char[block.size + SCRATCH_ARENA_ALIGNMENT - 1]);
+            m_blocks.push_back(std::move(block));
+        }
+        catch (...)
+        {
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// ThreadPool class
+
+struct ThreadPool::Job
+{
+    // A range of tasks that one thread runs in order, and that the other
+    // threads steal from.
+    struct TaskRange
+    {
+        std::mutex mutex;
+        int begin;
+        int end;
+    };
+
+    Job(ExecutionContext& context, std::atomic<size_t>& contextCompletedTaskCount, int taskCount, int rangeCount, const std::function<void(int task)>& runTask)
+        : activeThreadCount(0)
+        , completedTaskCount(0)
+        , context(context)
+        , contextCompletedTaskCount(contextCompletedTaskCount)
+        , isStopped(false)
+        , nextRange(0)
+        , pRanges(new TaskRange[rangeCount])
+        , rangeCount(rangeCount)
+        , runTask(runTask)
+    {
+        for (int i = 0; i < rangeCount; i++)
+        {
+            pRanges[i].begin = (int)((long long)taskCount * i / rangeCount);
+            pRanges[i].end = (int)((long long)taskCount * (i + 1) / rangeCount);
+        }
+    }
+
+    // Claims the next task of a range, or steals tasks from another range if
+    // it is empty.  Returns false if no tasks are left.
+    bool ClaimTask(int rangeIndex, int& task)
+    {
+        TaskRange& ownRange = pRanges[rangeIndex];
+        {
+            std::lock_guard<std::mutex> lock(ownRange.mutex);
+            if (ownRange.begin < ownRange.end)
+            {
+                task = ownRange.begin++;
+                return true;
+            }
+        }
+
+        for (;;)
+        {
+            // Find the range with the most tasks left.
+            int victimIndex = -1;
+            int victimTaskCount = 0;
+            for (int i = 0; i < rangeCount; i++)
+            {
+                std::lock_guard<std::mutex> lock(pRanges[i].mutex);
+                if (pRanges[i].end - pRanges[i].begin > victimTaskCount)
+                {
+                    victimIndex = i;
+                    victimTaskCount = pRanges[i].end - pRanges[i].begin;
+                }
+            }
+            if (victimIndex < 0)
+            {
+                return false;
+            }
+
+            // Take the second half of its tasks; the first task of that half
+            // is run now, and the rest becomes the new own range.
+            int stolenBegin, stolenEnd;
+            {
+                TaskRange& victimRange = pRanges[victimIndex];
+                std::lock_guard<std::mutex> lock(victimRange.mutex);
+                if (victimRange.begin >= victimRange.end)
+                {
+                    // Another thread emptied the range in the meantime.
+                    continue;
+                }
+                stolenEnd = victimRange.end;
+                stolenBegin = victimRange.begin + (victimRange.end - victimRange.begin) / 2;
+                victimRange.end = stolenBegin;
+            }
+
+            std::lock_guard<std::mutex> lock(ownRange.mutex);
+            task = stolenBegin;
+            ownRange.begin = stolenBegin + 1;
+            ownRange.end = stolenEnd;
+            return true;
+        }
+    }
+
+    // Runs tasks until none are left, or until the job stops because a task
+    // threw an exception or the context was cancelled.
+    void RunTasks()
+    {
+        int rangeIndex = nextRange++ % rangeCount;
+        ScratchArena& scratchArena = ExecutionContext::GetScratchArena();
+        int task;
+        while (!isStopped && !context.IsCancelled() && ClaimTask(rangeIndex, task))
+        {
+            ScratchArena::Mark mark = scratchArena.GetMark();
+            try
+            {
+                runTask(task);
+            }
+            catch (...)
+            {
+                scratchArena.Release(mark);
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!pError)
+                {
+                    pError = std::current_exception();
+                }
+                isStopped = true;
+                break;
+            }
+            scratchArena.Release(mark);
+            completedTaskCount++;
+            contextCompletedTaskCount++;
+        }
+    }
+
+    // Number of worker threads working on the job; protected by the mutex
+    // of the thread pool.
+    int activeThreadCount;
+
+    // Signals the thread that runs the job when the last worker thread
+    // leaves it.
+    std::condition_variable allThreadsDone;
+
+    // Number of tasks that have completed.
+    std::atomic<int> completedTaskCount;
+
+    // The execution context that runs the job, and its count of completed
+    // tasks.
+    ExecutionContext& context;
+    std::atomic<size_t>& contextCompletedTaskCount;
+
+    // A flag that tells the threads to stop claiming tasks.
+    std::atomic<bool> isStopped;
+
+    // The first exception thrown by a task, protected by errorMutex.
+    std::exception_ptr pError;
+    std::mutex errorMutex;
+
+    // Index of the range of the next thread that joins the job.
+    std::atomic<int> nextRange;
+
+    // The ranges of tasks.
+    std::unique_ptr<TaskRange[]> pRanges;
+    int rangeCount;
+
+    // The function that runs a task.
+    const std::function<void(int task)>& runTask;
+};
+
+ThreadPool::ThreadPool(int threadCount)
+    : m_isStopping(false)
+    , m_threadCount(1)
+{
+    if (threadCount < 0)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    m_threadCount = GetEffectiveThreadCount(threadCount);
+    m_threads.reserve(m_threadCount - 1);
+    for (int i = 0; i < m_threadCount - 1; i++)
+    {
+        m_threads.push_back(std::thread([this]() { RunWorker(); }));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+    }
+    m_jobAdded.notify_all();
+    for (size_t i = 0; i < m_threads.size(); i++)
+    {
+        m_threads[i].join();
+    }
+}
+
+void ThreadPool::RunJob(Job& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(&job);
+    }
+    m_jobAdded.notify_all();
+
+    job.RunTasks();
+
+    // No tasks are left to claim.  Make sure that no other worker thread
+    // joins the job, and wait for the ones working on it to finish their
+    // tasks.
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobs.remove(&job);
+    job.allThreadsDone.wait(lock, [&]() { return job.activeThreadCount == 0; });
+}
+
+void ThreadPool::RunWorker()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        m_jobAdded.wait(lock, [&]() { return m_isStopping || !m_jobs.empty(); });
+        if (m_isStopping)
+        {
+            return;
+        }
+
+        // Help with the oldest job.  Once its tasks are all claimed, remove
+        // it from the list so that the worker threads move on to the next
+        // job.
+        Job* pJob = m_jobs.front();
+        pJob->activeThreadCount++;
+        lock.unlock();
+        pJob->RunTasks();
+        lock.lock();
+        m_jobs.remove(pJob);
+        if (--pJob->activeThreadCount == 0)
+        {
+            pJob->allThreadsDone.notify_all();
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// ExecutionContext class
+
+ExecutionContext::ExecutionContext()
+    : m_completedTaskCount(0)
+    , m_isCancelled(false)
+    , m_pThreadPool(NULL)
+    , m_taskCount(0)
+{
+}
+
+ExecutionContext::ExecutionContext(ThreadPool& threadPool)
+    : m_completedTaskCount(0)
+    , m_isCancelled(false)
+    , m_pThreadPool(&threadPool)
+    , m_taskCount(0)
+{
+}
+
+ScratchArena& ExecutionContext::GetScratchArena()
+{
+    static thread_local ScratchArena scratchArena;
+    return scratchArena;
+}
+
+void ExecutionContext::Reset()
+{
+    m_completedTaskCount = 0;
+    m_isCancelled = false;
+    m_taskCount = 0;
+}
+
+void ExecutionContext::Run(int taskCount, const std::function<void(int task)>& runTask)
+{
+    if (m_isCancelled)
+    {
+        throw noise::ExceptionCancelled();
+    }
+    if (taskCount <= 0)
+    {
+        return;
+    }
+
+    m_taskCount += taskCount;
+    int rangeCount = GetMin(GetThreadCount(), taskCount);
+    ThreadPool::Job job(*this, m_completedTaskCount, taskCount, rangeCount, runTask);
+    if (rangeCount <= 1)
+    {
+        job.RunTasks();
+    }
+    else
+    {
+        m_pThreadPool->RunJob(job);
+    }
+
+    if (job.pError)
+    {
+        std::rethrow_exception(job.pError);
+    }
+    if (job.completedTaskCount < taskCount)
+    {
+        throw noise::ExceptionCancelled();
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// NoiseMapBuilder class
+
+NoiseMapBuilder::NoiseMapBuilder()
+    : m_pCallback(NULL)
+    , m_destHeight(0)
+    , m_destWidth(0)
+    , m_pExecutionContext(NULL)
+    , m_pDestNoiseMap(NULL)
+    , m_isFloatEvaluationEnabled(false)
+    , m_pSourceModule(NULL)
+    , m_threadCount(1)
+{
+}
+
+void NoiseMapBuilder::Build()
+{
+    if (m_pDestNoiseMap == NULL)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    BuildBand(0, m_destHeight, *m_pDestNoiseMap);
+}
+
+void NoiseMapBuilder::BuildBand(int yBegin, int yEnd, NoiseMap& destBand)
+{
+    if (yBegin < 0 || yEnd <= yBegin || yEnd > m_destHeight)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    BuildRegion(0, yBegin, m_destWidth, yEnd - yBegin, 1, destBand);
+}
+
+void NoiseMapBuilder::BuildRows(int yBegin, int yEnd, const std::function<void(int row)>& buildRow)
+{
+    if (m_pCallback == NULL)
+    {
+        RunTasks(m_pExecutionContext, m_threadCount, yEnd - yBegin, [&](int task) { buildRow(yBegin + task); });
+        return;
+    }
+
+    // The callback function is called in row order from the calling thread.
+    // Each time the calling thread completes a row, it reports the completed
+    // rows that follow the last reported row; the remaining rows are reported
+    // once all rows are complete.
+    std::thread::id callingThreadId = std::this_thread::get_id();
+    std::vector<char> isRowDone(yEnd - yBegin, 0);
+    std::mutex mutex;
+    int nextReportedRow = yBegin;
+
+    auto reportRows = [&]() {
+        for (;;)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (nextReportedRow == yEnd || isRowDone[nextReportedRow - yBegin] == 0)
+                {
+                    break;
+                }
+            }
+            m_pCallback(nextReportedRow++);
+        }
+    };
+
+    RunTasks(m_pExecutionContext, m_threadCount, yEnd - yBegin, [&](int task) {
+        buildRow(yBegin + task);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isRowDone[task] = 1;
+        }
+        if (std::this_thread::get_id() == callingThreadId)
+        {
+            reportRows();
+        }
+    });
+    reportRows();
+}
+
+bool NoiseMapBuilder::IsRegionValid(int xBegin, int yBegin, int width, int height, int step) const
+{
+    return width > 0 && height > 0 && step > 0 && xBegin >= 0 && yBegin >= 0 && xBegin + (long long)(width - 1) * step < m_destWidth && yBegin + (long long)(height - 1) * step < m_destHeight;
+}
+
+void NoiseMapBuilder::SetCallback(NoiseMapCallback pCallback)
+{
+    m_pCallback = pCallback;
+}
+
+void NoiseMapBuilder::SetExecutionContext(ExecutionContext* pContext)
+{
+    m_pExecutionContext = pContext;
+}
+
+void NoiseMapBuilder::SetThreadCount(int threadCount)
+{
+    if (threadCount < 0)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    m_threadCount = threadCount;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// NoiseMapBuilderCylinder class
+
+NoiseMapBuilderCylinder::NoiseMapBuilderCylinder()
+    : m_lowerAngleBound(0.0)
+    , m_lowerHeightBound(0.0)
+    , m_upperAngleBound(0.0)
+    , m_upperHeightBound(0.0)
+{
+}
+
+void NoiseMapBuilderCylinder::BuildRegion(int xBegin, int yBegin, int width, int height, int step, NoiseMap& destRegion)
+{
+    if (m_upperAngleBound <= m_lowerAngleBound || m_upperHeightBound <= m_lowerHeightBound || m_destWidth <= 0 || m_destHeight <= 0 || m_pSourceModule == NULL || !IsRegionValid(xBegin, yBegin, width, height, step))
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    // Resize the region noise map so that it can store the new output values
+    // from the source model.
+    destRegion.SetSize(width, height);
+
+    // Create the cylinder model.
+    model::Cylinder cylinderModel;
+    cylinderModel.SetModule(*m_pSourceModule);
+
+    double angleExtent = m_upperAngleBound - m_lowerAngleBound;
+    double heightExtent = m_upperHeightBound - m_lowerHeightBound;
+    double xDelta = angleExtent / (double)m_destWidth;
+    double yDelta = heightExtent / (double)m_destHeight;
+
+    // Compute the angle of each column and the height of each row of the
+    // region up front, the same way for every region and thread count.
+    std::vector<double> columnAngles;
+    std::vector<double> rowHeights;
+    CalcRegionCoords(m_lowerAngleBound, xDelta, xBegin, width, step, columnAngles);
+    CalcRegionCoords(m_lowerHeightBound, yDelta, yBegin, height, step, rowHeights);
+
+    // Fill every point in the noise map with the output values from the model.
+    // Each row is evaluated in batches of input values.
+    BuildRows(yBegin, yBegin + height, [&](int y) {
+        double angles[MAX_BATCH_SIZE];
+        double heights[MAX_BATCH_SIZE];
+        double values[MAX_BATCH_SIZE];
+        float* pDest = destRegion.GetSlabPtr(y - yBegin);
+        for (int x = 0; x < width; x += (int)MAX_BATCH_SIZE)
+        {
+            int count = GetMin(width - x, (int)MAX_BATCH_SIZE);
+            for (int i = 0; i < count; i++)
+            {
+                angles[i] = columnAngles[x + i];
+                heights[i] = rowHeights[y - yBegin];
+            }
+            if (m_isFloatEvaluationEnabled)
+            {
+                cylinderModel.GetFloatValues(angles, heights, pDest, count);
+                pDest += count;
+                continue;
+            }
+            cylinderModel.GetValues(angles, heights, values, count);
+            for (int i = 0; i < count; i++)
+            {
+                *pDest++ = (float)values[i];
+            }
+        }
+    });
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// NoiseMapBuilderPlane class
+
+NoiseMapBuilderPlane::NoiseMapBuilderPlane()
+    : m_isSeamlessEnabled(false)
+    , m_lowerXBound(0.0)
+    , m_lowerZBound(0.0)
+    , m_upperXBound(0.0)
+    , m_upperZBound(0.0)
+{
+}
+
+void NoiseMapBuilderPlane::BuildRegion(int xBegin, int yBegin, int width, int height, int step, NoiseMap& destRegion)
+{
+    if (m_upperXBound <= m_lowerXBound || m_upperZBound <= m_lowerZBound || m_destWidth <= 0 || m_destHeight <= 0 || m_pSourceModule == NULL || !IsRegionValid(xBegin, yBegin, width, height, step))
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    // Resize the region noise map so that it can store the new output values
+    // from the source model.
+    destRegion.SetSize(width, height);
+
+    // Create the plane model.
+    model::Plane planeModel;
+    planeModel.SetModule(*m_pSourceModule);
+
+    double xExtent = m_upperXBound - m_lowerXBound;
+    double zExtent = m_upperZBound - m_lowerZBound;
+    double xDelta = xExtent / (double)m_destWidth;
+    double zDelta = zExtent / (double)m_destHeight;
+
+    // Compute the x coordinate of each column and the z coordinate of each
+    // row of the region up front, the same way for every region and thread
+    // count.
+    std::vector<double> columnXs;
+    std::vector<double> rowZs;
+    CalcRegionCoords(m_lowerXBound, xDelta, xBegin, width, step, columnXs);
+    CalcRegionCoords(m_lowerZBound, zDelta, yBegin, height, step, rowZs);
+
+    // Evaluates the model in the precision selected by
+    // EnableFloatEvaluation(); the seamless blending is done in double
+    // precision either way.
+    auto getValues = [&](const double* xs, const double* zs, double* values, int count) {
+        if (m_isFloatEvaluationEnabled)
+        {
+            float floatValues[MAX_BATCH_SIZE];
+            planeModel.GetFloatValues(xs, zs, floatValues, count);
+            for (int i = 0; i < count; i++)
+            {
+                values[i] = floatValues[i];
+            }
+        }
+        else
+        {
+            planeModel.GetValues(xs, zs, values, count);
+        }
+    };
+
+    // Fill every point in the noise map with the output values from the model.
+    // Each row is evaluated in batches of input values.
+    BuildRows(yBegin, yBegin + height, [&](int z) {
+        double xs[MAX_BATCH_SIZE];
+        double zs[MAX_BATCH_SIZE];
+        double xsEast[MAX_BATCH_SIZE];
+        double zsNorth[MAX_BATCH_SIZE];
+        double swValues[MAX_BATCH_SIZE];
+        double seValues[MAX_BATCH_SIZE];
+        double nwValues[MAX_BATCH_SIZE];
+        double neValues[MAX_BATCH_SIZE];
+        float* pDest = destRegion.GetSlabPtr(z - yBegin);
+        for (int x = 0; x < width; x += (int)MAX_BATCH_SIZE)
+        {
+            int count = GetMin(width - x, (int)MAX_BATCH_SIZE);
+            for (int i = 0; i < count; i++)
+            {
+                xs[i] = columnXs[x + i];
+                zs[i] = rowZs[z - yBegin];
+            }
+
+            if (!m_isSeamlessEnabled && m_isFloatEvaluationEnabled)
+            {
+                planeModel.GetFloatValues(xs, zs, pDest, count);
+                pDest += count;
+            }
+            else if (!m_isSeamlessEnabled)
+            {
+                planeModel.GetValues(xs, zs, swValues, count);
+                for (int i = 0; i < count; i++)
+                {
+                    *pDest++ = static_cast<float>(swValues[i]);
+                }
+            }
+            else
+            {
+                for (int i = 0; i < count; i++)
+                {
+                    xsEast[i] = xs[i] + xExtent;
+                    zsNorth[i] = zs[i] + zExtent;
+                }
+                getValues(xs, zs, swValues, count);
+                getValues(xsEast, zs, seValues, count);
+                getValues(xs, zsNorth, nwValues, count);
+                getValues(xsEast, zsNorth, neValues, count);
+                double zBlend = 1.0 - ((rowZs[z - yBegin] - m_lowerZBound) / zExtent);
+                for (int i = 0; i < count; i++)
+                {
+                    double xBlend = 1.0 - ((xs[i] - m_lowerXBound) / xExtent);
+                    double z0 = LinearInterp(swValues[i], seValues[i], xBlend);
+                    double z1 = LinearInterp(nwValues[i], neValues[i], xBlend);
+                    *pDest++ = (float)LinearInterp(z0, z1, zBlend);
+                }
+            }
+        }
+    });
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// NoiseMapBuilderSphere class
+
+NoiseMapBuilderSphere::NoiseMapBuilderSphere()
+    : m_eastLonBound(0.0)
+    , m_northLatBound(0.0)
+    , m_southLatBound(0.0)
+    , m_westLonBound(0.0)
+{
+}
+
+void NoiseMapBuilderSphere::BuildRegion(int xBegin, int yBegin, int width, int height, int step, NoiseMap& destRegion)
+{
+    if (m_eastLonBound <= m_westLonBound || m_northLatBound <= m_southLatBound || m_destWidth <= 0 || m_destHeight <= 0 || m_pSourceModule == NULL || !IsRegionValid(xBegin, yBegin, width, height, step))
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    // Resize the region noise map so that it can store the new output values
+    // from the source model.
+    destRegion.SetSize(width, height);
+
+    // Create the plane model.
+    model::Sphere sphereModel;
+    sphereModel.SetModule(*m_pSourceModule);
+
+    double lonExtent = m_eastLonBound - m_westLonBound;
+    double latExtent = m_northLatBound - m_southLatBound;
+    double xDelta = lonExtent / (double)m_destWidth;
+    double yDelta = latExtent / (double)m_destHeight;
+
+    // Compute the longitude of each column and the latitude of each row of
+    // the region up front, the same way for every region and thread count.
+    std::vector<double> columnLons;
+    std::vector<double> rowLats;
+    CalcRegionCoords(m_westLonBound, xDelta, xBegin, width, step, columnLons);
+    CalcRegionCoords(m_southLatBound, yDelta, yBegin, height, step, rowLats);
+
+    // Fill every point in the noise map with the output values from the model.
+    // Each row is evaluated in batches of input values.
+    BuildRows(yBegin, yBegin + height, [&](int y) {
+        double lats[MAX_BATCH_SIZE];
+        double lons[MAX_BATCH_SIZE];
+        double values[MAX_BATCH_SIZE];
+        float* pDest = destRegion.GetSlabPtr(y - yBegin);
+        for (int x = 0; x < width; x += (int)MAX_BATCH_SIZE)
+        {
+            int count = GetMin(width - x, (int)MAX_BATCH_SIZE);
+            for (int i = 0; i < count; i++)
+            {
+                lats[i] = rowLats[y - yBegin];
+                lons[i] = columnLons[x + i];
+            }
+            if (m_isFloatEvaluationEnabled)
+            {
+                sphereModel.GetFloatValues(lats, lons, pDest, count);
+                pDest += count;
+                continue;
+            }
+            sphereModel.GetValues(lats, lons, values, count);
+            for (int i = 0; i < count; i++)
+            {
+                *pDest++ = (float)values[i];
+            }
+        }
+    });
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// RendererImage class
 
 RendererImage::RendererImage()
     : m_isLightEnabled(false)
@@ -1004,8 +2858,10 @@ RendererImage::RendererImage()
     , m_lightIntensity(1.0)
     , m_pBackgroundImage(NULL)
     , m_pDestImage(NULL)
+    , m_pExecutionContext(NULL)
     , m_pSourceNoiseMap(NULL)
     , m_recalcLightValues(true)
+    , m_threadCount(1)
 {
     BuildGrayscaleGradient();
 };
@@ -1084,11 +2940,11 @@ Color RendererImage::CalcDestColor(const Color& sourceColor, const Color& backgr
     return newColor;
 }
 
-double RendererImage::CalcLightIntensity(double center, double left, double right, double down, double up) const
+void RendererImage::CalcLightValues() const
 {
     // Recalculate the sine and cosine of the various light values if
-    // necessary so it does not have to be calculated each time this method is
-    // called.
+    // necessary so it does not have to be calculated each time the image is
+    // rendered.
     if (m_recalcLightValues)
     {
         m_cosAzimuth = cos(m_lightAzimuth * DEG_TO_RAD);
@@ -1097,18 +2953,6 @@ double RendererImage::CalcLightIntensity(double center, double left, double righ
         m_sinElev = sin(m_lightElev * DEG_TO_RAD);
         m_recalcLightValues = false;
     }
-
-    // Now do the lighting calculations.
-    const double I_MAX = 1.0;
-    double io = I_MAX * SQRT_2 * m_sinElev / 2.0;
-    double ix = (I_MAX - io) * m_lightContrast * SQRT_2 * m_cosElev * m_cosAzimuth;
-    double iy = (I_MAX - io) * m_lightContrast * SQRT_2 * m_cosElev * m_sinAzimuth;
-    double intensity = (ix * (left - right) + iy * (down - up) + io);
-    if (intensity < 0.0)
-    {
-        intensity = 0.0;
-    }
-    return intensity;
 }
 
 void RendererImage::ClearGradient()
@@ -1143,140 +2987,150 @@ void RendererImage::Render()
         m_pDestImage->SetSize(width, height);
     }
 
-    for (int y = 0; y < height; y++)
+    // Calculate the light values up front, so that the threads only read
+    // them.
+    CalcLightValues();
+
+    std::vector<const float*> sourceRows = GetRendererRows(*m_pSourceNoiseMap, m_isWrapEnabled);
+    RenderRows(&sourceRows[0], width, height, 0, *m_pDestImage);
+}
+
+void RendererImage::RenderBand(const NoiseMap& sourceBand, int yBegin, Image& destBand)
+{
+    if (sourceBand.GetWidth() <= 0 || sourceBand.GetHeight() < 3 || yBegin < 0 || m_gradient.GetGradientPointCount() < 2)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    int width = sourceBand.GetWidth();
+    int rowCount = sourceBand.GetHeight() - 2;
+
+    // If a background image was provided, make sure it contains the rows of
+    // the band.
+    if (m_pBackgroundImage != NULL)
     {
-        const Color* pBackground = NULL;
-        if (m_pBackgroundImage != NULL)
+        if (m_pBackgroundImage->GetWidth() != width || m_pBackgroundImage->GetHeight() < yBegin + rowCount || m_pBackgroundImage == &destBand)
         {
-            pBackground = m_pBackgroundImage->GetConstSlabPtr(y);
+            throw noise::ExceptionInvalidParam();
         }
-        const float* pSource = m_pSourceNoiseMap->GetConstSlabPtr(y);
-        Color* pDest = m_pDestImage->GetSlabPtr(y);
-        for (int x = 0; x < width; x++)
+    }
+
+    destBand.SetSize(width, rowCount);
+
+    CalcLightValues();
+
+    std::vector<const float*> sourceRows(rowCount + 2);
+    for (int i = 0; i < rowCount + 2; i++)
+    {
+        sourceRows[i] = sourceBand.GetConstSlabPtr(i);
+    }
+    RenderRows(&sourceRows[0], width, rowCount, yBegin, destBand);
+}
+
+void RendererImage::RenderRows(const float* const* ppSourceRows, int width, int rowCount, int backgroundYBegin, Image& destImage) const
+{
+    // Calculate the lighting factors once for all rows.
+    const double I_MAX = 1.0;
+    LightFactors factors;
+    factors.io = I_MAX * SQRT_2 * m_sinElev / 2.0;
+    factors.ix = (I_MAX - factors.io) * m_lightContrast * SQRT_2 * m_cosElev * m_cosAzimuth;
+    factors.iy = (I_MAX - factors.io) * m_lightContrast * SQRT_2 * m_cosElev * m_sinAzimuth;
+    factors.brightness = m_lightBrightness;
+
+    // Render bands of rows in parallel.  Each pixel only depends on the
+    // source rows and the background image, so the bands are independent of
+    // each other.
+    int bandCount = (rowCount + RENDER_BAND_HEIGHT - 1) / RENDER_BAND_HEIGHT;
+    RunTasks(m_pExecutionContext, m_threadCount, bandCount, [&](int band) {
+        int yBegin = band * RENDER_BAND_HEIGHT;
+        int yEnd = GetMin(yBegin + RENDER_BAND_HEIGHT, rowCount);
+
+        // Light intensity of each point of the current row.
+        double* lightIntensities = ExecutionContext::GetScratchArena().AllocateArray<double>(width);
+        std::fill(lightIntensities, lightIntensities + width, 1.0);
+
+        for (int y = yBegin; y < yEnd; y++)
         {
-
-            // Get the color based on the value at the current point in the noise
-            // map.
-            Color destColor = m_gradient.GetColor(*pSource);
-
-            // If lighting is enabled, calculate the light intensity based on the
-            // rate of change at the current point in the noise map.
-            double lightIntensity;
+            const Color* pBackground = NULL;
+            if (m_pBackgroundImage != NULL)
+            {
+                pBackground = m_pBackgroundImage->GetConstSlabPtr(backgroundYBegin + y);
+            }
+            const float* pDown = ppSourceRows[y];
+            const float* pSource = ppSourceRows[y + 1];
+            const float* pUp = ppSourceRows[y + 2];
+            Color* pDest = destImage.GetSlabPtr(y);
+
+            // If lighting is enabled, calculate the light intensity of each
+            // point of the row based on the rate of change at that point in
+            // the noise map.
             if (m_isLightEnabled)
             {
-
-                // Calculate the positions of the current point's four-neighbors.
-                int xLeftOffset, xRightOffset;
-                int yUpOffset, yDownOffset;
-                if (m_isWrapEnabled)
+                // The left and right neighbors of the points between the first
+                // and the last point of a row are always one point away, so the
+                // row kernel handles them; only the points on the edges of the
+                // noise map need the wrapping or cropping rules.
+                int xKernelEnd = 1;
+                if (width > 2)
                 {
-                    if (x == 0)
-                    {
-                        xLeftOffset = (int)width - 1;
-                        xRightOffset = 1;
-                    }
-                    else if (x == (int)width - 1)
-                    {
-                        xLeftOffset = -1;
-                        xRightOffset = -((int)width - 1);
-                    }
-                    else
-                    {
-                        xLeftOffset = -1;
-                        xRightOffset = 1;
-                    }
-                    if (y == 0)
-                    {
-                        yDownOffset = (int)height - 1;
-                        yUpOffset = 1;
-                    }
-                    else if (y == (int)height - 1)
-                    {
-                        yDownOffset = -1;
-                        yUpOffset = -((int)height - 1);
-                    }
-                    else
-                    {
-                        yDownOffset = -1;
-                        yUpOffset = 1;
-                    }
+                    xKernelEnd += CalcLightRow(pDown + 1, pSource + 1, pUp + 1, width - 2, factors, &lightIntensities[1]);
                 }
-                else
-                {
-                    if (x == 0)
-                    {
-                        xLeftOffset = 0;
-                        xRightOffset = 1;
-                    }
-                    else if (x == (int)width - 1)
-                    {
-                        xLeftOffset = -1;
-                        xRightOffset = 0;
-                    }
-                    else
-                    {
-                        xLeftOffset = -1;
-                        xRightOffset = 1;
-                    }
-                    if (y == 0)
-                    {
-                        yDownOffset = 0;
-                        yUpOffset = 1;
-                    }
-                    else if (y == (int)height - 1)
-                    {
-                        yDownOffset = -1;
-                        yUpOffset = 0;
-                    }
-                    else
+
+                auto calcLightPoint = [&](int x) {
+                    // Calculate the positions of the current point's left and
+                    // right neighbors.
+                    int xLeftOffset = -1;
+                    int xRightOffset = 1;
+                    if (x == 0 || x == width - 1)
                     {
-                        yDownOffset = -1;
-                        yUpOffset = 1;
+                        CalcNeighborOffsets(x, width, m_isWrapEnabled, xLeftOffset, xRightOffset);
                     }
-                }
-                yDownOffset *= m_pSourceNoiseMap->GetStride();
-                yUpOffset *= m_pSourceNoiseMap->GetStride();
-
-                // Get the noise value of the current point in the source noise map
-                // and the noise values of its four-neighbors.
-                double nc = (double)(*pSource);
-                double nl = (double)(*(pSource + xLeftOffset));
-                double nr = (double)(*(pSource + xRightOffset));
-                double nd = (double)(*(pSource + yDownOffset));
-                double nu = (double)(*(pSource + yUpOffset));
-
-                // Now we can calculate the lighting intensity.
-                lightIntensity = CalcLightIntensity(nc, nl, nr, nd, nu);
-                lightIntensity *= m_lightBrightness;
-            }
-            else
-            {
 
-                // These values will apply no lighting to the destination image.
-                lightIntensity = 1.0;
+                    const float* pCenter = pSource + x;
+                    lightIntensities[x] = CalcLightPoint(*(pCenter + xLeftOffset), *(pCenter + xRightOffset), pDown[x], pUp[x], factors);
+                };
+                calcLightPoint(0);
+                for (int x = xKernelEnd; x < width; x++)
+                {
+                    calcLightPoint(x);
+                }
             }
 
-            // Get the current background color from the background image.
-            Color backgroundColor(255, 255, 255, 255);
-            if (m_pBackgroundImage != NULL)
+            for (int x = 0; x < width; x++)
             {
-                backgroundColor = *pBackground;
-            }
+                // Get the color based on the value at the current point in the
+                // noise map.
+                Color destColor = m_gradient.GetLookupColor(pSource[x]);
 
-            // Blend the destination color, background color, and the light
-            // intensity together, then update the destination image with that
-            // color.
-            *pDest = CalcDestColor(destColor, backgroundColor, lightIntensity);
+                // Get the current background color from the background image.
+                Color backgroundColor(255, 255, 255, 255);
+                if (pBackground != NULL)
+                {
+                    backgroundColor = pBackground[x];
+                }
 
-            // Go to the next point.
-            ++pSource;
-            ++pDest;
-            if (m_pBackgroundImage != NULL)
-            {
-                ++pBackground;
+                // Blend the destination color, background color, and the light
+                // intensity together, then update the destination image with
+                // that color.
+                pDest[x] = CalcDestColor(destColor, backgroundColor, lightIntensities[x]);
             }
         }
+    });
+}
+
+void RendererImage::SetExecutionContext(ExecutionContext* pContext)
+{
+    m_pExecutionContext = pContext;
+}
+
+void RendererImage::SetThreadCount(int threadCount)
+{
+    if (threadCount < 0)
+    {
+        throw noise::ExceptionInvalidParam();
     }
+
+    m_threadCount = threadCount;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1286,7 +3140,11 @@ RendererNormalMap::RendererNormalMap()
     : m_bumpHeight(1.0)
     , m_isWrapEnabled(false)
     , m_pDestImage(NULL)
-    , m_pSourceNoiseMap(NULL){};
+    , m_pExecutionContext(NULL)
+    , m_pSourceNoiseMap(NULL)
+    , m_threadCount(1)
+{
+}
 
 Color RendererNormalMap::CalcNormalColor(double nc, double nr, double nu, double bumpHeight) const
 {
@@ -1321,68 +3179,472 @@ void RendererNormalMap::Render()
     int width = m_pSourceNoiseMap->GetWidth();
     int height = m_pSourceNoiseMap->GetHeight();
 
-    for (int y = 0; y < height; y++)
+    m_pDestImage->SetSize(width, height);
+
+    std::vector<const float*> sourceRows = GetRendererRows(*m_pSourceNoiseMap, m_isWrapEnabled);
+    RenderRows(&sourceRows[0], width, height, *m_pDestImage);
+}
+
+void RendererNormalMap::RenderBand(const NoiseMap& sourceBand, Image& destBand)
+{
+    if (sourceBand.GetWidth() <= 0 || sourceBand.GetHeight() < 3)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    int width = sourceBand.GetWidth();
+    int rowCount = sourceBand.GetHeight() - 2;
+
+    destBand.SetSize(width, rowCount);
+
+    std::vector<const float*> sourceRows(rowCount + 2);
+    for (int i = 0; i < rowCount + 2; i++)
     {
-        const float* pSource = m_pSourceNoiseMap->GetConstSlabPtr(y);
-        Color* pDest = m_pDestImage->GetSlabPtr(y);
-        for (int x = 0; x < width; x++)
+        sourceRows[i] = sourceBand.GetConstSlabPtr(i);
+    }
+    RenderRows(&sourceRows[0], width, rowCount, destBand);
+}
+
+void RendererNormalMap::RenderRows(const float* const* ppSourceRows, int width, int rowCount, Image& destImage) const
+{
+    // Render bands of rows in parallel; see RendererImage::RenderRows().
+    int bandCount = (rowCount + RENDER_BAND_HEIGHT - 1) / RENDER_BAND_HEIGHT;
+    RunTasks(m_pExecutionContext, m_threadCount, bandCount, [&](int band) {
+        int yBegin = band * RENDER_BAND_HEIGHT;
+        int yEnd = GetMin(yBegin + RENDER_BAND_HEIGHT, rowCount);
+        for (int y = yBegin; y < yEnd; y++)
         {
+            const float* pSource = ppSourceRows[y + 1];
+            const float* pUp = ppSourceRows[y + 2];
+            Color* pDest = destImage.GetSlabPtr(y);
 
-            // Calculate the positions of the current point's right and up
-            // neighbors.
-            int xRightOffset, yUpOffset;
-            if (m_isWrapEnabled)
+            // The right neighbors of all points but the last point of a row
+            // are always one point away, so the row kernel handles them.
+            int xInner = CalcNormalRow(pSource, pUp, width - 1, m_bumpHeight, pDest);
+
+            for (int x = xInner; x < width; x++)
             {
-                if (x == (int)width - 1)
+                // Calculate the position of the current point's right
+                // neighbor.
+                int xLeftOffset = -1;
+                int xRightOffset = 1;
+                if (x == width - 1)
                 {
-                    xRightOffset = -((int)width - 1);
+                    CalcNeighborOffsets(x, width, m_isWrapEnabled, xLeftOffset, xRightOffset);
                 }
-                else
+
+                // Get the noise value of the current point in the source noise
+                // map and the noise values of its right and up neighbors.
+                double nc = (double)pSource[x];
+                double nr = (double)pSource[x + xRightOffset];
+                double nu = (double)pUp[x];
+
+                // Calculate the normal product.
+                pDest[x] = CalcNormalColor(nc, nr, nu, m_bumpHeight);
+            }
+        }
+    });
+}
+
+void RendererNormalMap::SetExecutionContext(ExecutionContext* pContext)
+{
+    m_pExecutionContext = pContext;
+}
+
+void RendererNormalMap::SetThreadCount(int threadCount)
+{
+    if (threadCount < 0)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    m_threadCount = threadCount;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// BandPipeline class
+
+BandPipeline::BandPipeline()
+    : m_bandHeight(DEFAULT_PIPELINE_BAND_HEIGHT)
+    , m_pBuilder(NULL)
+    , m_pExecutionContext(NULL)
+    , m_pRendererImage(NULL)
+    , m_pRendererNormalMap(NULL)
+    , m_pWriterBMP(NULL)
+    , m_pWriterTER(NULL)
+    , m_pWriterTiled(NULL)
+{
+}
+
+void BandPipeline::Run()
+{
+    bool hasRenderer = (m_pRendererImage != NULL || m_pRendererNormalMap != NULL);
+    bool hasNoiseMapWriter = (m_pWriterTER != NULL || m_pWriterTiled != NULL);
+    if (m_pBuilder == NULL || (m_pWriterBMP != NULL && !hasRenderer) || (hasNoiseMapWriter && hasRenderer) || (m_pWriterBMP == NULL && !hasNoiseMapWriter))
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    int width = (int)m_pBuilder->GetDestWidth();
+    int height = (int)m_pBuilder->GetDestHeight();
+    if (width <= 0 || height <= 0)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    ScopedExecutionContext<NoiseMapBuilder> builderContext(m_pBuilder, m_pExecutionContext);
+    ScopedExecutionContext<RendererImage> rendererImageContext(m_pRendererImage, m_pExecutionContext);
+    ScopedExecutionContext<RendererNormalMap> rendererNormalMapContext(m_pRendererNormalMap, m_pExecutionContext);
+
+    if (m_pWriterBMP != NULL)
+    {
+        RunRendered(width, height);
+    }
+    else if (m_pWriterTER != NULL)
+    {
+        WriteNoiseMapBands(*m_pBuilder, m_bandHeight, width, height, *m_pWriterTER);
+    }
+    else
+    {
+        WriteNoiseMapBands(*m_pBuilder, m_bandHeight, width, height, *m_pWriterTiled);
+    }
+}
+
+void BandPipeline::RunRendered(int width, int height)
+{
+    bool isWrapEnabled = (m_pRendererImage != NULL) ? m_pRendererImage->IsWrapEnabled() : m_pRendererNormalMap->IsWrapEnabled();
+
+    m_pWriterBMP->OpenDestFile(width, height);
+    try
+    {
+        // The source band holds the rows of a band, preceded by the down
+        // neighbor of its first row and followed by the up neighbor of its
+        // last row, as the RenderBand() methods of the renderers expect.  The
+        // row y of the noise map is at row y - yBegin + 1 of the source band.
+        NoiseMap sourceBand;
+        NoiseMap builtRows;
+        Image destBand;
+
+        // The last two rows of a source band, which are the first two rows
+        // of the next one.
+        NoiseMap carriedRows;
+        carriedRows.SetSize(width, 2);
+
+        // With wrapping enabled, the first row of the noise map is the up
+        // neighbor of the last row, and the last row is the down neighbor of
+        // the first row.
+        NoiseMap firstRow;
+        NoiseMap lastRow;
+        if (isWrapEnabled)
+        {
+            m_pBuilder->BuildBand(height - 1, height, lastRow);
+        }
+
+        for (int yBegin = 0; yBegin < height; yBegin += m_bandHeight)
+        {
+            int yEnd = GetMin(yBegin + m_bandHeight, height);
+            int rowCount = yEnd - yBegin;
+            sourceBand.SetSize(width, rowCount + 2);
+
+            // Build the rows of the band that were not built as the up
+            // neighbor of the previous band, and the up neighbor of its last
+            // row.
+            int yBuildBegin = yBegin;
+            if (yBegin > 0)
+            {
+                CopyNoiseMapRow(carriedRows, 0, sourceBand, 0);
+                CopyNoiseMapRow(carriedRows, 1, sourceBand, 1);
+                yBuildBegin++;
+            }
+            int yBuildEnd = GetMin(yEnd + 1, height);
+            if (yBuildBegin < yBuildEnd)
+            {
+                m_pBuilder->BuildBand(yBuildBegin, yBuildEnd, builtRows);
+                for (int y = yBuildBegin; y < yBuildEnd; y++)
                 {
-                    xRightOffset = 1;
+                    CopyNoiseMapRow(builtRows, y - yBuildBegin, sourceBand, y - yBegin + 1);
                 }
-                if (y == (int)height - 1)
+            }
+
+            // Apply the wrapping or cropping rules to the top and bottom
+            // edges of the noise map.
+            if (yBegin == 0)
+            {
+                if (isWrapEnabled)
                 {
-                    yUpOffset = -((int)height - 1);
+                    CopyNoiseMapRow(lastRow, 0, sourceBand, 0);
+                    firstRow.SetSize(width, 1);
+                    CopyNoiseMapRow(sourceBand, 1, firstRow, 0);
                 }
                 else
                 {
-                    yUpOffset = 1;
+                    CopyNoiseMapRow(sourceBand, 1, sourceBand, 0);
                 }
             }
-            else
+            if (yEnd == height)
             {
-                if (x == (int)width - 1)
+                if (isWrapEnabled)
                 {
-                    xRightOffset = 0;
+                    CopyNoiseMapRow(firstRow, 0, sourceBand, rowCount + 1);
                 }
                 else
                 {
-                    xRightOffset = 1;
-                }
-                if (y == (int)height - 1)
-                {
-                    yUpOffset = 0;
+                    CopyNoiseMapRow(sourceBand, rowCount, sourceBand, rowCount + 1);
                 }
-                else
+            }
+
+            if (m_pRendererImage != NULL)
+            {
+                m_pRendererImage->RenderBand(sourceBand, yBegin, destBand);
+            }
+            else
+            {
+                m_pRendererNormalMap->RenderBand(sourceBand, destBand);
+            }
+            m_pWriterBMP->WriteRows(destBand);
+
+            CopyNoiseMapRow(sourceBand, rowCount, carriedRows, 0);
+            CopyNoiseMapRow(sourceBand, rowCount + 1, carriedRows, 1);
+        }
+    }
+    catch (...)
+    {
+        CloseIncompleteFile(*m_pWriterBMP);
+        throw;
+    }
+    m_pWriterBMP->CloseDestFile();
+}
+
+void BandPipeline::SetBandHeight(int bandHeight)
+{
+    if (bandHeight < 1)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    m_bandHeight = bandHeight;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TileCache class
+
+TileCache::TileCache()
+    : m_memoryBudget(DEFAULT_TILE_CACHE_MEMORY_BUDGET)
+    , m_memoryUsage(0)
+    , m_pBuilder(NULL)
+    , m_tileSize(DEFAULT_TILE_SIZE)
+{
+}
+
+TileCache::~TileCache()
+{
+    ClearLocked();
+}
+
+void TileCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ClearLocked();
+}
+
+void TileCache::ClearLocked()
+{
+    for (std::set<TileKey>::const_iterator it = m_spilledTiles.begin(); it != m_spilledTiles.end(); ++it)
+    {
+        std::remove(GetSpillFilename(*it).c_str());
+    }
+    m_spilledTiles.clear();
+    m_cachedTiles.clear();
+    m_useOrder.clear();
+    m_memoryUsage = 0;
+}
+
+void TileCache::DropTiles()
+{
+    while (m_memoryUsage > m_memoryBudget && m_useOrder.size() > 1)
+    {
+        TileKey key = m_useOrder.back();
+        std::map<TileKey, CachedTile>::iterator it = m_cachedTiles.find(key);
+
+        // A tile that cannot be spilled is built again when it is requested.
+        if (!m_spillDirectory.empty() && m_spilledTiles.count(key) == 0)
+        {
+            std::string filename = GetSpillFilename(key);
+            try
+            {
+                const NoiseMap& tile = *it->second.pNoiseMap;
+                NoiseMap spilledTile;
+                spilledTile.CreateMappedFile(filename, tile.GetWidth(), tile.GetHeight());
+                for (int y = 0; y < tile.GetHeight(); y++)
                 {
-                    yUpOffset = 1;
+                    CopyNoiseMapRow(tile, y, spilledTile, y);
                 }
+                m_spilledTiles.insert(key);
+            }
+            catch (...)
+            {
+                std::remove(filename.c_str());
             }
-            yUpOffset *= m_pSourceNoiseMap->GetStride();
+        }
 
-            // Get the noise value of the current point in the source noise map
-            // and the noise values of its right and up neighbors.
-            double nc = (double)(*pSource);
-            double nr = (double)(*(pSource + xRightOffset));
-            double nu = (double)(*(pSource + yUpOffset));
+        m_memoryUsage -= it->second.memoryUsage;
+        m_cachedTiles.erase(it);
+        m_useOrder.pop_back();
+    }
+}
 
-            // Calculate the normal product.
-            *pDest = CalcNormalColor(nc, nr, nu, m_bumpHeight);
+TileLevel TileCache::GetLevel(int level) const
+{
+    std::vector<TileLevel> levels;
+    GetLevels(levels);
+    if (level < 0 || level >= (int)levels.size())
+    {
+        throw noise::ExceptionInvalidParam();
+    }
 
-            // Go to the next point.
-            ++pSource;
-            ++pDest;
+    return levels[level];
+}
+
+int TileCache::GetLevelCount() const
+{
+    std::vector<TileLevel> levels;
+    GetLevels(levels);
+    return (int)levels.size();
+}
+
+void TileCache::GetLevels(std::vector<TileLevel>& levels) const
+{
+    if (m_pBuilder == NULL || m_pBuilder->GetDestWidth() <= 0 || m_pBuilder->GetDestHeight() <= 0)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    // The levels are those of a tiled noise map file with a mipmap pyramid.
+    CalcTileLevels((int)m_pBuilder->GetDestWidth(), (int)m_pBuilder->GetDestHeight(), m_tileSize, (int)sizeof(float), true, levels);
+    for (std::vector<TileLevel>::iterator it = levels.begin(); it != levels.end(); ++it)
+    {
+        it->dataOffset = 0;
+    }
+}
+
+size_t TileCache::GetMemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryUsage;
+}
+
+std::string TileCache::GetSpillFilename(const TileKey& key) const
+{
+    return m_spillDirectory + "/tile_" + std::to_string(key.first) + "_" + std::to_string(key.second.first) + "_" + std::to_string(key.second.second) + ".noisemap";
+}
+
+std::shared_ptr<const NoiseMap> TileCache::GetTile(int level, int tileX, int tileY)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<TileLevel> levels;
+    GetLevels(levels);
+    if (level < 0 || level >= (int)levels.size() || tileX < 0 || tileX >= levels[level].tileCountX || tileY < 0 || tileY >= levels[level].tileCountY)
+    {
+        throw noise::ExceptionInvalidParam();
+    }
+
+    TileKey key(level, std::make_pair(tileX, tileY));
+    std::map<TileKey, CachedTile>::iterator it = m_cachedTiles.find(key);
+    if (it != m_cachedTiles.end())
+    {
+        m_useOrder.splice(m_useOrder.begin(), m_useOrder, it->second.usePos);
+        return it->second.pNoiseMap;
+    }
+
+    std::shared_ptr<NoiseMap> pTile;
+    try
+    {
+        pTile = std::make_shared<NoiseMap>();
+    }
+    catch (...)
+    {
+        throw noise::ExceptionOutOfMemory();
+    }
+
+    // Read the tile back from its spill file, or build it.
+    bool isLoaded = false;
+    if (m_spilledTiles.count(key) != 0)
+    {
+        try
+        {
+            NoiseMap spilledTile;
+            spilledTile.OpenMappedFile(GetSpillFilename(key));
+            *pTile = spilledTile;
+            isLoaded = true;
+        }
+        catch (...)
+        {
+            m_spilledTiles.erase(key);
+        }
+    }
+    if (!isLoaded)
+    {
+        int step = 1 << level;
+        int width = GetMin(m_tileSize, levels[level].width - tileX * m_tileSize);
+        int height = GetMin(m_tileSize, levels[level].height - tileY * m_tileSize);
+        m_pBuilder->BuildRegion(tileX * m_tileSize * step, tileY * m_tileSize * step, width, height, step, *pTile);
+    }
+
+    CachedTile cachedTile;
+    cachedTile.pNoiseMap = pTile;
+    cachedTile.memoryUsage = pTile->GetMemUsed() * sizeof(float);
+    try
+    {
+        m_useOrder.push_front(key);
+        cachedTile.usePos = m_useOrder.begin();
+        m_cachedTiles[key] = cachedTile;
+    }
+    catch (...)
+    {
+        if (!m_useOrder.empty() && m_useOrder.front() == key)
+        {
+            m_useOrder.pop_front();
         }
+        throw noise::ExceptionOutOfMemory();
+    }
+    m_memoryUsage += cachedTile.memoryUsage;
+    DropTiles();
+    return pTile;
+}
+
+void TileCache::SetMemoryBudget(size_t memoryBudget)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_memoryBudget = memoryBudget;
+    DropTiles();
+}
+
+void TileCache::SetNoiseMapBuilder(NoiseMapBuilder& builder)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ClearLocked();
+    m_pBuilder = &builder;
+}
+
+void TileCache::SetSpillDirectory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::set<TileKey>::const_iterator it = m_spilledTiles.begin(); it != m_spilledTiles.end(); ++it)
+    {
+        std::remove(GetSpillFilename(*it).c_str());
+    }
+    m_spilledTiles.clear();
+    m_spillDirectory = directory;
+}
+
+void TileCache::SetTileSize(int tileSize)
+{
+    if (tileSize < 1 || tileSize > RASTER_MAX_WIDTH)
+    {
+        throw noise::ExceptionInvalidParam();
     }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ClearLocked();
+    m_tileSize = tileSize;
 }
@@ -23,10 +23,20 @@
 #ifndef NOISEUTILS_H
 #define NOISEUTILS_H
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <noise/noise.h>
+#include <set>
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace noise;
 
@@ -80,6 +90,11 @@ namespace noise
         /// The maximum height of a raster.
         const int RASTER_MAX_HEIGHT = 32767;
 
+        /// The maximum width and height of a noise map stored in a mapped file.
+        ///
+        /// See NoiseMap::CreateMappedFile().
+        const int MAPPED_RASTER_MAX_SIZE = 0x7ffffff0;
+
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
         // The raster's stride length must be a multiple of this constant.
         const int RASTER_STRIDE_BOUNDARY = 4;
@@ -103,6 +118,44 @@ namespace noise
         /// canuckleheads.
         const double DEFAULT_METRES_PER_POINT = DEFAULT_METERS_PER_POINT;
 
+        /// Default number of entries in the lookup table of a GradientColor
+        /// object.
+        const int DEFAULT_GRADIENT_LOOKUP_TABLE_SIZE = 4096;
+
+        /// Default number of rows in a band of a BandPipeline.
+        const int DEFAULT_PIPELINE_BAND_HEIGHT = 64;
+
+        /// Default width and height of a tile in a tiled noise map file, in
+        /// points.
+        const int DEFAULT_TILE_SIZE = 256;
+
+        /// Default difference between the noise values of consecutive 16-bit
+        /// points in a tiled noise map file.  The 16-bit points cover noise
+        /// values from -2.0 to +2.0.
+        const float DEFAULT_TILE_INT16_STEP = 1.0f / 16384.0f;
+
+        /// Default amount of memory that a TileCache object uses for its tiles,
+        /// in bytes.
+        const size_t DEFAULT_TILE_CACHE_MEMORY_BUDGET = 256 << 20;
+
+        /// Alignment of the memory allocated from a ScratchArena object, in
+        /// bytes.
+        const size_t SCRATCH_ARENA_ALIGNMENT = 64;
+
+        /// Minimum size of a block of a ScratchArena object, in bytes.
+        const size_t SCRATCH_ARENA_BLOCK_SIZE = 64 << 10;
+
+        /// Enumerates the formats of the points in a tiled noise map file.
+        enum TileFormat
+        {
+            /// Each point is a 32-bit floating-point noise value.
+            TILE_FORMAT_FLOAT = 0,
+
+            /// Each point is a 16-bit signed integer; the noise value is the
+            /// integer multiplied by the step stored in the file.
+            TILE_FORMAT_INT16 = 1
+        };
+
         /// Defines a color.
         ///
         /// A color object contains four 8-bit channels: red, green, blue, and an
@@ -127,10 +180,10 @@ namespace noise
             /// @param b Value of the blue channel.
             /// @param a Value of the alpha (transparency) channel.
             Color(noise::uint8 r, noise::uint8 g, noise::uint8 b, noise::uint8 a)
-                : red(r)
-                , green(g)
+                : alpha(a)
                 , blue(b)
-                , alpha(a)
+                , green(g)
+                , red(r)
             {
             }
 
@@ -195,6 +248,18 @@ namespace noise
         /// If an application passes 0.25 to the GetColor() method, this method
         /// will return a very light pink color that is one quarter of the way
         /// between white and red.
+        ///
+        /// <b>Lookup table</b>
+        ///
+        /// Each time a gradient point is added, this object samples the color
+        /// gradient into a lookup table that spans the positions of the first
+        /// and the last gradient points.  The GetLookupColor() method returns
+        /// the color of the nearest table entry, which costs a single table
+        /// fetch instead of a search through the gradient points.  Call the
+        /// SetLookupTableSize() method to change the number of table entries.
+        ///
+        /// The GetColor() and GetLookupColor() methods do not modify this
+        /// object, so several threads may call them at once.
         class GradientColor
         {
 
@@ -227,7 +292,9 @@ namespace noise
             /// @param gradientPos The specified position.
             ///
             /// @returns The color at that position.
-            const Color& GetColor(double gradientPos) const;
+            ///
+            /// @pre This object contains at least two gradient points.
+            Color GetColor(double gradientPos) const;
 
             /// Returns a pointer to the array of gradient points in this object.
             ///
@@ -252,7 +319,69 @@ namespace noise
                 return m_gradientPointCount;
             }
 
+            /// Returns the color at the specified position in the color
+            /// gradient, from the lookup table.
+            ///
+            /// @param gradientPos The specified position.
+            ///
+            /// @returns The color of the lookup table entry nearest to that
+            /// position.
+            ///
+            /// @pre This object contains at least two gradient points.
+            ///
+            /// Positions outside of the range of the gradient points return
+            /// the color of the nearest gradient point, as GetColor() does.
+            /// Inside of that range, the returned color is the color that
+            /// GetColor() returns at a position at most half a table entry
+            /// away.
+            Color GetLookupColor(double gradientPos) const
+            {
+                assert(m_gradientPointCount >= 2);
+
+                double index = (gradientPos - m_lookupTableMin) * m_lookupTableScale + 0.5;
+                if (index <= 0.0)
+                {
+                    return m_lookupTable.front();
+                }
+                else if (!(index < (double)(m_lookupTable.size() - 1)))
+                {
+                    // Also catches a NaN position, which GetColor() maps to
+                    // the last gradient point.
+                    return m_lookupTable.back();
+                }
+                return m_lookupTable[(size_t)index];
+            }
+
+            /// Returns the number of entries in the lookup table.
+            ///
+            /// @returns The number of entries in the lookup table.
+            int GetLookupTableSize() const
+            {
+                return m_lookupTableSize;
+            }
+
+            /// Sets the number of entries in the lookup table.
+            ///
+            /// @param lookupTableSize The number of entries in the lookup
+            /// table.
+            ///
+            /// @pre The number of entries is at least two.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the precondition.
+            ///
+            /// More entries reduce the difference between the colors returned
+            /// by GetLookupColor() and GetColor().  By default, the lookup
+            /// table has noise::utils::DEFAULT_GRADIENT_LOOKUP_TABLE_SIZE
+            /// entries.
+            void SetLookupTableSize(int lookupTableSize);
+
         private:
+            /// Samples the color gradient into the lookup table.
+            ///
+            /// This method is called each time the gradient points or the
+            /// size of the lookup table change.
+            void CalcLookupTable();
+
             /// Determines the array index in which to insert the gradient point
             /// into the internal gradient-point array.
             ///
@@ -293,9 +422,18 @@ namespace noise
             /// Array that stores the gradient points.
             GradientPoint* m_pGradientPoints;
 
-            /// A color object that is used by a gradient object to store a
-            /// temporary value.
-            mutable Color m_workingColor;
+            /// Colors sampled from the color gradient at evenly spaced
+            /// positions, from the first to the last gradient point.
+            std::vector<Color> m_lookupTable;
+
+            /// Gradient position of the first entry in the lookup table.
+            double m_lookupTableMin;
+
+            /// Number of lookup table entries per unit of gradient position.
+            double m_lookupTableScale;
+
+            /// Number of entries in the lookup table.
+            int m_lookupTableSize;
         };
 
         /// Implements a noise map, a 2-dimensional array of floating-point
@@ -346,6 +484,23 @@ namespace noise
         ///
         /// The GetSlabPtr() and GetConstSlabPtr() methods allow you to retrieve
         /// pointers to the slabs themselves.
+        ///
+        /// <b>Mapped Files</b>
+        ///
+        /// By default, the values are stored in a buffer allocated on the
+        /// heap, and the size of the noise map is limited by RASTER_MAX_WIDTH
+        /// and RASTER_MAX_HEIGHT.  The CreateMappedFile() method instead stores
+        /// the values in a file that is mapped into memory.  The operating
+        /// system then pages the values in and out of memory as they are
+        /// accessed, so the noise map can be larger than the physical memory,
+        /// up to MAPPED_RASTER_MAX_SIZE points wide and high.  The file keeps
+        /// the values after the noise map is destroyed, and the
+        /// OpenMappedFile() method maps it again without rebuilding the noise
+        /// map.
+        ///
+        /// The builders write into a mapped noise map as into any other noise
+        /// map.  Build it in bands with NoiseMapBuilder::BuildBand() and access
+        /// its rows in order to keep the number of pages in memory low.
         class NoiseMap
         {
 
@@ -398,6 +553,37 @@ namespace noise
             /// cleared to.
             void Clear(float value);
 
+            /// Creates a file that stores the values of the noise map, and maps
+            /// it into memory.
+            ///
+            /// @param filename The name of the file.
+            /// @param width The width of the noise map.
+            /// @param height The height of the noise map.
+            ///
+            /// @pre The width and height values are positive.
+            /// @pre The width and height values do not exceed
+            /// MAPPED_RASTER_MAX_SIZE.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            /// @throw noise::ExceptionOutOfMemory The file does not fit in the
+            /// address space.
+            /// @throw noise::ExceptionUnknown The file could not be created or
+            /// mapped.
+            ///
+            /// If the file exists, it is replaced.  On exit, the noise map has
+            /// the specified size, and its values are zero.  The values are
+            /// written to the file when the operating system pages them out, and
+            /// at the latest when the noise map is destroyed or resized to
+            /// another size.
+            ///
+            /// The file begins with a 64-byte header holding the size of the
+            /// noise map, followed by the slabs, including the padding up to the
+            /// stride amount.  The values are stored in the byte order of the
+            /// machine.
+            ///
+            /// If an exception occurs, this noise map object becomes empty.
+            void CreateMappedFile(const std::string& filename, int width, int height);
+
             /// Returns the value used for all positions outside of the noise map.
             ///
             /// @returns The value used for all positions outside of the noise
@@ -548,6 +734,42 @@ namespace noise
                 return m_width;
             }
 
+            /// Determines if the values of the noise map are stored in a mapped
+            /// file.
+            ///
+            /// @returns
+            /// - @a true if the values are stored in a mapped file.
+            /// - @a false if they are stored on the heap.
+            bool IsMapped() const
+            {
+                return m_pMappedView != NULL;
+            }
+
+            /// Opens a file created by CreateMappedFile(), and maps it into
+            /// memory.
+            ///
+            /// @param filename The name of the file.
+            /// @param isWritable Specifies whether the values of the noise map
+            /// can be modified, writing the changes to the file, or not.
+            ///
+            /// @throw noise::ExceptionOutOfMemory The file does not fit in the
+            /// address space.
+            /// @throw noise::ExceptionUnknown The file could not be opened or
+            /// mapped, or it is not a noise map file.
+            ///
+            /// On exit, the noise map has the size stored in the file, and
+            /// contains its values.  The values are only read from the file when
+            /// they are accessed, so this method returns immediately regardless
+            /// of the size of the noise map.
+            ///
+            /// If the file is not opened as writable, the values are mapped
+            /// read-only: the noise map can be read, e.g. by the renderers and
+            /// writers, but modifying its values, e.g. by building it, causes
+            /// an access violation.
+            ///
+            /// If an exception occurs, this noise map object becomes empty.
+            void OpenMappedFile(const std::string& filename, bool isWritable = false);
+
             /// Reallocates the noise map to recover wasted memory.
             ///
             /// @throw noise::ExceptionOutOfMemory Out of memory.  (Yes, this
@@ -555,6 +777,9 @@ namespace noise
             /// maps will temporarily exist in memory during this call.)
             ///
             /// The contents of the noise map is unaffected.
+            ///
+            /// This method does nothing if the noise map is stored in a mapped
+            /// file.
             void ReclaimMem();
 
             /// Sets the value to use for all positions outside of the noise map.
@@ -588,6 +813,12 @@ namespace noise
             ///
             /// If the @a INVALID_PARAM exception occurs, the noise map is
             /// unmodified.
+            ///
+            /// If the noise map is stored in a mapped file and the new size is
+            /// equal to its current size, the noise map is unmodified and stays
+            /// mapped, so the noise-map builders can fill a mapped noise map.
+            /// Otherwise, the file is unmapped and the noise map is allocated on
+            /// the heap.
             void SetSize(int width, int height);
 
             /// Sets a value at a specified position in the noise map.
@@ -607,7 +838,8 @@ namespace noise
             /// On exit, the source noise map object becomes empty.
             ///
             /// This method only moves the buffer pointer so this method is very
-            /// quick.
+            /// quick.  If the source noise map is stored in a mapped file, this
+            /// noise map takes over the mapping.
             void TakeOwnership(NoiseMap& source);
 
         private:
@@ -664,12 +896,28 @@ namespace noise
             /// deletes the buffer in this noise map.
             void DeleteNoiseMapAndReset();
 
+            /// Deletes the buffer in this noise map, or unmaps its file, without
+            /// resetting the other member variables.
+            void FreeNoiseMap();
+
             /// Initializes the noise map object.
             ///
             /// @pre Must be called during object construction.
             /// @pre The noise map buffer must not exist.
             void InitObj();
 
+            /// Maps a noise map file into memory.
+            ///
+            /// @param filename The name of the file.
+            /// @param isNewFile Specifies whether to create the file.
+            /// @param isWritable Specifies whether changes to the values are
+            /// written to the file.
+            /// @param width The width of the noise map.
+            /// @param height The height of the noise map.
+            ///
+            /// @pre The noise map is empty.
+            void MapFile(const std::string& filename, bool isNewFile, bool isWritable, int width, int height);
+
             /// Value used for all positions outside of the noise map.
             float m_borderValue;
 
@@ -682,6 +930,13 @@ namespace noise
             /// the noise map, not the number of bytes.
             size_t m_memUsed;
 
+            /// The memory mapping of the file that stores the noise map, or
+            /// @a NULL if the noise map is stored on the heap.
+            void* m_pMappedView;
+
+            /// The size of the memory mapping, in bytes.
+            size_t m_mappedViewSize;
+
             /// A pointer to the noise map buffer.
             float* m_pNoiseMap;
 
@@ -1081,6 +1336,12 @@ namespace noise
             int m_width;
         };
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+        // Buffered output file of the writer classes, defined in
+        // noiseutils.cpp.
+        class FileOutput;
+#endif
+
         /// Windows bitmap image writer class.
         ///
         /// This class creates a file in Windows bitmap (*.bmp) format given the
@@ -1095,14 +1356,61 @@ namespace noise
         ///
         /// The SetDestFilename() and SetSourceImage() methods must be called
         /// before calling the WriteDestFile() method.
+        ///
+        /// <b>Writing the image in bands</b>
+        ///
+        /// To write an image that is produced one band of rows at a time, pass
+        /// the size of the whole image to the OpenDestFile() method, pass each
+        /// band in row order to the WriteRows() method, then call the
+        /// CloseDestFile() method.  The file is identical to the one written
+        /// by WriteDestFile() for the whole image.
+        ///
+        /// <b>Buffering</b>
+        ///
+        /// This class converts the rows into large buffers and writes each
+        /// buffer to the file at once.  If background writing is enabled by
+        /// the EnableBackgroundWrite() method, a background thread writes one
+        /// buffer to the file while WriteRows() fills the next one, so that
+        /// writing the file overlaps with rendering the next band of rows.
         class WriterBMP
         {
 
         public:
             /// Constructor.
-            WriterBMP()
-                : m_pSourceImage(NULL)
+            WriterBMP();
+
+            /// Destructor.
+            ///
+            /// Closes a file left open by OpenDestFile().
+            ~WriterBMP();
+
+            /// Finishes writing the file opened by OpenDestFile().
+            ///
+            /// @pre OpenDestFile() has been previously called.
+            /// @pre WriteRows() has been passed as many rows as the height
+            /// passed to OpenDestFile().
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.  The
+            /// file is closed anyway.
+            /// @throw noise::ExceptionUnknown An unknown exception occurred.
+            /// Possibly the file could not be written.
+            void CloseDestFile();
+
+            /// Enables or disables writing the file on a background thread.
+            ///
+            /// @param enable Specifies whether to write the file on a
+            /// background thread or not.
+            ///
+            /// When this feature is enabled, the OpenDestFile() method starts a
+            /// thread that writes the filled buffers to the file, so that the
+            /// WriteRows() method only converts the rows.  A write error is
+            /// then reported by a later call to the WriteRows() or
+            /// CloseDestFile() method.
+            ///
+            /// By default, this feature is disabled.
+            void EnableBackgroundWrite(bool enable = true)
             {
+                m_isBackgroundWriteEnabled = enable;
             }
 
             /// Returns the name of the file to write.
@@ -1113,6 +1421,16 @@ namespace noise
                 return m_destFilename;
             }
 
+            /// Determines if the file is written on a background thread.
+            ///
+            /// @returns
+            /// - @a true if the file is written on a background thread.
+            /// - @a false if not.
+            bool IsBackgroundWriteEnabled() const
+            {
+                return m_isBackgroundWriteEnabled;
+            }
+
             /// Sets the name of the file to write.
             ///
             /// @param filename The name of the file to write.
@@ -1123,6 +1441,23 @@ namespace noise
                 m_destFilename = filename;
             }
 
+            /// Creates the file and writes its header, for an image that is
+            /// written one band of rows at a time.
+            ///
+            /// @param width The width of the whole image, in points.
+            /// @param height The height of the whole image, in points.
+            ///
+            /// @pre SetDestFilename() has been previously called.
+            /// @pre The width and height are not negative.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            /// @throw noise::ExceptionUnknown An unknown exception occurred.
+            /// Possibly the file could not be written.
+            ///
+            /// After calling this method, pass the rows of the image to the
+            /// WriteRows() method, then call the CloseDestFile() method.
+            void OpenDestFile(int width, int height);
+
             /// Sets the image object that is written to the file.
             ///
             /// @param sourceImage The image object to write.
@@ -1150,6 +1485,22 @@ namespace noise
             /// method to specify the name of the file to write.
             void WriteDestFile();
 
+            /// Writes the next rows of the file opened by OpenDestFile().
+            ///
+            /// @param sourceRows An image holding the next rows of the image,
+            /// from bottom to top.
+            ///
+            /// @pre OpenDestFile() has been previously called.
+            /// @pre The rows are as wide as the width passed to
+            /// OpenDestFile(), and do not exceed its height together with the
+            /// rows already written.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            /// @throw noise::ExceptionOutOfMemory Out of memory.
+            /// @throw noise::ExceptionUnknown An unknown exception occurred.
+            /// Possibly the file could not be written.  The file is closed.
+            void WriteRows(const Image& sourceRows);
+
         protected:
             /// Calculates the width of one horizontal line in the file, in bytes.
             ///
@@ -1164,8 +1515,24 @@ namespace noise
             /// Name of the file to write.
             std::string m_destFilename;
 
+            /// Height of the image in the open file, in points.
+            int m_fileHeight;
+
+            /// Width of the image in the open file, in points.
+            int m_fileWidth;
+
+            /// A flag specifying whether the file is written on a background
+            /// thread.
+            bool m_isBackgroundWriteEnabled;
+
+            /// The file opened by OpenDestFile(), or @a NULL.
+            std::unique_ptr<FileOutput> m_pFile;
+
             /// A pointer to the image object that will be written to the file.
             Image* m_pSourceImage;
+
+            /// Number of rows written to the open file.
+            int m_writtenRowCount;
         };
 
         /// Terragen Terrain writer class.
@@ -1188,15 +1555,48 @@ namespace noise
         ///
         /// The SetDestFilename() and SetSourceNoiseMap() methods must be called
         /// before calling the WriteDestFile() method.
+        ///
+        /// Like WriterBMP, this class writes the file through large buffers,
+        /// optionally on a background thread.
         class WriterTER
         {
 
         public:
             /// Constructor.
-            WriterTER()
-                : m_pSourceNoiseMap(NULL)
-                , m_metersPerPoint(DEFAULT_METERS_PER_POINT)
+            WriterTER();
+
+            /// Destructor.
+            ///
+            /// Closes a file left open by OpenDestFile().
+            ~WriterTER();
+
+            /// Finishes writing the file opened by OpenDestFile().
+            ///
+            /// @pre OpenDestFile() has been previously called.
+            /// @pre WriteRows() has been passed as many rows as the height
+            /// passed to OpenDestFile().
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.  The
+            /// file is closed anyway.
+            /// @throw noise::ExceptionUnknown An unknown exception occurred.
+            /// Possibly the file could not be written.
+            void CloseDestFile();
+
+            /// Enables or disables writing the file on a background thread.
+            ///
+            /// @param enable Specifies whether to write the file on a
+            /// background thread or not.
+            ///
+            /// When this feature is enabled, the OpenDestFile() method starts a
+            /// thread that writes the filled buffers to the file, so that the
+            /// WriteRows() method only converts the rows.  A write error is
+            /// then reported by a later call to the WriteRows() or
+            /// CloseDestFile() method.
+            ///
+            /// By default, this feature is disabled.
+            void EnableBackgroundWrite(bool enable = true)
             {
+                m_isBackgroundWriteEnabled = enable;
             }
 
             /// Returns the name of the file to write.
@@ -1207,6 +1607,16 @@ namespace noise
                 return m_destFilename;
             }
 
+            /// Determines if the file is written on a background thread.
+            ///
+            /// @returns
+            /// - @a true if the file is written on a background thread.
+            /// - @a false if not.
+            bool IsBackgroundWriteEnabled() const
+            {
+                return m_isBackgroundWriteEnabled;
+            }
+
             /// Returns the distance separating adjacent points in the noise map,
             /// in meters.
             ///
@@ -1236,6 +1646,23 @@ namespace noise
                 m_metersPerPoint = metersPerPoint;
             }
 
+            /// Creates the file and writes its header, for a noise map that is
+            /// written one band of rows at a time.
+            ///
+            /// @param width The width of the whole noise map, in points.
+            /// @param height The height of the whole noise map, in points.
+            ///
+            /// @pre SetDestFilename() has been previously called.
+            /// @pre The width and height are not negative.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            /// @throw noise::ExceptionUnknown An unknown exception occurred.
+            /// Possibly the file could not be written.
+            ///
+            /// After calling this method, pass the rows of the noise map to the
+            /// WriteRows() method, then call the CloseDestFile() method.
+            void OpenDestFile(int width, int height);
+
             /// Sets the noise map object that is written to the file.
             ///
             /// @param sourceNoiseMap The noise map object to write.
@@ -1266,6 +1693,22 @@ namespace noise
             /// meters.
             void WriteDestFile();
 
+            /// Writes the next rows of the file opened by OpenDestFile().
+            ///
+            /// @param sourceRows A noise map holding the next rows of the noise
+            /// map.
+            ///
+            /// @pre OpenDestFile() has been previously called.
+            /// @pre The rows are as wide as the width passed to
+            /// OpenDestFile(), and do not exceed its height together with the
+            /// rows already written.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            /// @throw noise::ExceptionOutOfMemory Out of memory.
+            /// @throw noise::ExceptionUnknown An unknown exception occurred.
+            /// Possibly the file could not be written.  The file is closed.
+            void WriteRows(const NoiseMap& sourceRows);
+
         protected:
             /// Calculates the width of one horizontal line in the file, in bytes.
             ///
@@ -1277,103 +1720,1029 @@ namespace noise
             /// Name of the file to write.
             std::string m_destFilename;
 
+            /// Height of the noise map in the open file, in points.
+            int m_fileHeight;
+
+            /// Width of the noise map in the open file, in points.
+            int m_fileWidth;
+
+            /// A flag specifying whether the file is written on a background
+            /// thread.
+            bool m_isBackgroundWriteEnabled;
+
             /// The distance separating adjacent points in the noise map, in
             /// meters.
             float m_metersPerPoint;
 
+            /// The file opened by OpenDestFile(), or @a NULL.
+            std::unique_ptr<FileOutput> m_pFile;
+
             /// A pointer to the noise map that will be written to the file.
             NoiseMap* m_pSourceNoiseMap;
+
+            /// Number of rows written to the open file.
+            int m_writtenRowCount;
         };
 
-        /// Abstract base class for a noise-map builder
+        /// Describes a level of the mipmap pyramid of a tiled noise map.
         ///
-        /// A builder class builds a noise map by filling it with coherent-noise
-        /// values generated from the surface of a three-dimensional mathematical
-        /// object.  Each builder class defines a specific three-dimensional
-        /// surface, such as a cylinder, sphere, or plane.
+        /// See WriterTiled and TileCache.
+        struct TileLevel
+        {
+            /// Width of the level, in points.
+            int width;
+
+            /// Height of the level, in points.
+            int height;
+
+            /// Number of tiles in a row of tiles.
+            int tileCountX;
+
+            /// Number of rows of tiles.
+            int tileCountY;
+
+            /// Offset of the first tile of the level in a tiled noise map
+            /// file, in bytes; 0 for the levels of a TileCache object.
+            unsigned long long dataOffset;
+        };
+
+        /// Tiled noise map writer class.
         ///
-        /// A builder class describes these input values using a coordinate system
-        /// applicable for the mathematical object (e.g., a latitude/longitude
-        /// coordinate system for the spherical noise-map builder.)  It then
-        /// "flattens" these coordinates onto a plane so that it can write the
-        /// coherent-noise values into a two-dimensional noise map.
+        /// This class creates a file that stores a noise map in square tiles,
+        /// optionally together with a mipmap pyramid of the noise map.  A
+        /// ReaderTiled object maps such a file into memory and reads any region
+        /// of any level without reading the rest of the file, which suits
+        /// servers that deliver the noise map tile by tile.
         ///
-        /// <b>Building the Noise Map</b>
+        /// <b>File format</b>
         ///
-        /// To build the noise map, perform the following steps:
-        /// - Pass the bounding coordinates to the SetBounds() method.
-        /// - Pass the noise map size, in points, to the SetDestSize() method.
-        /// - Pass a NoiseMap object to the SetDestNoiseMap() method.
-        /// - Pass a noise module (derived from noise::module::ModuleBase) to the
-        ///   SetSourceModule() method.
-        /// - Call the Build() method.
+        /// The file starts with a 64-byte header holding the size of the noise
+        /// map, the size of the tiles, the format of the points, and the number
+        /// of levels, followed by an index that describes each level by a
+        /// TileLevel structure.  Level 0 is the noise map itself; each further
+        /// level is half as wide and high as the previous one, rounded up, and
+        /// each point is the average of the corresponding 2 x 2 points of the
+        /// previous level.  The last level fits in a single tile.
         ///
-        /// You may also pass a callback function to the SetCallback() method.
-        /// The Build() method calls this callback function each time it fills a
-        /// row of the noise map with coherent-noise values.  This callback
-        /// function has a single integer parameter that contains a count of the
-        /// rows that have been completed.  It returns void.
+        /// The tiles of each level follow, in row order, starting at a
+        /// multiple of 4096 bytes.  All tiles have the same size; the points
+        /// of the tiles at the right and top edges that lie outside the level
+        /// are zero.  The points are stored in the byte order of Intel
+        /// machines, row after row, so a tile of 32-bit floating-point points
+        /// can be used in place.
         ///
-        /// Note that SetBounds() is not defined in the abstract base class; it is
-        /// only defined in the derived classes.  This is because each model uses
-        /// a different coordinate system.
-        class NoiseMapBuilder
+        /// <b>Writing the noise map</b>
+        ///
+        /// To write the noise map, perform the following steps:
+        /// - Pass the filename to the SetDestFilename() method.
+        /// - Pass a NoiseMap object to the SetSourceNoiseMap() method.
+        /// - Optionally change the tile size, the point format, and enable the
+        ///   mipmap pyramid.
+        /// - Call the WriteDestFile() method.
+        ///
+        /// Alternatively, call the OpenDestFile() method, pass the rows of the
+        /// noise map in row order to the WriteRows() method, then call the
+        /// CloseDestFile() method.  The writer computes the mipmap pyramid
+        /// from the rows as they arrive, so a BandPipeline object can build a
+        /// noise map and its pyramid that do not fit in memory.
+        ///
+        /// The writer maps the file into memory, so the whole file must fit in
+        /// the address space.
+        class WriterTiled
         {
 
         public:
             /// Constructor.
-            NoiseMapBuilder();
+            WriterTiled();
 
-            /// Builds the noise map.
-            ///
-            /// @pre SetBounds() was previously called.
-            /// @pre SetDestNoiseMap() was previously called.
-            /// @pre SetSourceModule() was previously called.
-            /// @pre The width and height values specified by SetDestSize() are
-            /// positive.
-            /// @pre The width and height values specified by SetDestSize() do not
-            /// exceed the maximum possible width and height for the noise map.
+            /// Destructor.
             ///
-            /// @post The original contents of the destination noise map is
-            /// destroyed.
+            /// Closes a file left open by OpenDestFile().  That file is
+            /// incomplete.
+            ~WriterTiled();
+
+            /// Finishes writing the file opened by OpenDestFile().
             ///
-            /// @throw noise::ExceptionInvalidParam See the preconditions.
-            /// @throw noise::ExceptionOutOfMemory Out of memory.
+            /// @pre OpenDestFile() has been previously called.
+            /// @pre WriteRows() has been passed as many rows as the height
+            /// passed to OpenDestFile().
             ///
-            /// If this method is successful, the destination noise map contains
-            /// the coherent-noise values from the noise module specified by
-            /// SetSourceModule().
-            virtual void Build() = 0;
+            /// @throw noise::ExceptionInvalidParam See the preconditions.  The
+            /// file is closed anyway, and is incomplete.
+            void CloseDestFile();
 
-            /// Returns the height of the destination noise map.
+            /// Enables or disables the mipmap pyramid.
             ///
-            /// @returns The height of the destination noise map, in points.
+            /// @param enable Specifies whether to write the mipmap pyramid or
+            /// not.
             ///
-            /// This object does not change the height in the destination noise
-            /// map object until the Build() method is called.
-            double GetDestHeight() const
+            /// By default, the file only holds the noise map.
+            void EnableMipmaps(bool enable = true)
             {
-                return m_destHeight;
+                m_isMipmapsEnabled = enable;
             }
 
-            /// Returns the width of the destination noise map.
+            /// Returns the name of the file to write.
             ///
-            /// @returns The width of the destination noise map, in points.
+            /// @returns The name of the file to write.
+            std::string GetDestFilename() const
+            {
+                return m_destFilename;
+            }
+
+            /// Returns the difference between the noise values of consecutive
+            /// 16-bit points.
             ///
-            /// This object does not change the height in the destination noise
-            /// map object until the Build() method is called.
-            double GetDestWidth() const
+            /// @returns The difference between the noise values of consecutive
+            /// 16-bit points.
+            float GetInt16Step() const
             {
-                return m_destWidth;
+                return m_int16Step;
             }
 
-            /// Sets the callback function that Build() calls each time it fills a
-            /// row of the noise map with coherent-noise values.
+            /// Returns the format of the points.
             ///
-            /// @param pCallback The callback function.
+            /// @returns The format of the points.
+            TileFormat GetTileFormat() const
+            {
+                return m_tileFormat;
+            }
+
+            /// Returns the width and height of a tile.
             ///
-            /// This callback function has a single integer parameter that
-            /// contains a count of the rows that have been completed.  It returns
+            /// @returns The width and height of a tile, in points.
+            int GetTileSize() const
+            {
+                return m_tileSize;
+            }
+
+            /// Determines if the mipmap pyramid is written.
+            ///
+            /// @returns
+            /// - @a true if the mipmap pyramid is written.
+            /// - @a false if not.
+            bool IsMipmapsEnabled() const
+            {
+                return m_isMipmapsEnabled;
+            }
+
+            /// Creates the file and writes its header.
+            ///
+            /// @param width The width of the noise map, in points.
+            /// @param height The height of the noise map, in points.
+            ///
+            /// @pre SetDestFilename() has been previously called.
+            /// @pre The width and height values are positive and do not exceed
+            /// MAPPED_RASTER_MAX_SIZE.
+            /// @pre No file opened by this method is open.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            /// @throw noise::ExceptionOutOfMemory The file does not fit in the
+            /// address space.
+            /// @throw noise::ExceptionUnknown An unknown exception occurred.
+            /// Possibly the file could not be created.
+            ///
+            /// After calling this method, pass the rows of the noise map to the
+            /// WriteRows() method, then call the CloseDestFile() method.
+            void OpenDestFile(int width, int height);
+
+            /// Sets the name of the file to write.
+            ///
+            /// @param filename The name of the file to write.
+            ///
+            /// Call this method before calling the WriteDestFile() method.
+            void SetDestFilename(const std::string& filename)
+            {
+                m_destFilename = filename;
+            }
+
+            /// Sets the difference between the noise values of consecutive
+            /// 16-bit points.
+            ///
+            /// @param step The difference between the noise values of
+            /// consecutive 16-bit points.
+            ///
+            /// @pre The step is positive.
+            ///
+            /// @throw noise::ExceptionInvalidParam An invalid parameter was
+            /// specified; see the preconditions for more information.
+            ///
+            /// The 16-bit points cover noise values from -32768 to +32767
+            /// times the step; the writer clamps noise values outside that
+            /// range.  By default, the step is
+            /// noise::utils::DEFAULT_TILE_INT16_STEP.
+            void SetInt16Step(float step);
+
+            /// Sets the noise map object that is written to the file.
+            ///
+            /// @param sourceNoiseMap The noise map object to write.
+            ///
+            /// This object only stores a pointer to a noise map object, so make
+            /// sure this object exists before calling the WriteDestFile() method.
+            void SetSourceNoiseMap(NoiseMap& sourceNoiseMap)
+            {
+                m_pSourceNoiseMap = &sourceNoiseMap;
+            }
+
+            /// Sets the format of the points.
+            ///
+            /// @param tileFormat The format of the points.
+            ///
+            /// By default, the points are 32-bit floating-point values
+            /// (noise::utils::TILE_FORMAT_FLOAT).
+            void SetTileFormat(TileFormat tileFormat)
+            {
+                m_tileFormat = tileFormat;
+            }
+
+            /// Sets the width and height of a tile.
+            ///
+            /// @param tileSize The width and height of a tile, in points.
+            ///
+            /// @pre The tile size is positive and does not exceed
+            /// noise::utils::RASTER_MAX_WIDTH.
+            ///
+            /// @throw noise::ExceptionInvalidParam An invalid parameter was
+            /// specified; see the preconditions for more information.
+            ///
+            /// By default, a tile is noise::utils::DEFAULT_TILE_SIZE points
+            /// wide and high.
+            void SetTileSize(int tileSize);
+
+            /// Writes the contents of the noise map object to the file.
+            ///
+            /// @pre SetDestFilename() has been previously called.
+            /// @pre SetSourceNoiseMap() has been previously called.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            /// @throw noise::ExceptionOutOfMemory Out of memory.
+            /// @throw noise::ExceptionUnknown An unknown exception occurred.
+            /// Possibly the file could not be written.
+            void WriteDestFile();
+
+            /// Writes the next rows of the file opened by OpenDestFile().
+            ///
+            /// @param sourceRows A noise map holding the next rows of the noise
+            /// map.
+            ///
+            /// @pre OpenDestFile() has been previously called.
+            /// @pre The rows are as wide as the width passed to
+            /// OpenDestFile(), and do not exceed its height together with the
+            /// rows already written.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            void WriteRows(const NoiseMap& sourceRows);
+
+        protected:
+            /// Averages two rows of a level into a row of the next level, and
+            /// stores that row.
+            ///
+            /// @param level The index of the level of the two rows.
+            /// @param y The row of the second row, which is the first row
+            /// itself at the top of an odd-height level.
+            /// @param pLower The first row.
+            /// @param pUpper The second row.
+            void StoreMipmapRow(int level, int y, const float* pLower, const float* pUpper);
+
+            /// Stores a row of a level into its tiles, then passes it to the
+            /// next level.
+            ///
+            /// @param level The index of the level.
+            /// @param y The row.
+            /// @param pSource The noise values of the row.
+            void StoreRow(int level, int y, const float* pSource);
+
+            /// Name of the file to write.
+            std::string m_destFilename;
+
+            /// Difference between the noise values of consecutive 16-bit
+            /// points.
+            float m_int16Step;
+
+            /// A flag specifying whether the mipmap pyramid is written.
+            bool m_isMipmapsEnabled;
+
+            /// The levels of the open file.
+            std::vector<TileLevel> m_levels;
+
+            /// Size of the view of the open file, in bytes.
+            size_t m_mappedViewSize;
+
+            /// For each level, a row that has not been averaged into the next
+            /// level yet, followed by a row of the next level.
+            std::vector<std::vector<float>> m_mipmapRows;
+
+            /// View of the open file, or @a NULL.
+            noise::uint8* m_pMappedView;
+
+            /// A pointer to the noise map that will be written to the file.
+            NoiseMap* m_pSourceNoiseMap;
+
+            /// Format of the points.
+            TileFormat m_tileFormat;
+
+            /// Width and height of a tile, in points.
+            int m_tileSize;
+
+            /// Number of rows of the noise map written to the open file.
+            int m_writtenRowCount;
+        };
+
+        /// Tiled noise map reader class.
+        ///
+        /// This class maps a file written by a WriterTiled object into memory,
+        /// read-only, and reads regions of the levels of the noise map stored
+        /// in it.  The operating system only reads the parts of the file that
+        /// are accessed.
+        ///
+        /// The methods that read the file do not modify this object, so several
+        /// threads can read the same file through one object at once.
+        class ReaderTiled
+        {
+
+        public:
+            /// Constructor.
+            ReaderTiled();
+
+            /// Destructor.
+            ///
+            /// Closes the open file.
+            ~ReaderTiled();
+
+            /// Closes the open file, if any.
+            void Close();
+
+            /// Returns the difference between the noise values of consecutive
+            /// 16-bit points.
+            ///
+            /// @returns The difference between the noise values of consecutive
+            /// 16-bit points.
+            float GetInt16Step() const
+            {
+                return m_int16Step;
+            }
+
+            /// Returns a level of the open file.
+            ///
+            /// @param level The index of the level, level 0 being the noise map
+            /// itself.
+            ///
+            /// @returns The description of the level.
+            ///
+            /// @pre The level is less than the value returned by
+            /// GetLevelCount().
+            const TileLevel& GetLevel(int level) const
+            {
+                assert(level >= 0 && level < GetLevelCount());
+                return m_levels[level];
+            }
+
+            /// Returns the number of levels of the open file.
+            ///
+            /// @returns The number of levels, or 0 if no file is open.
+            int GetLevelCount() const
+            {
+                return (int)m_levels.size();
+            }
+
+            /// Returns the points of a tile.
+            ///
+            /// @param level The index of the level.
+            /// @param tileX The column of the tile.
+            /// @param tileY The row of the tile.
+            ///
+            /// @returns A pointer to the points of the tile in the mapped file,
+            /// in the format returned by GetTileFormat().
+            ///
+            /// @pre The level and the tile exist.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            const void* GetTileData(int level, int tileX, int tileY) const;
+
+            /// Returns the format of the points.
+            ///
+            /// @returns The format of the points.
+            TileFormat GetTileFormat() const
+            {
+                return m_tileFormat;
+            }
+
+            /// Returns the width and height of a tile.
+            ///
+            /// @returns The width and height of a tile, in points.
+            int GetTileSize() const
+            {
+                return m_tileSize;
+            }
+
+            /// Determines if a file is open.
+            ///
+            /// @returns
+            /// - @a true if a file is open.
+            /// - @a false if not.
+            bool IsOpen() const
+            {
+                return m_pMappedView != NULL;
+            }
+
+            /// Opens a file written by a WriterTiled object.
+            ///
+            /// @param filename The name of the file.
+            ///
+            /// @throw noise::ExceptionOutOfMemory The file does not fit in the
+            /// address space.
+            /// @throw noise::ExceptionUnknown An unknown exception occurred.
+            /// Possibly the file does not exist, or is not a complete tiled
+            /// noise map file.
+            ///
+            /// This method closes any file that was open before.
+            void Open(const std::string& filename);
+
+            /// Reads a region of a level into a noise map.
+            ///
+            /// @param level The index of the level.
+            /// @param x The x coordinate of the lower-left point of the region.
+            /// @param y The y coordinate of the lower-left point of the region.
+            /// @param width The width of the region, in points.
+            /// @param height The height of the region, in points.
+            /// @param destNoiseMap The noise map that receives the region.
+            ///
+            /// @pre A file is open, and the level exists.
+            /// @pre The width and height values are positive.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions, and
+            /// those of NoiseMap::SetSize().
+            /// @throw noise::ExceptionOutOfMemory Out of memory.
+            ///
+            /// The region may extend past the edges of the level; its points
+            /// outside the level are set to the border value of the destination
+            /// noise map.
+            void ReadRegion(int level, int x, int y, int width, int height, NoiseMap& destNoiseMap) const;
+
+        protected:
+            /// Difference between the noise values of consecutive 16-bit
+            /// points.
+            float m_int16Step;
+
+            /// The levels of the open file.
+            std::vector<TileLevel> m_levels;
+
+            /// Size of the view of the open file, in bytes.
+            size_t m_mappedViewSize;
+
+            /// View of the open file, or @a NULL.
+            const noise::uint8* m_pMappedView;
+
+            /// Format of the points.
+            TileFormat m_tileFormat;
+
+            /// Width and height of a tile, in points.
+            int m_tileSize;
+        };
+
+        /// Scratch memory of a thread.
+        ///
+        /// A scratch arena hands out memory for temporary buffers, such as the
+        /// row buffers of a renderer, from a few large blocks instead of the
+        /// heap.  The ExecutionContext::Run() method marks the arena of a
+        /// thread before each task and releases it back to that mark after the
+        /// task, so the memory allocated by a task is valid until the task
+        /// returns, and a thread reuses the same memory for all of its tasks.
+        ///
+        /// Each thread has its own arena; call the
+        /// ExecutionContext::GetScratchArena() method to get the arena of the
+        /// calling thread.
+        class ScratchArena
+        {
+
+        public:
+            /// A position in a scratch arena.
+            struct Mark
+            {
+                /// Number of blocks in use.
+                size_t blockCount;
+
+                /// Number of bytes used in the last block in use.
+                size_t usedSize;
+            };
+
+            /// Constructor.
+            ScratchArena();
+
+            /// Allocates memory from the arena.
+            ///
+            /// @param size The number of bytes to allocate.
+            ///
+            /// @returns A pointer to the memory, aligned to a multiple of
+            /// SCRATCH_ARENA_ALIGNMENT bytes.
+            ///
+            /// @throw noise::ExceptionOutOfMemory Out of memory.
+            ///
+            /// The memory is valid until the arena is released to a mark taken
+            /// before this call.
+            void* Allocate(size_t size);
+
+            /// Allocates an array from the arena.
+            ///
+            /// @param count The number of elements of the array.
+            ///
+            /// @returns A pointer to the first element of the array.
+            ///
+            /// @throw noise::ExceptionOutOfMemory Out of memory.
+            ///
+            /// The elements are not initialized, so @a T must be a type that
+            /// does not need construction, such as @a double or Color.
+            template <class T> T* AllocateArray(size_t count)
+            {
+                return static_cast<T*>(Allocate(count * sizeof(T)));
+            }
+
+            /// Returns the amount of memory held by the arena.
+            ///
+            /// @returns The size of the blocks of the arena, in bytes.
+            size_t GetCapacity() const;
+
+            /// Returns the current position in the arena.
+            ///
+            /// @returns The mark to pass to the Release() method.
+            Mark GetMark() const;
+
+            /// Releases the memory allocated since a mark was taken.
+            ///
+            /// @param mark The mark returned by GetMark().
+            ///
+            /// When the arena is released to its start after it had to add
+            /// blocks, it replaces its blocks by a single block holding all of
+            /// their memory, so the next tasks fit in one block.
+            void Release(const Mark& mark);
+
+        protected:
+            /// A block of memory of the arena.
+            struct Block
+            {
+                /// The memory of the block.
+                std::unique_ptr<char[]> pData;
+
+                /// Size of the block, in bytes.
+                size_t size;
+            };
+
+            /// Blocks of the arena, in allocation order.
+            std::vector<Block> m_blocks;
+
+            /// Number of blocks in use.
+            size_t m_blockCount;
+
+            /// Number of bytes used in the last block in use.
+            size_t m_usedSize;
+        };
+
+        /// Pool of worker threads shared by execution contexts.
+        ///
+        /// A thread pool runs the tasks of the ExecutionContext objects created
+        /// over it.  Several threads can run tasks through the same pool at
+        /// once, so the noise-map builders and renderers of an application can
+        /// build many maps concurrently without creating more threads than
+        /// there are cores.
+        ///
+        /// The tasks of each call to ExecutionContext::Run() are split into one
+        /// range of task indices per thread.  A thread runs the tasks of its
+        /// own range in order; when it runs out of tasks, it steals the second
+        /// half of the largest remaining range of another thread.  The thread
+        /// that calls ExecutionContext::Run() works on its tasks as well, and
+        /// the worker threads help with the tasks of the oldest call first.
+        class ThreadPool
+        {
+
+        public:
+            /// Constructor.
+            ///
+            /// @param threadCount The number of threads that run the tasks of
+            /// a call to ExecutionContext::Run(), including the calling thread,
+            /// or 0 to use one thread per hardware thread.
+            ///
+            /// @pre The thread count is not negative.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            ///
+            /// The pool creates one worker thread less than the thread count.
+            explicit ThreadPool(int threadCount = 0);
+
+            /// Destructor.
+            ///
+            /// Stops the worker threads.  No call to ExecutionContext::Run()
+            /// may be in progress on this pool.
+            ~ThreadPool();
+
+            /// Returns the number of threads that run the tasks of a call to
+            /// ExecutionContext::Run().
+            ///
+            /// @returns The number of threads, including the calling thread.
+            int GetThreadCount() const
+            {
+                return m_threadCount;
+            }
+
+        protected:
+            friend class ExecutionContext;
+
+            /// The tasks of a call to ExecutionContext::Run(), defined in
+            /// noiseutils.cpp.
+            struct Job;
+
+            /// Runs the tasks of a job on the calling thread together with the
+            /// worker threads, and returns when all of them have completed.
+            void RunJob(Job& job);
+
+            /// Body of the worker threads.
+            void RunWorker();
+
+            /// Jobs with tasks left to claim, oldest first.
+            std::list<Job*> m_jobs;
+
+            /// Signals the worker threads that a job was added or that the pool
+            /// is stopping.
+            std::condition_variable m_jobAdded;
+
+            /// Protects the list of jobs and the stop flag.
+            std::mutex m_mutex;
+
+            /// A flag that tells the worker threads to stop.
+            bool m_isStopping;
+
+            /// Number of threads that run the tasks of a job.
+            int m_threadCount;
+
+            /// The worker threads.
+            std::vector<std::thread> m_threads;
+        };
+
+        /// Execution context of the noise-map builders, renderers and band
+        /// pipelines.
+        ///
+        /// An execution context runs the tasks of the objects it is passed to,
+        /// such as the rows of a noise map or the bands of rows of an image,
+        /// on the threads of a ThreadPool.  It also holds the state of the job
+        /// these objects perform for the application:
+        /// - A <i>cancellation flag</i>: once the Cancel() method is called,
+        ///   possibly from another thread, the tasks that have not started yet
+        ///   are skipped, and Run() throws noise::ExceptionCancelled.
+        /// - The <i>progress</i> of the job: the number of tasks that were
+        ///   submitted to the context, and the number of those that have
+        ///   completed.  Another thread can poll them to display the progress
+        ///   of the job.
+        ///
+        /// Create one execution context per job over a thread pool shared by
+        /// all jobs.  An execution context created without a thread pool runs
+        /// the tasks on the calling thread.
+        ///
+        /// To run the tasks of a noise-map builder, a renderer or a band
+        /// pipeline through an execution context, pass the context to their
+        /// SetExecutionContext() method.  Their thread count setting is then
+        /// ignored.
+        class ExecutionContext
+        {
+
+        public:
+            /// Constructor.
+            ///
+            /// The tasks are run on the calling thread.
+            ExecutionContext();
+
+            /// Constructor.
+            ///
+            /// @param threadPool The thread pool that runs the tasks.
+            ///
+            /// The thread pool must exist throughout the lifetime of this
+            /// object.
+            explicit ExecutionContext(ThreadPool& threadPool);
+
+            /// Cancels the job.
+            ///
+            /// The calls to Run() in progress skip the tasks that have not
+            /// started yet, and the calls to Run() throw
+            /// noise::ExceptionCancelled until the Reset() method is called.
+            /// This method can be called from any thread.
+            void Cancel()
+            {
+                m_isCancelled = true;
+            }
+
+            /// Returns the number of tasks that have completed.
+            ///
+            /// @returns The number of tasks, since the creation of this object
+            /// or the last call to Reset().
+            size_t GetCompletedTaskCount() const
+            {
+                return m_completedTaskCount;
+            }
+
+            /// Returns the scratch arena of the calling thread.
+            ///
+            /// @returns The scratch arena.
+            ///
+            /// A task can allocate temporary buffers from this arena; they are
+            /// released when the task returns.
+            static ScratchArena& GetScratchArena();
+
+            /// Returns the number of tasks that were submitted.
+            ///
+            /// @returns The number of tasks, since the creation of this object
+            /// or the last call to Reset().
+            size_t GetTaskCount() const
+            {
+                return m_taskCount;
+            }
+
+            /// Returns the number of threads that run the tasks.
+            ///
+            /// @returns The number of threads, including the calling thread.
+            int GetThreadCount() const
+            {
+                return (m_pThreadPool != NULL) ? m_pThreadPool->GetThreadCount() : 1;
+            }
+
+            /// Returns the thread pool that runs the tasks.
+            ///
+            /// @returns The thread pool, or @a NULL if the tasks are run on the
+            /// calling thread.
+            ThreadPool* GetThreadPool() const
+            {
+                return m_pThreadPool;
+            }
+
+            /// Determines if the job was cancelled.
+            ///
+            /// @returns
+            /// - @a true if the Cancel() method was called since the creation
+            ///   of this object or the last call to Reset().
+            /// - @a false if not.
+            bool IsCancelled() const
+            {
+                return m_isCancelled;
+            }
+
+            /// Clears the cancellation flag and the progress, so that the
+            /// context can run another job.
+            ///
+            /// @pre No call to Run() is in progress.
+            void Reset();
+
+            /// Runs tasks, and returns when all of them have completed.
+            ///
+            /// @param taskCount The number of tasks.
+            /// @param runTask The function that runs the task whose index, from
+            /// 0 to @a taskCount - 1, is passed to it.
+            ///
+            /// @throw noise::ExceptionCancelled The job was cancelled before
+            /// all tasks have started.
+            ///
+            /// The tasks are run in any order and on any thread of the thread
+            /// pool, including the calling thread.  Each task may allocate
+            /// temporary buffers from the scratch arena of its thread.  A task
+            /// may call this method again, for example through a noise-map
+            /// builder that uses the same context.
+            ///
+            /// If a task throws an exception, the tasks that have not started
+            /// yet are skipped, and this method rethrows the exception after
+            /// the other tasks have stopped.
+            void Run(int taskCount, const std::function<void(int task)>& runTask);
+
+        protected:
+            /// Number of tasks that have completed.
+            std::atomic<size_t> m_completedTaskCount;
+
+            /// A flag that specifies whether the job was cancelled.
+            std::atomic<bool> m_isCancelled;
+
+            /// Thread pool that runs the tasks, or @a NULL.
+            ThreadPool* m_pThreadPool;
+
+            /// Number of tasks that were submitted.
+            std::atomic<size_t> m_taskCount;
+        };
+
+        /// Abstract base class for a noise-map builder
+        ///
+        /// A builder class builds a noise map by filling it with coherent-noise
+        /// values generated from the surface of a three-dimensional mathematical
+        /// object.  Each builder class defines a specific three-dimensional
+        /// surface, such as a cylinder, sphere, or plane.
+        ///
+        /// A builder class describes these input values using a coordinate system
+        /// applicable for the mathematical object (e.g., a latitude/longitude
+        /// coordinate system for the spherical noise-map builder.)  It then
+        /// "flattens" these coordinates onto a plane so that it can write the
+        /// coherent-noise values into a two-dimensional noise map.
+        ///
+        /// <b>Building the Noise Map</b>
+        ///
+        /// To build the noise map, perform the following steps:
+        /// - Pass the bounding coordinates to the SetBounds() method.
+        /// - Pass the noise map size, in points, to the SetDestSize() method.
+        /// - Pass a NoiseMap object to the SetDestNoiseMap() method.
+        /// - Pass a noise module (derived from noise::module::ModuleBase) to the
+        ///   SetSourceModule() method.
+        /// - Call the Build() method.
+        ///
+        /// You may also pass a callback function to the SetCallback() method.
+        /// The Build() method calls this callback function each time it fills a
+        /// row of the noise map with coherent-noise values.  This callback
+        /// function has a single integer parameter that contains a count of the
+        /// rows that have been completed.  It returns void.
+        ///
+        /// <b>Building the Noise Map in Parallel</b>
+        ///
+        /// Pass a thread count greater than one to the SetThreadCount() method
+        /// to spread the rows of the noise map across several threads.  The
+        /// resulting noise map is identical to the one built by a single
+        /// thread, and the callback function is still called once per row, in
+        /// row order, from the thread that called Build().  To share threads
+        /// with other builders and renderers, pass an ExecutionContext object
+        /// to the SetExecutionContext() method instead.
+        ///
+        /// Note that SetBounds() is not defined in the abstract base class; it is
+        /// only defined in the derived classes.  This is because each model uses
+        /// a different coordinate system.
+        class NoiseMapBuilder
+        {
+
+        public:
+            /// Constructor.
+            NoiseMapBuilder();
+
+            /// Builds the noise map.
+            ///
+            /// @pre SetBounds() was previously called.
+            /// @pre SetDestNoiseMap() was previously called.
+            /// @pre SetSourceModule() was previously called.
+            /// @pre The width and height values specified by SetDestSize() are
+            /// positive.
+            /// @pre The width and height values specified by SetDestSize() do not
+            /// exceed the maximum possible width and height for the noise map.
+            ///
+            /// @post The original contents of the destination noise map is
+            /// destroyed.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            /// @throw noise::ExceptionOutOfMemory Out of memory.
+            ///
+            /// If this method is successful, the destination noise map contains
+            /// the coherent-noise values from the noise module specified by
+            /// SetSourceModule().
+            void Build();
+
+            /// Builds a band of rows of the noise map.
+            ///
+            /// @param yBegin The first row of the band.
+            /// @param yEnd The row after the last row of the band.
+            /// @param destBand The noise map that receives the rows of the band.
+            ///
+            /// @pre SetBounds() was previously called.
+            /// @pre SetSourceModule() was previously called.
+            /// @pre The width and height values specified by SetDestSize() are
+            /// positive.
+            /// @pre 0 <= @a yBegin < @a yEnd <= the height specified by
+            /// SetDestSize().
+            ///
+            /// @post The original contents of the band noise map is destroyed.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            /// @throw noise::ExceptionOutOfMemory Out of memory.
+            ///
+            /// This method resizes the band noise map to the width specified by
+            /// SetDestSize() and a height of @a yEnd - @a yBegin, and fills it
+            /// with the rows @a yBegin to @a yEnd - 1 of the noise map that the
+            /// Build() method would build.  The values are identical to the
+            /// values of the whole noise map, so an application can build a
+            /// large noise map one band at a time without holding all of it in
+            /// memory; see BandPipeline.  The destination noise map specified by
+            /// SetDestNoiseMap() is not used.
+            ///
+            /// The callback function is called once for each row of the band,
+            /// with the index of the row in the whole noise map.
+            void BuildBand(int yBegin, int yEnd, NoiseMap& destBand);
+
+            /// Builds a region of the noise map, optionally at a lower
+            /// resolution.
+            ///
+            /// @param xBegin The x coordinate of the first point of the region
+            /// in the noise map.
+            /// @param yBegin The y coordinate of the first point of the region
+            /// in the noise map.
+            /// @param width The width of the region, in points.
+            /// @param height The height of the region, in points.
+            /// @param step The distance between adjacent points of the region,
+            /// in points of the noise map.
+            /// @param destRegion The noise map that receives the region.
+            ///
+            /// @pre SetBounds() was previously called.
+            /// @pre SetSourceModule() was previously called.
+            /// @pre The width and height values specified by SetDestSize() are
+            /// positive.
+            /// @pre The width, height and step values are positive.
+            /// @pre All points of the region lie inside the noise map.
+            ///
+            /// @post The original contents of the region noise map is
+            /// destroyed.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            /// @throw noise::ExceptionOutOfMemory Out of memory.
+            ///
+            /// This method resizes the region noise map to @a width by
+            /// @a height points, and fills its point (@a x, @a y) with the
+            /// point (@a xBegin + @a x * @a step, @a yBegin + @a y * @a step)
+            /// of the noise map that the Build() method would build.  A step
+            /// of two or more samples the noise map at a lower resolution,
+            /// without evaluating the points in between; see TileCache.
+            ///
+            /// The callback function is called once for each row of the region,
+            /// with @a yBegin plus the index of the row in the region.
+            virtual void BuildRegion(int xBegin, int yBegin, int width, int height, int step, NoiseMap& destRegion) = 0;
+
+            /// Enables or disables single-precision evaluation of the source
+            /// module.
+            ///
+            /// @param enable Specifies whether to evaluate the source module in
+            /// single precision or not.
+            ///
+            /// The noise map stores single-precision values, so evaluating the
+            /// source module in double precision only to round its output
+            /// values is wasted work.  When this feature is enabled, the
+            /// Build() method evaluates the source module through its
+            /// noise::module::ModuleBase::getFloatValues() method, which
+            /// processes twice as many input values per SIMD instruction in
+            /// the generator modules and writes its output values directly
+            /// into the noise map.  The values then differ from the
+            /// double-precision values by the error documented for
+            /// noise::GradientCoherentNoise3D(), summed over the octaves of the
+            /// generator modules.
+            ///
+            /// By default, this feature is disabled.
+            void EnableFloatEvaluation(bool enable = true)
+            {
+                m_isFloatEvaluationEnabled = enable;
+            }
+
+            /// Returns the height of the destination noise map.
+            ///
+            /// @returns The height of the destination noise map, in points.
+            ///
+            /// This object does not change the height in the destination noise
+            /// map object until the Build() method is called.
+            double GetDestHeight() const
+            {
+                return m_destHeight;
+            }
+
+            /// Returns the width of the destination noise map.
+            ///
+            /// @returns The width of the destination noise map, in points.
+            ///
+            /// This object does not change the height in the destination noise
+            /// map object until the Build() method is called.
+            double GetDestWidth() const
+            {
+                return m_destWidth;
+            }
+
+            /// Returns the execution context that runs the tasks of the
+            /// Build() method.
+            ///
+            /// @returns The execution context, or @a NULL if the Build() method
+            /// uses the number of threads specified by SetThreadCount().
+            ExecutionContext* GetExecutionContext() const
+            {
+                return m_pExecutionContext;
+            }
+
+            /// Returns the number of threads that the Build() method uses.
+            ///
+            /// @returns The number of threads, or 0 if the Build() method uses
+            /// one thread per hardware thread.
+            int GetThreadCount() const
+            {
+                return m_threadCount;
+            }
+
+            /// Determines if the source module is evaluated in single
+            /// precision.
+            ///
+            /// @returns
+            /// - @a true if the source module is evaluated in single precision.
+            /// - @a false if not.
+            bool IsFloatEvaluationEnabled() const
+            {
+                return m_isFloatEvaluationEnabled;
+            }
+
+            /// Sets the callback function that Build() calls each time it fills a
+            /// row of the noise map with coherent-noise values.
+            ///
+            /// @param pCallback The callback function.
+            ///
+            /// This callback function has a single integer parameter that
+            /// contains a count of the rows that have been completed.  It returns
             /// void.  Pass a function with this signature to the SetCallback()
             /// method.
             void SetCallback(NoiseMapCallback pCallback);
@@ -1421,7 +2790,64 @@ namespace noise
                 m_destHeight = destHeight;
             }
 
+            /// Sets the execution context that runs the tasks of the Build()
+            /// method.
+            ///
+            /// @param pContext The execution context, or @a NULL to use the
+            /// number of threads specified by SetThreadCount().
+            ///
+            /// The Build() method runs its rows as tasks of the execution
+            /// context, on the threads of its thread pool, and throws
+            /// noise::ExceptionCancelled if the job of the context is
+            /// cancelled.  The execution context must exist until this object
+            /// no longer uses it.
+            void SetExecutionContext(ExecutionContext* pContext);
+
+            /// Sets the number of threads that the Build() method uses.
+            ///
+            /// @param threadCount The number of threads, or 0 to use one thread
+            /// per hardware thread.
+            ///
+            /// @pre The thread count is not negative.
+            ///
+            /// @throw noise::ExceptionInvalidParam An invalid parameter was
+            /// specified; see the preconditions for more information.
+            ///
+            /// By default, the Build() method uses one thread.
+            ///
+            /// When more than one thread is used, the source module is evaluated
+            /// by several threads at once.  The noise modules included in
+            /// libnoise can be evaluated concurrently, except for the
+            /// noise::module::Cache noise module, which must not be part of the
+            /// source module in this case; use noise::module::ThreadCache
+            /// instead.
+            void SetThreadCount(int threadCount);
+
         protected:
+            /// Calls a row-building function once for each row of a band of the
+            /// destination noise map.
+            ///
+            /// @param yBegin The first row of the band.
+            /// @param yEnd The row after the last row of the band.
+            /// @param buildRow The function that fills the row whose index is
+            /// passed to it.
+            ///
+            /// The rows are run as tasks of the execution context specified by
+            /// SetExecutionContext(), or distributed across the threads
+            /// specified by SetThreadCount().  This method calls the callback
+            /// function once per row, in row order, from the calling thread.
+            /// If a row-building function throws an exception, this method
+            /// rethrows it after all threads have stopped.
+            void BuildRows(int yBegin, int yEnd, const std::function<void(int row)>& buildRow);
+
+            /// Determines if a region lies inside the destination noise map.
+            ///
+            /// @returns
+            /// - @a true if the parameters of BuildRegion() describe a
+            ///   non-empty region inside the destination noise map.
+            /// - @a false if not.
+            bool IsRegionValid(int xBegin, int yBegin, int width, int height, int step) const;
+
             /// The callback function that Build() calls each time it fills a row
             /// of the noise map with coherent-noise values.
             ///
@@ -1437,11 +2863,23 @@ namespace noise
             /// Width of the destination noise map, in points.
             int m_destWidth;
 
+            /// Execution context that runs the tasks of the Build() method, or
+            /// @a NULL.
+            ExecutionContext* m_pExecutionContext;
+
             /// Destination noise map that will contain the coherent-noise values.
             NoiseMap* m_pDestNoiseMap;
 
+            /// A flag specifying whether the source module is evaluated in
+            /// single precision.
+            bool m_isFloatEvaluationEnabled;
+
             /// Source noise module that will generate the coherent-noise values.
             const module::ModuleBase* m_pSourceModule;
+
+            /// Number of threads that the Build() method uses, or 0 for one
+            /// thread per hardware thread.
+            int m_threadCount;
         };
 
         /// Builds a cylindrical noise map.
@@ -1472,7 +2910,7 @@ namespace noise
             /// Constructor.
             NoiseMapBuilderCylinder();
 
-            virtual void Build();
+            virtual void BuildRegion(int xBegin, int yBegin, int width, int height, int step, NoiseMap& destRegion);
 
             /// Returns the lower angle boundary of the cylindrical noise map.
             ///
@@ -1577,7 +3015,7 @@ namespace noise
             /// Constructor.
             NoiseMapBuilderPlane();
 
-            virtual void Build();
+            virtual void BuildRegion(int xBegin, int yBegin, int width, int height, int step, NoiseMap& destRegion);
 
             /// Enables or disables seamless tiling.
             ///
@@ -1705,7 +3143,7 @@ namespace noise
             /// Constructor.
             NoiseMapBuilderSphere();
 
-            virtual void Build();
+            virtual void BuildRegion(int xBegin, int yBegin, int width, int height, int step, NoiseMap& destRegion);
 
             /// Returns the eastern boundary of the spherical noise map.
             ///
@@ -2031,6 +3469,25 @@ namespace noise
                 return m_lightIntensity;
             }
 
+            /// Returns the execution context that runs the tasks of the
+            /// Render() method.
+            ///
+            /// @returns The execution context, or @a NULL if the Render() method
+            /// uses the number of threads specified by SetThreadCount().
+            ExecutionContext* GetExecutionContext() const
+            {
+                return m_pExecutionContext;
+            }
+
+            /// Returns the number of threads that the Render() method uses.
+            ///
+            /// @returns The number of threads, or 0 if the Render() method uses
+            /// one thread per hardware thread.
+            int GetThreadCount() const
+            {
+                return m_threadCount;
+            }
+
             /// Determines if the light source is enabled.
             ///
             /// @returns
@@ -2080,6 +3537,38 @@ namespace noise
             /// irretrievably blended into the background image.
             void Render();
 
+            /// Renders a band of rows of an image.
+            ///
+            /// @param sourceBand The rows of the noise map to render, preceded
+            /// by the down neighbor of the first row and followed by the up
+            /// neighbor of the last row.
+            /// @param yBegin The row of the background image that corresponds
+            /// to the first row of the band.
+            /// @param destBand The image that receives the rendered rows.
+            ///
+            /// @pre The source band is at least three rows high.
+            /// @pre The color gradient has at least two gradient points.
+            /// @pre If a background image has been specified, it is as wide as
+            /// the source band, contains the rows @a yBegin to @a yBegin +
+            /// the height of the band - 1, and is not the band image.
+            ///
+            /// @post The original contents of the band image is destroyed.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            ///
+            /// This method renders the rows 1 to height - 2 of the source band
+            /// into the rows 0 to height - 3 of the band image, which it
+            /// resizes accordingly.  The first and last rows of the source band
+            /// are only read as the neighbors used by the lighting
+            /// calculations, so the caller applies the wrapping or cropping
+            /// rules to the top and bottom edges of the noise map when it
+            /// chooses them; this object applies them to the left and right
+            /// edges.  A large noise map can then be rendered one band at a
+            /// time without holding all of it in memory; see BandPipeline.  The
+            /// source noise map and the destination image specified by
+            /// SetSourceNoiseMap() and SetDestImage() are not used.
+            void RenderBand(const NoiseMap& sourceBand, int yBegin, Image& destBand);
+
             /// Sets the background image.
             ///
             /// @param backgroundImage The background image.
@@ -2230,6 +3719,35 @@ namespace noise
                 m_pSourceNoiseMap = &sourceNoiseMap;
             }
 
+            /// Sets the execution context that runs the tasks of the Render()
+            /// method.
+            ///
+            /// @param pContext The execution context, or @a NULL to use the
+            /// number of threads specified by SetThreadCount().
+            ///
+            /// The Render() method runs its bands of rows as tasks of the
+            /// execution context, on the threads of its thread pool, and
+            /// throws noise::ExceptionCancelled if the job of the context is
+            /// cancelled.  The execution context must exist until this object
+            /// no longer uses it.
+            void SetExecutionContext(ExecutionContext* pContext);
+
+            /// Sets the number of threads that the Render() method uses.
+            ///
+            /// @param threadCount The number of threads, or 0 to use one thread
+            /// per hardware thread.
+            ///
+            /// @pre The thread count is not negative.
+            ///
+            /// @throw noise::ExceptionInvalidParam An invalid parameter was
+            /// specified; see the preconditions for more information.
+            ///
+            /// By default, the Render() method uses one thread.  The Render()
+            /// method splits the image into bands of rows and renders them on
+            /// this many threads; the rendered image does not depend on the
+            /// number of threads.
+            void SetThreadCount(int threadCount);
+
         private:
             /// Calculates the destination color.
             ///
@@ -2242,19 +3760,24 @@ namespace noise
             /// @returns The destination color.
             Color CalcDestColor(const Color& sourceColor, const Color& backgroundColor, double lightValue) const;
 
-            /// Calculates the intensity of the light given some elevation values.
+            /// Recalculates the sine and cosine of the light azimuth and
+            /// elevation if the light parameters have changed.
+            void CalcLightValues() const;
+
+            /// Renders rows of an image, spreading them across the threads
+            /// specified by SetThreadCount().
             ///
-            /// @param center Elevation of the center point.
-            /// @param left Elevation of the point directly left of the center
-            /// point.
-            /// @param right Elevation of the point directly right of the center
-            /// point.
-            /// @param down Elevation of the point directly below the center
-            /// point.
-            /// @param up Elevation of the point directly above the center point.
+            /// @param ppSourceRows The rows of the noise map: the row at index
+            /// @a y + 1 is rendered into the row @a y of the image, and the
+            /// rows at index @a y and @a y + 2 are its down and up neighbors.
+            /// @param width The width of the rows, in points.
+            /// @param rowCount The number of rows to render.
+            /// @param backgroundYBegin The row of the background image that
+            /// corresponds to the first row of the image.
+            /// @param destImage The image that receives the rendered rows.
             ///
-            /// These values come directly from the noise map.
-            double CalcLightIntensity(double center, double left, double right, double down, double up) const;
+            /// Call CalcLightValues() before calling this method.
+            void RenderRows(const float* const* ppSourceRows, int width, int rowCount, int backgroundYBegin, Image& destImage) const;
 
             /// The cosine of the azimuth of the light source.
             mutable double m_cosAzimuth;
@@ -2295,14 +3818,18 @@ namespace noise
             /// A pointer to the destination image.
             Image* m_pDestImage;
 
+            /// Execution context that runs the tasks of the Render() method, or
+            /// @a NULL.
+            ExecutionContext* m_pExecutionContext;
+
             /// A pointer to the source noise map.
             const NoiseMap* m_pSourceNoiseMap;
 
-            /// Used by the CalcLightIntensity() method to recalculate the light
+            /// Used by the CalcLightValues() method to recalculate the light
             /// values only if the light parameters change.
             ///
             /// When the light parameters change, this value is set to True.  When
-            /// the CalcLightIntensity() method is called, this value is set to
+            /// the CalcLightValues() method is called, this value is set to
             /// false.
             mutable bool m_recalcLightValues;
 
@@ -2311,6 +3838,10 @@ namespace noise
 
             /// The sine of the elevation of the light source.
             mutable double m_sinElev;
+
+            /// Number of threads that the Render() method uses, or 0 for one
+            /// thread per hardware thread.
+            int m_threadCount;
         };
 
         /// Renders a normal map from a noise map.
@@ -2380,6 +3911,25 @@ namespace noise
                 return m_bumpHeight;
             }
 
+            /// Returns the execution context that runs the tasks of the
+            /// Render() method.
+            ///
+            /// @returns The execution context, or @a NULL if the Render() method
+            /// uses the number of threads specified by SetThreadCount().
+            ExecutionContext* GetExecutionContext() const
+            {
+                return m_pExecutionContext;
+            }
+
+            /// Returns the number of threads that the Render() method uses.
+            ///
+            /// @returns The number of threads, or 0 if the Render() method uses
+            /// one thread per hardware thread.
+            int GetThreadCount() const
+            {
+                return m_threadCount;
+            }
+
             /// Determines if noise-map wrapping is enabled.
             ///
             /// @returns
@@ -2411,6 +3961,26 @@ namespace noise
             /// @throw noise::ExceptionInvalidParam See the preconditions.
             void Render();
 
+            /// Renders a band of rows of a normal map.
+            ///
+            /// @param sourceBand The rows of the noise map to render, preceded
+            /// by an unused row and followed by the up neighbor of the last
+            /// row.
+            /// @param destBand The image that receives the rendered rows.
+            ///
+            /// @pre The source band is at least three rows high.
+            ///
+            /// @post The original contents of the band image is destroyed.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            ///
+            /// This method renders the rows 1 to height - 2 of the source band
+            /// into the rows 0 to height - 3 of the band image, which it
+            /// resizes accordingly.  The layout of the source band matches the
+            /// one of RendererImage::RenderBand(), so both renderers can consume
+            /// the same bands; see that method and BandPipeline.
+            void RenderBand(const NoiseMap& sourceBand, Image& destBand);
+
             /// Sets the bump height.
             ///
             /// @param bumpHeight The bump height.
@@ -2452,6 +4022,35 @@ namespace noise
                 m_pSourceNoiseMap = &sourceNoiseMap;
             }
 
+            /// Sets the execution context that runs the tasks of the Render()
+            /// method.
+            ///
+            /// @param pContext The execution context, or @a NULL to use the
+            /// number of threads specified by SetThreadCount().
+            ///
+            /// The Render() method runs its bands of rows as tasks of the
+            /// execution context, on the threads of its thread pool, and
+            /// throws noise::ExceptionCancelled if the job of the context is
+            /// cancelled.  The execution context must exist until this object
+            /// no longer uses it.
+            void SetExecutionContext(ExecutionContext* pContext);
+
+            /// Sets the number of threads that the Render() method uses.
+            ///
+            /// @param threadCount The number of threads, or 0 to use one thread
+            /// per hardware thread.
+            ///
+            /// @pre The thread count is not negative.
+            ///
+            /// @throw noise::ExceptionInvalidParam An invalid parameter was
+            /// specified; see the preconditions for more information.
+            ///
+            /// By default, the Render() method uses one thread.  The Render()
+            /// method splits the image into bands of rows and renders them on
+            /// this many threads; the rendered image does not depend on the
+            /// number of threads.
+            void SetThreadCount(int threadCount);
+
         private:
             /// Calculates the normal vector at a given point on the noise map.
             ///
@@ -2476,6 +4075,16 @@ namespace noise
             /// the application.
             Color CalcNormalColor(double nc, double nr, double nu, double bumpHeight) const;
 
+            /// Renders rows of a normal map, spreading them across the threads
+            /// specified by SetThreadCount().
+            ///
+            /// @param ppSourceRows The rows of the noise map, in the layout
+            /// described by RendererImage::RenderRows().
+            /// @param width The width of the rows, in points.
+            /// @param rowCount The number of rows to render.
+            /// @param destImage The image that receives the rendered rows.
+            void RenderRows(const float* const* ppSourceRows, int width, int rowCount, Image& destImage) const;
+
             /// The bump height for the normal map.
             double m_bumpHeight;
 
@@ -2485,8 +4094,478 @@ namespace noise
             /// A pointer to the destination image.
             Image* m_pDestImage;
 
+            /// Execution context that runs the tasks of the Render() method, or
+            /// @a NULL.
+            ExecutionContext* m_pExecutionContext;
+
             /// A pointer to the source noise map.
             const NoiseMap* m_pSourceNoiseMap;
+
+            /// Number of threads that the Render() method uses, or 0 for one
+            /// thread per hardware thread.
+            int m_threadCount;
+        };
+
+        /// Builds, renders and writes a noise map one band of rows at a time.
+        ///
+        /// Building a noise map with a NoiseMapBuilder, rendering it with
+        /// RendererImage and writing it with WriterBMP holds the whole noise
+        /// map and the whole image in memory; a 32768 x 16384 map takes 2 GB
+        /// for each of them.  This class instead passes bands of rows from the
+        /// builder to the renderer and from the renderer to the writer, so its
+        /// memory use is proportional to the width of the noise map times the
+        /// band height:
+        ///
+        /// - The builder fills each band with the NoiseMapBuilder::BuildBand()
+        ///   method, one row ahead of the renderer, because the lighting
+        ///   calculations of a row read the row above it.
+        /// - The renderer renders each band with its RenderBand() method.  This
+        ///   class supplies the neighbors of the first and last rows of the
+        ///   noise map according to the wrapping setting of the renderer.
+        /// - The writer appends each band to the file with its WriteRows()
+        ///   method.  If its background writing is enabled, the file is
+        ///   written while the next band is built and rendered.
+        ///
+        /// The resulting file is identical to the one written from the whole
+        /// noise map and image.  Each row is built once, except that a
+        /// renderer with wrapping enabled needs the last row of the noise map
+        /// before the first band, which is built twice.  The builder and the
+        /// renderer still spread the rows of each band across the threads
+        /// specified by their SetThreadCount() methods.
+        ///
+        /// <b>Running the pipeline</b>
+        ///
+        /// - Set up a NoiseMapBuilder object as for its Build() method, except
+        ///   that no destination noise map is needed, and pass it to the
+        ///   SetNoiseMapBuilder() method.
+        /// - To write an image, set up a RendererImage or RendererNormalMap
+        ///   object as for its Render() method, except that no source noise
+        ///   map and destination image are needed, and pass it to the
+        ///   SetRenderer() method.  Then pass a WriterBMP object with a file
+        ///   name to the SetWriter() method.
+        /// - To write the noise map itself, pass a WriterTER or WriterTiled
+        ///   object with a file name to the SetWriter() method, without a
+        ///   renderer.
+        /// - Call the Run() method.
+        ///
+        /// A background image of a RendererImage object must be as large as
+        /// the whole image, so use it only if it fits in memory.
+        class BandPipeline
+        {
+
+        public:
+            /// Constructor.
+            BandPipeline();
+
+            /// Returns the number of rows in a band.
+            ///
+            /// @returns The number of rows in a band.
+            int GetBandHeight() const
+            {
+                return m_bandHeight;
+            }
+
+            /// Returns the execution context of the pipeline.
+            ///
+            /// @returns The execution context, or @a NULL if the builder and
+            /// the renderer use their own settings.
+            ExecutionContext* GetExecutionContext() const
+            {
+                return m_pExecutionContext;
+            }
+
+            /// Builds, renders and writes the noise map.
+            ///
+            /// @pre SetNoiseMapBuilder() has been previously called.
+            /// @pre SetWriter() has been previously called.
+            /// @pre If the writer is a WriterBMP object, SetRenderer() has been
+            /// previously called; if it is a WriterTER or WriterTiled object,
+            /// it has not.
+            /// @pre The width and height values of the builder are positive.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions, and
+            /// those of the methods of the builder, renderer and writer.
+            /// @throw noise::ExceptionOutOfMemory Out of memory.
+            /// @throw noise::ExceptionUnknown An unknown exception occurred.
+            /// Possibly the file could not be written.
+            /// @throw noise::ExceptionCancelled The job of the execution
+            /// context was cancelled.
+            ///
+            /// If an exception is thrown, the file is closed, and is
+            /// incomplete.
+            void Run();
+
+            /// Sets the number of rows in a band.
+            ///
+            /// @param bandHeight The number of rows in a band.
+            ///
+            /// @pre The band height is positive.
+            ///
+            /// @throw noise::ExceptionInvalidParam An invalid parameter was
+            /// specified; see the preconditions for more information.
+            ///
+            /// Larger bands give the threads of the builder and the renderer
+            /// more rows to share, and use more memory.  By default, a band
+            /// has noise::utils::DEFAULT_PIPELINE_BAND_HEIGHT rows.
+            void SetBandHeight(int bandHeight);
+
+            /// Sets the execution context of the pipeline.
+            ///
+            /// @param pContext The execution context, or @a NULL.
+            ///
+            /// While the Run() method runs, the builder and the renderer run
+            /// their tasks through this execution context instead of the one
+            /// passed to their own SetExecutionContext() method.  Cancelling
+            /// the job of the context stops the pipeline before its next task,
+            /// and closes the incomplete file.  The execution context must
+            /// exist until this object no longer uses it.
+            void SetExecutionContext(ExecutionContext* pContext)
+            {
+                m_pExecutionContext = pContext;
+            }
+
+            /// Sets the builder that builds the bands of the noise map.
+            ///
+            /// @param builder The noise map builder.
+            ///
+            /// The builder must exist throughout the lifetime of this object
+            /// unless another builder replaces that builder.
+            void SetNoiseMapBuilder(NoiseMapBuilder& builder)
+            {
+                m_pBuilder = &builder;
+            }
+
+            /// Sets the renderer that renders the bands of the image.
+            ///
+            /// @param renderer The image renderer.
+            ///
+            /// This renderer replaces any renderer set before.  It must exist
+            /// throughout the lifetime of this object unless another renderer
+            /// replaces that renderer.
+            void SetRenderer(RendererImage& renderer)
+            {
+                m_pRendererImage = &renderer;
+                m_pRendererNormalMap = NULL;
+            }
+
+            /// Sets the renderer that renders the bands of the normal map.
+            ///
+            /// @param renderer The normal map renderer.
+            ///
+            /// This renderer replaces any renderer set before.  It must exist
+            /// throughout the lifetime of this object unless another renderer
+            /// replaces that renderer.
+            void SetRenderer(RendererNormalMap& renderer)
+            {
+                m_pRendererImage = NULL;
+                m_pRendererNormalMap = &renderer;
+            }
+
+            /// Sets the writer that writes the rendered image.
+            ///
+            /// @param writer The Windows bitmap writer.
+            ///
+            /// This writer replaces any writer set before.  It must exist
+            /// throughout the lifetime of this object unless another writer
+            /// replaces that writer.
+            void SetWriter(WriterBMP& writer)
+            {
+                m_pWriterBMP = &writer;
+                m_pWriterTER = NULL;
+                m_pWriterTiled = NULL;
+            }
+
+            /// Sets the writer that writes the noise map.
+            ///
+            /// @param writer The Terragen Terrain writer.
+            ///
+            /// This writer replaces any writer set before.  It must exist
+            /// throughout the lifetime of this object unless another writer
+            /// replaces that writer.
+            void SetWriter(WriterTER& writer)
+            {
+                m_pWriterBMP = NULL;
+                m_pWriterTER = &writer;
+                m_pWriterTiled = NULL;
+            }
+
+            /// Sets the writer that writes the noise map and its mipmap
+            /// pyramid as tiles.
+            ///
+            /// @param writer The tiled noise map writer.
+            ///
+            /// This writer replaces any writer set before.  It must exist
+            /// throughout the lifetime of this object unless another writer
+            /// replaces that writer.
+            void SetWriter(WriterTiled& writer)
+            {
+                m_pWriterBMP = NULL;
+                m_pWriterTER = NULL;
+                m_pWriterTiled = &writer;
+            }
+
+        private:
+            /// Builds, renders and writes the bands for a WriterBMP object.
+            void RunRendered(int width, int height);
+
+            /// Number of rows in a band.
+            int m_bandHeight;
+
+            /// The builder that builds the bands of the noise map.
+            NoiseMapBuilder* m_pBuilder;
+
+            /// The execution context of the pipeline, or NULL.
+            ExecutionContext* m_pExecutionContext;
+
+            /// The image renderer, or NULL.
+            RendererImage* m_pRendererImage;
+
+            /// The normal map renderer, or NULL.
+            RendererNormalMap* m_pRendererNormalMap;
+
+            /// The Windows bitmap writer, or NULL.
+            WriterBMP* m_pWriterBMP;
+
+            /// The Terragen Terrain writer, or NULL.
+            WriterTER* m_pWriterTER;
+
+            /// The tiled noise map writer, or NULL.
+            WriterTiled* m_pWriterTiled;
+        };
+
+        /// Builds the tiles of a noise map on demand and caches them.
+        ///
+        /// An interactive viewer of a large noise map only shows a few tiles
+        /// of it at a time, at the resolution of its zoom level.  This class
+        /// builds those tiles with the NoiseMapBuilder::BuildRegion() method
+        /// of a noise map builder when they are first requested, and keeps the
+        /// most recently used tiles in memory, so that the viewer only pays
+        /// for the tiles that it shows.
+        ///
+        /// The builder defines the whole noise map, through its source module,
+        /// its projection (plane, cylinder or sphere), its bounds and its
+        /// destination size.  The tiles are square, and are identified by
+        /// their level and by their column and row in that level:
+        ///
+        /// - Level 0 is the noise map itself.  Its tile (@a x, @a y) holds the
+        ///   points from (@a x, @a y) times the tile size; the tiles at the
+        ///   right and top edges are smaller if the tile size does not divide
+        ///   the size of the noise map.
+        /// - Level @a n samples every 2<sup>@a n</sup>-th point of the noise
+        ///   map along each axis, so each of its tiles costs as much to build
+        ///   as a tile of level 0.  The last level fits in a single tile.
+        ///
+        /// The GetLevel() method describes each level.  Unlike the mipmap
+        /// pyramid of WriterTiled, the points of the lower levels are samples,
+        /// not averages, of the noise map.
+        ///
+        /// <b>Memory budget and spilling</b>
+        ///
+        /// When the tiles in memory exceed the memory budget, this object
+        /// drops the least recently used tiles.  If a spill directory is set,
+        /// it first writes them to files in that directory, in the format of
+        /// NoiseMap::CreateMappedFile(), and reads them back instead of
+        /// building them again.  The files are deleted by the Clear() method
+        /// and the destructor.  Each TileCache object needs its own spill
+        /// directory.
+        ///
+        /// The tiles are returned as shared pointers, so a tile stays valid
+        /// for the caller after this object drops it.
+        ///
+        /// <b>Threads</b>
+        ///
+        /// The GetTile() method can be called from several threads at once;
+        /// the calls are serialized, and each tile is built with the thread
+        /// count or the execution context of the builder.  If the builder or
+        /// its source module changes, call the Clear() method to drop the
+        /// tiles built before.
+        class TileCache
+        {
+
+        public:
+            /// Constructor.
+            TileCache();
+
+            /// Destructor.
+            ///
+            /// Deletes the spill files.
+            ~TileCache();
+
+            /// Drops all tiles, and deletes the spill files.
+            void Clear();
+
+            /// Returns a level of the noise map.
+            ///
+            /// @param level The index of the level.
+            ///
+            /// @returns The description of the level.
+            ///
+            /// @pre SetNoiseMapBuilder() has been previously called.
+            /// @pre The width and height values of the builder are positive.
+            /// @pre The level is less than the value returned by
+            /// GetLevelCount().
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            TileLevel GetLevel(int level) const;
+
+            /// Returns the number of levels of the noise map.
+            ///
+            /// @returns The number of levels.
+            ///
+            /// @pre SetNoiseMapBuilder() has been previously called.
+            /// @pre The width and height values of the builder are positive.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions.
+            int GetLevelCount() const;
+
+            /// Returns the memory budget.
+            ///
+            /// @returns The amount of memory for the tiles, in bytes.
+            size_t GetMemoryBudget() const
+            {
+                return m_memoryBudget;
+            }
+
+            /// Returns the amount of memory used by the tiles in memory.
+            ///
+            /// @returns The amount of memory, in bytes.
+            size_t GetMemoryUsage() const;
+
+            /// Returns the directory of the spill files.
+            ///
+            /// @returns The directory, or an empty string if tiles are not
+            /// spilled.
+            std::string GetSpillDirectory() const
+            {
+                return m_spillDirectory;
+            }
+
+            /// Returns a tile, building it if it is not cached.
+            ///
+            /// @param level The index of the level.
+            /// @param tileX The column of the tile.
+            /// @param tileY The row of the tile.
+            ///
+            /// @returns A noise map holding the points of the tile.
+            ///
+            /// @pre SetNoiseMapBuilder() has been previously called.
+            /// @pre The level and the tile exist.
+            ///
+            /// @throw noise::ExceptionInvalidParam See the preconditions, and
+            /// those of NoiseMapBuilder::BuildRegion().
+            /// @throw noise::ExceptionOutOfMemory Out of memory.
+            std::shared_ptr<const NoiseMap> GetTile(int level, int tileX, int tileY);
+
+            /// Returns the width and height of a tile.
+            ///
+            /// @returns The width and height of a tile, in points.
+            int GetTileSize() const
+            {
+                return m_tileSize;
+            }
+
+            /// Sets the memory budget.
+            ///
+            /// @param memoryBudget The amount of memory for the tiles, in
+            /// bytes.
+            ///
+            /// The most recently requested tile stays in memory even if it
+            /// exceeds the budget.  By default, the budget is
+            /// noise::utils::DEFAULT_TILE_CACHE_MEMORY_BUDGET.
+            void SetMemoryBudget(size_t memoryBudget);
+
+            /// Sets the builder that builds the tiles.
+            ///
+            /// @param builder The noise map builder.
+            ///
+            /// This method drops the tiles built by the previous builder.  The
+            /// builder must exist throughout the lifetime of this object unless
+            /// another builder replaces that builder.
+            void SetNoiseMapBuilder(NoiseMapBuilder& builder);
+
+            /// Sets the directory of the spill files.
+            ///
+            /// @param directory The directory, which must exist, or an empty
+            /// string to drop tiles without spilling them.
+            ///
+            /// This method deletes the spill files in the previous directory.
+            /// By default, tiles are not spilled.
+            void SetSpillDirectory(const std::string& directory);
+
+            /// Sets the width and height of a tile.
+            ///
+            /// @param tileSize The width and height of a tile, in points.
+            ///
+            /// @pre The tile size is positive and does not exceed
+            /// noise::utils::RASTER_MAX_WIDTH.
+            ///
+            /// @throw noise::ExceptionInvalidParam An invalid parameter was
+            /// specified; see the preconditions for more information.
+            ///
+            /// This method drops all tiles.  By default, a tile is
+            /// noise::utils::DEFAULT_TILE_SIZE points wide and high.
+            void SetTileSize(int tileSize);
+
+        protected:
+            /// Identifies a tile by its level, column and row.
+            typedef std::pair<int, std::pair<int, int>> TileKey;
+
+            /// A tile in memory.
+            struct CachedTile
+            {
+                /// The points of the tile.
+                std::shared_ptr<const NoiseMap> pNoiseMap;
+
+                /// The position of the tile in the list of recently used
+                /// tiles.
+                std::list<TileKey>::iterator usePos;
+
+                /// Amount of memory used by the tile, in bytes.
+                size_t memoryUsage;
+            };
+
+            /// Drops all tiles and deletes the spill files; the caller holds
+            /// the lock.
+            void ClearLocked();
+
+            /// Drops the least recently used tiles until the tiles fit in the
+            /// budget, except for the most recently used one; the caller holds
+            /// the lock.
+            void DropTiles();
+
+            /// Returns the name of the spill file of a tile.
+            std::string GetSpillFilename(const TileKey& key) const;
+
+            /// Computes the levels of the noise map of the builder.
+            void GetLevels(std::vector<TileLevel>& levels) const;
+
+            /// The tiles in memory.
+            std::map<TileKey, CachedTile> m_cachedTiles;
+
+            /// Amount of memory for the tiles, in bytes.
+            size_t m_memoryBudget;
+
+            /// Amount of memory used by the tiles in memory, in bytes.
+            size_t m_memoryUsage;
+
+            /// Serializes the calls to the methods that access the tiles.
+            mutable std::mutex m_mutex;
+
+            /// The builder that builds the tiles.
+            NoiseMapBuilder* m_pBuilder;
+
+            /// The tiles that have been written to spill files.
+            std::set<TileKey> m_spilledTiles;
+
+            /// Directory of the spill files, or an empty string.
+            std::string m_spillDirectory;
+
+            /// Width and height of a tile, in points.
+            int m_tileSize;
+
+            /// The tiles in memory, from the most recently used one to the
+            /// least recently used one.
+            std::list<TileKey> m_useOrder;
         };
 
     } // namespace utils